@@ -0,0 +1,225 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Measures a hot loop whose callees are small methods interleaved with large,
+// never executed ones, which is where the layout of the code in the
+// instructions image matters most. Compare AOT snapshots built with and
+// without --load-type-feedback.
+//
+// When 'perf' is available, also reports the instruction cache and iTLB
+// misses of the measured loop.
+
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+
+import 'package:benchmark_harness/benchmark_harness.dart';
+
+const int kShapeCount = 1000;
+
+abstract class Shape {
+  final int seed;
+
+  Shape(this.seed);
+
+  int area();
+
+  // Never executed by the benchmark, but large enough to push the hot
+  // methods of different classes apart when the code is laid out in
+  // declaration order.
+  @pragma('vm:never-inline')
+  String describe() {
+    final buffer = StringBuffer();
+    buffer.write('$runtimeType(');
+    for (var i = 0; i < seed; i++) {
+      if (i.isEven) {
+        buffer.write('even:${i * seed},');
+      } else if (i % 3 == 0) {
+        buffer.write('triple:${i ~/ 3},');
+      } else {
+        buffer.write('other:${i.toRadixString(16)},');
+      }
+    }
+    buffer.write(')');
+    return buffer.toString();
+  }
+}
+
+class Square extends Shape {
+  Square(int seed) : super(seed);
+
+  @override
+  @pragma('vm:never-inline')
+  int area() => seed * seed;
+
+  @pragma('vm:never-inline')
+  void validate() {
+    if (seed < 0) throw ArgumentError('${describe()} has negative side');
+    if (seed > 1 << 20) throw RangeError('${describe()} is too large');
+  }
+}
+
+class Rectangle extends Shape {
+  final int height;
+
+  Rectangle(int seed)
+      : height = seed + 1,
+        super(seed);
+
+  @override
+  @pragma('vm:never-inline')
+  int area() => seed * height;
+
+  @pragma('vm:never-inline')
+  void validate() {
+    if (seed < 0 || height < 0) {
+      throw ArgumentError('${describe()} has a negative side');
+    }
+    if (seed * height > 1 << 30) throw RangeError('${describe()} overflows');
+  }
+}
+
+class Triangle extends Shape {
+  Triangle(int seed) : super(seed);
+
+  @override
+  @pragma('vm:never-inline')
+  int area() => (seed * (seed + 2)) >> 1;
+
+  @pragma('vm:never-inline')
+  void validate() {
+    if (seed < 0) throw ArgumentError('${describe()} has negative base');
+    if (seed.isOdd && seed > 1 << 20) {
+      throw StateError('${describe()} is degenerate');
+    }
+  }
+}
+
+class Circle extends Shape {
+  Circle(int seed) : super(seed);
+
+  @override
+  @pragma('vm:never-inline')
+  int area() => (seed * seed * 355) ~/ 113;
+
+  @pragma('vm:never-inline')
+  void validate() {
+    if (seed < 0) throw ArgumentError('${describe()} has negative radius');
+    if (seed > 1 << 14) throw RangeError('${describe()} is too large');
+  }
+}
+
+class Hexagon extends Shape {
+  Hexagon(int seed) : super(seed);
+
+  @override
+  @pragma('vm:never-inline')
+  int area() => (seed * seed * 5196) ~/ 2000;
+
+  @pragma('vm:never-inline')
+  void validate() {
+    if (seed < 0) throw ArgumentError('${describe()} has negative side');
+    if (seed > 1 << 14) throw RangeError('${describe()} is too large');
+  }
+}
+
+class CodeLayoutBenchmark extends BenchmarkBase {
+  late List<Shape> shapes;
+  int total = 0;
+
+  CodeLayoutBenchmark() : super('CodeLayout');
+
+  @override
+  void setup() {
+    shapes = List<Shape>.generate(kShapeCount, (i) {
+      switch (i % 5) {
+        case 0:
+          return Square(i % 17);
+        case 1:
+          return Rectangle(i % 19);
+        case 2:
+          return Triangle(i % 23);
+        case 3:
+          return Circle(i % 29);
+        default:
+          return Hexagon(i % 31);
+      }
+    });
+  }
+
+  @override
+  void run() {
+    var sum = 0;
+    for (var shape in shapes) {
+      sum += shape.area();
+    }
+    total = sum;
+  }
+
+  @override
+  void teardown() {
+    if (total <= 0) {
+      // Keeps the cold methods reachable.
+      for (var shape in shapes) {
+        if (shape is Square) shape.validate();
+        if (shape is Rectangle) shape.validate();
+        if (shape is Triangle) shape.validate();
+        if (shape is Circle) shape.validate();
+        if (shape is Hexagon) shape.validate();
+      }
+      throw 'Unexpected result: $total';
+    }
+  }
+}
+
+const Map<String, String> kPerfEvents = {
+  'L1-icache-load-misses': 'ICacheMisses',
+  'iTLB-load-misses': 'ITLBMisses',
+};
+
+// Runs [benchmark] with 'perf stat' attached to this process and reports the
+// counted events. Does nothing if 'perf' cannot be started.
+Future<void> reportPerfCounters(CodeLayoutBenchmark benchmark) async {
+  Process perf;
+  try {
+    perf = await Process.start('perf', [
+      'stat',
+      '-x',
+      ',',
+      '-e',
+      kPerfEvents.keys.join(','),
+      '-p',
+      '$pid',
+    ]);
+  } on ProcessException {
+    return;
+  }
+  final output = perf.stderr.transform(utf8.decoder).join();
+  perf.stdout.drain();
+  // Give perf time to attach before the measured loop starts.
+  await Future.delayed(const Duration(milliseconds: 200));
+
+  benchmark.setup();
+  for (var i = 0; i < 10000; i++) {
+    benchmark.run();
+  }
+  benchmark.teardown();
+
+  perf.kill(ProcessSignal.sigint);
+  if (await perf.exitCode != 0) return;
+  for (final line in LineSplitter.split(await output)) {
+    final fields = line.split(',');
+    if (fields.length < 3) continue;
+    final name = kPerfEvents[fields[2]];
+    final count = int.tryParse(fields[0]);
+    if (name == null || count == null) continue;
+    print('CodeLayout.$name(Count): $count');
+  }
+}
+
+Future<void> main() async {
+  final benchmark = CodeLayoutBenchmark();
+  benchmark.report();
+  await reportPerfCounters(benchmark);
+}
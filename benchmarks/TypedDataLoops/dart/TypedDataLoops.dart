@@ -0,0 +1,146 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Micro-benchmarks for element-wise arithmetic loops over typed data lists.
+
+import 'dart:typed_data';
+
+import 'package:benchmark_harness/benchmark_harness.dart';
+
+abstract class Float64ListLoopBenchmark extends BenchmarkBase {
+  final int size;
+  late Float64List a;
+  late Float64List b;
+  late Float64List result;
+
+  Float64ListLoopBenchmark(String method, this.size)
+      : super('TypedDataLoops.Float64List.$size.$method');
+
+  @override
+  void setup() {
+    a = Float64List(size);
+    b = Float64List(size);
+    result = Float64List(size);
+    for (var i = 0; i < size; ++i) {
+      a[i] = i.toDouble();
+      b[i] = (size - i).toDouble();
+    }
+  }
+
+  @override
+  void warmup() {
+    for (var i = 0; i < 100; ++i) {
+      run();
+    }
+  }
+
+  double expected(int i);
+
+  @override
+  void teardown() {
+    for (var i = 0; i < size; ++i) {
+      if (result[i] != expected(i)) {
+        throw 'Unexpected result';
+      }
+    }
+  }
+}
+
+class Float64ListAddBenchmark extends Float64ListLoopBenchmark {
+  Float64ListAddBenchmark(int size) : super('add', size);
+
+  @override
+  void run() {
+    final a = this.a;
+    final b = this.b;
+    final result = this.result;
+    final n = result.length;
+    for (var i = 0; i < n; i++) {
+      result[i] = a[i] + b[i];
+    }
+  }
+
+  @override
+  double expected(int i) => size.toDouble();
+}
+
+class Float64ListScaleBenchmark extends Float64ListLoopBenchmark {
+  Float64ListScaleBenchmark(int size) : super('scale', size);
+
+  @override
+  void run() {
+    final a = this.a;
+    final b = this.b;
+    final result = this.result;
+    final n = result.length;
+    for (var i = 0; i < n; i++) {
+      result[i] = a[i] * 2.0 - b[i];
+    }
+  }
+
+  @override
+  double expected(int i) => (3 * i - size).toDouble();
+}
+
+class Int32ListXorBenchmark extends BenchmarkBase {
+  final int size;
+  late Int32List a;
+  late Int32List b;
+  late Int32List result;
+
+  Int32ListXorBenchmark(this.size)
+      : super('TypedDataLoops.Int32List.$size.xor');
+
+  @override
+  void setup() {
+    a = Int32List(size);
+    b = Int32List(size);
+    result = Int32List(size);
+    for (var i = 0; i < size; ++i) {
+      a[i] = i;
+      b[i] = 0x55555555;
+    }
+  }
+
+  @override
+  void warmup() {
+    for (var i = 0; i < 100; ++i) {
+      run();
+    }
+  }
+
+  @override
+  void run() {
+    final a = this.a;
+    final b = this.b;
+    final result = this.result;
+    final n = result.length;
+    for (var i = 0; i < n; i++) {
+      result[i] = a[i] ^ b[i];
+    }
+  }
+
+  @override
+  void teardown() {
+    for (var i = 0; i < size; ++i) {
+      if (result[i] != (i ^ 0x55555555)) {
+        throw 'Unexpected result';
+      }
+    }
+  }
+}
+
+void main() {
+  final sizes = [8, 32, 256, 16384];
+  final benchmarks = [
+    for (int size in sizes) ...[
+      Float64ListAddBenchmark(size),
+      Float64ListScaleBenchmark(size),
+      Int32ListXorBenchmark(size),
+    ]
+  ];
+  for (var bench in benchmarks) {
+    bench.report();
+  }
+}
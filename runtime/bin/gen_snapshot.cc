@@ -174,6 +174,7 @@ static void PrintUsage() {
 "[--obfuscate]                                                               \n"
 "[--save-debugging-info=<debug-filename>]                                    \n"
 "[--save-obfuscation-map=<map-filename>]                                     \n"
+"[--load-type-feedback=<feedback-filename>]                                  \n"
 "<dart-kernel-file>                                                          \n"
 "                                                                            \n"
 "To create an AOT application snapshot as an ELF shared library:             \n"
@@ -183,6 +184,7 @@ static void PrintUsage() {
 "[--obfuscate]                                                               \n"
 "[--save-debugging-info=<debug-filename>]                                    \n"
 "[--save-obfuscation-map=<map-filename>]                                     \n"
+"[--load-type-feedback=<feedback-filename>]                                  \n"
 "<dart-kernel-file>                                                          \n"
 "                                                                            \n"
 "AOT snapshots can be obfuscated: that is all identifiers will be renamed    \n"
@@ -191,6 +193,11 @@ static void PrintUsage() {
 "using --save-obfuscation-map=<filename> option. See dartbug.com/30524       \n"
 "for implementation details and limitations of the obfuscation pass.         \n"
 "                                                                            \n"
+"AOT snapshots can be guided by type feedback collected by a JIT run with    \n"
+"--save-type-feedback=<filename>. The receiver classes seen by the JIT are   \n"
+"used for polymorphic inlining, and the functions it executed are laid out   \n"
+"first.                                                                      \n"
+"                                                                            \n"
 "\n");
   if (verbose) {
     Syslog::PrintErr(
@@ -414,7 +421,11 @@ static void MaybeLoadCode() {
   }
 
   if ((load_type_feedback_filename != NULL) &&
-      ((snapshot_kind == kCoreJIT) || (snapshot_kind == kAppJIT))) {
+      ((snapshot_kind == kCoreJIT) || (snapshot_kind == kAppJIT) ||
+       IsSnapshottingForPrecompilation())) {
+    // For AOT snapshots the feedback is not used to compile functions here.
+    // It is recorded for the precompiler, which uses it to guide inlining
+    // and block layout.
     uint8_t* buffer = NULL;
     intptr_t size = 0;
     ReadFile(load_type_feedback_filename, &buffer, &size);
@@ -492,6 +492,10 @@ Dart_IsolateHeapGlobalUsedMetric(Dart_Isolate isolate);  // Byte
 DART_EXPORT int64_t
 Dart_IsolateHeapGlobalUsedMaxMetric(Dart_Isolate isolate);  // Byte
 DART_EXPORT int64_t
+Dart_IsolateFinalizersPendingMetric(Dart_Isolate isolate);  // Counter
+DART_EXPORT int64_t
+Dart_IsolateFinalizersPendingMaxMetric(Dart_Isolate isolate);  // Counter
+DART_EXPORT int64_t
 Dart_IsolateRunnableLatencyMetric(Dart_Isolate isolate);  // Microsecond
 DART_EXPORT int64_t
 Dart_IsolateRunnableHeapSizeMetric(Dart_Isolate isolate);  // Byte
@@ -0,0 +1,71 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+// VMOptions=--allocation_sample_interval=1024 --sample_buffer_duration=1 --profile_period=10000 --max_profile_depth=32
+
+import 'package:observatory/service_io.dart';
+import 'package:test/test.dart';
+
+import 'service_test_common.dart';
+import 'test_helper.dart';
+
+class Retained {
+  var a;
+  var b;
+  var c;
+}
+
+class Garbage {
+  var a;
+  var b;
+  var c;
+}
+
+var retained = <Retained>[];
+var garbage;
+
+void testeeMain() {
+  for (int i = 0; i < 10000; i++) {
+    retained.add(new Retained());
+  }
+  // The sample buffer holds 200 samples with the flags above, so the
+  // samples of the first retained objects are overwritten many times over.
+  for (int i = 0; i < 200000; i++) {
+    garbage = new Garbage();
+  }
+  garbage = null;
+  for (int i = 0; i < 1000; i++) {
+    retained.add(new Retained());
+  }
+}
+
+var tests = <IsolateTest>[
+  (Isolate isolate) async {
+    await isolate.invokeRpcNoUpgrade('_collectAllGarbage', {});
+    var retainedClass = await getClassFromRootLib(isolate, 'Retained');
+    var garbageClass = await getClassFromRootLib(isolate, 'Garbage');
+    int retainedCid = int.parse(retainedClass!.id!.split('/').last);
+    int garbageCid = int.parse(garbageClass!.id!.split('/').last);
+
+    var response =
+        await isolate.invokeRpcNoUpgrade('_getSampledAllocations', {});
+    expect(response['type'], equals('CpuSamples'));
+    int liveRetained = 0;
+    int garbageSamples = 0;
+    for (var sample in response['samples']) {
+      final cid = sample['classId'];
+      if (cid == retainedCid && sample['_live']) {
+        liveRetained++;
+      } else if (cid == garbageCid) {
+        // The slots of the overwritten samples of retained objects must not
+        // report the garbage samples now occupying them as live.
+        expect(sample['_live'], isFalse);
+        garbageSamples++;
+      }
+    }
+    expect(liveRetained, greaterThan(0));
+    expect(garbageSamples, greaterThan(0));
+  },
+];
+
+main(args) async => runIsolateTests(args, tests, testeeBefore: testeeMain);
@@ -0,0 +1,108 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// VMOptions=--optimization_counter_threshold=10 --no-use-osr --no-background-compilation
+
+// Test that objects which are only allocated on the paths where they escape
+// keep their state and identity.
+
+import "package:expect/expect.dart";
+
+class Point {
+  int x, y;
+  Point(this.x, this.y);
+}
+
+class Box {
+  final Object f;
+  Box(this.f);
+}
+
+final escaped = <Object>[];
+
+@pragma('vm:never-inline')
+int sum(int x) {
+  final p = new Point(x, x + 1);
+  if (x < 0) {
+    p.y = 42;
+    escaped.add(p);
+    escaped.add(p);
+    p.x = 7;
+    return -1;
+  }
+  return p.x + p.y;
+}
+
+@pragma('vm:never-inline')
+int check(int x) {
+  final p = new Point(x, 2 * x);
+  if (p.y > 100) {
+    throw p;
+  }
+  return p.x + p.y;
+}
+
+// The box refers to the point on all paths, so the point is not sunk.
+@pragma('vm:never-inline')
+Box wrap(int x) {
+  final p = new Point(x, x);
+  final b = new Box(p);
+  if (x < 0) {
+    escaped.add(p);
+  }
+  return b;
+}
+
+@pragma('vm:never-inline')
+int loop(int n) {
+  int result = 0;
+  for (int i = 0; i < n; i++) {
+    final p = new Point(i, i);
+    if (i % 3 == 0) {
+      escaped.add(p);
+    }
+    result += p.x + p.y;
+  }
+  return result;
+}
+
+main() {
+  for (int i = 0; i < 100; i++) {
+    Expect.equals(2 * i + 1, sum(i));
+    Expect.equals(3 * i, check(i % 30));
+    Expect.equals(i, (wrap(i).f as Point).x);
+  }
+
+  escaped.clear();
+  Expect.equals(-1, sum(-5));
+  Expect.equals(2, escaped.length);
+  Expect.identical(escaped[0], escaped[1]);
+  final p = escaped[0] as Point;
+  Expect.equals(7, p.x);
+  Expect.equals(42, p.y);
+
+  try {
+    check(60);
+    Expect.fail("expected Point");
+  } on Point catch (e) {
+    Expect.equals(60, e.x);
+    Expect.equals(120, e.y);
+  }
+
+  escaped.clear();
+  final b = wrap(-3);
+  Expect.equals(1, escaped.length);
+  Expect.identical(b.f, escaped[0]);
+
+  for (int i = 0; i < 20; i++) {
+    escaped.clear();
+    Expect.equals(90, loop(10));
+    Expect.equals(4, escaped.length);
+    for (int j = 0; j < escaped.length; j++) {
+      final q = escaped[j] as Point;
+      Expect.equals(3 * j, q.x);
+      Expect.equals(3 * j, q.y);
+    }
+  }
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// VMOptions=--optimization_counter_threshold=10 --no-use-osr --no-background-compilation
+
+// Test that unrolled and peeled loops execute the same iterations as the
+// loops they replace.
+
+import 'dart:typed_data';
+
+import "package:expect/expect.dart";
+
+@pragma('vm:never-inline')
+void scale(Int32List a, int from) {
+  final n = a.length;
+  for (int i = from; i < n; i++) {
+    a[i] = a[i] * 3;
+  }
+}
+
+@pragma('vm:never-inline')
+int sumDown(Int32List a) {
+  int sum = 0;
+  for (int i = a.length - 1; i >= 0; i--) {
+    sum = sum * 31 + a[i];
+  }
+  return sum;
+}
+
+@pragma('vm:never-inline')
+void fillThree(Int32List a, int value) {
+  for (int i = 0; i < 3; i++) {
+    a[i] = value + i;
+  }
+}
+
+void testScale(int length, int from) {
+  final a = new Int32List(length);
+  for (int i = 0; i < length; i++) {
+    a[i] = i;
+  }
+  scale(a, from);
+  for (int i = 0; i < length; i++) {
+    Expect.equals(i < from ? i : i * 3, a[i]);
+  }
+}
+
+void testSumDown(int length) {
+  final a = new Int32List(length);
+  int expected = 0;
+  for (int i = 0; i < length; i++) {
+    a[i] = i + 1;
+  }
+  for (int i = length - 1; i >= 0; i--) {
+    expected = expected * 31 + a[i];
+  }
+  Expect.equals(expected, sumDown(a));
+}
+
+void testFillThree(int value) {
+  final a = new Int32List(4);
+  fillThree(a, value);
+  Expect.equals(value, a[0]);
+  Expect.equals(value + 1, a[1]);
+  Expect.equals(value + 2, a[2]);
+  Expect.equals(0, a[3]);
+}
+
+main() {
+  for (int iteration = 0; iteration < 20; iteration++) {
+    for (int length = 0; length < 13; length++) {
+      testScale(length, 0);
+      testScale(length, 1);
+      testScale(length, length);
+      testSumDown(length);
+    }
+    testScale(100, 7);
+    testSumDown(100);
+    testFillThree(iteration);
+  }
+  Expect.throws(() => fillThree(new Int32List(2), 0));
+}
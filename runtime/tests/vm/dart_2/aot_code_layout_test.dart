@@ -0,0 +1,121 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Checks that gen_snapshot lays out the code of the functions that the JIT
+// type feedback saw executed at the start of the instructions image, and the
+// code of the functions it never saw executed at the end.
+
+import "dart:async";
+import "dart:convert";
+import "dart:io";
+
+import "package:expect/expect.dart";
+import "package:path/path.dart" as p;
+
+import "snapshot_test_helper.dart";
+
+@pragma('vm:never-inline')
+int coldFunction(int x) {
+  int result = x;
+  for (int i = 0; i < x; i++) {
+    result = (result * 17 + i) & 0xFFFF;
+  }
+  return result;
+}
+
+@pragma('vm:never-inline')
+int hotLeaf(int x) => (x * 31 + 7) & 0xFFFF;
+
+@pragma('vm:never-inline')
+int hotLoop(int n) {
+  int result = 0;
+  for (int i = 0; i < n; i++) {
+    result = (result + hotLeaf(i)) & 0xFFFF;
+  }
+  return result;
+}
+
+void child(List<String> args) {
+  print(hotLoop(1000000));
+  // Keeps coldFunction in the AOT snapshot without running it.
+  if (args.contains("--cold")) {
+    print(coldFunction(args.length));
+  }
+}
+
+Future<void> main(List<String> args) async {
+  if (args.contains("--child")) {
+    child(args);
+    return;
+  }
+
+  if (!Platform.script.toString().endsWith(".dart")) {
+    print("This test must run from source");
+    return;
+  }
+
+  if (!File(genSnapshot).existsSync() ||
+      !File(dartPrecompiledRuntime).existsSync()) {
+    print("AOT tools are not available");
+    return;
+  }
+
+  await withTempDir((String tmp) async {
+    final String feedbackPath = p.join(tmp, "type_feedback.bin");
+    final String dillPath = p.join(tmp, "test.dill");
+    final String snapshotPath = p.join(tmp, "test.so");
+    final String sizesPath = p.join(tmp, "sizes.json");
+
+    final jitResult = await runDart("generate type feedback", [
+      "--save_type_feedback=$feedbackPath",
+      Platform.script.toFilePath(),
+      "--child",
+    ]);
+
+    await runGenKernel("compile to kernel", [
+      "--aot",
+      "-o",
+      dillPath,
+      Platform.script.toFilePath(),
+    ]);
+
+    final compileResult = await runGenSnapshot("compile with type feedback", [
+      "--snapshot-kind=app-aot-elf",
+      "--load-type-feedback=$feedbackPath",
+      "--trace_precompiler",
+      "--print-instructions-sizes-to=$sizesPath",
+      "--elf=$snapshotPath",
+      dillPath,
+    ]);
+
+    final layout = new RegExp(r"Code layout: (\d+) hot .*, (\d+) cold")
+        .firstMatch(compileResult.output);
+    Expect.isNotNull(layout, "No code layout was computed");
+    Expect.isTrue(int.parse(layout.group(1)) > 0, "No hot functions");
+    Expect.isTrue(int.parse(layout.group(2)) > 0, "No cold functions");
+
+    // The instructions sizes are printed in the order of the instructions
+    // image.
+    final List<dynamic> sizes =
+        json.decode(await new File(sizesPath).readAsString());
+    int indexOf(String name) {
+      final index = sizes.indexWhere((dynamic entry) =>
+          entry["n"] == name &&
+          (entry["l"] ?? "").endsWith("aot_code_layout_test.dart"));
+      Expect.notEquals(-1, index, "No code for $name");
+      return index;
+    }
+
+    final hotIndex = indexOf("hotLeaf");
+    final coldIndex = indexOf("coldFunction");
+    Expect.isTrue(hotIndex < sizes.length ~/ 2,
+        "hotLeaf is at $hotIndex of ${sizes.length}");
+    Expect.isTrue(coldIndex >= sizes.length ~/ 2,
+        "coldFunction is at $coldIndex of ${sizes.length}");
+
+    final aotResult = await runBinary("run with code layout",
+        dartPrecompiledRuntime, [snapshotPath, "--child"]);
+    expectOutput(jitResult.output, aotResult);
+  });
+}
@@ -0,0 +1,123 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Checks that gen_snapshot accepts type feedback collected by the JIT when
+// creating an AOT snapshot, that the feedback is applied to the calls in
+// totalArea, and that the snapshot still runs correctly.
+
+import "dart:async";
+import "dart:io";
+
+import "package:expect/expect.dart";
+import "package:path/path.dart" as p;
+
+import "snapshot_test_helper.dart";
+
+abstract class Shape {
+  int area();
+}
+
+class Square implements Shape {
+  final int side;
+  Square(this.side);
+  int area() => side * side;
+}
+
+class Rectangle implements Shape {
+  final int width;
+  final int height;
+  Rectangle(this.width, this.height);
+  int area() => width * height;
+}
+
+class Triangle implements Shape {
+  final int base;
+  final int height;
+  Triangle(this.base, this.height);
+  int area() {
+    if (base < 0) {
+      throw new ArgumentError.value(base, "base");
+    }
+    return base * height ~/ 2;
+  }
+}
+
+int totalArea(List<Shape> shapes) {
+  int total = 0;
+  for (int i = 0; i < shapes.length; i++) {
+    total += shapes[i].area();
+  }
+  return total;
+}
+
+void child() {
+  final shapes = <Shape>[];
+  for (int i = 0; i < 100; i++) {
+    shapes.add(new Square(i % 7));
+    shapes.add(new Rectangle(i % 5, i % 3));
+    if (i % 10 == 0) {
+      shapes.add(new Triangle(i % 9, 4));
+    }
+  }
+  int result = 0;
+  for (int i = 0; i < 20000; i++) {
+    result = (result + totalArea(shapes)) & 0xFFFFFF;
+  }
+  print(result);
+}
+
+Future<void> main(List<String> args) async {
+  if (args.contains("--child")) {
+    child();
+    return;
+  }
+
+  if (!Platform.script.toString().endsWith(".dart")) {
+    print("This test must run from source");
+    return;
+  }
+
+  if (!File(genSnapshot).existsSync() ||
+      !File(dartPrecompiledRuntime).existsSync()) {
+    print("AOT tools are not available");
+    return;
+  }
+
+  await withTempDir((String tmp) async {
+    final String feedbackPath = p.join(tmp, "type_feedback.bin");
+    final String dillPath = p.join(tmp, "test.dill");
+    final String snapshotPath = p.join(tmp, "test.so");
+
+    final jitResult = await runDart("generate type feedback", [
+      "--save_type_feedback=$feedbackPath",
+      Platform.script.toFilePath(),
+      "--child",
+    ]);
+
+    await runGenKernel("compile to kernel", [
+      "--aot",
+      "-o",
+      dillPath,
+      Platform.script.toFilePath(),
+    ]);
+
+    // --trace_optimization is only available in debug builds.
+    final bool isDebug = Platform.executable.contains("Debug");
+    final compileResult = await runGenSnapshot("compile with type feedback", [
+      "--snapshot-kind=app-aot-elf",
+      "--load-type-feedback=$feedbackPath",
+      if (isDebug) "--trace_optimization",
+      "--elf=$snapshotPath",
+      dillPath,
+    ]);
+    if (isDebug) {
+      Expect.isTrue(compileResult.output.contains("Using type feedback"),
+          "Type feedback was not applied");
+    }
+
+    final aotResult = await runBinary("run with type feedback",
+        dartPrecompiledRuntime, [snapshotPath, "--child"]);
+    expectOutput(jitResult.output, aotResult);
+  });
+}
@@ -0,0 +1,114 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// VMOptions=--optimization_counter_threshold=10 --no-use-osr --no-background-compilation
+
+// Test that vectorized typed data loops handle remainders, start offsets and
+// overlapping views like the scalar loops they replace.
+
+import 'dart:typed_data';
+
+import "package:expect/expect.dart";
+
+@pragma('vm:never-inline')
+void addFloat64(Float64List a, Float64List b, Float64List c, int from) {
+  final n = c.length;
+  for (int i = from; i < n; i++) {
+    c[i] = a[i] + b[i];
+  }
+}
+
+@pragma('vm:never-inline')
+void xorInt32(Int32List a, Int32List b, Int32List c) {
+  final n = c.length;
+  for (int i = 0; i < n; i++) {
+    c[i] = a[i] ^ b[i];
+  }
+}
+
+@pragma('vm:never-inline')
+void addUint32(Uint32List a, Uint32List c) {
+  final n = c.length;
+  for (int i = 0; i < n; i++) {
+    c[i] = a[i] + c[i];
+  }
+}
+
+void testFloat64(int length, int from) {
+  final a = new Float64List(length);
+  final b = new Float64List(length);
+  final c = new Float64List(length);
+  for (int i = 0; i < length; i++) {
+    a[i] = i.toDouble();
+    b[i] = 0.5;
+    c[i] = -1.0;
+  }
+  addFloat64(a, b, c, from);
+  for (int i = 0; i < length; i++) {
+    Expect.equals(i < from ? -1.0 : i + 0.5, c[i]);
+  }
+}
+
+void testOverlap(int length, int shift) {
+  final buffer = new Float64List(length + shift).buffer;
+  final a = new Float64List.view(buffer, 0, length);
+  final c = new Float64List.view(buffer, shift * 8, length);
+  final b = new Float64List(length);
+  for (int i = 0; i < length; i++) {
+    a[i] = 1.0;
+    b[i] = 1.0;
+  }
+  // Every store feeds the load [shift] iterations later.
+  final expected = new List<double>.filled(length + shift, 0.0);
+  for (int i = 0; i < length; i++) {
+    expected[i] = 1.0;
+  }
+  for (int i = 0; i < length; i++) {
+    expected[i + shift] = expected[i] + 1.0;
+  }
+  addFloat64(a, b, c, 0);
+  for (int i = 0; i < length; i++) {
+    Expect.equals(expected[i + shift], c[i]);
+  }
+}
+
+void testInt32(int length) {
+  final a = new Int32List(length);
+  final b = new Int32List(length);
+  final c = new Int32List(length);
+  for (int i = 0; i < length; i++) {
+    a[i] = -i;
+    b[i] = 0x7fffffff;
+  }
+  xorInt32(a, b, c);
+  for (int i = 0; i < length; i++) {
+    Expect.equals((-i ^ 0x7fffffff).toSigned(32), c[i]);
+  }
+}
+
+void testUint32(int length) {
+  final a = new Uint32List(length);
+  final c = new Uint32List(length);
+  for (int i = 0; i < length; i++) {
+    a[i] = 0xffffffff;
+    c[i] = i;
+  }
+  addUint32(a, c);
+  for (int i = 0; i < length; i++) {
+    Expect.equals((i - 1).toUnsigned(32), c[i]);
+  }
+}
+
+main() {
+  for (int j = 0; j < 20; j++) {
+    for (int length in [0, 1, 2, 3, 7, 32, 33, 100]) {
+      testFloat64(length, 0);
+      testFloat64(length, 3);
+      testInt32(length);
+      testUint32(length);
+      testOverlap(length, 1);
+      testOverlap(length, 2);
+    }
+  }
+}
@@ -18,9 +18,17 @@
 #include "vm/clustered_snapshot.h"
 #include "vm/dart_api_impl.h"
 #include "vm/datastream.h"
+#include "vm/heap/scavenger.h"
 #include "vm/stack_frame.h"
 #include "vm/timer.h"
 
+#if defined(HOST_OS_LINUX)
+#include <linux/perf_event.h>  // NOLINT
+#include <sys/ioctl.h>         // NOLINT
+#include <sys/syscall.h>       // NOLINT
+#include <unistd.h>            // NOLINT
+#endif
+
 using dart::bin::File;
 
 namespace dart {
@@ -613,6 +621,178 @@ BENCHMARK(LargeMap) {
   benchmark->set_score(elapsed_time);
 }
 
+// Counts the data TLB misses of the calling thread, where perf events are
+// available.
+class DataTLBMissCounter : public ValueObject {
+ public:
+  DataTLBMissCounter() {
+#if defined(HOST_OS_LINUX)
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+  }
+
+  ~DataTLBMissCounter() {
+#if defined(HOST_OS_LINUX)
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+#endif
+  }
+
+  void Start() {
+#if defined(HOST_OS_LINUX)
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+  }
+
+  void Stop() {
+#if defined(HOST_OS_LINUX)
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+    }
+#endif
+  }
+
+  // Returns -1 if the counter is not available.
+  int64_t Count() const {
+#if defined(HOST_OS_LINUX)
+    uint64_t count = 0;
+    if ((fd_ >= 0) && (read(fd_, &count, sizeof(count)) == sizeof(count))) {
+      return count;
+    }
+#endif
+    return -1;
+  }
+
+ private:
+  int fd_ = -1;
+
+  DISALLOW_COPY_AND_ASSIGN(DataTLBMissCounter);
+};
+
+// Measures the time spent in scavenges and the data TLB misses of the
+// allocation and the scavenges, with new space backed by regular or by huge
+// pages. The scavenge runs on the main thread so all misses are counted.
+static void RunScavengeBenchmark(Benchmark* benchmark,
+                                 Thread* thread,
+                                 bool huge_pages) {
+  TransitionNativeToVM transition(thread);
+  StackZone zone(thread);
+  HANDLESCOPE(thread);
+  const bool saved_huge_heap_pages = FLAG_huge_heap_pages;
+  const intptr_t saved_scavenger_tasks = FLAG_scavenger_tasks;
+  FLAG_huge_heap_pages = huge_pages;
+  FLAG_scavenger_tasks = 0;
+
+  // Flip twice with an empty page cache so both semi-spaces get new pages.
+  SemiSpace::ClearCache();
+  GCTestHelper::CollectNewSpace();
+  SemiSpace::ClearCache();
+  GCTestHelper::CollectNewSpace();
+
+  const intptr_t kNumScavenges = 50;
+  const intptr_t kNumLists = 2000;
+  const intptr_t kListLength = 100;
+  // A live set spread over many objects for the scavenger to copy.
+  const Array& live = Array::Handle(Array::New(kNumLists));
+  Array& list = Array::Handle();
+  DataTLBMissCounter tlb_misses;
+  Timer timer(true, "Scavenge");
+  tlb_misses.Start();
+  for (intptr_t i = 0; i < kNumScavenges; i++) {
+    for (intptr_t j = 0; j < kNumLists; j++) {
+      list = Array::New(kListLength);
+      live.SetAt((i * 7 + j) % kNumLists, list);
+    }
+    timer.Start();
+    GCTestHelper::CollectNewSpace();
+    timer.Stop();
+  }
+  tlb_misses.Stop();
+  benchmark->set_score(timer.TotalElapsedTime());
+  OS::Print("%s(DataTLBMisses): %" Pd64 "\n", benchmark->name(),
+            tlb_misses.Count());
+
+  FLAG_huge_heap_pages = saved_huge_heap_pages;
+  FLAG_scavenger_tasks = saved_scavenger_tasks;
+  SemiSpace::ClearCache();
+}
+
+BENCHMARK(Scavenge) {
+  RunScavengeBenchmark(benchmark, thread, /*huge_pages=*/false);
+}
+
+BENCHMARK(ScavengeHugePages) {
+  RunScavengeBenchmark(benchmark, thread, /*huge_pages=*/true);
+}
+
+// Scavenges a live set in which every object has an identity hash, either
+// stored in the object header (where available) or in the heap's weak tables,
+// which the scavenger has to rehash after every collection.
+static void RunScavengeHashedObjectsBenchmark(Benchmark* benchmark,
+                                              Thread* thread,
+                                              bool use_weak_table) {
+  TransitionNativeToVM transition(thread);
+  StackZone zone(thread);
+  HANDLESCOPE(thread);
+  Heap* heap = thread->heap();
+
+  const intptr_t kNumScavenges = 50;
+  const intptr_t kNumObjects = 20000;
+  const Array& live = Array::Handle(Array::New(kNumObjects));
+  Array& obj = Array::Handle();
+  for (intptr_t i = 0; i < kNumObjects; i++) {
+    obj = Array::New(1);
+    const intptr_t hash = i + 1;
+    if (use_weak_table) {
+      heap->SetPeer(obj.raw(), reinterpret_cast<void*>(hash));
+    } else {
+#if defined(HASH_IN_OBJECT_HEADER)
+      Object::SetCachedHash(obj.raw(), hash);
+#else
+      heap->SetHash(obj.raw(), hash);
+#endif
+    }
+    live.SetAt(i, obj);
+  }
+
+  Timer timer(true, "Scavenge hashed objects");
+  for (intptr_t i = 0; i < kNumScavenges; i++) {
+    timer.Start();
+    GCTestHelper::CollectNewSpace();
+    timer.Stop();
+  }
+  benchmark->set_score(timer.TotalElapsedTime());
+
+  if (use_weak_table) {
+    for (intptr_t i = 0; i < kNumObjects; i++) {
+      heap->SetPeer(live.At(i), nullptr);
+    }
+  }
+}
+
+BENCHMARK(ScavengeIdentityHashes) {
+  RunScavengeHashedObjectsBenchmark(benchmark, thread,
+                                    /*use_weak_table=*/false);
+}
+
+BENCHMARK(ScavengeWeakTableEntries) {
+  RunScavengeHashedObjectsBenchmark(benchmark, thread,
+                                    /*use_weak_table=*/true);
+}
+
 BENCHMARK_MEMORY(InitialRSS) {
   benchmark->set_score(bin::Process::MaxRSS());
 }
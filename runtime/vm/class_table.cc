@@ -531,6 +531,22 @@ void ClassTable::PrintToJSONObject(JSONObject* object) {
       }
     }
   }
+  {
+    JSONArray packing(object, "_fieldPacking");
+    for (intptr_t i = 1; i < top_; i++) {
+      if (!HasValidClassAt(i)) {
+        continue;
+      }
+      cls = At(i);
+      const intptr_t saved = cls.FieldPackingSavings();
+      if (saved > 0) {
+        JSONObject entry(&packing);
+        entry.AddProperty("class", cls);
+        entry.AddProperty("instanceSize", cls.host_instance_size());
+        entry.AddProperty("bytesSavedPerInstance", saved);
+      }
+    }
+  }
 }
 
 bool SharedClassTable::ShouldUpdateSizeForClassId(intptr_t cid) {
@@ -118,12 +118,23 @@ class SharedClassTable {
   }
 
 #if !defined(PRODUCT)
+  // Any of these bits sends allocations of the class to the runtime.
+  enum {
+    kTraceAllocationBit = 1 << 0,
+    kPretenureBit = 1 << 1,
+  };
+
   void SetTraceAllocationFor(intptr_t cid, bool trace) {
-    ASSERT(cid > 0);
-    ASSERT(cid < top_);
-    trace_allocation_table_.load()[cid] = trace ? 1 : 0;
+    SetAllocationBitFor(cid, kTraceAllocationBit, trace);
   }
   bool TraceAllocationFor(intptr_t cid);
+
+  // Whether the runtime allocates instances of the class in old space. Set
+  // by the scavenger's allocation-site feedback.
+  void SetPretenureFor(intptr_t cid, bool pretenure) {
+    SetAllocationBitFor(cid, kPretenureBit, pretenure);
+  }
+  bool PretenureFor(intptr_t cid);
 #endif  // !defined(PRODUCT)
 
   void CopyBeforeHotReload(intptr_t** copy, intptr_t* copy_num_cids) {
@@ -218,6 +229,13 @@ class SharedClassTable {
   static bool ShouldUpdateSizeForClassId(intptr_t cid);
 
 #ifndef PRODUCT
+  void SetAllocationBitFor(intptr_t cid, uint8_t bit, bool value) {
+    ASSERT(cid > 0);
+    ASSERT(cid < top_);
+    uint8_t* entry = &trace_allocation_table_.load()[cid];
+    *entry = value ? (*entry | bit) : (*entry & ~bit);
+  }
+
   // Copy-on-write is used for trace_allocation_table_, with old copies stored
   // in old_tables_.
   AcqRelAtomic<uint8_t*> trace_allocation_table_ = {nullptr};
@@ -468,7 +486,16 @@ DART_FORCE_INLINE bool SharedClassTable::TraceAllocationFor(intptr_t cid) {
     return false;
   }
   ASSERT(cid < top_);
-  return trace_allocation_table_.load()[cid] != 0;
+  return (trace_allocation_table_.load()[cid] & kTraceAllocationBit) != 0;
+}
+
+DART_FORCE_INLINE bool SharedClassTable::PretenureFor(intptr_t cid) {
+  ASSERT(cid > 0);
+  if (ClassTable::IsTopLevelCid(cid)) {
+    return false;
+  }
+  ASSERT(cid < top_);
+  return (trace_allocation_table_.load()[cid] & kPretenureBit) != 0;
 }
 #endif  // !defined(PRODUCT)
 
@@ -1661,7 +1661,72 @@ class CodeSerializationCluster : public SerializationCluster {
     }
   }
 
+#if defined(DART_PRECOMPILER)
+  // Moves the code the precompiler found hot (see
+  // Precompiler::ComputeCodeLayout) to the start of the instructions image in
+  // the computed order, and the code it found cold to the end. Everything
+  // else keeps its relative order in between.
+  static void ApplyCodeLayout(Serializer* s, GrowableArray<CodePtr>* codes) {
+    ObjectStore* object_store = s->thread()->isolate()->object_store();
+    const auto& hot_code = GrowableObjectArray::Handle(
+        s->zone(), object_store->hot_code_order());
+    const auto& cold_code =
+        GrowableObjectArray::Handle(s->zone(), object_store->cold_code());
+    if (hot_code.IsNull() && cold_code.IsNull()) {
+      return;
+    }
+
+    IntMap<intptr_t> rank_map;
+    if (!hot_code.IsNull()) {
+      for (intptr_t i = 0; i < hot_code.Length(); i++) {
+        rank_map.Insert(static_cast<intptr_t>(hot_code.At(i)), i + 1);
+      }
+    }
+    if (!cold_code.IsNull()) {
+      for (intptr_t i = 0; i < cold_code.Length(); i++) {
+        rank_map.Insert(static_cast<intptr_t>(cold_code.At(i)), -1);
+      }
+    }
+
+    GrowableArray<CodeOrderInfo> hot;
+    GrowableArray<CodePtr> middle;
+    GrowableArray<CodePtr> cold;
+    for (intptr_t i = 0; i < codes->length(); i++) {
+      CodePtr code = (*codes)[i];
+      const intptr_t rank = rank_map.Lookup(static_cast<intptr_t>(code));
+      if (rank > 0) {
+        CodeOrderInfo info;
+        info.code = code;
+        info.order = rank;
+        hot.Add(info);
+      } else if (rank < 0) {
+        cold.Add(code);
+      } else {
+        middle.Add(code);
+      }
+    }
+    hot.Sort(CompareCodeOrderInfo);
+
+    intptr_t index = 0;
+    for (intptr_t i = 0; i < hot.length(); i++) {
+      (*codes)[index++] = hot[i].code;
+    }
+    for (intptr_t i = 0; i < middle.length(); i++) {
+      (*codes)[index++] = middle[i];
+    }
+    for (intptr_t i = 0; i < cold.length(); i++) {
+      (*codes)[index++] = cold[i];
+    }
+    ASSERT(index == codes->length());
+  }
+#endif  // defined(DART_PRECOMPILER)
+
   void WriteAlloc(Serializer* s) {
+#if defined(DART_PRECOMPILER)
+    if (s->kind() == Snapshot::kFullAOT) {
+      ApplyCodeLayout(s, &objects_);
+    }
+#endif
     Sort(&objects_);
     auto loading_units = s->loading_units();
     if (loading_units != nullptr) {
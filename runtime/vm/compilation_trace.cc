@@ -6,6 +6,7 @@
 
 #include "vm/compiler/jit/compiler.h"
 #include "vm/globals.h"
+#include "vm/hash_table.h"
 #include "vm/log.h"
 #include "vm/longjump.h"
 #include "vm/object_store.h"
@@ -584,6 +585,114 @@ void TypeFeedbackSaver::WriteString(const String& value) {
   stream_->WriteBytes(cstr, len);
 }
 
+// Maps functions to the feedback loaded for them in AOT mode.
+class AotFeedbackTraits {
+ public:
+  static const char* Name() { return "AotFeedbackTraits"; }
+  static bool ReportStats() { return false; }
+
+  static bool IsMatch(const Object& a, const Object& b) {
+    return a.raw() == b.raw();
+  }
+  static uword Hash(const Object& obj) { return Function::Cast(obj).Hash(); }
+};
+
+typedef UnorderedHashMap<AotFeedbackTraits> AotFeedbackMap;
+
+ArrayPtr AotTypeFeedback::FeedbackFor(const Function& function) {
+  Thread* thread = Thread::Current();
+  Zone* zone = thread->zone();
+  const Array& table = Array::Handle(
+      zone, thread->isolate()->object_store()->aot_type_feedback());
+  if (table.IsNull()) {
+    return Array::null();
+  }
+  AotFeedbackMap map(table.raw());
+  const Array& feedback =
+      Array::Handle(zone, Array::RawCast(map.GetOrNull(function)));
+  map.Release();
+  return feedback.raw();
+}
+
+struct FunctionUsage {
+  const Function* function;
+  intptr_t usage;
+
+  static int MostUsedFirst(const FunctionUsage* a, const FunctionUsage* b) {
+    if (a->usage > b->usage) return -1;
+    if (a->usage < b->usage) return 1;
+    return 0;
+  }
+};
+
+ArrayPtr AotTypeFeedback::FunctionsByUsage() {
+  Thread* thread = Thread::Current();
+  Zone* zone = thread->zone();
+  const Array& table = Array::Handle(
+      zone, thread->isolate()->object_store()->aot_type_feedback());
+  if (table.IsNull()) {
+    return Array::null();
+  }
+
+  GrowableArray<FunctionUsage> functions;
+  Array& feedback = Array::Handle(zone);
+  {
+    AotFeedbackMap map(table.raw());
+    AotFeedbackMap::Iterator it(&map);
+    while (it.MoveNext()) {
+      const intptr_t entry = it.Current();
+      feedback ^= map.GetPayload(entry, 0);
+      const intptr_t usage = UsageCounter(feedback);
+      if (usage > 0) {
+        FunctionUsage function_usage;
+        function_usage.function =
+            &Function::Handle(zone, Function::RawCast(map.GetKey(entry)));
+        function_usage.usage = usage;
+        functions.Add(function_usage);
+      }
+    }
+    map.Release();
+  }
+  functions.Sort(FunctionUsage::MostUsedFirst);
+
+  const Array& result =
+      Array::Handle(zone, Array::New(functions.length(), Heap::kOld));
+  for (intptr_t i = 0; i < functions.length(); i++) {
+    result.SetAt(i, *functions[i].function);
+  }
+  return result.raw();
+}
+
+intptr_t AotTypeFeedback::UsageCounter(const Array& feedback) {
+  return Smi::Value(Smi::RawCast(feedback.At(kUsageCounterIndex)));
+}
+
+ArrayPtr AotTypeFeedback::ReceiverClasses(const Array& feedback,
+                                          intptr_t deopt_id,
+                                          const String& selector) {
+  Zone* zone = Thread::Current()->zone();
+  String& name = String::Handle(zone);
+  intptr_t selector_matches = 0;
+  intptr_t selector_match = -1;
+  for (intptr_t i = kFirstCallSiteIndex; i < feedback.Length();
+       i += kCallSiteSize) {
+    name ^= feedback.At(i + kCallSiteSelectorOffset);
+    if (!String::EqualsIgnoringPrivateKey(selector, name)) {
+      continue;
+    }
+    if (Smi::Value(Smi::RawCast(feedback.At(i + kCallSiteDeoptIdOffset))) ==
+        deopt_id) {
+      return Array::RawCast(feedback.At(i + kCallSiteEntriesOffset));
+    }
+    selector_matches++;
+    selector_match = i;
+  }
+  if (selector_matches != 1) {
+    return Array::null();
+  }
+  return Array::RawCast(feedback.At(selector_match + kCallSiteEntriesOffset));
+}
+
 TypeFeedbackLoader::TypeFeedbackLoader(Thread* thread)
     : thread_(thread),
       zone_(thread->zone()),
@@ -605,6 +714,9 @@ TypeFeedbackLoader::TypeFeedbackLoader(Thread* thread)
       args_desc_(Array::Handle(zone_)),
       functions_to_compile_(
           GrowableObjectArray::Handle(zone_, GrowableObjectArray::New())),
+      aot_call_sites_(GrowableObjectArray::Handle(zone_)),
+      feedback_(Array::Handle(zone_)),
+      feedback_table_(Array::Handle(zone_)),
       error_(Error::Handle(zone_)) {}
 
 TypeFeedbackLoader::~TypeFeedbackLoader() {
@@ -629,6 +741,13 @@ ObjectPtr TypeFeedbackLoader::LoadFeedback(ReadStream* stream) {
     return error_.raw();
   }
 
+  if (FLAG_precompiled_mode) {
+    feedback_table_ = thread_->isolate()->object_store()->aot_type_feedback();
+    if (feedback_table_.IsNull()) {
+      feedback_table_ = HashTables::New<AotFeedbackMap>(256, Heap::kOld);
+    }
+  }
+
   while (stream_->PendingBytes() > 0) {
     error_ = LoadFunction();
     if (error_.IsError()) {
@@ -636,6 +755,11 @@ ObjectPtr TypeFeedbackLoader::LoadFeedback(ReadStream* stream) {
     }
   }
 
+  if (FLAG_precompiled_mode) {
+    thread_->isolate()->object_store()->set_aot_type_feedback(feedback_table_);
+    ASSERT(functions_to_compile_.Length() == 0);
+  }
+
   while (functions_to_compile_.Length() > 0) {
     func_ ^= functions_to_compile_.RemoveLast();
 
@@ -693,6 +817,14 @@ ObjectPtr TypeFeedbackLoader::CheckHeader() {
       reinterpret_cast<const char*>(stream_->AddressOfCurrentPosition());
   ASSERT(features != NULL);
   intptr_t buffer_len = Utils::StrNLen(features, stream_->PendingBytes());
+  if (FLAG_precompiled_mode) {
+    // The precompiler always runs with different flags than the JIT that
+    // collected the feedback. Deopt ids are only used as a hint when loading
+    // feedback for AOT, see AotTypeFeedback::ReceiverClasses.
+    free(expected_features);
+    stream_->Advance(buffer_len + 1);
+    return Error::null();
+  }
   if ((buffer_len != expected_len) ||
       (strncmp(features, expected_features, expected_len) != 0)) {
     const String& msg = String::Handle(String::NewFormatted(
@@ -749,7 +881,9 @@ ObjectPtr TypeFeedbackLoader::LoadFields() {
       intptr_t guarded_cid = cid_map_[ReadInt()];
       intptr_t is_nullable = ReadInt();
 
-      if (skip) {
+      // Field guards are not used by AOT code, so guarding on a class seen by
+      // the JIT would not be sound.
+      if (skip || FLAG_precompiled_mode) {
         continue;
       }
 
@@ -829,7 +963,11 @@ ObjectPtr TypeFeedbackLoader::LoadFunction() {
     }
   }
 
-  if (!skip) {
+  if (!skip && FLAG_precompiled_mode) {
+    // Functions are compiled by the precompiler, which starts with empty
+    // ICData. Collect the feedback instead.
+    aot_call_sites_ = GrowableObjectArray::New();
+  } else if (!skip) {
     error_ = Compiler::CompileFunction(thread_, func_);
     if (error_.IsError()) {
       return error_.raw();
@@ -847,6 +985,7 @@ ObjectPtr TypeFeedbackLoader::LoadFunction() {
     }
   }
 
+  GrowableObjectArray& aot_entries = GrowableObjectArray::Handle(zone_);
   // First element is edge counters.
   for (intptr_t i = 1; i <= num_call_sites; i++) {
     intptr_t deopt_id = ReadInt();
@@ -855,7 +994,18 @@ ObjectPtr TypeFeedbackLoader::LoadFunction() {
     intptr_t num_checked_arguments = ReadInt();
     intptr_t num_entries = ReadInt();
 
-    if (!skip) {
+    if (!skip && FLAG_precompiled_mode) {
+      // Only instance calls have receiver classes to speculate on. Static
+      // calls test no arguments.
+      if ((rebind_rule == ICData::kInstance) && (num_checked_arguments >= 1)) {
+        aot_entries = GrowableObjectArray::New();
+        aot_call_sites_.Add(Smi::Handle(zone_, Smi::New(deopt_id)));
+        aot_call_sites_.Add(target_name_);
+        aot_call_sites_.Add(aot_entries);
+      } else {
+        aot_entries = GrowableObjectArray::null();
+      }
+    } else if (!skip) {
       call_site_ ^= call_sites_.At(i);
       if ((call_site_.deopt_id() != deopt_id) ||
           (call_site_.rebind_rule() != rebind_rule) ||
@@ -887,6 +1037,16 @@ ObjectPtr TypeFeedbackLoader::LoadFunction() {
         continue;
       }
 
+      if (FLAG_precompiled_mode) {
+        // Calls testing two arguments record the receiver class of each
+        // combination.
+        if (!aot_entries.IsNull()) {
+          cls_ = thread_->isolate()->class_table()->At(cids[0]);
+          AddAotReceiverClass(aot_entries, cls_, entry_usage);
+        }
+        continue;
+      }
+
       intptr_t reuse_index = call_site_.FindCheck(cids);
       if (reuse_index == -1) {
         cls_ = thread_->isolate()->class_table()->At(cids[0]);
@@ -912,7 +1072,9 @@ ObjectPtr TypeFeedbackLoader::LoadFunction() {
     }
   }
 
-  if (!skip) {
+  if (!skip && FLAG_precompiled_mode) {
+    AddAotFeedback(usage);
+  } else if (!skip) {
     func_.set_usage_counter(usage);
     func_.set_inlining_depth(inlining_depth);
 
@@ -924,6 +1086,44 @@ ObjectPtr TypeFeedbackLoader::LoadFunction() {
   return Error::null();
 }
 
+void TypeFeedbackLoader::AddAotReceiverClass(
+    const GrowableObjectArray& entries,
+    const Class& cls,
+    intptr_t count) {
+  for (intptr_t i = 0; i < entries.Length(); i += 2) {
+    if (entries.At(i) == cls.raw()) {
+      const intptr_t old_count = Smi::Value(Smi::RawCast(entries.At(i + 1)));
+      entries.SetAt(i + 1, Smi::Handle(zone_, Smi::New(old_count + count)));
+      return;
+    }
+  }
+  entries.Add(cls);
+  entries.Add(Smi::Handle(zone_, Smi::New(count)));
+}
+
+void TypeFeedbackLoader::AddAotFeedback(intptr_t usage) {
+  const intptr_t num_call_sites =
+      aot_call_sites_.Length() / AotTypeFeedback::kCallSiteSize;
+  feedback_ = Array::New(AotTypeFeedback::kFirstCallSiteIndex +
+                             num_call_sites * AotTypeFeedback::kCallSiteSize,
+                         Heap::kOld);
+  feedback_.SetAt(AotTypeFeedback::kUsageCounterIndex,
+                  Smi::Handle(zone_, Smi::New(usage)));
+
+  Object& value = Object::Handle(zone_);
+  for (intptr_t i = 0; i < aot_call_sites_.Length(); i++) {
+    value = aot_call_sites_.At(i);
+    if (value.IsGrowableObjectArray()) {
+      value = Array::MakeFixedLength(GrowableObjectArray::Cast(value));
+    }
+    feedback_.SetAt(AotTypeFeedback::kFirstCallSiteIndex + i, value);
+  }
+
+  AotFeedbackMap map(feedback_table_.raw());
+  map.UpdateOrInsert(func_, feedback_);
+  feedback_table_ = map.Release().raw();
+}
+
 FunctionPtr TypeFeedbackLoader::FindFunction(FunctionLayout::Kind kind,
                                              intptr_t token_pos) {
   if (cls_name_.Equals(Symbols::TopLevel())) {
@@ -102,6 +102,10 @@ class TypeFeedbackLoader : public ValueObject {
   ObjectPtr LoadClasses();
   ObjectPtr LoadFields();
   ObjectPtr LoadFunction();
+  void AddAotReceiverClass(const GrowableObjectArray& entries,
+                           const Class& cls,
+                           intptr_t count);
+  void AddAotFeedback(intptr_t usage);
   FunctionPtr FindFunction(FunctionLayout::Kind kind, intptr_t token_pos);
 
   ClassPtr ReadClassByName();
@@ -128,9 +132,60 @@ class TypeFeedbackLoader : public ValueObject {
   Function& target_;
   Array& args_desc_;
   GrowableObjectArray& functions_to_compile_;
+  GrowableObjectArray& aot_call_sites_;
+  Array& feedback_;
+  Array& feedback_table_;
   Object& error_;
 };
 
+// Type feedback loaded for an AOT compilation.
+//
+// The precompiler starts every function with empty ICData, so instead of
+// filling in ICData the TypeFeedbackLoader records the usage counter and the
+// receiver classes seen at each instance call of every function in a table in
+// the object store. The call specializer uses the receiver classes to create
+// polymorphic calls that the inliner can inline.
+//
+// Edge counters are not loaded: they are indexed by the blocks of the JIT's
+// unoptimized graph, which do not correspond to the blocks of the AOT graph.
+//
+// Receiver classes are recorded as Class objects rather than class ids
+// because the precompiler sorts classes after the feedback is loaded.
+class AotTypeFeedback : public AllStatic {
+ public:
+  // Returns the feedback recorded for [function], or null if there is none.
+  static ArrayPtr FeedbackFor(const Function& function);
+
+  // Returns the functions with feedback that were executed at least once,
+  // most frequently used first, or null if no feedback was loaded.
+  static ArrayPtr FunctionsByUsage();
+
+  static intptr_t UsageCounter(const Array& feedback);
+
+  // Returns the pairs of receiver class and count seen at the call to
+  // [selector] with [deopt_id], or null. Deopt ids of the JIT and the AOT
+  // flow graphs may differ, so a call to [selector] with another deopt id is
+  // used if it is the only call to [selector] in the function.
+  static ArrayPtr ReceiverClasses(const Array& feedback,
+                                  intptr_t deopt_id,
+                                  const String& selector);
+
+ private:
+  enum {
+    kUsageCounterIndex = 0,
+    kFirstCallSiteIndex,
+  };
+
+  enum {
+    kCallSiteDeoptIdOffset = 0,
+    kCallSiteSelectorOffset,
+    kCallSiteEntriesOffset,
+    kCallSiteSize,
+  };
+
+  friend class TypeFeedbackLoader;
+};
+
 }  // namespace dart
 
 #endif  // RUNTIME_VM_COMPILATION_TRACE_H_
@@ -5,6 +5,7 @@
 #include "vm/compiler/aot/aot_call_specializer.h"
 
 #include "vm/bit_vector.h"
+#include "vm/compilation_trace.h"
 #include "vm/compiler/aot/precompiler.h"
 #include "vm/compiler/backend/branch_optimizer.h"
 #include "vm/compiler/backend/flow_graph_compiler.h"
@@ -36,6 +37,10 @@ DEFINE_FLAG(int,
             5,
             "If a call receiver is known to be of at most this many classes, "
             "generate exhaustive class tests instead of a megamorphic call");
+DEFINE_FLAG(bool,
+            aot_type_feedback_inlining,
+            true,
+            "Use type feedback loaded for AOT to create polymorphic calls.");
 
 // Quick access to the current isolate and zone.
 #define I (isolate())
@@ -1049,6 +1054,96 @@ void AotCallSpecializer::VisitInstanceCall(InstanceCallInstr* instr) {
     instr->ReplaceWith(call, current_iterator());
     return;
   }
+
+  if (TryReplaceWithPolymorphicCallFromFeedback(instr)) {
+    return;
+  }
+}
+
+bool AotCallSpecializer::TryReplaceWithPolymorphicCallFromFeedback(
+    InstanceCallInstr* instr) {
+  if (!FLAG_aot_type_feedback_inlining) {
+    return false;
+  }
+  // Calls inlined from other functions were already handled when the callee
+  // graph was optimized before inlining, using the callee's feedback.
+  if (instr->inlining_id() != flow_graph()->inlining_id()) {
+    return false;
+  }
+  const Array& feedback =
+      Array::Handle(Z, AotTypeFeedback::FeedbackFor(flow_graph()->function()));
+  if (feedback.IsNull()) {
+    return false;
+  }
+  const Array& entries = Array::Handle(
+      Z, AotTypeFeedback::ReceiverClasses(feedback, instr->deopt_id(),
+                                          instr->function_name()));
+  if (entries.IsNull() || (entries.Length() == 0)) {
+    return false;
+  }
+
+  // Keep the most frequently seen receiver classes, the remaining ones are
+  // handled by the fallback instance call.
+  const intptr_t num_classes = entries.Length() / 2;
+  GrowableArray<intptr_t> order(num_classes);
+  for (intptr_t i = 0; i < num_classes; i++) {
+    order.Add(i);
+  }
+  for (intptr_t i = 1; i < num_classes; i++) {
+    for (intptr_t j = i; j > 0; j--) {
+      const intptr_t count_a =
+          Smi::Value(Smi::RawCast(entries.At(2 * order[j - 1] + 1)));
+      const intptr_t count_b =
+          Smi::Value(Smi::RawCast(entries.At(2 * order[j] + 1)));
+      if (count_a >= count_b) break;
+      order.Swap(j - 1, j);
+    }
+  }
+
+  const ICData& ic_data = ICData::Handle(
+      Z, ICData::New(flow_graph()->function(), instr->function_name(),
+                     Array::Handle(Z, instr->GetArgumentsDescriptor()),
+                     DeoptId::kNone, /* args_tested = */ 1,
+                     ICData::kOptimized));
+  Class& cls = Class::Handle(Z);
+  Function& target = Function::Handle(Z);
+  intptr_t num_targets = 0;
+  for (intptr_t i = 0; i < num_classes; i++) {
+    if (num_targets == FLAG_max_polymorphic_checks) {
+      break;
+    }
+    const intptr_t count =
+        Smi::Value(Smi::RawCast(entries.At(2 * order[i] + 1)));
+    if (count == 0) {
+      break;
+    }
+    cls ^= entries.At(2 * order[i]);
+    if (!cls.is_finalized()) {
+      continue;
+    }
+    target = instr->ResolveForReceiverClass(cls);
+    if (target.IsNull()) {
+      continue;
+    }
+    ic_data.AddReceiverCheck(cls.id(), target, count);
+    num_targets++;
+  }
+  if (num_targets == 0) {
+    return false;
+  }
+
+  if (FLAG_trace_optimization) {
+    THR_Print("Using type feedback for %s: %s\n", instr->ToCString(),
+              ic_data.ToCString());
+  }
+
+  const CallTargets* targets = CallTargets::Create(Z, ic_data);
+  ASSERT(!targets->is_empty());
+  PolymorphicInstanceCallInstr* call =
+      PolymorphicInstanceCallInstr::FromCall(Z, instr, *targets,
+                                             /* complete = */ false);
+  instr->ReplaceWith(call, current_iterator());
+  return true;
 }
 
 void AotCallSpecializer::VisitStaticCall(StaticCallInstr* instr) {
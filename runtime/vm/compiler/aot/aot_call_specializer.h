@@ -38,6 +38,10 @@ class AotCallSpecializer : public CallSpecializer {
 
   bool TryCreateICDataForUniqueTarget(InstanceCallInstr* call);
 
+  // Attempt to replace the call with a polymorphic call over the receiver
+  // classes recorded in type feedback collected by the JIT.
+  bool TryReplaceWithPolymorphicCallFromFeedback(InstanceCallInstr* call);
+
   bool RecognizeRuntimeTypeGetter(InstanceCallInstr* call);
   bool TryReplaceWithHaveSameRuntimeType(TemplateDartCall<0>* call);
 
@@ -8,6 +8,7 @@
 #include "vm/canonical_tables.h"
 #include "vm/class_finalizer.h"
 #include "vm/code_patcher.h"
+#include "vm/compilation_trace.h"
 #include "vm/compiler/aot/aot_call_specializer.h"
 #include "vm/compiler/aot/precompiler_tracer.h"
 #include "vm/compiler/assembler/assembler.h"
@@ -62,6 +63,11 @@ namespace dart {
 DEFINE_FLAG(bool, print_unique_targets, false, "Print unique dynamic targets");
 DEFINE_FLAG(bool, print_gop, false, "Print global object pool");
 DEFINE_FLAG(bool, trace_precompiler, false, "Trace precompiler.");
+DEFINE_FLAG(bool,
+            profile_guided_code_layout,
+            true,
+            "Lay out the code of functions that loaded type feedback saw "
+            "executed first and the code of the others last.");
 DEFINE_FLAG(
     int,
     max_speculative_inlining_attempts,
@@ -390,6 +396,7 @@ void Precompiler::DoCompileAll() {
       }
 
       TraceForRetainedFunctions();
+      ComputeCodeLayout();
       FinalizeDispatchTable();
       ReplaceFunctionStaticCallEntries();
 
@@ -403,6 +410,7 @@ void Precompiler::DoCompileAll() {
       // Clear these before dropping classes as they may hold onto otherwise
       // dead instances of classes we will remove or otherwise unused symbols.
       I->object_store()->set_unique_dynamic_targets(Array::null_array());
+      I->object_store()->set_aot_type_feedback(Array::null_array());
       Class& null_class = Class::Handle(Z);
       Function& null_function = Function::Handle(Z);
       Field& null_field = Field::Handle(Z);
@@ -1616,6 +1624,109 @@ void Precompiler::TraceForRetainedFunctions() {
   }
 }
 
+// Computes the order in which the serializer lays out code, see
+// CodeSerializationCluster::ApplyCodeLayout.
+//
+// Functions that the type feedback saw executed come first, most frequently
+// used first. Each one is followed by the hot functions it calls directly
+// that are not placed yet, so callers and callees share cache lines and
+// pages. The code of functions the feedback never saw executed is moved to
+// the end, away from the hot code.
+//
+// This only orders whole functions. Within a function the blocks keep the
+// order of BlockScheduler::ReorderBlocksAOT, which moves throwing blocks to
+// the end but not blocks the JIT never executed: its edge counters do not
+// map onto the blocks of the AOT flow graph.
+void Precompiler::ComputeCodeLayout() {
+  if (!FLAG_profile_guided_code_layout) {
+    return;
+  }
+  const Array& hot_functions =
+      Array::Handle(Z, AotTypeFeedback::FunctionsByUsage());
+  if (hot_functions.IsNull()) {
+    return;
+  }
+
+  const auto& hot_code =
+      GrowableObjectArray::Handle(Z, GrowableObjectArray::New(Heap::kOld));
+  const auto& cold_code =
+      GrowableObjectArray::Handle(Z, GrowableObjectArray::New(Heap::kOld));
+  FunctionSet hot_set(
+      HashTables::New<FunctionSet>(hot_functions.Length() + 1, Heap::kOld));
+  FunctionSet placed(
+      HashTables::New<FunctionSet>(hot_functions.Length() + 1, Heap::kOld));
+  Function& function = Function::Handle(Z);
+  Function& callee = Function::Handle(Z);
+  Code& code = Code::Handle(Z);
+  Array& static_calls = Array::Handle(Z);
+  intptr_t hot_size = 0;
+  intptr_t cold_size = 0;
+
+  for (intptr_t i = 0; i < hot_functions.Length(); i++) {
+    function ^= hot_functions.At(i);
+    hot_set.Insert(function);
+  }
+
+  auto place = [&](const Function& target) {
+    if (!target.HasCode() || placed.ContainsKey(target)) {
+      return false;
+    }
+    placed.Insert(target);
+    code = target.CurrentCode();
+    hot_code.Add(code);
+    hot_size += code.Size();
+    return true;
+  };
+
+  for (intptr_t i = 0; i < hot_functions.Length(); i++) {
+    function ^= hot_functions.At(i);
+    if (!place(function)) {
+      continue;
+    }
+    static_calls = code.static_calls_target_table();
+    if (static_calls.IsNull()) {
+      continue;
+    }
+    StaticCallsTable calls(static_calls);
+    for (auto& view : calls) {
+      callee = view.Get<Code::kSCallTableFunctionTarget>();
+      if (!callee.IsNull() && hot_set.ContainsKey(callee)) {
+        place(callee);
+      }
+    }
+  }
+
+  FunctionSet::Iterator it(&seen_functions_);
+  while (it.MoveNext()) {
+    function ^= seen_functions_.GetKey(it.Current());
+    // Only consider kinds of functions that exist in the JIT as well, so
+    // that missing feedback means the function was never executed.
+    const bool has_jit_counterpart =
+        function.IsRegularFunction() || function.IsGetterFunction() ||
+        function.IsSetterFunction() || function.IsGenerativeConstructor() ||
+        function.IsFactory();
+    if (has_jit_counterpart && function.HasCode() &&
+        !hot_set.ContainsKey(function) &&
+        (AotTypeFeedback::FeedbackFor(function) == Array::null())) {
+      code = function.CurrentCode();
+      cold_code.Add(code);
+      cold_size += code.Size();
+    }
+  }
+
+  hot_set.Release();
+  placed.Release();
+
+  I->object_store()->set_hot_code_order(hot_code);
+  I->object_store()->set_cold_code(cold_code);
+
+  if (FLAG_trace_precompiler) {
+    THR_Print("Code layout: %" Pd " hot functions (%" Pd
+              " bytes), %" Pd " cold functions (%" Pd " bytes)\n",
+              hot_code.Length(), hot_size, cold_code.Length(), cold_size);
+  }
+}
+
 void Precompiler::FinalizeDispatchTable() {
   if (!FLAG_use_bare_instructions || !FLAG_use_table_dispatch) return;
   // Build the entries used to serialize the dispatch table before
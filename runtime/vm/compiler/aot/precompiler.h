@@ -300,6 +300,7 @@ class Precompiler : public ValueObject {
   void AttachOptimizedTypeTestingStub();
 
   void TraceForRetainedFunctions();
+  void ComputeCodeLayout();
   void FinalizeDispatchTable();
   void ReplaceFunctionStaticCallEntries();
   void DropFunctions();
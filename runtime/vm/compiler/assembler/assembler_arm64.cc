@@ -1710,6 +1710,22 @@ void Assembler::MaybeTraceAllocation(intptr_t cid,
   ldr(temp_reg, Address(temp_reg, 0), kUnsignedByte);
   cbnz(trace, temp_reg);
 }
+
+void Assembler::MaybeTraceAllocation(Register cid_reg,
+                                     Register temp_reg,
+                                     Label* trace) {
+  ASSERT(cid_reg != temp_reg);
+  const intptr_t shared_table_offset =
+      target::Isolate::shared_class_table_offset();
+  const intptr_t table_offset =
+      target::SharedClassTable::class_heap_stats_table_offset();
+
+  LoadIsolate(temp_reg);
+  ldr(temp_reg, Address(temp_reg, shared_table_offset));
+  ldr(temp_reg, Address(temp_reg, table_offset));
+  ldr(temp_reg, Address(temp_reg, cid_reg), kUnsignedByte);
+  cbnz(trace, temp_reg);
+}
 #endif  // !PRODUCT
 
 void Assembler::TryAllocate(const Class& cls,
@@ -1731,6 +1731,10 @@ class Assembler : public AssemblerBase {
   // which will allocate in the runtime where tracing occurs.
   void MaybeTraceAllocation(intptr_t cid, Register temp_reg, Label* trace);
 
+  // Same as above for the class id in |cid_reg|. Also taken for classes the
+  // scavenger has chosen to pretenure.
+  void MaybeTraceAllocation(Register cid_reg, Register temp_reg, Label* trace);
+
   // Inlined allocation of an instance of class 'cls', code has no runtime
   // calls. Jump to 'failure' if the instance cannot be allocated here.
   // Allocated instance is returned in 'instance_reg'.
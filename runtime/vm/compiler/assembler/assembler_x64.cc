@@ -1906,6 +1906,22 @@ void Assembler::MaybeTraceAllocation(intptr_t cid,
   // the allocation stub.
   j(NOT_ZERO, trace, near_jump);
 }
+
+void Assembler::MaybeTraceAllocation(Register cid_reg,
+                                     Label* trace,
+                                     bool near_jump) {
+  ASSERT(cid_reg != TMP);
+  const intptr_t shared_table_offset =
+      target::Isolate::shared_class_table_offset();
+  const intptr_t table_offset =
+      target::SharedClassTable::class_heap_stats_table_offset();
+
+  LoadIsolate(TMP);
+  movq(TMP, Address(TMP, shared_table_offset));
+  movq(TMP, Address(TMP, table_offset));
+  cmpb(Address(TMP, cid_reg, TIMES_1, 0), Immediate(0));
+  j(NOT_ZERO, trace, near_jump);
+}
 #endif  // !PRODUCT
 
 void Assembler::TryAllocate(const Class& cls,
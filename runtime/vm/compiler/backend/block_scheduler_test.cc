@@ -0,0 +1,58 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compiler/backend/block_scheduler.h"
+#include "vm/compiler/backend/il_printer.h"
+#include "vm/compiler/backend/il_test_helper.h"
+#include "vm/compiler/compiler_pass.h"
+#include "vm/object.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+#if defined(DART_PRECOMPILER)
+
+// AOT code has no edge counters, so the blocks are laid out in reverse
+// postorder except for the throwing ones, which are moved to the end.
+ISOLATE_UNIT_TEST_CASE(IRTest_ReorderBlocksAOT_ThrowLast) {
+  const char* kScript =
+      R"(
+      @pragma('vm:never-inline')
+      int foo(int x) {
+        if (x < 0) {
+          throw new ArgumentError.value(x);
+        }
+        return x + 1;
+      }
+
+      main() {
+        foo(1);
+      }
+      )";
+
+  FlowGraph* flow_graph = CompileFunction(kScript, "foo", CompilerPass::kAOT);
+  EXPECT_EQ(0, flow_graph->graph_entry()->entry_count());
+
+  auto codegen_order = flow_graph->CodegenBlockOrder(true);
+  RELEASE_ASSERT(codegen_order->length() > 1);
+  EXPECT(codegen_order->At(0)->IsGraphEntry());
+  EXPECT(codegen_order->At(1)->IsFunctionEntry());
+
+  intptr_t throw_index = -1;
+  intptr_t return_index = -1;
+  for (intptr_t i = 0; i < codegen_order->length(); i++) {
+    Instruction* last = codegen_order->At(i)->last_instruction();
+    if (last->IsThrow()) {
+      throw_index = i;
+    } else if (last->IsReturn()) {
+      return_index = i;
+    }
+  }
+  EXPECT(return_index != -1);
+  EXPECT_EQ(codegen_order->length() - 1, throw_index);
+}
+
+#endif  // defined(DART_PRECOMPILER)
+
+}  // namespace dart
@@ -1155,6 +1155,7 @@ class Instruction : public ZoneAllocated {
   friend class CatchBlockEntryInstr;  // deopt_id_
   friend class DebugStepCheckInstr;   // deopt_id_
   friend class StrictCompareInstr;    // deopt_id_
+  friend class UnrollableLoop;        // GetDeoptId
 
   // Fetch deopt id without checking if this computation can deoptimize.
   intptr_t GetDeoptId() const { return deopt_id_; }
@@ -8090,6 +8091,7 @@ class CheckStackOverflowInstr : public TemplateInstruction<0, NoThrow> {
   bool in_loop() const { return loop_depth_ > 0; }
   intptr_t stack_depth() const { return stack_depth_; }
   intptr_t loop_depth() const { return loop_depth_; }
+  Kind kind() const { return kind_; }
 
   DECLARE_INSTRUCTION(CheckStackOverflow)
 
@@ -9147,6 +9149,11 @@ class SimdOpInstr : public Definition {
     return new SimdOpInstr(kind, left, right, deopt_id);
   }
 
+  // Create a unary SimdOp instr.
+  static SimdOpInstr* Create(Kind kind, Value* left, intptr_t deopt_id) {
+    return new SimdOpInstr(kind, left, deopt_id);
+  }
+
   // Create a binary SimdOp instr.
   static SimdOpInstr* Create(MethodRecognizer::Kind kind,
                              Value* left,
@@ -3181,7 +3181,8 @@ void CreateArrayInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
       compiler::target::IsSmi(num_elements()->BoundConstant())) {
     const intptr_t length =
         compiler::target::SmiValue(num_elements()->BoundConstant());
-    if (Array::IsValidLength(length)) {
+    // Card marked arrays must be allocated in old space by the stub.
+    if (compiler::target::WillAllocateNewOrRememberedArray(length)) {
       InlineArrayAllocation(compiler, length, &slow_path, &done);
     }
   }
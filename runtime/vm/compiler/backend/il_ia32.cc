@@ -2515,7 +2515,8 @@ void CreateArrayInstr::EmitNativeCode(FlowGraphCompiler* compiler) {
   if (compiler->is_optimizing() && num_elements()->BindsToConstant() &&
       num_elements()->BoundConstant().IsSmi()) {
     const intptr_t length = Smi::Cast(num_elements()->BoundConstant()).Value();
-    if (Array::IsValidLength(length)) {
+    // Card marked arrays must be allocated in old space by the stub.
+    if (compiler::target::WillAllocateNewOrRememberedArray(length)) {
       InlineArrayAllocation(compiler, length, &slow_path, &done);
     }
   }
@@ -153,6 +153,18 @@ FlowGraph* TestPipeline::RunPasses(
   return flow_graph_;
 }
 
+FlowGraph* CompileFunction(const char* script,
+                           const char* name,
+                           CompilerPass::PipelineMode mode) {
+  const auto& root_library = Library::Handle(LoadTestScript(script));
+  if (mode == CompilerPass::kJIT) {
+    Invoke(root_library, "main");
+  }
+  const auto& function = Function::Handle(GetFunction(root_library, name));
+  TestPipeline pipeline(function, mode);
+  return pipeline.RunPasses({});
+}
+
 void TestPipeline::CompileGraphAndAttachFunction() {
   Zone* zone = thread_->zone();
   const bool optimized = true;
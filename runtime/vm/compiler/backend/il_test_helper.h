@@ -95,6 +95,26 @@ class TestPipeline : public ValueObject {
   FlowGraph* flow_graph_ = nullptr;
 };
 
+// Loads the script and runs the whole pipeline on the function with the given
+// name. In JIT mode, main() is invoked first to collect type feedback.
+FlowGraph* CompileFunction(const char* script,
+                           const char* name,
+                           CompilerPass::PipelineMode mode);
+
+// Returns the number of instructions in the graph that satisfy [predicate].
+template <typename Predicate>
+intptr_t CountInstructions(FlowGraph* flow_graph, Predicate predicate) {
+  intptr_t count = 0;
+  for (auto block : flow_graph->reverse_postorder()) {
+    for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+      if (predicate(it.Current())) {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
 // Match opcodes used for [ILMatcher], see below.
 enum MatchOpCode {
 // Emit a match and match-and-move code for every instruction.
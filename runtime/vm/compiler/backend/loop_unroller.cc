@@ -0,0 +1,694 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compiler/backend/loop_unroller.h"
+
+#include "vm/compiler/backend/flow_graph.h"
+#include "vm/compiler/backend/il.h"
+#include "vm/compiler/backend/loops.h"
+#include "vm/compiler/runtime_api.h"
+#include "vm/flags.h"
+#include "vm/log.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, unroll_loops, true, "Unroll and peel small innermost loops.");
+DEFINE_FLAG(int,
+            loop_unroll_factor,
+            4,
+            "Maximum number of iterations executed per iteration of an "
+            "unrolled loop, and of iterations peeled from a loop.");
+DEFINE_FLAG(int,
+            loop_unroll_budget,
+            64,
+            "Maximum number of instructions in the body of an unrolled loop, "
+            "and in all iterations peeled from a loop.");
+DEFINE_FLAG(bool, trace_loop_unroller, false, "Trace loop unrolling.");
+
+// Bounds the constant added to a symbolic loop bound, so that moving the
+// bound by a few iterations cannot overflow.
+static const int64_t kMaxBoundOffset = 1 << 16;
+
+// Returns true if the given definition is the length of an array, a string
+// or typed data, which is non-negative and far from overflowing.
+static bool IsLength(Definition* def) {
+  LoadFieldInstr* load = def->AsLoadField();
+  if (load == nullptr) {
+    return false;
+  }
+  switch (load->slot().kind()) {
+    case Slot::Kind::kArray_length:
+    case Slot::Kind::kGrowableObjectArray_length:
+    case Slot::Kind::kString_length:
+    case Slot::Kind::kTypedDataBase_length:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// A loop of the form
+//
+//   P:  ...
+//       goto H
+//   H:  i = phi(s, i'), ...
+//       [CheckStackOverflow]
+//       if (i < n) goto B else goto X
+//   B:  ...
+//       i' = i + 1
+//       goto H
+//
+// where n is either a constant or a length plus a constant, is peeled, if s
+// and n are constants and n - s is small, into
+//
+//   P:  ...
+//       B[i := s]
+//       ...
+//       B[i := n - 1]
+//       goto H
+//   H:  i = phi(n, i'), ...
+//
+// and otherwise unrolled by a factor u into
+//
+//   P:  ...
+//       v = n - (u - 1)
+//       goto UH
+//   UH: ui = phi(s, ui'), ...
+//       [CheckStackOverflow]
+//       if (ui < v) goto UB else goto UX
+//   UB: B[i := ui]
+//       ...
+//       B[i := ui + (u - 1)]
+//       goto UH
+//   UX: goto H
+//   H:  i = phi(ui, i'), ...
+//
+// where B[i := x] denotes a copy of the body using the values the header phis
+// have in the iteration in which i is x. Loops counting down while i > n are
+// handled alike.
+class UnrollableLoop : public ZoneAllocated {
+ public:
+  UnrollableLoop(FlowGraph* flow_graph, LoopInfo* loop, bool peel)
+      : flow_graph_(flow_graph),
+        zone_(flow_graph->zone()),
+        loop_(loop),
+        peel_(peel) {}
+
+  // Returns true if the loop has the shape described above and fits the
+  // budget for peeling, or for unrolling if peel is false.
+  bool Analyze();
+
+  // Peels or unrolls the loop. Analyze() must have succeeded.
+  void Transform();
+
+ private:
+  bool AnalyzeHeader();
+  bool AnalyzeBody();
+  static bool CanClone(Instruction* instr);
+
+  Definition* Map(Definition* def) const;
+  Value* MapValue(Value* value) const {
+    return new (zone_) Value(Map(value->definition()));
+  }
+  Instruction* Clone(Instruction* instr) const;
+  void MapPhisToInputs(intptr_t index);
+  void MapPhisToNextIteration();
+  void EmitIteration();
+  Definition* Emit(Definition* def);
+  Definition* EmitIndexConstant(int64_t value);
+  Definition* EmitUnrolledLimit();
+  TargetEntryInstr* NewTarget();
+  JoinEntryInstr* NewJoin();
+
+  void Peel();
+  void Unroll();
+
+  FlowGraph* const flow_graph_;
+  Zone* const zone_;
+  LoopInfo* const loop_;
+  const bool peel_;
+
+  JoinEntryInstr* header_ = nullptr;
+  TargetEntryInstr* body_ = nullptr;
+  BlockEntryInstr* pre_header_ = nullptr;
+  // The phi controlling the loop, which moves by stride_ towards the
+  // exclusive bound limit_ + limit_offset_, or just limit_offset_ if limit_
+  // is null.
+  PhiInstr* phi_ = nullptr;
+  int64_t stride_ = 0;
+  Definition* limit_ = nullptr;
+  int64_t limit_offset_ = 0;
+  // The trip count if it is known, or -1.
+  int64_t trip_count_ = -1;
+  intptr_t cid_ = kIllegalCid;
+  CheckStackOverflowInstr* stack_check_ = nullptr;
+  TokenPosition token_pos_ = TokenPosition::kNoSource;
+  intptr_t body_size_ = 0;
+
+  // Number of iterations to peel, or 0 to unroll unroll_factor_ iterations.
+  intptr_t peel_count_ = 0;
+  intptr_t unroll_factor_ = 0;
+
+  // The value of the loop definitions in the iteration being emitted,
+  // indexed by SSA temp index.
+  intptr_t num_ssa_temps_ = 0;
+  GrowableArray<Definition*> map_;
+  Instruction* cursor_ = nullptr;
+
+  DISALLOW_COPY_AND_ASSIGN(UnrollableLoop);
+};
+
+bool UnrollableLoop::Analyze() {
+  if ((loop_->inner() != nullptr) || (loop_->back_edges().length() != 1)) {
+    return false;
+  }
+  header_ = loop_->header()->AsJoinEntry();
+  body_ = loop_->back_edges()[0]->AsTargetEntry();
+  if ((header_ == nullptr) || (body_ == nullptr) ||
+      (header_->PredecessorCount() != 2) ||
+      (body_->PredecessorAt(0) != header_) ||
+      (header_->try_index() != kInvalidTryIndex)) {
+    return false;
+  }
+  pre_header_ = header_->PredecessorAt(1 - header_->IndexOfPredecessor(body_));
+  if (!(pre_header_->IsTargetEntry() || pre_header_->IsJoinEntry()) ||
+      !pre_header_->last_instruction()->IsGoto() ||
+      (pre_header_->try_index() != kInvalidTryIndex)) {
+    return false;
+  }
+  return AnalyzeHeader() && AnalyzeBody();
+}
+
+bool UnrollableLoop::AnalyzeHeader() {
+  InductionVar* control = loop_->control();
+  if ((control == nullptr) || !InductionVar::IsLinear(control, &stride_) ||
+      ((stride_ != 1) && (stride_ != -1))) {
+    return false;
+  }
+  for (PhiIterator it(header_); !it.Done(); it.Advance()) {
+    if (loop_->LookupInduction(it.Current()) == control) {
+      phi_ = it.Current();
+      break;
+    }
+  }
+  if (phi_ == nullptr) {
+    return false;
+  }
+  if (phi_->representation() == kUnboxedInt64) {
+    cid_ = kMintCid;
+  } else if ((phi_->representation() == kTagged) &&
+             (phi_->Type()->ToCid() == kSmiCid)) {
+    cid_ = kSmiCid;
+  } else {
+    return false;
+  }
+
+  // Only a stack overflow check may precede the exit test.
+  Instruction* current = header_->next();
+  stack_check_ = current->AsCheckStackOverflow();
+  if (stack_check_ != nullptr) {
+    current = current->next();
+  }
+  BranchInstr* branch = current->AsBranch();
+  if (branch == nullptr) {
+    return false;
+  }
+  InductionVar* bound = nullptr;
+  for (auto b : control->bounds()) {
+    if (b.branch_ == branch) {
+      bound = b.limit_;
+      break;
+    }
+  }
+  if (bound == nullptr) {
+    return false;
+  }
+  token_pos_ = branch->comparison()->token_pos();
+  if (!InductionVar::IsConstant(bound, &limit_offset_)) {
+    if (!InductionVar::IsInvariant(bound) || (bound->mult() != 1) ||
+        (bound->offset() < -kMaxBoundOffset) ||
+        (bound->offset() > kMaxBoundOffset)) {
+      return false;
+    }
+    limit_ = bound->def()->OriginalDefinitionIgnoreBoxingAndConstraints();
+    limit_offset_ = bound->offset();
+    if (!IsLength(limit_) || loop_->Contains(limit_->GetBlock())) {
+      return false;
+    }
+  } else if ((limit_offset_ < kMinInt32) || (limit_offset_ > kMaxInt32)) {
+    return false;
+  }
+
+  int64_t start = 0;
+  if ((limit_ == nullptr) &&
+      InductionVar::IsConstant(control->initial(), &start) &&
+      (start >= kMinInt32) && (start <= kMaxInt32)) {
+    trip_count_ = Utils::Maximum<int64_t>(
+        0, (stride_ > 0) ? limit_offset_ - start : start - limit_offset_);
+  }
+  return true;
+}
+
+bool UnrollableLoop::AnalyzeBody() {
+  for (ForwardInstructionIterator it(body_); !it.Done(); it.Advance()) {
+    Instruction* current = it.Current();
+    if (current->IsGoto()) {
+      continue;
+    }
+    if (!CanClone(current)) {
+      if (FLAG_trace_loop_unroller) {
+        THR_Print("Not unrolling B%" Pd ": %s\n", header_->block_id(),
+                  current->ToCString());
+      }
+      return false;
+    }
+    body_size_++;
+  }
+  if (body_size_ == 0) {
+    return false;
+  }
+
+  // Peel loops that are known to be short.
+  if (peel_) {
+    if ((trip_count_ > 0) && (trip_count_ <= FLAG_loop_unroll_factor) &&
+        (trip_count_ * body_size_ <= FLAG_loop_unroll_budget)) {
+      peel_count_ = trip_count_;
+      return true;
+    }
+    return false;
+  }
+
+  // Unrolling trades code size for speed.
+  if (FLAG_optimization_level < 2) {
+    return false;
+  }
+  unroll_factor_ =
+      Utils::Minimum<intptr_t>(FLAG_loop_unroll_factor,
+                               FLAG_loop_unroll_budget / body_size_);
+  if (unroll_factor_ < 2) {
+    return false;
+  }
+  // Loops known to be shorter than the unrolled iterations stay as they are.
+  if ((trip_count_ >= 0) && (trip_count_ < unroll_factor_)) {
+    return false;
+  }
+  const int64_t unrolled_limit =
+      limit_offset_ - stride_ * (unroll_factor_ - 1);
+  return (limit_ != nullptr) || (cid_ != kSmiCid) ||
+         compiler::target::IsSmi(unrolled_limit);
+}
+
+bool UnrollableLoop::CanClone(Instruction* instr) {
+  if (auto load = instr->AsLoadField()) {
+    return !load->calls_initializer();
+  }
+  return instr->IsBinaryIntegerOp() || instr->IsUnaryIntegerOp() ||
+         instr->IsBinaryDoubleOp() || instr->IsUnaryDoubleOp() ||
+         instr->IsBox() || instr->IsUnbox() || instr->IsIntConverter() ||
+         instr->IsLoadIndexed() || instr->IsStoreIndexed() ||
+         instr->IsLoadUntagged() || instr->IsCheckArrayBound() ||
+         instr->IsGenericCheckBound();
+}
+
+Definition* UnrollableLoop::Map(Definition* def) const {
+  if (def->HasSSATemp() && (def->ssa_temp_index() < num_ssa_temps_) &&
+      (map_[def->ssa_temp_index()] != nullptr)) {
+    return map_[def->ssa_temp_index()];
+  }
+  return def;
+}
+
+// Returns a copy of the given body instruction, which uses the values its
+// inputs have in the iteration being emitted.
+Instruction* UnrollableLoop::Clone(Instruction* instr) const {
+  const intptr_t deopt_id = instr->GetDeoptId();
+  if (auto op = instr->AsBinaryInt64Op()) {
+    auto clone = new (zone_) BinaryInt64OpInstr(
+        op->op_kind(), MapValue(op->left()), MapValue(op->right()), deopt_id,
+        op->SpeculativeModeOfInputs());
+    clone->set_can_overflow(op->can_overflow());
+    return clone;
+  } else if (auto op = instr->AsBinaryIntegerOp()) {
+    const bool is_speculative =
+        !op->IsShiftInt64Op() && !op->IsShiftUint32Op();
+    auto clone = BinaryIntegerOpInstr::Make(
+        op->representation(), op->op_kind(), MapValue(op->left()),
+        MapValue(op->right()), deopt_id, op->can_overflow(),
+        op->is_truncating(), nullptr,
+        is_speculative ? Instruction::kGuardInputs
+                       : Instruction::kNotSpeculative);
+    ASSERT(clone->tag() == op->tag());
+    return clone;
+  } else if (auto op = instr->AsUnaryInt64Op()) {
+    return new (zone_)
+        UnaryInt64OpInstr(op->op_kind(), MapValue(op->value()), deopt_id,
+                          op->SpeculativeModeOfInputs());
+  } else if (auto op = instr->AsUnaryIntegerOp()) {
+    return UnaryIntegerOpInstr::Make(op->representation(), op->op_kind(),
+                                     MapValue(op->value()), deopt_id, nullptr);
+  } else if (auto op = instr->AsBinaryDoubleOp()) {
+    return new (zone_) BinaryDoubleOpInstr(
+        op->op_kind(), MapValue(op->left()), MapValue(op->right()), deopt_id,
+        op->token_pos(), op->SpeculativeModeOfInputs());
+  } else if (auto op = instr->AsUnaryDoubleOp()) {
+    return new (zone_) UnaryDoubleOpInstr(op->op_kind(), MapValue(op->value()),
+                                          deopt_id,
+                                          op->SpeculativeModeOfInputs());
+  } else if (auto box = instr->AsBox()) {
+    return BoxInstr::Create(box->from_representation(),
+                            MapValue(box->value()));
+  } else if (auto unbox = instr->AsUnbox()) {
+    UnboxInstr* clone = UnboxInstr::Create(
+        unbox->representation(), MapValue(unbox->value()), deopt_id,
+        unbox->SpeculativeModeOfInputs());
+    if (unbox->IsUnboxInteger() && unbox->AsUnboxInteger()->is_truncating()) {
+      clone->AsUnboxInteger()->mark_truncating();
+    }
+    return clone;
+  } else if (auto conv = instr->AsIntConverter()) {
+    auto clone = new (zone_) IntConverterInstr(
+        conv->from(), conv->to(), MapValue(conv->value()), deopt_id);
+    if (conv->is_truncating()) {
+      clone->mark_truncating();
+    }
+    return clone;
+  } else if (auto load = instr->AsLoadIndexed()) {
+    return new (zone_) LoadIndexedInstr(
+        MapValue(load->array()), MapValue(load->index()),
+        load->RequiredInputRepresentation(1) != kTagged, load->index_scale(),
+        load->class_id(), load->aligned() ? kAlignedAccess : kUnalignedAccess,
+        deopt_id, load->token_pos(), new (zone_) CompileType(*load->Type()));
+  } else if (auto store = instr->AsStoreIndexed()) {
+    return new (zone_) StoreIndexedInstr(
+        MapValue(store->array()), MapValue(store->index()),
+        MapValue(store->value()),
+        store->ShouldEmitStoreBarrier() ? kEmitStoreBarrier : kNoStoreBarrier,
+        store->RequiredInputRepresentation(StoreIndexedInstr::kIndexPos) !=
+            kTagged,
+        store->index_scale(), store->class_id(),
+        store->aligned() ? kAlignedAccess : kUnalignedAccess, deopt_id,
+        store->token_pos(), store->SpeculativeModeOfInputs());
+  } else if (auto load = instr->AsLoadUntagged()) {
+    return new (zone_)
+        LoadUntaggedInstr(MapValue(load->object()), load->offset());
+  } else if (auto load = instr->AsLoadField()) {
+    return new (zone_)
+        LoadFieldInstr(MapValue(load->instance()), load->slot(),
+                       load->token_pos());
+  } else if (auto check = instr->AsCheckArrayBound()) {
+    return new (zone_) CheckArrayBoundInstr(
+        MapValue(check->length()), MapValue(check->index()), deopt_id);
+  } else if (auto check = instr->AsGenericCheckBound()) {
+    return new (zone_) GenericCheckBoundInstr(
+        MapValue(check->length()), MapValue(check->index()), deopt_id);
+  }
+  UNREACHABLE();
+  return nullptr;
+}
+
+void UnrollableLoop::MapPhisToInputs(intptr_t index) {
+  for (PhiIterator it(header_); !it.Done(); it.Advance()) {
+    PhiInstr* phi = it.Current();
+    map_[phi->ssa_temp_index()] = phi->InputAt(index)->definition();
+  }
+}
+
+void UnrollableLoop::MapPhisToNextIteration() {
+  const intptr_t back_index = header_->IndexOfPredecessor(body_);
+  GrowableArray<Definition*> next;
+  for (PhiIterator it(header_); !it.Done(); it.Advance()) {
+    next.Add(Map(it.Current()->InputAt(back_index)->definition()));
+  }
+  intptr_t i = 0;
+  for (PhiIterator it(header_); !it.Done(); it.Advance()) {
+    map_[it.Current()->ssa_temp_index()] = next[i++];
+  }
+}
+
+// Emits a copy of the body after cursor_.
+void UnrollableLoop::EmitIteration() {
+  for (ForwardInstructionIterator it(body_); !it.Done(); it.Advance()) {
+    Instruction* current = it.Current();
+    if (current->IsGoto()) {
+      continue;
+    }
+    Instruction* clone = Clone(current);
+    Definition* def = current->AsDefinition();
+    const bool is_value = (def != nullptr) && def->HasSSATemp();
+    flow_graph_->InsertAfter(cursor_, clone, current->env(),
+                             is_value ? FlowGraph::kValue : FlowGraph::kEffect);
+    cursor_ = clone;
+    if (clone->env() != nullptr) {
+      for (Environment::DeepIterator env_it(clone->env()); !env_it.Done();
+           env_it.Advance()) {
+        Value* value = env_it.CurrentValue();
+        Definition* mapped = Map(value->definition());
+        if (mapped != value->definition()) {
+          value->BindToEnvironment(mapped);
+        }
+      }
+    }
+    if (is_value) {
+      map_[def->ssa_temp_index()] = clone->AsDefinition();
+    }
+  }
+}
+
+Definition* UnrollableLoop::Emit(Definition* def) {
+  flow_graph_->InsertAfter(cursor_, def, nullptr, FlowGraph::kValue);
+  cursor_ = def;
+  return def;
+}
+
+Definition* UnrollableLoop::EmitIndexConstant(int64_t value) {
+  Definition* constant = flow_graph_->GetConstant(
+      Integer::ZoneHandle(zone_, Integer::NewCanonical(value)));
+  if (cid_ == kMintCid) {
+    constant = Emit(UnboxInstr::Create(kUnboxedInt64,
+                                       new (zone_) Value(constant),
+                                       DeoptId::kNone,
+                                       Instruction::kNotSpeculative));
+  }
+  return constant;
+}
+
+// Emits the bound that the unrolled loop tests, which keeps the last of its
+// iterations within the bound of the original loop.
+Definition* UnrollableLoop::EmitUnrolledLimit() {
+  const int64_t offset = limit_offset_ - stride_ * (unroll_factor_ - 1);
+  if (limit_ == nullptr) {
+    return EmitIndexConstant(offset);
+  }
+  Definition* limit = limit_;
+  if (cid_ == kMintCid) {
+    limit = Emit(UnboxInstr::Create(kUnboxedInt64, new (zone_) Value(limit),
+                                    DeoptId::kNone,
+                                    Instruction::kNotSpeculative));
+  }
+  if (offset == 0) {
+    return limit;
+  }
+  return Emit(BinaryIntegerOpInstr::Make(
+      phi_->representation(), Token::kADD, new (zone_) Value(limit),
+      new (zone_) Value(EmitIndexConstant(offset)), DeoptId::kNone,
+      /*can_overflow=*/false, /*is_truncating=*/false, nullptr,
+      Instruction::kNotSpeculative));
+}
+
+TargetEntryInstr* UnrollableLoop::NewTarget() {
+  return new (zone_) TargetEntryInstr(flow_graph_->allocate_block_id(),
+                                      header_->try_index(), DeoptId::kNone);
+}
+
+JoinEntryInstr* UnrollableLoop::NewJoin() {
+  return new (zone_) JoinEntryInstr(flow_graph_->allocate_block_id(),
+                                    header_->try_index(), DeoptId::kNone);
+}
+
+void UnrollableLoop::Transform() {
+  num_ssa_temps_ = flow_graph_->current_ssa_temp_index();
+  map_.FillWith(nullptr, 0, num_ssa_temps_);
+  if (peel_count_ > 0) {
+    Peel();
+  } else {
+    Unroll();
+  }
+  if (FLAG_trace_loop_unroller) {
+    THR_Print("%s loop B%" Pd " in %s %" Pd " times\n",
+              (peel_count_ > 0) ? "Peeled" : "Unrolled", header_->block_id(),
+              flow_graph_->function().ToFullyQualifiedCString(),
+              (peel_count_ > 0) ? peel_count_ : unroll_factor_);
+  }
+}
+
+void UnrollableLoop::Peel() {
+  const intptr_t entry_index = header_->IndexOfPredecessor(pre_header_);
+  cursor_ = pre_header_->last_instruction()->previous();
+  MapPhisToInputs(entry_index);
+  for (intptr_t i = 0; i < peel_count_; i++) {
+    if (i > 0) {
+      MapPhisToNextIteration();
+    }
+    EmitIteration();
+  }
+  MapPhisToNextIteration();
+  // The loop now starts after the peeled iterations, which leaves it with no
+  // iterations to execute.
+  for (PhiIterator it(header_); !it.Done(); it.Advance()) {
+    PhiInstr* phi = it.Current();
+    phi->InputAt(entry_index)->BindTo(Map(phi));
+  }
+}
+
+void UnrollableLoop::Unroll() {
+  GotoInstr* pre_header_goto = pre_header_->last_instruction()->AsGoto();
+  const intptr_t entry_index = header_->IndexOfPredecessor(pre_header_);
+  cursor_ = pre_header_goto->previous();
+  Definition* unrolled_limit = EmitUnrolledLimit();
+
+  // Enter the original loop from the exit of the unrolled loop.
+  JoinEntryInstr* unrolled_header = NewJoin();
+  TargetEntryInstr* unrolled_body = NewTarget();
+  TargetEntryInstr* unrolled_exit = NewTarget();
+  GrowableArray<PhiInstr*> phis;
+  for (PhiIterator it(header_); !it.Done(); it.Advance()) {
+    PhiInstr* phi = it.Current();
+    PhiInstr* unrolled_phi = new (zone_) PhiInstr(unrolled_header, 2);
+    flow_graph_->AllocateSSAIndexes(unrolled_phi);
+    unrolled_phi->mark_alive();
+    unrolled_phi->set_representation(phi->representation());
+    Definition* input = phi->InputAt(entry_index)->definition();
+    unrolled_phi->SetInputAt(0, new (zone_) Value(input));
+    input->AddInputUse(unrolled_phi->InputAt(0));
+    unrolled_header->InsertPhi(unrolled_phi);
+    phis.Add(unrolled_phi);
+  }
+  pre_header_->ReplaceAsPredecessorWith(unrolled_exit);
+  unrolled_exit->LinkTo(pre_header_goto);
+  GotoInstr* goto_unrolled =
+      new (zone_) GotoInstr(unrolled_header, DeoptId::kNone);
+  flow_graph_->AppendTo(cursor_, goto_unrolled, nullptr, FlowGraph::kEffect);
+  pre_header_->set_last_instruction(goto_unrolled);
+
+  // The unrolled header performs the stack overflow check and exit test of
+  // the first of the iterations it starts.
+  intptr_t i = 0;
+  for (PhiIterator it(header_); !it.Done(); it.Advance()) {
+    map_[it.Current()->ssa_temp_index()] = phis[i++];
+  }
+  cursor_ = unrolled_header;
+  if (stack_check_ != nullptr) {
+    CheckStackOverflowInstr* check = new (zone_) CheckStackOverflowInstr(
+        stack_check_->token_pos(), stack_check_->stack_depth(),
+        stack_check_->loop_depth(), stack_check_->deopt_id(),
+        stack_check_->kind());
+    cursor_ = flow_graph_->AppendTo(cursor_, check, stack_check_->env(),
+                                    FlowGraph::kEffect);
+    if (check->env() != nullptr) {
+      for (Environment::DeepIterator it(check->env()); !it.Done();
+           it.Advance()) {
+        Definition* mapped = Map(it.CurrentValue()->definition());
+        if (mapped != it.CurrentValue()->definition()) {
+          it.CurrentValue()->BindToEnvironment(mapped);
+        }
+      }
+    }
+  }
+  BranchInstr* branch = new (zone_) BranchInstr(
+      new (zone_) RelationalOpInstr(
+          token_pos_, (stride_ > 0) ? Token::kLT : Token::kGT,
+          new (zone_) Value(Map(phi_)), new (zone_) Value(unrolled_limit),
+          cid_, DeoptId::kNone, Instruction::kNotSpeculative),
+      DeoptId::kNone);
+  flow_graph_->AppendTo(cursor_, branch, nullptr, FlowGraph::kEffect);
+  unrolled_header->set_last_instruction(branch);
+  *branch->true_successor_address() = unrolled_body;
+  *branch->false_successor_address() = unrolled_exit;
+
+  // The unrolled body executes the iterations without testing for the exit.
+  GotoInstr* back_edge = new (zone_) GotoInstr(unrolled_header, DeoptId::kNone);
+  flow_graph_->AppendTo(unrolled_body, back_edge, nullptr, FlowGraph::kEffect);
+  unrolled_body->set_last_instruction(back_edge);
+  cursor_ = unrolled_body;
+  for (intptr_t j = 0; j < unroll_factor_; j++) {
+    if (j > 0) {
+      MapPhisToNextIteration();
+    }
+    EmitIteration();
+  }
+  MapPhisToNextIteration();
+  i = 0;
+  for (PhiIterator it(header_); !it.Done(); it.Advance()) {
+    PhiInstr* unrolled_phi = phis[i++];
+    Definition* input = Map(it.Current());
+    unrolled_phi->SetInputAt(1, new (zone_) Value(input));
+    input->AddInputUse(unrolled_phi->InputAt(1));
+  }
+
+  // The original loop executes the remaining iterations.
+  const intptr_t exit_index = header_->IndexOfPredecessor(unrolled_exit);
+  i = 0;
+  for (PhiIterator it(header_); !it.Done(); it.Advance()) {
+    it.Current()->InputAt(exit_index)->BindTo(phis[i++]);
+  }
+}
+
+static bool IsSkipped(const GrowableArray<intptr_t>* skipped_loops,
+                      BlockEntryInstr* header) {
+  if (skipped_loops == nullptr) {
+    return false;
+  }
+  for (intptr_t block_id : *skipped_loops) {
+    if (block_id == header->block_id()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static void Optimize(FlowGraph* flow_graph,
+                     bool peel,
+                     const GrowableArray<intptr_t>* skipped_loops) {
+  if (!FLAG_unroll_loops) {
+    return;
+  }
+  const LoopHierarchy& hierarchy = flow_graph->GetLoopHierarchy();
+  if (hierarchy.num_loops() == 0) {
+    return;
+  }
+  hierarchy.ComputeInduction();
+  GrowableArray<UnrollableLoop*> loops;
+  for (BlockEntryInstr* header : hierarchy.headers()) {
+    if (IsSkipped(skipped_loops, header)) {
+      continue;
+    }
+    UnrollableLoop* loop = new (flow_graph->zone())
+        UnrollableLoop(flow_graph, header->loop_info(), peel);
+    if (loop->Analyze()) {
+      loops.Add(loop);
+    }
+  }
+  if (loops.is_empty()) {
+    return;
+  }
+  for (UnrollableLoop* loop : loops) {
+    loop->Transform();
+  }
+  // The block order and the dominator tree have changed.
+  flow_graph->DiscoverBlocks();
+  GrowableArray<BitVector*> dominance_frontier;
+  flow_graph->ComputeDominators(&dominance_frontier);
+}
+
+void LoopUnroller::PeelLoops(FlowGraph* flow_graph) {
+  Optimize(flow_graph, /*peel=*/true, nullptr);
+}
+
+void LoopUnroller::UnrollLoops(
+    FlowGraph* flow_graph,
+    const GrowableArray<intptr_t>& vectorized_loops) {
+  Optimize(flow_graph, /*peel=*/false, &vectorized_loops);
+}
+
+}  // namespace dart
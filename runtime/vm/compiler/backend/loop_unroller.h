@@ -0,0 +1,49 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_COMPILER_BACKEND_LOOP_UNROLLER_H_
+#define RUNTIME_VM_COMPILER_BACKEND_LOOP_UNROLLER_H_
+
+#if defined(DART_PRECOMPILED_RUNTIME)
+#error "AOT runtime should not use compiler sources (including header files)"
+#endif  // defined(DART_PRECOMPILED_RUNTIME)
+
+#include "vm/allocation.h"
+#include "vm/growable_array.h"
+
+namespace dart {
+
+class FlowGraph;
+
+// Unrolls and peels innermost loops whose single body block is controlled by
+// a unit stride induction variable with a loop invariant bound, such as
+//
+//   for (int i = 0; i < list.length; i++) {
+//     ...
+//   }
+//
+// Loops with a small constant trip count are peeled completely into their
+// pre-header, which leaves a loop that constant propagation removes. Other
+// loops are preceded by a copy whose body executes several iterations at a
+// time without stack overflow checks or exit tests in between, guarded by a
+// single test that enough iterations remain. The original loop then runs
+// the remaining iterations.
+//
+// Peeling runs before range analysis and branch optimization, which then
+// remove the peeled loops. Unrolling runs after the vectorizer, so that it
+// only sees the loops the vectorizer decided not to rewrite.
+class LoopUnroller : public AllStatic {
+ public:
+  // Peels the loops with a small constant trip count.
+  static void PeelLoops(FlowGraph* flow_graph);
+
+  // Unrolls the loops, except those whose header block id is listed in
+  // vectorized_loops.
+  static void UnrollLoops(FlowGraph* flow_graph,
+                          const GrowableArray<intptr_t>& vectorized_loops);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_COMPILER_BACKEND_LOOP_UNROLLER_H_
@@ -0,0 +1,174 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Unit tests for loop unrolling and peeling.
+
+#include "vm/compiler/backend/loop_unroller.h"
+#include "vm/compiler/backend/il_printer.h"
+#include "vm/compiler/backend/il_test_helper.h"
+#include "vm/compiler/backend/loops.h"
+#include "vm/compiler/compiler_pass.h"
+#include "vm/flags.h"
+#include "vm/object.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+DECLARE_FLAG(bool, unroll_loops);
+
+static bool IsLoad(Instruction* instr) {
+  return instr->IsLoadIndexed();
+}
+
+static bool IsStore(Instruction* instr) {
+  return instr->IsStoreIndexed();
+}
+
+static bool IsBoundsCheck(Instruction* instr) {
+  return instr->IsCheckArrayBound() || instr->IsGenericCheckBound();
+}
+
+// Multiplication is not vectorized, so the loop is unrolled instead.
+static const char* kUnrollScript =
+    R"(
+      import 'dart:typed_data';
+
+      @pragma('vm:never-inline')
+      foo(Int32List a) {
+        final n = a.length;
+        for (int i = 0; i < n; i++) {
+          a[i] = a[i] * 3;
+        }
+      }
+
+      main() {
+        final a = new Int32List(100);
+        for (int i = 0; i < 10; i++) {
+          foo(a);
+        }
+      }
+    )";
+
+ISOLATE_UNIT_TEST_CASE(IRTest_UnrollLoop_JIT) {
+  FlowGraph* flow_graph =
+      CompileFunction(kUnrollScript, "foo", CompilerPass::kJIT);
+  // One access in each of the four unrolled iterations, and one in the loop
+  // executing the remaining iterations.
+  EXPECT_EQ(5, CountInstructions(flow_graph, IsLoad));
+  EXPECT_EQ(5, CountInstructions(flow_graph, IsStore));
+  // Range analysis removes the bounds check from the loop before it is
+  // unrolled, so the unrolled iterations have none either.
+  EXPECT_EQ(0, CountInstructions(flow_graph, IsBoundsCheck));
+}
+
+#if defined(DART_PRECOMPILER)
+ISOLATE_UNIT_TEST_CASE(IRTest_UnrollLoop_AOT) {
+  FlowGraph* flow_graph =
+      CompileFunction(kUnrollScript, "foo", CompilerPass::kAOT);
+  EXPECT_EQ(5, CountInstructions(flow_graph, IsLoad));
+  EXPECT_EQ(5, CountInstructions(flow_graph, IsStore));
+  EXPECT_EQ(0, CountInstructions(flow_graph, IsBoundsCheck));
+}
+#endif  // defined(DART_PRECOMPILER)
+
+ISOLATE_UNIT_TEST_CASE(IRTest_UnrollLoopDisabled) {
+  SetFlagScope<bool> sfs(&FLAG_unroll_loops, false);
+  FlowGraph* flow_graph =
+      CompileFunction(kUnrollScript, "foo", CompilerPass::kJIT);
+  EXPECT_EQ(1, CountInstructions(flow_graph, IsLoad));
+  EXPECT_EQ(1, CountInstructions(flow_graph, IsStore));
+}
+
+// Loops with a short constant trip count are peeled completely, after which
+// constant propagation removes the loop.
+ISOLATE_UNIT_TEST_CASE(IRTest_PeelLoop) {
+  const char* kScript =
+      R"(
+      import 'dart:typed_data';
+
+      @pragma('vm:never-inline')
+      foo(Int32List a) {
+        for (int i = 0; i < 3; i++) {
+          a[i] = i;
+        }
+      }
+
+      main() {
+        final a = new Int32List(100);
+        for (int i = 0; i < 10; i++) {
+          foo(a);
+        }
+      }
+    )";
+
+  FlowGraph* flow_graph = CompileFunction(kScript, "foo", CompilerPass::kJIT);
+  EXPECT_EQ(0, CountInstructions(flow_graph, IsLoad));
+  EXPECT_EQ(3, CountInstructions(flow_graph, IsStore));
+  EXPECT_EQ(0, flow_graph->GetLoopHierarchy().num_loops());
+}
+
+// Loops with calls in their body are left alone.
+ISOLATE_UNIT_TEST_CASE(IRTest_UnrollLoopWithCall) {
+  const char* kScript =
+      R"(
+      import 'dart:typed_data';
+
+      @pragma('vm:never-inline')
+      int bar(int x) => x + 1;
+
+      @pragma('vm:never-inline')
+      foo(Int32List a) {
+        final n = a.length;
+        for (int i = 0; i < n; i++) {
+          a[i] = bar(a[i]);
+        }
+      }
+
+      main() {
+        final a = new Int32List(100);
+        for (int i = 0; i < 10; i++) {
+          foo(a);
+        }
+      }
+    )";
+
+  FlowGraph* flow_graph = CompileFunction(kScript, "foo", CompilerPass::kJIT);
+  EXPECT_EQ(1, CountInstructions(flow_graph, IsLoad));
+  EXPECT_EQ(1, CountInstructions(flow_graph, IsStore));
+}
+
+#if defined(TARGET_ARCH_X64) || defined(TARGET_ARCH_ARM64)
+// Loops rewritten by the vectorizer are not unrolled afterwards.
+ISOLATE_UNIT_TEST_CASE(IRTest_UnrollLoopAfterVectorizer) {
+  const char* kScript =
+      R"(
+      import 'dart:typed_data';
+
+      @pragma('vm:never-inline')
+      foo(Float64List a, Float64List b, Float64List c) {
+        final n = c.length;
+        for (int i = 0; i < n; i++) {
+          c[i] = a[i] + b[i];
+        }
+      }
+
+      main() {
+        final a = new Float64List(100);
+        final b = new Float64List(100);
+        final c = new Float64List(100);
+        for (int i = 0; i < 10; i++) {
+          foo(a, b, c);
+        }
+      }
+    )";
+
+  FlowGraph* flow_graph = CompileFunction(kScript, "foo", CompilerPass::kJIT);
+  // The accesses of the vector loop and of the loop executing the remaining
+  // iterations.
+  EXPECT_EQ(4, CountInstructions(flow_graph, IsLoad));
+  EXPECT_EQ(2, CountInstructions(flow_graph, IsStore));
+}
+#endif  // defined(TARGET_ARCH_X64) || defined(TARGET_ARCH_ARM64)
+
+}  // namespace dart
@@ -0,0 +1,848 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compiler/backend/loop_vectorizer.h"
+
+#include "vm/bit_vector.h"
+#include "vm/compiler/backend/flow_graph.h"
+#include "vm/compiler/backend/flow_graph_compiler.h"
+#include "vm/compiler/backend/il.h"
+#include "vm/compiler/backend/loops.h"
+#include "vm/compiler/runtime_api.h"
+#include "vm/flags.h"
+#include "vm/log.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool,
+            vectorize_loops,
+            true,
+            "Vectorize element-wise loops over typed data.");
+DEFINE_FLAG(bool, trace_loop_vectorizer, false, "Trace loop vectorization.");
+
+#if defined(TARGET_ARCH_X64) || defined(TARGET_ARCH_ARM64)
+
+// Size of the values SimdOpInstr operates on, in bytes.
+static const intptr_t kVectorSize = 16;
+
+// Returns the number of elements of the given typed data class per vector,
+// or 0 if accesses to it are not vectorized. Float32 elements are widened to
+// double precision by the scalar code, which Float32x4 arithmetic would not
+// reproduce, and SimdOpInstr has no 8- or 16-bit lanes.
+static intptr_t LanesFor(intptr_t cid) {
+  switch (cid) {
+    case kTypedDataFloat64ArrayCid:
+      return 2;
+    case kTypedDataInt32ArrayCid:
+    case kTypedDataUint32ArrayCid:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+// Returns the SimdOp that computes the given scalar operation on each lane,
+// or kIllegalSimdOp.
+static SimdOpInstr::Kind VectorOpFor(Definition* def, intptr_t lanes) {
+  if (lanes == 2) {
+    if (auto op = def->AsBinaryDoubleOp()) {
+      switch (op->op_kind()) {
+        case Token::kADD:
+          return SimdOpInstr::kFloat64x2Add;
+        case Token::kSUB:
+          return SimdOpInstr::kFloat64x2Sub;
+        case Token::kMUL:
+          return SimdOpInstr::kFloat64x2Mul;
+        case Token::kDIV:
+          return SimdOpInstr::kFloat64x2Div;
+        default:
+          break;
+      }
+    } else if (def->IsUnaryDoubleOp()) {
+      ASSERT(def->AsUnaryDoubleOp()->op_kind() == Token::kNEGATE);
+      return SimdOpInstr::kFloat64x2Negate;
+    } else if (auto op = def->AsMathUnary()) {
+      if (op->kind() == MathUnaryInstr::kSqrt) {
+        return SimdOpInstr::kFloat64x2Sqrt;
+      }
+    }
+  } else if (auto op = def->AsBinaryIntegerOp()) {
+    // Only the low 32 bits of integer results reach memory, so operations
+    // that commute with truncation can use 32-bit lanes.
+    switch (op->op_kind()) {
+      case Token::kADD:
+        return SimdOpInstr::kInt32x4Add;
+      case Token::kSUB:
+        return SimdOpInstr::kInt32x4Sub;
+      case Token::kBIT_AND:
+        return SimdOpInstr::kInt32x4BitAnd;
+      case Token::kBIT_OR:
+        return SimdOpInstr::kInt32x4BitOr;
+      case Token::kBIT_XOR:
+        return SimdOpInstr::kInt32x4BitXor;
+      default:
+        break;
+    }
+  }
+  return SimdOpInstr::kIllegalSimdOp;
+}
+
+// A loop of the form
+//
+//   P:  ...
+//       goto H
+//   H:  i = phi(s, i')
+//       [CheckStackOverflow]
+//       if (i < n) goto B else goto X
+//   B:  ... element-wise body, accessing typed data at index i ...
+//       i' = i + 1
+//       goto H
+//
+// which is rewritten into
+//
+//   P:  ...
+//       if (guard_1) goto T_1 else goto F_1
+//   T_1:
+//       ...
+//   T_k:
+//       v = n - (lanes - 1)
+//       goto VH
+//   VH: vi = phi(s, vi')
+//       [CheckStackOverflow]
+//       if (vi < v) goto VB else goto E
+//   VB: ... body on vectors of lanes elements starting at vi ...
+//       vi' = vi + lanes
+//       goto VH
+//   F_j:
+//       goto VX
+//   E:  goto VX
+//   VX: x = phi(s, ..., s, vi)
+//       goto H
+//   H:  i = phi(x, i')
+//       ...
+//
+// The guards ensure that the vector loop only accesses elements that the
+// original loop would have accessed and checked, and that no list stored
+// into partially overlaps another list accessed by the loop.
+class VectorizableLoop : public ZoneAllocated {
+ public:
+  VectorizableLoop(FlowGraph* flow_graph, LoopInfo* loop)
+      : flow_graph_(flow_graph),
+        zone_(flow_graph->zone()),
+        loop_(loop),
+        lengths_(),
+        accesses_(),
+        splats_() {}
+
+  // Returns true if the loop has the shape and the body described above.
+  bool Analyze();
+
+  // Rewrites the loop. Analyze() must have succeeded. Adds the block ids of
+  // the original and the vector loop headers to vectorized_loops, if given.
+  void Vectorize(GrowableArray<intptr_t>* vectorized_loops);
+
+ private:
+  struct Access {
+    Instruction* instr;
+    // The typed data object.
+    Definition* object;
+    // Whether the access goes through the object's data pointer, in which
+    // case the object may be a view or external typed data.
+    bool is_untagged;
+  };
+
+  bool AnalyzeHeader(intptr_t back_index);
+  bool AnalyzeBody();
+  bool AnalyzeInstruction(Instruction* instr);
+  bool AddAccess(Instruction* instr,
+                 Value* array,
+                 Value* index,
+                 intptr_t class_id,
+                 intptr_t index_scale);
+
+  bool IsInLoop(Definition* def) const {
+    return loop_->Contains(def->GetBlock());
+  }
+  bool IsInduction(Definition* def) const {
+    Definition* orig = def->OriginalDefinitionIgnoreBoxingAndConstraints();
+    return (orig == phi_) || (orig == increment_);
+  }
+  bool IsVector(Definition* def) const {
+    return HasIndex(def) && vectors_->Contains(def->ssa_temp_index());
+  }
+  bool HasIndex(Definition* def) const {
+    return def->HasSSATemp() && (def->ssa_temp_index() < num_ssa_temps_);
+  }
+  Definition* Invariant(Definition* def) const;
+  bool HasIndexType(Definition* def) const;
+  bool NeedsAliasGuard(const Access& a, const Access& b) const;
+
+  TargetEntryInstr* NewTarget();
+  JoinEntryInstr* NewJoin();
+  ConstantInstr* NewConstant(int64_t value);
+  Definition* Emit(Definition* def);
+  void AppendGuard(ComparisonInstr* compare);
+  void AppendAliasGuard(Definition* a, Definition* b);
+  Definition* EmitDataAddress(Definition* object);
+  Definition* VectorOf(Value* value);
+  void EmitVectorBody(PhiInstr* index);
+
+  FlowGraph* const flow_graph_;
+  Zone* const zone_;
+  LoopInfo* const loop_;
+
+  JoinEntryInstr* header_ = nullptr;
+  TargetEntryInstr* body_ = nullptr;
+  BlockEntryInstr* pre_header_ = nullptr;
+  PhiInstr* phi_ = nullptr;
+  Definition* increment_ = nullptr;
+  Definition* start_ = nullptr;
+  Definition* limit_ = nullptr;
+  RelationalOpInstr* compare_ = nullptr;
+  CheckStackOverflowInstr* stack_check_ = nullptr;
+  intptr_t cid_ = kIllegalCid;
+  intptr_t lanes_ = 0;
+  intptr_t num_stores_ = 0;
+
+  // Lengths the original loop checks its index against.
+  GrowableArray<Definition*> lengths_;
+  GrowableArray<Access> accesses_;
+
+  // Indexed by the SSA temp index of the definitions in the loop body.
+  intptr_t num_ssa_temps_ = 0;
+  BitVector* vectors_ = nullptr;
+  GrowableArray<Definition*> invariants_;
+  GrowableArray<Definition*> vector_defs_;
+
+  // Invariant operands, followed by their splat.
+  GrowableArray<Definition*> splats_;
+
+  // Where the guards and the vector loop setup are emitted.
+  BlockEntryInstr* block_ = nullptr;
+  Instruction* cursor_ = nullptr;
+  JoinEntryInstr* exit_join_ = nullptr;
+  GrowableArray<TargetEntryInstr*> failed_guards_;
+  GotoInstr* setup_goto_ = nullptr;
+
+  DISALLOW_COPY_AND_ASSIGN(VectorizableLoop);
+};
+
+bool VectorizableLoop::Analyze() {
+  if ((loop_->inner() != nullptr) || (loop_->back_edges().length() != 1)) {
+    return false;
+  }
+  header_ = loop_->header()->AsJoinEntry();
+  body_ = loop_->back_edges()[0]->AsTargetEntry();
+  if ((header_ == nullptr) || (body_ == nullptr) ||
+      (header_->PredecessorCount() != 2) ||
+      (body_->PredecessorAt(0) != header_) ||
+      (header_->try_index() != kInvalidTryIndex)) {
+    return false;
+  }
+  const intptr_t back_index = header_->IndexOfPredecessor(body_);
+  pre_header_ = header_->PredecessorAt(1 - back_index);
+  if (!(pre_header_->IsTargetEntry() || pre_header_->IsJoinEntry()) ||
+      !pre_header_->last_instruction()->IsGoto() ||
+      (pre_header_->try_index() != kInvalidTryIndex)) {
+    return false;
+  }
+  if (!AnalyzeHeader(back_index) || !AnalyzeBody()) {
+    return false;
+  }
+  // Not worth it unless a constant trip count runs the vector loop twice.
+  return !(limit_->IsConstant() && limit_->AsConstant()->value().IsInteger() &&
+           (Integer::Cast(limit_->AsConstant()->value()).AsInt64Value() <
+            2 * lanes_));
+}
+
+bool VectorizableLoop::AnalyzeHeader(intptr_t back_index) {
+  for (PhiIterator it(header_); !it.Done(); it.Advance()) {
+    if (phi_ != nullptr) {
+      return false;
+    }
+    phi_ = it.Current();
+  }
+  int64_t stride = 0;
+  if ((phi_ == nullptr) ||
+      !InductionVar::IsLinear(loop_->LookupInduction(phi_), &stride) ||
+      (stride != 1)) {
+    return false;
+  }
+  start_ = phi_->InputAt(1 - back_index)->definition();
+  increment_ = phi_->InputAt(back_index)
+                   ->definition()
+                   ->OriginalDefinitionIgnoreBoxingAndConstraints();
+  if (increment_->GetBlock() != body_) {
+    return false;
+  }
+
+  Instruction* current = header_->next();
+  stack_check_ = current->AsCheckStackOverflow();
+  if (stack_check_ != nullptr) {
+    current = current->next();
+  }
+  BranchInstr* branch = current->AsBranch();
+  if ((branch == nullptr) ||
+      (branch->comparison()->AsRelationalOp() == nullptr)) {
+    return false;
+  }
+  // Express the condition as phi < limit while staying in the loop.
+  compare_ = branch->comparison()->AsRelationalOp();
+  Token::Kind kind = compare_->kind();
+  if (branch->false_successor() == body_) {
+    kind = Token::NegateComparison(kind);
+  } else if (branch->true_successor() != body_) {
+    return false;
+  }
+  Value* limit = compare_->right();
+  if (compare_->left()->definition() != phi_) {
+    if (compare_->right()->definition() != phi_) {
+      return false;
+    }
+    limit = compare_->left();
+    kind = Token::FlipComparison(kind);
+  }
+  limit_ = limit->definition();
+  cid_ = compare_->operation_cid();
+  return (kind == Token::kLT) && !IsInLoop(limit_) &&
+         ((cid_ == kSmiCid) || (cid_ == kMintCid)) && HasIndexType(phi_) &&
+         HasIndexType(start_) && HasIndexType(limit_);
+}
+
+bool VectorizableLoop::HasIndexType(Definition* def) const {
+  if (cid_ == kSmiCid) {
+    return def->Type()->ToCid() == kSmiCid;
+  }
+  return def->Type()->IsInt();
+}
+
+bool VectorizableLoop::AnalyzeBody() {
+  num_ssa_temps_ = flow_graph_->current_ssa_temp_index();
+  vectors_ = new (zone_) BitVector(zone_, num_ssa_temps_);
+  invariants_.FillWith(nullptr, 0, num_ssa_temps_);
+  for (ForwardInstructionIterator it(body_); !it.Done(); it.Advance()) {
+    Instruction* current = it.Current();
+    if (current->IsGoto()) {
+      continue;
+    }
+    if (!AnalyzeInstruction(current)) {
+      if (FLAG_trace_loop_vectorizer) {
+        THR_Print("Not vectorizing B%" Pd ": %s\n", header_->block_id(),
+                  current->ToCString());
+      }
+      return false;
+    }
+  }
+  return num_stores_ > 0;
+}
+
+Definition* VectorizableLoop::Invariant(Definition* def) const {
+  if (!IsInLoop(def)) {
+    return def;
+  }
+  return HasIndex(def) ? invariants_[def->ssa_temp_index()] : nullptr;
+}
+
+bool VectorizableLoop::AnalyzeInstruction(Instruction* instr) {
+  if (auto load = instr->AsLoadIndexed()) {
+    if (load->CanDeoptimize() ||
+        !AddAccess(load, load->array(), load->index(), load->class_id(),
+                   load->index_scale())) {
+      return false;
+    }
+    vectors_->Add(load->ssa_temp_index());
+    return true;
+  }
+  if (auto store = instr->AsStoreIndexed()) {
+    num_stores_++;
+    return AddAccess(store, store->array(), store->index(), store->class_id(),
+                     store->index_scale()) &&
+           IsVector(store->value()->definition());
+  }
+
+  Definition* def = instr->AsDefinition();
+  if ((def == nullptr) || !HasIndex(def)) {
+    return false;
+  }
+
+  // Bounds checks are replaced by the guards.
+  CheckBoundBase* check = instr->AsCheckArrayBound();
+  if (check == nullptr) {
+    check = instr->AsGenericCheckBound();
+  }
+  if (check != nullptr) {
+    Definition* length = check->length()->definition();
+    if ((check->index()
+             ->definition()
+             ->OriginalDefinitionIgnoreBoxingAndConstraints() != phi_) ||
+        IsInLoop(length) || !HasIndexType(length)) {
+      return false;
+    }
+    for (Definition* other : lengths_) {
+      if (other == length) {
+        return true;
+      }
+    }
+    lengths_.Add(length);
+    return true;
+  }
+
+  // The induction and its increment are computed by the vector loop itself.
+  if ((def == increment_) ||
+      ((def->IsBox() || def->IsUnbox() || def->IsIntConverter()) &&
+       IsInduction(def))) {
+    return true;
+  }
+
+  if (def->CanDeoptimize()) {
+    return false;
+  }
+
+  // The data pointer is reloaded in the vector loop, since the object may
+  // move at its stack overflow check.
+  if (auto data = def->AsLoadUntagged()) {
+    return !IsInLoop(data->object()->definition()) &&
+           (data->offset() ==
+            compiler::target::PointerBase::data_field_offset());
+  }
+
+  if (def->IsBox() || def->IsUnbox() || def->IsIntConverter()) {
+    Definition* input = def->InputAt(0)->definition();
+    if (IsVector(input)) {
+      vectors_->Add(def->ssa_temp_index());
+      return true;
+    }
+    invariants_[def->ssa_temp_index()] = Invariant(input);
+    return invariants_[def->ssa_temp_index()] != nullptr;
+  }
+
+  if (VectorOpFor(def, lanes_) == SimdOpInstr::kIllegalSimdOp) {
+    return false;
+  }
+  bool has_vector_input = false;
+  for (intptr_t i = 0; i < def->InputCount(); i++) {
+    Definition* input = def->InputAt(i)->definition();
+    if (IsVector(input)) {
+      has_vector_input = true;
+      continue;
+    }
+    // Invariant doubles are splat into a vector ahead of the loop.
+    Definition* invariant = Invariant(input);
+    if ((lanes_ != 2) || (invariant == nullptr) ||
+        !invariant->Type()->IsDouble()) {
+      return false;
+    }
+  }
+  if (!has_vector_input) {
+    return false;
+  }
+  vectors_->Add(def->ssa_temp_index());
+  return true;
+}
+
+bool VectorizableLoop::AddAccess(Instruction* instr,
+                                 Value* array,
+                                 Value* index,
+                                 intptr_t class_id,
+                                 intptr_t index_scale) {
+  const intptr_t lanes = LanesFor(class_id);
+  if ((lanes == 0) || ((lanes_ != 0) && (lanes != lanes_)) ||
+      (index_scale * lanes != kVectorSize)) {
+    return false;
+  }
+  lanes_ = lanes;
+  if (index->definition()->OriginalDefinitionIgnoreBoxingAndConstraints() !=
+      phi_) {
+    return false;
+  }
+  Definition* object = array->definition();
+  const bool is_untagged = object->representation() == kUntagged;
+  if (is_untagged) {
+    // Either hoisted out of the loop or accepted by AnalyzeInstruction.
+    LoadUntaggedInstr* data = object->AsLoadUntagged();
+    if (data == nullptr) {
+      return false;
+    }
+    object = data->object()->definition();
+  }
+  if (IsInLoop(object)) {
+    return false;
+  }
+  accesses_.Add({instr, object, is_untagged});
+  return true;
+}
+
+// Distinct internal typed data objects never overlap, but views and external
+// typed data may share their data with any other list.
+bool VectorizableLoop::NeedsAliasGuard(const Access& a,
+                                       const Access& b) const {
+  return (a.object != b.object) && (a.is_untagged || b.is_untagged) &&
+         (a.instr->IsStoreIndexed() || b.instr->IsStoreIndexed());
+}
+
+TargetEntryInstr* VectorizableLoop::NewTarget() {
+  return new (zone_) TargetEntryInstr(flow_graph_->allocate_block_id(),
+                                      header_->try_index(), DeoptId::kNone);
+}
+
+JoinEntryInstr* VectorizableLoop::NewJoin() {
+  return new (zone_) JoinEntryInstr(flow_graph_->allocate_block_id(),
+                                    header_->try_index(), DeoptId::kNone);
+}
+
+ConstantInstr* VectorizableLoop::NewConstant(int64_t value) {
+  return flow_graph_->GetConstant(
+      Integer::ZoneHandle(zone_, Integer::NewCanonical(value)));
+}
+
+Definition* VectorizableLoop::Emit(Definition* def) {
+  cursor_ = flow_graph_->AppendTo(cursor_, def, nullptr, FlowGraph::kValue);
+  return def;
+}
+
+void VectorizableLoop::AppendGuard(ComparisonInstr* compare) {
+  TargetEntryInstr* pass = NewTarget();
+  TargetEntryInstr* fail = NewTarget();
+  BranchInstr* branch = new (zone_) BranchInstr(compare, DeoptId::kNone);
+  flow_graph_->AppendTo(cursor_, branch, nullptr, FlowGraph::kEffect);
+  block_->set_last_instruction(branch);
+  *branch->true_successor_address() = pass;
+  *branch->false_successor_address() = fail;
+
+  GotoInstr* goto_exit = new (zone_) GotoInstr(exit_join_, DeoptId::kNone);
+  flow_graph_->AppendTo(fail, goto_exit, nullptr, FlowGraph::kEffect);
+  fail->set_last_instruction(goto_exit);
+  failed_guards_.Add(fail);
+
+  block_ = pass;
+  cursor_ = pass;
+}
+
+Definition* VectorizableLoop::EmitDataAddress(Definition* object) {
+  Definition* data = Emit(new (zone_) LoadUntaggedInstr(
+      new (zone_) Value(object),
+      compiler::target::PointerBase::data_field_offset()));
+  return Emit(new (zone_) IntConverterInstr(
+      kUntagged, kUnboxedIntPtr, new (zone_) Value(data), DeoptId::kNone));
+}
+
+// Guards that the data of a and b either start at the same address or are at
+// least a vector apart: 0 < |a - b| < kVectorSize is checked as the unsigned
+// comparison (a - b) + (kVectorSize - 1) < 2 * kVectorSize - 1, with the
+// operands biased by kMinInt64 to compare them as signed values. This also
+// rejects a == b, which is rare for distinct definitions.
+void VectorizableLoop::AppendAliasGuard(Definition* a, Definition* b) {
+  Definition* distance = Emit(BinaryIntegerOpInstr::Make(
+      kUnboxedInt64, Token::kSUB, new (zone_) Value(EmitDataAddress(a)),
+      new (zone_) Value(EmitDataAddress(b)), DeoptId::kNone,
+      Instruction::kNotSpeculative));
+  Definition* biased = Emit(BinaryIntegerOpInstr::Make(
+      kUnboxedInt64, Token::kADD, new (zone_) Value(distance),
+      new (zone_) Value(NewConstant(kMinInt64 + kVectorSize - 1)),
+      DeoptId::kNone, Instruction::kNotSpeculative));
+  AppendGuard(new (zone_) RelationalOpInstr(
+      compare_->token_pos(), Token::kGTE, new (zone_) Value(biased),
+      new (zone_) Value(NewConstant(kMinInt64 + 2 * kVectorSize - 1)),
+      kMintCid, DeoptId::kNone, Instruction::kNotSpeculative));
+}
+
+Definition* VectorizableLoop::VectorOf(Value* value) {
+  Definition* def = value->definition();
+  if (IsVector(def)) {
+    ASSERT(vector_defs_[def->ssa_temp_index()] != nullptr);
+    return vector_defs_[def->ssa_temp_index()];
+  }
+  def = Invariant(def);
+  ASSERT(def != nullptr);
+  for (intptr_t i = 0; i < splats_.length(); i += 2) {
+    if (splats_[i] == def) {
+      return splats_[i + 1];
+    }
+  }
+  Definition* splat = SimdOpInstr::Create(
+      SimdOpInstr::kFloat64x2Splat, new (zone_) Value(def), DeoptId::kNone);
+  flow_graph_->InsertBefore(setup_goto_, splat, nullptr, FlowGraph::kValue);
+  splats_.Add(def);
+  splats_.Add(splat);
+  return splat;
+}
+
+void VectorizableLoop::EmitVectorBody(PhiInstr* index) {
+  const intptr_t vector_cid = (lanes_ == 2) ? kTypedDataFloat64x2ArrayCid
+                                            : kTypedDataInt32x4ArrayCid;
+  vector_defs_.FillWith(nullptr, 0, num_ssa_temps_);
+  for (ForwardInstructionIterator it(body_); !it.Done(); it.Advance()) {
+    Instruction* current = it.Current();
+    if (auto load = current->AsLoadIndexed()) {
+      Definition* array = load->array()->definition();
+      if (HasIndex(array) &&
+          (vector_defs_[array->ssa_temp_index()] != nullptr)) {
+        array = vector_defs_[array->ssa_temp_index()];
+      }
+      Definition* vector = Emit(new (zone_) LoadIndexedInstr(
+          new (zone_) Value(array), new (zone_) Value(index),
+          load->RequiredInputRepresentation(1) != kTagged, load->index_scale(),
+          vector_cid, kUnalignedAccess, DeoptId::kNone, load->token_pos()));
+      vector_defs_[load->ssa_temp_index()] = vector;
+    } else if (auto store = current->AsStoreIndexed()) {
+      Definition* array = store->array()->definition();
+      if (HasIndex(array) &&
+          (vector_defs_[array->ssa_temp_index()] != nullptr)) {
+        array = vector_defs_[array->ssa_temp_index()];
+      }
+      cursor_ = flow_graph_->AppendTo(
+          cursor_,
+          new (zone_) StoreIndexedInstr(
+              new (zone_) Value(array), new (zone_) Value(index),
+              new (zone_) Value(VectorOf(store->value())), kNoStoreBarrier,
+              store->RequiredInputRepresentation(
+                  StoreIndexedInstr::kIndexPos) != kTagged,
+              store->index_scale(), vector_cid, kUnalignedAccess,
+              DeoptId::kNone, store->token_pos(),
+              Instruction::kNotSpeculative),
+          nullptr, FlowGraph::kEffect);
+    } else if (auto data = current->AsLoadUntagged()) {
+      vector_defs_[data->ssa_temp_index()] = Emit(new (zone_) LoadUntaggedInstr(
+          new (zone_) Value(data->object()->definition()), data->offset()));
+    } else if (current->IsDefinition() &&
+               IsVector(current->AsDefinition())) {
+      Definition* def = current->AsDefinition();
+      Definition* vector = nullptr;
+      if (def->IsBox() || def->IsUnbox() || def->IsIntConverter()) {
+        vector = VectorOf(def->InputAt(0));
+      } else if (def->InputCount() == 1) {
+        vector = Emit(SimdOpInstr::Create(VectorOpFor(def, lanes_),
+                                          new (zone_) Value(VectorOf(
+                                              def->InputAt(0))),
+                                          DeoptId::kNone));
+      } else {
+        ASSERT(def->InputCount() == 2);
+        vector = Emit(SimdOpInstr::Create(
+            VectorOpFor(def, lanes_),
+            new (zone_) Value(VectorOf(def->InputAt(0))),
+            new (zone_) Value(VectorOf(def->InputAt(1))), DeoptId::kNone));
+      }
+      vector_defs_[def->ssa_temp_index()] = vector;
+    }
+  }
+}
+
+void VectorizableLoop::Vectorize(GrowableArray<intptr_t>* vectorized_loops) {
+  const Representation representation =
+      (cid_ == kSmiCid) ? kTagged : kUnboxedInt64;
+  int64_t limit_value = 0;
+  const bool limit_is_constant =
+      limit_->IsConstant() && limit_->AsConstant()->value().IsInteger();
+  if (limit_is_constant) {
+    limit_value =
+        Integer::Cast(limit_->AsConstant()->value()).AsInt64Value();
+  }
+  const bool start_is_non_negative =
+      start_->IsConstant() && start_->AsConstant()->value().IsInteger() &&
+      (Integer::Cast(start_->AsConstant()->value()).AsInt64Value() >= 0);
+  const bool needs_start_guard =
+      !lengths_.is_empty() && !start_is_non_negative;
+
+  GrowableArray<Definition*> alias_pairs;
+  for (intptr_t i = 0; i < accesses_.length(); i++) {
+    for (intptr_t j = i + 1; j < accesses_.length(); j++) {
+      if (!NeedsAliasGuard(accesses_[i], accesses_[j])) {
+        continue;
+      }
+      Definition* a = accesses_[i].object;
+      Definition* b = accesses_[j].object;
+      bool is_new = true;
+      for (intptr_t k = 0; k < alias_pairs.length(); k += 2) {
+        if (((alias_pairs[k] == a) && (alias_pairs[k + 1] == b)) ||
+            ((alias_pairs[k] == b) && (alias_pairs[k + 1] == a))) {
+          is_new = false;
+          break;
+        }
+      }
+      if (is_new) {
+        alias_pairs.Add(a);
+        alias_pairs.Add(b);
+      }
+    }
+  }
+  const bool has_guards = needs_start_guard || !limit_is_constant ||
+                          !lengths_.is_empty() || !alias_pairs.is_empty();
+
+  // Redirect the entry of the original loop to the exit of the vector loop.
+  GotoInstr* pre_header_goto = pre_header_->last_instruction()->AsGoto();
+  block_ = pre_header_;
+  cursor_ = pre_header_goto->previous();
+  TargetEntryInstr* vector_exit = NewTarget();
+  BlockEntryInstr* exit = vector_exit;
+  if (has_guards) {
+    exit_join_ = NewJoin();
+    exit = exit_join_;
+  }
+  pre_header_->ReplaceAsPredecessorWith(exit);
+  exit->LinkTo(pre_header_goto);
+
+  // Guards.
+  if (needs_start_guard) {
+    AppendGuard(new (zone_) RelationalOpInstr(
+        compare_->token_pos(), Token::kGTE, new (zone_) Value(start_),
+        new (zone_) Value(NewConstant(0)), cid_, DeoptId::kNone,
+        Instruction::kNotSpeculative));
+  }
+  if (!limit_is_constant) {
+    // Also keeps limit - (lanes - 1) from overflowing.
+    AppendGuard(new (zone_) RelationalOpInstr(
+        compare_->token_pos(), Token::kGTE, new (zone_) Value(limit_),
+        new (zone_) Value(NewConstant(lanes_)), cid_, DeoptId::kNone,
+        Instruction::kNotSpeculative));
+  }
+  for (intptr_t i = 0; i < lengths_.length(); i++) {
+    AppendGuard(new (zone_) RelationalOpInstr(
+        compare_->token_pos(), Token::kLTE, new (zone_) Value(limit_),
+        new (zone_) Value(lengths_[i]), cid_, DeoptId::kNone,
+        Instruction::kNotSpeculative));
+  }
+  for (intptr_t i = 0; i < alias_pairs.length(); i += 2) {
+    AppendAliasGuard(alias_pairs[i], alias_pairs[i + 1]);
+  }
+
+  // The vector loop runs while all lanes are below the limit.
+  Definition* vector_limit = nullptr;
+  if (limit_is_constant) {
+    vector_limit = NewConstant(limit_value - (lanes_ - 1));
+  } else {
+    vector_limit = Emit(BinaryIntegerOpInstr::Make(
+        representation, Token::kSUB, new (zone_) Value(limit_),
+        new (zone_) Value(NewConstant(lanes_ - 1)), DeoptId::kNone,
+        /*can_overflow=*/false, /*is_truncating=*/false, nullptr,
+        Instruction::kNotSpeculative));
+  }
+  JoinEntryInstr* vector_header = NewJoin();
+  if (vectorized_loops != nullptr) {
+    vectorized_loops->Add(header_->block_id());
+    vectorized_loops->Add(vector_header->block_id());
+  }
+  setup_goto_ = new (zone_) GotoInstr(vector_header, DeoptId::kNone);
+  flow_graph_->AppendTo(cursor_, setup_goto_, nullptr, FlowGraph::kEffect);
+  block_->set_last_instruction(setup_goto_);
+
+  // Vector loop header.
+  PhiInstr* index = new (zone_) PhiInstr(vector_header, 2);
+  flow_graph_->AllocateSSAIndexes(index);
+  index->mark_alive();
+  index->set_representation(phi_->representation());
+  index->SetInputAt(0, new (zone_) Value(start_));
+  start_->AddInputUse(index->InputAt(0));
+  vector_header->InsertPhi(index);
+  block_ = vector_header;
+  cursor_ = vector_header;
+  if (stack_check_ != nullptr) {
+    CheckStackOverflowInstr* check = new (zone_) CheckStackOverflowInstr(
+        stack_check_->token_pos(), stack_check_->stack_depth(),
+        stack_check_->loop_depth(), stack_check_->deopt_id(),
+        stack_check_->kind());
+    cursor_ = flow_graph_->AppendTo(cursor_, check, stack_check_->env(),
+                                    FlowGraph::kEffect);
+    if (check->env() != nullptr) {
+      for (Environment::DeepIterator it(check->env()); !it.Done();
+           it.Advance()) {
+        if (it.CurrentValue()->definition() == phi_) {
+          it.CurrentValue()->BindToEnvironment(index);
+        }
+      }
+    }
+  }
+  TargetEntryInstr* vector_body = NewTarget();
+  BranchInstr* branch = new (zone_) BranchInstr(
+      new (zone_) RelationalOpInstr(
+          compare_->token_pos(), Token::kLT, new (zone_) Value(index),
+          new (zone_) Value(vector_limit), cid_, DeoptId::kNone,
+          Instruction::kNotSpeculative),
+      DeoptId::kNone);
+  flow_graph_->AppendTo(cursor_, branch, nullptr, FlowGraph::kEffect);
+  vector_header->set_last_instruction(branch);
+  *branch->true_successor_address() = vector_body;
+  *branch->false_successor_address() = vector_exit;
+
+  // Vector loop body.
+  block_ = vector_body;
+  cursor_ = vector_body;
+  EmitVectorBody(index);
+  Definition* next = Emit(BinaryIntegerOpInstr::Make(
+      representation, Token::kADD, new (zone_) Value(index),
+      new (zone_) Value(NewConstant(lanes_)), DeoptId::kNone,
+      /*can_overflow=*/false, /*is_truncating=*/false, nullptr,
+      Instruction::kNotSpeculative));
+  GotoInstr* back_edge = new (zone_) GotoInstr(vector_header, DeoptId::kNone);
+  flow_graph_->AppendTo(cursor_, back_edge, nullptr, FlowGraph::kEffect);
+  vector_body->set_last_instruction(back_edge);
+  index->SetInputAt(1, new (zone_) Value(next));
+  next->AddInputUse(index->InputAt(1));
+
+  // Vector loop exit, which resumes the original loop.
+  Definition* resume = index;
+  if (has_guards) {
+    GotoInstr* goto_exit = new (zone_) GotoInstr(exit_join_, DeoptId::kNone);
+    flow_graph_->AppendTo(vector_exit, goto_exit, nullptr, FlowGraph::kEffect);
+    vector_exit->set_last_instruction(goto_exit);
+    // Predecessors are ordered by block id: E, then the failed guards.
+    PhiInstr* phi =
+        new (zone_) PhiInstr(exit_join_, failed_guards_.length() + 1);
+    flow_graph_->AllocateSSAIndexes(phi);
+    phi->mark_alive();
+    phi->set_representation(phi_->representation());
+    for (intptr_t i = 0; i <= failed_guards_.length(); i++) {
+      Definition* input = (i == 0) ? index : start_;
+      phi->SetInputAt(i, new (zone_) Value(input));
+      input->AddInputUse(phi->InputAt(i));
+    }
+    exit_join_->InsertPhi(phi);
+    resume = phi;
+  }
+  phi_->InputAt(header_->IndexOfPredecessor(exit))->BindTo(resume);
+
+  if (FLAG_trace_loop_vectorizer) {
+    THR_Print("Vectorized loop B%" Pd " in %s with %" Pd " lanes\n",
+              header_->block_id(),
+              flow_graph_->function().ToFullyQualifiedCString(), lanes_);
+  }
+}
+
+void LoopVectorizer::Optimize(FlowGraph* flow_graph,
+                              GrowableArray<intptr_t>* vectorized_loops) {
+  if (!FLAG_vectorize_loops || !FlowGraphCompiler::SupportsUnboxedSimd128()) {
+    return;
+  }
+  const LoopHierarchy& hierarchy = flow_graph->GetLoopHierarchy();
+  if (hierarchy.num_loops() == 0) {
+    return;
+  }
+  hierarchy.ComputeInduction();
+  GrowableArray<VectorizableLoop*> loops;
+  for (BlockEntryInstr* header : hierarchy.headers()) {
+    VectorizableLoop* loop = new (flow_graph->zone())
+        VectorizableLoop(flow_graph, header->loop_info());
+    if (loop->Analyze()) {
+      loops.Add(loop);
+    }
+  }
+  if (loops.is_empty()) {
+    return;
+  }
+  for (VectorizableLoop* loop : loops) {
+    loop->Vectorize(vectorized_loops);
+  }
+  // The block order and the dominator tree have changed.
+  flow_graph->DiscoverBlocks();
+  GrowableArray<BitVector*> dominance_frontier;
+  flow_graph->ComputeDominators(&dominance_frontier);
+}
+
+#else
+
+void LoopVectorizer::Optimize(FlowGraph* flow_graph,
+                              GrowableArray<intptr_t>* vectorized_loops) {}
+
+#endif  // defined(TARGET_ARCH_X64) || defined(TARGET_ARCH_ARM64)
+
+}  // namespace dart
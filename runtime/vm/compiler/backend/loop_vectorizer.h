@@ -0,0 +1,44 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_COMPILER_BACKEND_LOOP_VECTORIZER_H_
+#define RUNTIME_VM_COMPILER_BACKEND_LOOP_VECTORIZER_H_
+
+#if defined(DART_PRECOMPILED_RUNTIME)
+#error "AOT runtime should not use compiler sources (including header files)"
+#endif  // defined(DART_PRECOMPILED_RUNTIME)
+
+#include "vm/allocation.h"
+#include "vm/growable_array.h"
+
+namespace dart {
+
+class FlowGraph;
+
+// Vectorizes innermost countable loops that apply element-wise arithmetic to
+// typed data, such as
+//
+//   for (int i = s; i < n; i++) {
+//     c[i] = a[i] * k + b[i];
+//   }
+//
+// Such loops are preceded by a copy that processes a whole 128-bit vector of
+// elements per iteration using SimdOpInstr, guarded by runtime checks that
+// the vector loop stays within the bounds checked by the original loop and
+// that the lists it stores into do not partially overlap the other lists it
+// accesses. The original loop then runs the remaining iterations.
+//
+// Only Float64List, Int32List and Uint32List elements are supported, and
+// only on targets with unboxed 128-bit SIMD values (x64 and arm64).
+class LoopVectorizer : public AllStatic {
+ public:
+  // Adds the block ids of the headers of the original and the vector loops
+  // to vectorized_loops, if given.
+  static void Optimize(FlowGraph* flow_graph,
+                       GrowableArray<intptr_t>* vectorized_loops = nullptr);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_COMPILER_BACKEND_LOOP_VECTORIZER_H_
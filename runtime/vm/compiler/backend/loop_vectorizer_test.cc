@@ -0,0 +1,144 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Unit tests for the vectorization of typed data loops.
+
+#include "vm/compiler/backend/loop_vectorizer.h"
+#include "vm/compiler/backend/il_printer.h"
+#include "vm/compiler/backend/il_test_helper.h"
+#include "vm/compiler/compiler_pass.h"
+#include "vm/flags.h"
+#include "vm/object.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+#if defined(TARGET_ARCH_X64) || defined(TARGET_ARCH_ARM64)
+
+DECLARE_FLAG(bool, vectorize_loops);
+
+static bool IsSimdOp(Instruction* instr) {
+  return instr->IsSimdOp();
+}
+
+// Returns true for stores of 128-bit typed data elements.
+static bool IsVectorStore(Instruction* instr) {
+  StoreIndexedInstr* store = instr->AsStoreIndexed();
+  return (store != nullptr) &&
+         ((store->class_id() == kTypedDataFloat64x2ArrayCid) ||
+          (store->class_id() == kTypedDataInt32x4ArrayCid));
+}
+
+static const char* kFloat64Script =
+    R"(
+      import 'dart:typed_data';
+
+      @pragma('vm:never-inline')
+      foo(Float64List a, Float64List b, Float64List c) {
+        final n = c.length;
+        for (int i = 0; i < n; i++) {
+          c[i] = a[i] + b[i];
+        }
+      }
+
+      main() {
+        final a = new Float64List(100);
+        final b = new Float64List(100);
+        final c = new Float64List(100);
+        for (int i = 0; i < 100; i++) {
+          a[i] = i.toDouble();
+          b[i] = 1.0;
+        }
+        for (int i = 0; i < 10; i++) {
+          foo(a, b, c);
+        }
+      }
+    )";
+
+ISOLATE_UNIT_TEST_CASE(IRTest_VectorizeFloat64Loop_JIT) {
+  FlowGraph* flow_graph =
+      CompileFunction(kFloat64Script, "foo", CompilerPass::kJIT);
+  EXPECT_EQ(1, CountInstructions(flow_graph, IsSimdOp));
+  EXPECT_EQ(1, CountInstructions(flow_graph, IsVectorStore));
+}
+
+#if defined(DART_PRECOMPILER)
+ISOLATE_UNIT_TEST_CASE(IRTest_VectorizeFloat64Loop_AOT) {
+  FlowGraph* flow_graph =
+      CompileFunction(kFloat64Script, "foo", CompilerPass::kAOT);
+  EXPECT_EQ(1, CountInstructions(flow_graph, IsSimdOp));
+  EXPECT_EQ(1, CountInstructions(flow_graph, IsVectorStore));
+}
+#endif  // defined(DART_PRECOMPILER)
+
+ISOLATE_UNIT_TEST_CASE(IRTest_VectorizeInt32Loop) {
+  const char* kScript =
+      R"(
+      import 'dart:typed_data';
+
+      @pragma('vm:never-inline')
+      foo(Int32List a, Int32List b, Int32List c) {
+        final n = c.length;
+        for (int i = 0; i < n; i++) {
+          c[i] = a[i] ^ b[i];
+        }
+      }
+
+      main() {
+        final a = new Int32List(100);
+        final b = new Int32List(100);
+        final c = new Int32List(100);
+        for (int i = 0; i < 10; i++) {
+          foo(a, b, c);
+        }
+      }
+    )";
+
+  FlowGraph* flow_graph = CompileFunction(kScript, "foo", CompilerPass::kJIT);
+  EXPECT_EQ(1, CountInstructions(flow_graph, IsSimdOp));
+  EXPECT_EQ(1, CountInstructions(flow_graph, IsVectorStore));
+}
+
+ISOLATE_UNIT_TEST_CASE(IRTest_VectorizeLoopDisabled) {
+  SetFlagScope<bool> sfs(&FLAG_vectorize_loops, false);
+  FlowGraph* flow_graph =
+      CompileFunction(kFloat64Script, "foo", CompilerPass::kJIT);
+  EXPECT_EQ(0, CountInstructions(flow_graph, IsSimdOp));
+  EXPECT_EQ(0, CountInstructions(flow_graph, IsVectorStore));
+}
+
+// Loops carrying values across iterations are not vectorized.
+ISOLATE_UNIT_TEST_CASE(IRTest_VectorizeLoopReduction) {
+  const char* kScript =
+      R"(
+      import 'dart:typed_data';
+
+      @pragma('vm:never-inline')
+      foo(Float64List a, Float64List c) {
+        final n = c.length;
+        double sum = 0.0;
+        for (int i = 0; i < n; i++) {
+          sum += a[i];
+          c[i] = sum;
+        }
+        return sum;
+      }
+
+      main() {
+        final a = new Float64List(100);
+        final c = new Float64List(100);
+        for (int i = 0; i < 10; i++) {
+          foo(a, c);
+        }
+      }
+    )";
+
+  FlowGraph* flow_graph = CompileFunction(kScript, "foo", CompilerPass::kJIT);
+  EXPECT_EQ(0, CountInstructions(flow_graph, IsSimdOp));
+  EXPECT_EQ(0, CountInstructions(flow_graph, IsVectorStore));
+}
+
+#endif  // defined(TARGET_ARCH_X64) || defined(TARGET_ARCH_ARM64)
+
+}  // namespace dart
@@ -21,6 +21,10 @@ DEFINE_FLAG(bool,
             optimize_lazy_initializer_calls,
             true,
             "Eliminate redundant lazy initializer calls.");
+DEFINE_FLAG(bool,
+            partial_escape_analysis,
+            true,
+            "Sink allocations which escape only on some paths.");
 DEFINE_FLAG(bool,
             trace_load_optimization,
             false,
@@ -3396,6 +3400,13 @@ void AllocationSinking::DiscoverFailedCandidates() {
 }
 
 void AllocationSinking::Optimize() {
+  if (FLAG_partial_escape_analysis && MaterializeAtPartialEscapes()) {
+    // Forward the loads inserted by the materializations. The allocations
+    // don't escape anymore, so their fields are not affected by calls and
+    // all of these loads are expected to be forwarded.
+    LoadOptimizer::OptimizeGraph(flow_graph_);
+  }
+
   CollectCandidates();
 
   // Insert MaterializeObject instructions that will describe the state of the
@@ -3449,6 +3460,20 @@ void AllocationSinking::Optimize() {
     EliminateAllocation(candidates_[i]);
   }
 
+  if (FLAG_trace_optimization && !candidates_.is_empty()) {
+    intptr_t partially_escaping = 0;
+    for (intptr_t i = 0; i < partially_escaping_.length(); i++) {
+      if (partially_escaping_[i]->Identity().IsAllocationSinkingCandidate()) {
+        partially_escaping++;
+      }
+    }
+    THR_Print("removed %" Pd " allocation(s) from %s, %" Pd
+              " of them escaping on some paths\n",
+              candidates_.length(),
+              flow_graph_->function().ToFullyQualifiedCString(),
+              partially_escaping);
+  }
+
   // Process materializations and unbox their arguments: materializations
   // are part of the environment and can materialize boxes for double/mint/simd
   // values when needed.
@@ -3711,6 +3736,247 @@ void AllocationSinking::InsertMaterializations(Definition* alloc) {
   }
 }
 
+// Allocations which escape only on some paths (e.g. into an exception thrown
+// on an error path) can't be sunk as they are. Instead of giving up on them
+// we materialize the object at the beginning of each path where it escapes:
+//
+//     v0 <- AllocateObject(...)             v0 <- AllocateObject(...)
+//     StoreInstanceField(v0.f, v1)          StoreInstanceField(v0.f, v1)
+//     Branch if ... goto B1, B2             Branch if ... goto B1, B2
+//   B1:                            ==>    B1:
+//     ...                                   ...
+//   B2:                                   B2:
+//     Throw(v0)                             v2 <- LoadField(v0.f)
+//                                           v3 <- AllocateObject(...)
+//                                           StoreInstanceField(v3.f, v2)
+//                                           Throw(v3)
+//
+// Load forwarding then replaces the loads with the stored values and v0 can
+// be sunk into deoptimization exits as usual.
+//
+// Object identity is preserved as long as no path from an escape reaches a
+// use of the original object which is not dominated by the escape: such a use
+// would need to see the materialized copy on some paths and the original
+// object on others.
+bool AllocationSinking::CollectPartialEscapes(
+    AllocateObjectInstr* alloc,
+    GrowableArray<BlockEntryInstr*>* escapes) {
+  BlockEntryInstr* alloc_block = alloc->GetBlock();
+  BitVector* use_blocks =
+      new (Z) BitVector(Z, flow_graph_->preorder().length());
+
+  for (Value::Iterator it(alloc->input_use_list()); !it.Done(); it.Advance()) {
+    Value* use = it.Current();
+    Instruction* instr = use->instruction();
+    if (instr->IsPhi()) {
+      return false;
+    }
+    BlockEntryInstr* block = instr->GetBlock();
+    use_blocks->Add(block->preorder_number());
+    // Loads from the allocation are forwarded once it stops escaping, and
+    // its materializations capture the stores into it. Storing the allocation
+    // into another object is an escape: the other object would keep
+    // referring to the original even where a copy is materialized.
+    StoreInstanceFieldInstr* store = instr->AsStoreInstanceField();
+    if (instr->IsLoadField() ||
+        ((store != nullptr) && (use == store->instance()))) {
+      continue;
+    }
+    if (block == alloc_block) {
+      // The allocation escapes on all paths.
+      return false;
+    }
+    AddInstruction(escapes, block);
+  }
+  for (Value::Iterator it(alloc->env_use_list()); !it.Done(); it.Advance()) {
+    Instruction* instr = it.Current()->instruction();
+    if (instr->IsBlockEntry()) {
+      return false;
+    }
+    use_blocks->Add(instr->GetBlock()->preorder_number());
+  }
+
+  if (escapes->is_empty()) {
+    return false;
+  }
+
+  // Only materialize the object at escapes which are not dominated by other
+  // escapes: uses after the dominated ones see the dominating copy.
+  intptr_t j = 0;
+  for (intptr_t i = 0; i < escapes->length(); i++) {
+    BlockEntryInstr* escape = (*escapes)[i];
+    bool is_dominated = false;
+    for (intptr_t k = 0; k < escapes->length(); k++) {
+      if ((k != i) && (*escapes)[k]->Dominates(escape)) {
+        is_dominated = true;
+        break;
+      }
+    }
+    if (!is_dominated) {
+      (*escapes)[j++] = escape;
+    }
+  }
+  escapes->TruncateTo(j);
+
+  // Check that paths starting at an escape reach neither the escape itself
+  // (it would allocate a new copy of the same object) nor uses of the
+  // allocation which the escape does not dominate. Paths which reach the
+  // allocation again see a new object and are not followed further.
+  BitVector* visited = new (Z) BitVector(Z, flow_graph_->preorder().length());
+  GrowableArray<BlockEntryInstr*> worklist;
+  for (auto escape : *escapes) {
+    visited->Clear();
+    worklist.Clear();
+    worklist.Add(escape);
+    while (!worklist.is_empty()) {
+      BlockEntryInstr* block = worklist.RemoveLast();
+      Instruction* last = block->last_instruction();
+      for (intptr_t i = 0; i < last->SuccessorCount(); i++) {
+        BlockEntryInstr* succ = last->SuccessorAt(i);
+        if (succ == alloc_block) {
+          continue;
+        }
+        if (succ == escape) {
+          return false;
+        }
+        if (!escape->Dominates(succ) &&
+            use_blocks->Contains(succ->preorder_number())) {
+          return false;
+        }
+        if (!visited->Contains(succ->preorder_number())) {
+          visited->Add(succ->preorder_number());
+          worklist.Add(succ);
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+// Allocate a copy of the given object in front of its first use in the given
+// escaping block and replace all uses dominated by this block with the copy.
+void AllocationSinking::MaterializeAtEscape(
+    AllocateObjectInstr* alloc,
+    BlockEntryInstr* escape,
+    const ZoneGrowableArray<const Slot*>& slots) {
+  GrowableArray<Value*> input_uses;
+  GrowableArray<Instruction*> env_uses;
+  for (Value::Iterator it(alloc->input_use_list()); !it.Done(); it.Advance()) {
+    if (escape->Dominates(it.Current()->instruction()->GetBlock())) {
+      input_uses.Add(it.Current());
+    }
+  }
+  for (Value::Iterator it(alloc->env_use_list()); !it.Done(); it.Advance()) {
+    Instruction* instr = it.Current()->instruction();
+    if (escape->Dominates(instr->GetBlock())) {
+      AddInstruction(&env_uses, instr);
+    }
+  }
+
+  // Find the first instruction in the escaping block which uses the object.
+  Instruction* point = nullptr;
+  for (ForwardInstructionIterator it(escape); !it.Done(); it.Advance()) {
+    Instruction* current = it.Current();
+    for (intptr_t i = 0; i < current->InputCount(); i++) {
+      if (current->InputAt(i)->definition() == alloc) {
+        point = current;
+        break;
+      }
+    }
+    if (point == nullptr) {
+      for (auto instr : env_uses) {
+        if (instr == current) {
+          point = current;
+          break;
+        }
+      }
+    }
+    if (point != nullptr) {
+      break;
+    }
+  }
+  ASSERT(point != nullptr);
+
+  Value* type_arguments = nullptr;
+  if (alloc->type_arguments() != nullptr) {
+    type_arguments = new (Z) Value(alloc->type_arguments()->definition());
+  }
+  AllocateObjectInstr* copy =
+      new (Z) AllocateObjectInstr(alloc->token_pos(), alloc->cls(),
+                                  type_arguments);
+  copy->set_closure_function(alloc->closure_function());
+
+  // Load the current state of the object before allocating the copy so
+  // that the loads are not affected by the copy.
+  GrowableArray<Definition*> loads(slots.length());
+  for (auto slot : slots) {
+    Definition* load =
+        new (Z) LoadFieldInstr(new (Z) Value(alloc), *slot, alloc->token_pos());
+    flow_graph_->InsertBefore(point, load, nullptr, FlowGraph::kValue);
+    loads.Add(load);
+  }
+  flow_graph_->InsertBefore(point, copy, nullptr, FlowGraph::kValue);
+  for (intptr_t i = 0; i < slots.length(); i++) {
+    StoreInstanceFieldInstr* store = new (Z) StoreInstanceFieldInstr(
+        *slots[i], new (Z) Value(copy), new (Z) Value(loads[i]),
+        kEmitStoreBarrier, alloc->token_pos(),
+        StoreInstanceFieldInstr::Kind::kInitializing);
+    flow_graph_->InsertBefore(point, store, nullptr, FlowGraph::kEffect);
+  }
+
+  for (auto use : input_uses) {
+    use->BindTo(copy);
+  }
+  for (auto instr : env_uses) {
+    instr->ReplaceInEnvironment(alloc, copy);
+  }
+}
+
+bool AllocationSinking::MaterializeAtPartialEscapes() {
+  GrowableArray<AllocateObjectInstr*> allocs;
+  for (BlockIterator block_it = flow_graph_->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    BlockEntryInstr* block = block_it.Current();
+    for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+      if (auto alloc = it.Current()->AsAllocateObject()) {
+        allocs.Add(alloc);
+      }
+    }
+  }
+
+  GrowableArray<BlockEntryInstr*> escapes;
+  for (auto alloc : allocs) {
+    escapes.Clear();
+    if (!CollectPartialEscapes(alloc, &escapes)) {
+      continue;
+    }
+
+    if (FLAG_trace_optimization) {
+      THR_Print("materializing allocation v%" Pd " at %" Pd " escape(s)\n",
+                alloc->ssa_temp_index(), escapes.length());
+    }
+
+    // Collect all fields written into the object. The copy is allocated with
+    // the same type arguments, so they don't need to be stored.
+    auto slots = new (Z) ZoneGrowableArray<const Slot*>(5);
+    for (Value::Iterator it(alloc->input_use_list()); !it.Done();
+         it.Advance()) {
+      if (StoreDestination(it.Current()) == alloc) {
+        AddSlot(slots,
+                it.Current()->instruction()->AsStoreInstanceField()->slot());
+      }
+    }
+
+    for (auto escape : escapes) {
+      MaterializeAtEscape(alloc, escape, *slots);
+    }
+    partially_escaping_.Add(alloc);
+  }
+
+  return !partially_escaping_.is_empty();
+}
+
 // TryCatchAnalyzer tries to reduce the state that needs to be synchronized
 // on entry to the catch by discovering Parameter-s which are never used
 // or which are always constant.
@@ -19,7 +19,10 @@ class CSEInstructionMap;
 class AllocationSinking : public ZoneAllocated {
  public:
   explicit AllocationSinking(FlowGraph* flow_graph)
-      : flow_graph_(flow_graph), candidates_(5), materializations_(5) {}
+      : flow_graph_(flow_graph),
+        candidates_(5),
+        materializations_(5),
+        partially_escaping_(5) {}
 
   const GrowableArray<Definition*>& candidates() const { return candidates_; }
 
@@ -56,6 +59,23 @@ class AllocationSinking : public ZoneAllocated {
     GrowableArray<Definition*> worklist_;
   };
 
+  // Allocations that escape only on some paths are materialized at the
+  // beginning of these paths: a copy of the object is allocated there and
+  // replaces all uses of the allocation that are dominated by the escape.
+  // Remaining uses of the allocation do not escape and it can be sunk.
+  // Returns true if any allocation was materialized.
+  bool MaterializeAtPartialEscapes();
+
+  // Collect blocks where the given allocation escapes. Returns false if the
+  // allocation does not escape or if it can't be materialized at the
+  // beginning of these blocks without changing object identity.
+  bool CollectPartialEscapes(AllocateObjectInstr* alloc,
+                             GrowableArray<BlockEntryInstr*>* escapes);
+
+  void MaterializeAtEscape(AllocateObjectInstr* alloc,
+                           BlockEntryInstr* escape,
+                           const ZoneGrowableArray<const Slot*>& slots);
+
   void CollectCandidates();
 
   void NormalizeMaterializations();
@@ -79,6 +99,7 @@ class AllocationSinking : public ZoneAllocated {
 
   GrowableArray<Definition*> candidates_;
   GrowableArray<MaterializeObjectInstr*> materializations_;
+  GrowableArray<Definition*> partially_escaping_;
 
   ExitsCollector exits_collector_;
 };
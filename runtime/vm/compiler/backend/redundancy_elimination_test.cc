@@ -1348,6 +1348,101 @@ ISOLATE_UNIT_TEST_CASE(DelayAllocations_DontDelayIntoLoop) {
   EXPECT(call->Receiver()->definition() == allocate);
 }
 
+// Returns the only AllocateObject instruction in the graph.
+static AllocateObjectInstr* FindSingleAllocateObject(FlowGraph* flow_graph) {
+  AllocateObjectInstr* result = nullptr;
+  for (auto block : flow_graph->reverse_postorder()) {
+    for (ForwardInstructionIterator it(block); !it.Done(); it.Advance()) {
+      if (auto alloc = it.Current()->AsAllocateObject()) {
+        EXPECT(result == nullptr);
+        result = alloc;
+      }
+    }
+  }
+  return result;
+}
+
+ISOLATE_UNIT_TEST_CASE(AllocationSinking_PartialEscape) {
+  const char* kScript = R"(
+    class Point {
+      final int x, y;
+      Point(this.x, this.y);
+    }
+
+    @pragma('vm:never-inline')
+    void use(Object o) {
+      print(o.hashCode);
+    }
+
+    int test(int x) {
+      final p = new Point(x, x + 1);
+      if (x < 0) {
+        use(p);
+        return 0;
+      }
+      return p.x + p.y;
+    }
+  )";
+
+  const auto& root_library = Library::Handle(LoadTestScript(kScript));
+  const auto& function = Function::Handle(GetFunction(root_library, "test"));
+
+  TestPipeline pipeline(function, CompilerPass::kAOT);
+  FlowGraph* flow_graph = pipeline.RunPasses({});
+  auto entry = flow_graph->graph_entry()->normal_entry();
+
+  // The object is only allocated on the path where it escapes.
+  AllocateObjectInstr* allocate = FindSingleAllocateObject(flow_graph);
+  RELEASE_ASSERT(allocate != nullptr);
+  EXPECT(allocate->GetBlock() != entry);
+
+  StaticCallInstr* call;
+  ILMatcher cursor(flow_graph, allocate, true, ParallelMovesHandling::kSkip);
+  RELEASE_ASSERT(cursor.TryMatch({
+      kMatchAndMoveAllocateObject,
+      kMoveGlob,
+      {kMatchAndMoveStaticCall, &call},
+  }));
+
+  EXPECT(strcmp(call->function().UserVisibleNameCString(), "use") == 0);
+  EXPECT(call->ArgumentAt(0) == allocate);
+}
+
+ISOLATE_UNIT_TEST_CASE(AllocationSinking_PartialEscapeBeforeMerge) {
+  const char* kScript = R"(
+    class Point {
+      final int x, y;
+      Point(this.x, this.y);
+    }
+
+    @pragma('vm:never-inline')
+    void use(Object o) {
+      print(o.hashCode);
+    }
+
+    int test(int x) {
+      final p = new Point(x, x + 1);
+      if (x < 0) {
+        use(p);
+      }
+      return p.x + p.y;
+    }
+  )";
+
+  const auto& root_library = Library::Handle(LoadTestScript(kScript));
+  const auto& function = Function::Handle(GetFunction(root_library, "test"));
+
+  TestPipeline pipeline(function, CompilerPass::kAOT);
+  FlowGraph* flow_graph = pipeline.RunPasses({});
+  auto entry = flow_graph->graph_entry()->normal_entry();
+
+  // The object is used after the paths merge, so it can't be materialized
+  // on the escaping path only.
+  AllocateObjectInstr* allocate = FindSingleAllocateObject(flow_graph);
+  RELEASE_ASSERT(allocate != nullptr);
+  EXPECT(allocate->GetBlock() == entry);
+}
+
 #endif  // !defined(TARGET_ARCH_IA32)
 
 }  // namespace dart
@@ -0,0 +1,105 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/compilation_trace.h"
+#include "vm/compiler/backend/il_printer.h"
+#include "vm/compiler/backend/il_test_helper.h"
+#include "vm/compiler/compiler_pass.h"
+#include "vm/datastream.h"
+#include "vm/object.h"
+#include "vm/program_visitor.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+#if defined(DART_PRECOMPILER)
+
+// Saves the type feedback collected by the JIT so far and loads it the way
+// gen_snapshot does for AOT compilation.
+static void LoadTypeFeedbackForAOT(Thread* thread) {
+  Zone* zone = thread->zone();
+  ZoneWriteStream stream(zone, KB);
+  TypeFeedbackSaver saver(&stream);
+  saver.WriteHeader();
+  saver.SaveClasses();
+  saver.SaveFields();
+  ProgramVisitor::WalkProgram(zone, thread->isolate(), &saver);
+
+  SetFlagScope<bool> sfs(&FLAG_precompiled_mode, true);
+  ReadStream read_stream(stream.buffer(), stream.bytes_written());
+  TypeFeedbackLoader loader(thread);
+  const Object& error = Object::Handle(zone, loader.LoadFeedback(&read_stream));
+  EXPECT(!error.IsError());
+}
+
+// A call that neither CHA nor type propagation can devirtualize becomes a
+// polymorphic call to the receiver classes the JIT saw, most frequent first.
+ISOLATE_UNIT_TEST_CASE(IRTest_AotTypeFeedback_PolymorphicCall) {
+  const char* kScript =
+      R"(
+      class A { int value() => 1; }
+      class B { int value() => 2; }
+      class C { int value() => 3; }
+
+      @pragma('vm:never-inline')
+      int foo(dynamic x) => x.value();
+
+      main() {
+        final a = new A();
+        final b = new B();
+        final c = new C();
+        int result = 0;
+        for (int i = 0; i < 100; i++) {
+          result += foo(b);
+        }
+        for (int i = 0; i < 200; i++) {
+          result += foo(a);
+        }
+        for (int i = 0; i < 300; i++) {
+          result += foo(c);
+        }
+        return result;
+      }
+      )";
+
+  const auto& root_library = Library::Handle(LoadTestScript(kScript));
+  Invoke(root_library, "main");
+  LoadTypeFeedbackForAOT(thread);
+
+  const auto& function = Function::Handle(GetFunction(root_library, "foo"));
+  TestPipeline pipeline(function, CompilerPass::kAOT);
+  FlowGraph* flow_graph = pipeline.RunPasses({
+      CompilerPass::kComputeSSA,
+      CompilerPass::kApplyICData,
+  });
+
+  PolymorphicInstanceCallInstr* call = nullptr;
+  for (BlockIterator block_it = flow_graph->reverse_postorder_iterator();
+       !block_it.Done(); block_it.Advance()) {
+    for (ForwardInstructionIterator it(block_it.Current()); !it.Done();
+         it.Advance()) {
+      EXPECT(!it.Current()->IsInstanceCall());
+      if (it.Current()->IsPolymorphicInstanceCall()) {
+        call = it.Current()->AsPolymorphicInstanceCall();
+      }
+    }
+  }
+  RELEASE_ASSERT(call != nullptr);
+
+  const CallTargets& targets = call->targets();
+  RELEASE_ASSERT(targets.length() == 3);
+  const char* kExpectedClasses[] = {"C", "A", "B"};
+  const intptr_t kExpectedCounts[] = {300, 200, 100};
+  for (intptr_t i = 0; i < targets.length(); i++) {
+    const auto& cls =
+        Class::Handle(GetClass(root_library, kExpectedClasses[i]));
+    EXPECT(targets.TargetAt(i)->IsSingleCid());
+    EXPECT_EQ(cls.id(), targets.TargetAt(i)->cid_start);
+    EXPECT_EQ(kExpectedCounts[i], targets.TargetAt(i)->count);
+  }
+}
+
+#endif  // defined(DART_PRECOMPILER)
+
+}  // namespace dart
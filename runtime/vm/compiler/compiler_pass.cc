@@ -13,6 +13,8 @@
 #include "vm/compiler/backend/il_serializer.h"
 #include "vm/compiler/backend/inliner.h"
 #include "vm/compiler/backend/linearscan.h"
+#include "vm/compiler/backend/loop_unroller.h"
+#include "vm/compiler/backend/loop_vectorizer.h"
 #include "vm/compiler/backend/range_analysis.h"
 #include "vm/compiler/backend/redundancy_elimination.h"
 #include "vm/compiler/backend/type_propagator.h"
@@ -328,6 +330,9 @@ FlowGraph* CompilerPass::RunPipeline(PipelineMode mode,
   INVOKE_PASS(LICM);
   INVOKE_PASS(TryOptimizePatterns);
   INVOKE_PASS(DSE);
+  // Peel short loops before range analysis and branch optimization, which
+  // remove what is left of the loops.
+  INVOKE_PASS(PeelLoops);
   INVOKE_PASS(TypePropagation);
   INVOKE_PASS(RangeAnalysis);
   INVOKE_PASS(OptimizeBranches);
@@ -346,6 +351,14 @@ FlowGraph* CompilerPass::RunPipeline(PipelineMode mode,
   INVOKE_PASS(AllocationSinking_Sink);
   INVOKE_PASS(EliminateDeadPhis);
   INVOKE_PASS(DCE);
+  // Vectorize loops before the final representation selection, which
+  // unboxes the phis and inserts conversions the vector loops need.
+  INVOKE_PASS(VectorizeLoops);
+  // Unroll the loops the vectorizer did not rewrite. The copies of the body
+  // keep only the bounds checks range analysis left in the original loop.
+  // Range analysis does not run again, so checks it could not remove there
+  // are repeated in every copy.
+  INVOKE_PASS(UnrollLoops);
   INVOKE_PASS(TypePropagation);
   INVOKE_PASS(SelectRepresentations);
   INVOKE_PASS(Canonicalize);
@@ -441,6 +454,16 @@ COMPILER_PASS(SelectRepresentations, {
   flow_graph->SelectRepresentations();
 });
 
+COMPILER_PASS(PeelLoops, { LoopUnroller::PeelLoops(flow_graph); });
+
+COMPILER_PASS(UnrollLoops, {
+  LoopUnroller::UnrollLoops(flow_graph, state->vectorized_loops);
+});
+
+COMPILER_PASS(VectorizeLoops, {
+  LoopVectorizer::Optimize(flow_graph, &state->vectorized_loops);
+});
+
 COMPILER_PASS(UseTableDispatch, {
   if (FLAG_use_bare_instructions && FLAG_use_table_dispatch) {
     state->call_specializer->ReplaceInstanceCallsWithDispatchTableCalls();
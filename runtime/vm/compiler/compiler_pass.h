@@ -42,6 +42,7 @@ namespace dart {
   V(OptimisticallySpecializeSmiPhis)                                           \
   V(OptimizeBranches)                                                          \
   V(OptimizeTypedDataAccesses)                                                 \
+  V(PeelLoops)                                                                 \
   V(RangeAnalysis)                                                             \
   V(ReorderBlocks)                                                             \
   V(RoundTripSerialization)                                                    \
@@ -51,7 +52,9 @@ namespace dart {
   V(TryCatchOptimization)                                                      \
   V(TryOptimizePatterns)                                                       \
   V(TypePropagation)                                                           \
+  V(UnrollLoops)                                                               \
   V(UseTableDispatch)                                                          \
+  V(VectorizeLoops)                                                            \
   V(WidenSmiToInt32)                                                           \
   V(EliminateWriteBarriers)
 
@@ -105,6 +108,10 @@ struct CompilerPassState {
 
   intptr_t sticky_flags;
 
+  // Block ids of the headers of the loops rewritten by the vectorizer, which
+  // the unroller leaves alone.
+  GrowableArray<intptr_t> vectorized_loops;
+
  private:
   FlowGraph* flow_graph_;
 };
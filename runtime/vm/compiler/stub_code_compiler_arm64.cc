@@ -34,6 +34,9 @@ DEFINE_FLAG(bool,
             false,
             "Set to true for debugging & verifying the slow paths.");
 DECLARE_FLAG(bool, precompiled_mode);
+#if !defined(PRODUCT)
+DECLARE_FLAG(bool, pretenure);
+#endif
 
 namespace compiler {
 
@@ -1866,6 +1869,16 @@ static void GenerateAllocateObjectHelper(Assembler* assembler,
 
     const Register kNewTopReg = R3;
 
+#if !defined(PRODUCT)
+    if (FLAG_pretenure) {
+      // Traced and pretenured classes are allocated in the runtime.
+      const Register kCidReg = R4;
+      const Register kTempReg = R5;
+      __ ExtractClassIdFromTags(kCidReg, kTagsReg);
+      __ MaybeTraceAllocation(kCidReg, kTempReg, &slow_case);
+    }  // kCidReg = R4, kTempReg = R5
+#endif  // !defined(PRODUCT)
+
     // Bump allocation.
     {
       const Register kInstanceSizeReg = R4;
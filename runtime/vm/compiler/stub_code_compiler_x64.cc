@@ -35,6 +35,9 @@ DEFINE_FLAG(bool,
             false,
             "Set to true for debugging & verifying the slow paths.");
 DECLARE_FLAG(bool, precompiled_mode);
+#if !defined(PRODUCT)
+DECLARE_FLAG(bool, pretenure);
+#endif
 
 namespace compiler {
 
@@ -1782,6 +1785,15 @@ static void GenerateAllocateObjectHelper(Assembler* assembler,
     Label slow_case;
     const Register kNewTopReg = R9;
 
+#if !defined(PRODUCT)
+    if (FLAG_pretenure) {
+      // Traced and pretenured classes are allocated in the runtime.
+      const Register kCidReg = RSI;
+      __ ExtractClassIdFromTags(kCidReg, kTagsReg);
+      __ MaybeTraceAllocation(kCidReg, &slow_case, Assembler::kFarJump);
+    }  // kCidReg = RSI
+#endif  // !defined(PRODUCT)
+
     // Allocate the object and update top to point to
     // next object start and initialize the allocated object.
     {
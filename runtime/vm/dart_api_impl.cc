@@ -705,7 +705,7 @@ FinalizablePersistentHandle* FinalizablePersistentHandle::Cast(
   return reinterpret_cast<FinalizablePersistentHandle*>(handle);
 }
 
-void FinalizablePersistentHandle::Finalize(
+void FinalizablePersistentHandle::QueueFinalizer(
     IsolateGroup* isolate_group,
     FinalizablePersistentHandle* handle) {
   if (!handle->raw()->IsHeapObject()) {
@@ -714,19 +714,16 @@ void FinalizablePersistentHandle::Finalize(
   Dart_HandleFinalizer callback = handle->callback();
   ASSERT(callback != NULL);
   void* peer = handle->peer();
+  const bool auto_delete = handle->auto_delete();
   ApiState* state = isolate_group->api_state();
   ASSERT(state != NULL);
 
-  if (!handle->auto_delete()) {
-    // Clear handle before running finalizer, finalizer can free the handle.
-    state->ClearWeakPersistentHandle(handle);
-  }
-
-  (*callback)(isolate_group->embedder_data(), peer);
-
-  if (handle->auto_delete()) {
-    state->FreeWeakPersistentHandle(handle);
-  }
+  // Clear the handle now, since its referent is about to be freed. The
+  // finalizer can free a handle that is not auto-deleted, and auto-deleted
+  // handles are freed after their finalizer has run.
+  state->ClearWeakPersistentHandle(handle);
+  state->pending_finalizers()->Add(callback, peer,
+                                   auto_delete ? handle : nullptr);
 }
 
 // --- Handles ---
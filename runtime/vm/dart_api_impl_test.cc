@@ -23,6 +23,7 @@
 
 namespace dart {
 
+DECLARE_FLAG(int, finalizer_budget);
 DECLARE_FLAG(bool, verify_acquired_data);
 
 #ifndef PRODUCT
@@ -3524,6 +3525,39 @@ TEST_CASE(DartAPI_FinalizableHandleCallback) {
   }
 }
 
+static void FinalizableHandleCountingFinalizer(void* isolate_callback_data,
+                                              void* peer) {
+  (*static_cast<intptr_t*>(peer))++;
+}
+
+TEST_CASE(DartAPI_FinalizableHandleCallbackOutsideBudget) {
+  SetFlagScope<int> sfs(&FLAG_finalizer_budget, 0);
+  const intptr_t kNumHandles = 100;
+  intptr_t finalized = 0;
+  {
+    Dart_EnterScope();
+    for (intptr_t i = 0; i < kNumHandles; i++) {
+      Dart_Handle obj = NewString("new string");
+      EXPECT_VALID(obj);
+      Dart_NewFinalizableHandle(obj, &finalized, 0,
+                                FinalizableHandleCountingFinalizer);
+    }
+    EXPECT(finalized == 0);
+    Dart_ExitScope();
+  }
+  {
+    TransitionNativeToVM transition(thread);
+    GCTestHelper::CollectNewSpace();
+    // The GC ran at least one finalizer and left the rest to a task.
+    EXPECT(finalized > 0);
+    PendingFinalizers* pending =
+        thread->isolate_group()->api_state()->pending_finalizers();
+    pending->WaitForTasks();
+    EXPECT_EQ(0, pending->length());
+    EXPECT_EQ(kNumHandles, finalized);
+  }
+}
+
 TEST_CASE(DartAPI_WeakPersistentHandleNoCallback) {
   Dart_WeakPersistentHandle weak_ref = NULL;
   int peer = 0;
@@ -6,6 +6,7 @@
 
 #include "platform/assert.h"
 #include "platform/utils.h"
+#include "vm/dart.h"
 #include "vm/heap/heap.h"
 #include "vm/isolate.h"
 #include "vm/lockers.h"
@@ -16,4 +17,117 @@ namespace dart {
 
 RelaxedAtomic<intptr_t> ApiNativeScope::current_memory_usage_ = 0;
 
+void PendingFinalizers::Add(Dart_HandleFinalizer callback,
+                            void* peer,
+                            FinalizablePersistentHandle* handle_to_free) {
+  MonitorLocker ml(&monitor_);
+  entries_.Add({callback, peer, handle_to_free});
+}
+
+intptr_t PendingFinalizers::length() {
+  MonitorLocker ml(&monitor_);
+  return entries_.length() - next_;
+}
+
+bool PendingFinalizers::TakeNext(Entry* entry, bool from_task) {
+  MonitorLocker ml(&monitor_);
+  if (next_ == entries_.length()) {
+    entries_.Clear();
+    next_ = 0;
+    if (from_task) {
+      // Let the next GC that queues finalizers start another task.
+      task_scheduled_ = false;
+    }
+    return false;
+  }
+  *entry = entries_[next_++];
+  return true;
+}
+
+void PendingFinalizers::Invoke(IsolateGroup* isolate_group,
+                               const Entry& entry) {
+  (*entry.callback)(isolate_group->embedder_data(), entry.peer);
+  if (entry.handle_to_free != nullptr) {
+    isolate_group->api_state()->FreeWeakPersistentHandle(entry.handle_to_free);
+  }
+  finalized_.fetch_add(1);
+}
+
+bool PendingFinalizers::Run(IsolateGroup* isolate_group,
+                            int64_t deadline_micros) {
+  Entry entry;
+  while (TakeNext(&entry, /*from_task=*/false)) {
+    Invoke(isolate_group, entry);
+    if ((deadline_micros >= 0) &&
+        (OS::GetCurrentMonotonicMicros() >= deadline_micros)) {
+      return length() > 0;
+    }
+  }
+  return false;
+}
+
+class FinalizerTask : public ThreadPool::Task {
+ public:
+  FinalizerTask(IsolateGroup* isolate_group, PendingFinalizers* finalizers)
+      : isolate_group_(isolate_group), finalizers_(finalizers) {}
+
+  void Run() {
+    // The task takes part in safepoints, so that a GC does not process the
+    // weak handles while a finalizer frees one.
+    bool result = Thread::EnterIsolateGroupAsHelper(
+        isolate_group_, Thread::kUnknownTask, /*bypass_safepoint=*/false);
+    ASSERT(result);
+    finalizers_->RunTask(isolate_group_);
+    Thread::ExitIsolateGroupAsHelper(/*bypass_safepoint=*/false);
+
+    // This task is done. Notify the original thread.
+    MonitorLocker ml(&finalizers_->monitor_);
+    finalizers_->tasks_--;
+    ml.NotifyAll();
+  }
+
+ private:
+  IsolateGroup* isolate_group_;
+  PendingFinalizers* finalizers_;
+
+  DISALLOW_COPY_AND_ASSIGN(FinalizerTask);
+};
+
+void PendingFinalizers::RunTask(IsolateGroup* isolate_group) {
+  TIMELINE_FUNCTION_GC_DURATION(Thread::Current(), "RunPendingFinalizers");
+  Thread* thread = Thread::Current();
+  Entry entry;
+  while (TakeNext(&entry, /*from_task=*/true)) {
+    Invoke(isolate_group, entry);
+    thread->CheckForSafepoint();
+  }
+}
+
+void PendingFinalizers::ScheduleTask(IsolateGroup* isolate_group) {
+  {
+    MonitorLocker ml(&monitor_);
+    if (task_scheduled_ || (next_ == entries_.length())) {
+      return;
+    }
+    task_scheduled_ = true;
+    tasks_++;
+  }
+  bool result = Dart::thread_pool()->Run<FinalizerTask>(isolate_group, this);
+  if (!result) {
+    // The thread pool is shutting down. The finalizers will run when the
+    // isolate group is destroyed.
+    MonitorLocker ml(&monitor_);
+    task_scheduled_ = false;
+    tasks_--;
+    ml.NotifyAll();
+  }
+}
+
+void PendingFinalizers::WaitForTasks() {
+  MonitorLocker ml(&monitor_);
+  while (tasks_ > 0) {
+    ml.Wait();
+  }
+}
+
 }  // namespace dart
@@ -7,6 +7,7 @@
 
 #include "include/dart_api.h"
 
+#include "platform/atomic.h"
 #include "platform/utils.h"
 #include "vm/bitfield.h"
 #include "vm/dart_api_impl.h"
@@ -243,10 +244,11 @@ class FinalizablePersistentHandle {
     }
   }
 
-  // Called when the referent becomes unreachable.
+  // Called when the referent becomes unreachable. The finalizer is queued and
+  // runs after the GC has processed all weak handles, see PendingFinalizers.
   void UpdateUnreachable(IsolateGroup* isolate_group) {
     EnsureFreedExternal(isolate_group);
-    Finalize(isolate_group, this);
+    QueueFinalizer(isolate_group, this);
   }
 
   // Called when the referent has moved, potentially between generations.
@@ -290,8 +292,8 @@ class FinalizablePersistentHandle {
       : raw_(nullptr), peer_(NULL), external_data_(0), callback_(NULL) {}
   ~FinalizablePersistentHandle() {}
 
-  static void Finalize(IsolateGroup* isolate_group,
-                       FinalizablePersistentHandle* handle);
+  static void QueueFinalizer(IsolateGroup* isolate_group,
+                             FinalizablePersistentHandle* handle);
 
   // Overload the raw_ field as a next pointer when adding freed
   // handles to the free list.
@@ -719,6 +721,60 @@ class ApiGrowableArray : public BaseGrowableArray<T, ValueObject, Zone> {
 // Implementation of the API State used in dart api for maintaining
 // local scopes, persistent handles etc. These are setup on a per isolate
 // group basis and destroyed when the isolate group is shutdown.
+// Finalizers of FinalizablePersistentHandles whose referents the GC found
+// unreachable, but which have not run yet.
+//
+// The GC only clears the handles and queues their finalizers, so that the
+// weak handle processing in the pause does not grow with the number of dead
+// handles. Heap::RunPendingFinalizers then runs them within a time budget, and
+// leaves the remainder to a background task.
+class PendingFinalizers {
+ public:
+  PendingFinalizers() {}
+  ~PendingFinalizers() { ASSERT(tasks_ == 0); }
+
+  // [handle_to_free] is the handle of an auto-deleting handle, to be freed
+  // once the finalizer has run, or nullptr.
+  void Add(Dart_HandleFinalizer callback,
+           void* peer,
+           FinalizablePersistentHandle* handle_to_free);
+
+  // Runs pending finalizers until none remain or [deadline_micros] has passed.
+  // A negative deadline runs all of them. Returns whether any remain.
+  bool Run(IsolateGroup* isolate_group, int64_t deadline_micros);
+
+  // Starts a task to run the pending finalizers, unless one is running.
+  void ScheduleTask(IsolateGroup* isolate_group);
+
+  // Waits for all tasks to finish.
+  void WaitForTasks();
+
+  intptr_t length();
+  int64_t finalized() const { return finalized_; }
+
+ private:
+  friend class FinalizerTask;
+
+  struct Entry {
+    Dart_HandleFinalizer callback;
+    void* peer;
+    FinalizablePersistentHandle* handle_to_free;
+  };
+
+  bool TakeNext(Entry* entry, bool from_task);
+  void Invoke(IsolateGroup* isolate_group, const Entry& entry);
+  void RunTask(IsolateGroup* isolate_group);
+
+  Monitor monitor_;
+  MallocGrowableArray<Entry> entries_;
+  intptr_t next_ = 0;
+  bool task_scheduled_ = false;
+  intptr_t tasks_ = 0;
+  RelaxedAtomic<int64_t> finalized_ = {0};
+
+  DISALLOW_COPY_AND_ASSIGN(PendingFinalizers);
+};
+
 class ApiState {
  public:
   ApiState()
@@ -847,12 +903,15 @@ class ApiState {
 
   WeakTable* acquired_table() { return &acquired_table_; }
 
+  PendingFinalizers* pending_finalizers() { return &pending_finalizers_; }
+
  private:
   Mutex mutex_;
 
   PersistentHandles persistent_handles_;
   FinalizablePersistentHandles weak_persistent_handles_;
   WeakTable acquired_table_;
+  PendingFinalizers pending_finalizers_;
 
   // Persistent handles to important objects.
   PersistentHandle* null_;
@@ -98,6 +98,8 @@ constexpr bool kDartUseBackgroundCompilation = true;
     "The number of tasks to use for parallel compaction.")                     \
   P(concurrent_mark, bool, true, "Concurrent mark for old generation.")        \
   P(concurrent_sweep, bool, true, "Concurrent sweep for old generation.")      \
+  P(sweeper_tasks, int, 2,                                                     \
+    "The number of tasks to use for concurrent sweeping.")                     \
   C(deoptimize_alot, false, false, bool, false,                                \
     "Deoptimizes we are about to return to Dart code from native entries.")    \
   C(deoptimize_every, 0, 0, int, 0,                                            \
@@ -122,6 +124,8 @@ constexpr bool kDartUseBackgroundCompilation = true;
     "Ratio of getter/setter usage used for double field unboxing heuristics")  \
   P(guess_icdata_cid, bool, true,                                              \
     "Artificially create type feedback for arithmetic etc. operations")        \
+  P(huge_heap_pages, bool, false,                                              \
+    "Reserve new-space pages in chunks backed by transparent huge pages.")     \
   P(huge_method_cutoff_in_tokens, int, 20000,                                  \
     "Huge method cutoff in tokens: Disables optimizations for huge methods.")  \
   P(idle_timeout_micros, int, 1000 * kMicrosecondsPerMillisecond,              \
@@ -129,9 +133,14 @@ constexpr bool kDartUseBackgroundCompilation = true;
   P(idle_duration_micros, int, 500 * kMicrosecondsPerMillisecond,              \
     "Allow idle tasks to run for this long.")                                  \
   P(interpret_irregexp, bool, false, "Use irregexp bytecode interpreter")      \
+  P(lazy_sweep, bool, true,                                                    \
+    "Sweep pages on demand when old gen allocation fails during concurrent "   \
+    "sweeping.")                                                               \
   P(link_natives_lazily, bool, false, "Link native calls lazily")              \
   R(log_marker_tasks, false, bool, false,                                      \
     "Log debugging information for old gen GC marking tasks.")                 \
+  R(log_scavenger_tasks, false, bool, false,                                   \
+    "Log debugging information for new gen GC scavenging tasks.")              \
   P(scavenger_tasks, int, 2,                                                   \
     "The number of tasks to spawn during scavenging (0 means "                 \
     "perform all marking on main thread).")                                    \
@@ -146,6 +155,9 @@ constexpr bool kDartUseBackgroundCompilation = true;
     "Max size of new gen semi space in MB")                                    \
   P(new_gen_semi_initial_size, int, (kWordSize <= 4) ? 1 : 2,                  \
     "Initial size of new gen semi space in MB")                                \
+  P(numa_heap_pages, bool, false,                                              \
+    "Prefer the NUMA node an isolate group was created on for its heap "       \
+    "pages.")                                                                  \
   P(optimization_counter_threshold, int, 30000,                                \
     "Function's usage-counter value before it is optimized, -1 means never")   \
   R(randomize_optimization_counter, false, bool, false,                        \
@@ -225,6 +237,11 @@ constexpr bool kDartUseBackgroundCompilation = true;
     "Enables heap verification after GC.")                                     \
   R(verify_before_gc, false, bool, false,                                      \
     "Enables heap verification before GC.")                                    \
+  R(verify_gc_sample_percent, 100, int, 100,                                   \
+    "Percentage of pages verified by --verify_before_gc and "                  \
+    "--verify_after_gc.")                                                      \
+  R(verify_gc_tasks, 2, int, 2,                                                \
+    "The number of tasks to use for heap verification.")                       \
   R(verify_store_buffer, false, bool, false,                                   \
     "Enables store buffer verification before and after scavenges.")           \
   P(enable_slow_path_sharing, bool, true, "Enable sharing of slow-path code.") \
@@ -8,15 +8,30 @@
 #include "platform/utils.h"
 
 #include "vm/dart_api_state.h"
+#include "vm/flags.h"
+#include "vm/heap/pages.h"
 #include "vm/heap/safepoint.h"
+#include "vm/heap/scavenger.h"
 #include "vm/isolate_reload.h"
 #include "vm/object.h"
 #include "vm/raw_object.h"
+#include "vm/thread_barrier.h"
+#include "vm/thread_pool.h"
 #include "vm/timeline.h"
 #include "vm/visitor.h"
 
 namespace dart {
 
+DEFINE_FLAG(bool,
+            become_scan_referrers,
+            true,
+            "Have become rewrite only the objects found by a parallel scan to "
+            "reference forwarded objects, instead of every heap pointer.");
+DEFINE_FLAG(int,
+            become_tasks,
+            2,
+            "The number of tasks to use to scan the heap during become.");
+
 ForwardingCorpse* ForwardingCorpse::AsForwarder(uword addr, intptr_t size) {
   ASSERT(size >= kObjectAlignment);
   ASSERT(Utils::IsAligned(size, kObjectAlignment));
@@ -78,10 +93,12 @@ static void ForwardObjectTo(ObjectPtr before_obj, ObjectPtr after_obj) {
 
 class ForwardPointersVisitor : public ObjectPointerVisitor {
  public:
-  explicit ForwardPointersVisitor(Thread* thread)
+  explicit ForwardPointersVisitor(Thread* thread,
+                                  bool clear_remembered_bits = true)
       : ObjectPointerVisitor(thread->isolate_group()),
         thread_(thread),
-        visiting_object_(nullptr) {}
+        visiting_object_(nullptr),
+        clear_remembered_bits_(clear_remembered_bits) {}
 
   virtual void VisitPointers(ObjectPtr* first, ObjectPtr* last) {
     for (ObjectPtr* p = first; p <= last; p++) {
@@ -111,7 +128,8 @@ class ForwardPointersVisitor : public ObjectPointerVisitor {
     visiting_object_ = obj;
     // The incoming remembered bit may be unreliable. Clear it so we can
     // consistently reapply the barrier to all slots.
-    if ((obj != nullptr) && obj->IsOldObject() && obj->ptr()->IsRemembered()) {
+    if (clear_remembered_bits_ && (obj != nullptr) && obj->IsOldObject() &&
+        obj->ptr()->IsRemembered()) {
       ASSERT(!obj->IsForwardingCorpse());
       ASSERT(!obj->IsFreeListElement());
       obj->ptr()->ClearRememberedBit();
@@ -121,10 +139,177 @@ class ForwardPointersVisitor : public ObjectPointerVisitor {
  private:
   Thread* thread_;
   ObjectPtr visiting_object_;
+  bool clear_remembered_bits_;
 
   DISALLOW_COPY_AND_ASSIGN(ForwardPointersVisitor);
 };
 
+// Finds whether any of the pointers of an object refer to a forwarding object.
+class FindForwardedPointerVisitor : public ObjectPointerVisitor {
+ public:
+  explicit FindForwardedPointerVisitor(IsolateGroup* isolate_group)
+      : ObjectPointerVisitor(isolate_group), found_(false) {}
+
+  virtual void VisitPointers(ObjectPtr* first, ObjectPtr* last) {
+    for (ObjectPtr* p = first; p <= last; p++) {
+      if (IsForwardingObject(*p)) {
+        found_ = true;
+        return;
+      }
+    }
+  }
+
+  bool found() const { return found_; }
+  void Reset() { found_ = false; }
+
+ private:
+  bool found_;
+
+  DISALLOW_COPY_AND_ASSIGN(FindForwardedPointerVisitor);
+};
+
+// Collects the heap objects that reference a forwarding object, splitting the
+// pages of the heap across FLAG_become_tasks tasks. The scan only reads the
+// heap, so the pages of objects that do not reference a forwarded object are
+// neither written nor have their slots run through the write barrier.
+class ForwardingReferrerScanner : public ValueObject {
+ public:
+  explicit ForwardingReferrerScanner(IsolateGroup* isolate_group)
+      : isolate_group_(isolate_group) {}
+
+  void Scan();
+
+  const MallocGrowableArray<ObjectPtr>& referrers() const {
+    return referrers_;
+  }
+
+ private:
+  struct Range {
+    uword start;
+    uword end;
+  };
+
+  void AddRange(uword start, uword end) {
+    if (start != end) {
+      Range range = {start, end};
+      ranges_.Add(range);
+    }
+  }
+
+  void ScanRanges(MallocGrowableArray<ObjectPtr>* referrers);
+
+  IsolateGroup* isolate_group_;
+  MallocGrowableArray<Range> ranges_;
+  RelaxedAtomic<intptr_t> next_range_ = {0};
+  MallocGrowableArray<ObjectPtr> referrers_;
+
+  friend class ForwardingReferrerTask;
+
+  DISALLOW_COPY_AND_ASSIGN(ForwardingReferrerScanner);
+};
+
+class ForwardingReferrerTask : public ThreadPool::Task {
+ public:
+  ForwardingReferrerTask(IsolateGroup* isolate_group,
+                         ForwardingReferrerScanner* scanner,
+                         ThreadBarrier* barrier,
+                         MallocGrowableArray<ObjectPtr>* referrers)
+      : isolate_group_(isolate_group),
+        scanner_(scanner),
+        barrier_(barrier),
+        referrers_(referrers) {}
+
+  void Run() {
+    bool result =
+        Thread::EnterIsolateGroupAsHelper(isolate_group_, Thread::kUnknownTask,
+                                          /*bypass_safepoint=*/true);
+    ASSERT(result);
+
+    RunEnteredIsolateGroup();
+
+    Thread::ExitIsolateGroupAsHelper(/*bypass_safepoint=*/true);
+
+    // This task is done. Notify the original thread.
+    barrier_->Exit();
+  }
+
+  void RunEnteredIsolateGroup() { scanner_->ScanRanges(referrers_); }
+
+ private:
+  IsolateGroup* isolate_group_;
+  ForwardingReferrerScanner* scanner_;
+  ThreadBarrier* barrier_;
+  MallocGrowableArray<ObjectPtr>* referrers_;
+
+  DISALLOW_COPY_AND_ASSIGN(ForwardingReferrerTask);
+};
+
+void ForwardingReferrerScanner::ScanRanges(
+    MallocGrowableArray<ObjectPtr>* referrers) {
+  FindForwardedPointerVisitor visitor(isolate_group_);
+  const intptr_t num_ranges = ranges_.length();
+  for (intptr_t i = next_range_.fetch_add(1); i < num_ranges;
+       i = next_range_.fetch_add(1)) {
+    uword addr = ranges_[i].start;
+    const uword end = ranges_[i].end;
+    while (addr < end) {
+      ObjectPtr obj = ObjectLayout::FromAddr(addr);
+      visitor.Reset();
+      addr += obj->ptr()->VisitPointers(&visitor);
+      if (visitor.found()) {
+        referrers->Add(obj);
+      }
+    }
+  }
+}
+
+void ForwardingReferrerScanner::Scan() {
+  Heap* heap = isolate_group_->heap();
+  Scavenger* new_space = heap->new_space();
+  for (NewPage* page = new_space->to_->head(); page != nullptr;
+       page = page->next()) {
+    AddRange(page->object_start(), page->object_end());
+  }
+  PageSpace* old_space = heap->old_space();
+  MutexLocker ml(&old_space->pages_lock_);
+  old_space->MakeIterable();
+  OldPage* const lists[] = {old_space->pages_, old_space->exec_pages_,
+                            old_space->large_pages_, old_space->image_pages_};
+  for (OldPage* page : lists) {
+    for (; page != nullptr; page = page->next()) {
+      AddRange(page->object_start(), page->object_end());
+    }
+  }
+
+  const intptr_t num_tasks = Utils::Minimum<intptr_t>(
+      Utils::Maximum(FLAG_become_tasks, 1), ranges_.length());
+  if (num_tasks == 0) {
+    return;
+  }
+  MallocGrowableArray<ObjectPtr>* task_referrers =
+      new MallocGrowableArray<ObjectPtr>[num_tasks];
+  {
+    ThreadBarrier barrier(num_tasks, heap->barrier(), heap->barrier_done());
+    for (intptr_t task_index = 0; task_index < num_tasks; task_index++) {
+      if (task_index < (num_tasks - 1)) {
+        // Begin scanning on a helper thread.
+        Dart::thread_pool()->Run<ForwardingReferrerTask>(
+            isolate_group_, this, &barrier, &task_referrers[task_index]);
+      } else {
+        // Last worker is the main thread.
+        ForwardingReferrerTask task(isolate_group_, this, &barrier,
+                                    &task_referrers[task_index]);
+        task.RunEnteredIsolateGroup();
+        barrier.Exit();
+      }
+    }
+  }
+  for (intptr_t task_index = 0; task_index < num_tasks; task_index++) {
+    referrers_.AddArray(task_referrers[task_index]);
+  }
+  delete[] task_referrers;
+}
+
 class ForwardHeapPointersVisitor : public ObjectVisitor {
  public:
   explicit ForwardHeapPointersVisitor(ForwardPointersVisitor* pointer_visitor)
@@ -272,7 +457,11 @@ void Become::ElementsForwardIdentity(const Array& before, const Array& after) {
 #endif
   }
 
-  FollowForwardingPointers(thread);
+  if (FLAG_become_scan_referrers) {
+    FollowForwardingPointersOfReferrers(thread);
+  } else {
+    FollowForwardingPointers(thread);
+  }
 
 #if defined(DEBUG)
   for (intptr_t i = 0; i < before.Length(); i++) {
@@ -301,15 +490,71 @@ void Become::FollowForwardingPointers(Thread* thread) {
     pointer_visitor.VisitingObject(NULL);
   }
 
+  FollowForwardingPointersOfRoots(thread, &pointer_visitor);
+}
+
+void Become::FollowForwardingPointersOfReferrers(Thread* thread) {
+  auto isolate_group = thread->isolate_group();
+  Heap* heap = isolate_group->heap();
+
+  // Unlike FollowForwardingPointers, keep the store buffer: the remembered
+  // bits are reliable outside of an aborted scavenge, and objects that are not
+  // rewritten keep their entries. Only the entries of forwarded objects are
+  // dropped.
+  isolate_group->ReleaseStoreBuffers();
+  StoreBuffer* store_buffer = isolate_group->store_buffer();
+  StoreBufferBlock* pending = store_buffer->TakeBlocks();
+  while (pending != nullptr) {
+    StoreBufferBlock* next = pending->next();
+    // Generated code appends to store buffers; tell MemorySanitizer.
+    MSAN_UNPOISON(pending, sizeof(*pending));
+    while (!pending->IsEmpty()) {
+      ObjectPtr obj = pending->Pop();
+      if (!obj->IsForwardingCorpse()) {
+        thread->StoreBufferAddObjectGC(obj);
+      }
+    }
+    pending->Reset();
+    store_buffer->PushBlock(pending, StoreBuffer::kIgnoreThreshold);
+    pending = next;
+  }
+
+  ForwardingReferrerScanner scanner(isolate_group);
+  scanner.Scan();
+
+  // Objects that are already remembered stay in the store buffer, so keep
+  // their remembered bits to avoid adding them a second time.
+  ForwardPointersVisitor pointer_visitor(thread,
+                                         /*clear_remembered_bits=*/false);
+  {
+    // Heap pointers.
+    WritableCodeLiteralsScope writable_code(heap);
+    const MallocGrowableArray<ObjectPtr>& referrers = scanner.referrers();
+    for (intptr_t i = 0; i < referrers.length(); i++) {
+      ObjectPtr obj = referrers[i];
+      pointer_visitor.VisitingObject(obj);
+      obj->ptr()->VisitPointers(&pointer_visitor);
+    }
+    pointer_visitor.VisitingObject(nullptr);
+  }
+
+  FollowForwardingPointersOfRoots(thread, &pointer_visitor);
+}
+
+void Become::FollowForwardingPointersOfRoots(
+    Thread* thread,
+    ForwardPointersVisitor* pointer_visitor) {
+  auto isolate_group = thread->isolate_group();
+
   // C++ pointers.
-  isolate_group->VisitObjectPointers(&pointer_visitor,
+  isolate_group->VisitObjectPointers(pointer_visitor,
                                      ValidationPolicy::kValidateFrames);
 #ifndef PRODUCT
   isolate_group->ForEachIsolate(
       [&](Isolate* isolate) {
         ObjectIdRing* ring = isolate->object_id_ring();
         if (ring != nullptr) {
-          ring->VisitPointers(&pointer_visitor);
+          ring->VisitPointers(pointer_visitor);
         }
       },
       /*at_safepoint=*/true);
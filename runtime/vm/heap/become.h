@@ -12,6 +12,7 @@
 namespace dart {
 
 class Array;
+class ForwardPointersVisitor;
 
 // Objects that are a source in a become are tranformed into forwarding
 // corpses pointing to the corresponding target. Forwarding corpses have the
@@ -92,6 +93,14 @@ class Become : public AllStatic {
 
  private:
   static void CrashDump(ObjectPtr before_obj, ObjectPtr after_obj);
+
+  // Like FollowForwardingPointers, but only rewrites the heap objects found
+  // by a scan to reference forwarding objects. Requires reliable remembered
+  // bits, so it is not used to recover from an aborted scavenge.
+  static void FollowForwardingPointersOfReferrers(Thread* thread);
+  static void FollowForwardingPointersOfRoots(
+      Thread* thread,
+      ForwardPointersVisitor* pointer_visitor);
 };
 
 }  // namespace dart
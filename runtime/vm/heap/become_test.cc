@@ -12,6 +12,8 @@
 
 namespace dart {
 
+DECLARE_FLAG(bool, become_scan_referrers);
+
 void TestBecomeForward(Heap::Space before_space, Heap::Space after_space) {
   const String& before_obj = String::Handle(String::New("old", before_space));
   const String& after_obj = String::Handle(String::New("new", after_space));
@@ -148,4 +150,38 @@ ISOLATE_UNIT_TEST_CASE(BecomeForwardRememberedCards) {
   }
 }
 
+ISOLATE_UNIT_TEST_CASE(BecomeForwardOnlyReferrers) {
+  const String& new_element = String::Handle(String::New("new", Heap::kNew));
+  const String& old_element = String::Handle(String::New("old", Heap::kOld));
+  const Array& referrer = Array::Handle(Array::New(1, Heap::kOld));
+  referrer.SetAt(0, old_element);
+  EXPECT(!referrer.raw()->ptr()->IsRemembered());
+
+  const String& unrelated_element =
+      String::Handle(String::New("unrelated", Heap::kNew));
+  const Array& unrelated = Array::Handle(Array::New(1, Heap::kOld));
+  unrelated.SetAt(0, unrelated_element);
+  EXPECT(unrelated.raw()->ptr()->IsRemembered());
+
+  SetFlagScope<bool> sfs(&FLAG_become_scan_referrers, true);
+  const Array& before = Array::Handle(Array::New(1, Heap::kOld));
+  before.SetAt(0, old_element);
+  const Array& after = Array::Handle(Array::New(1, Heap::kOld));
+  after.SetAt(0, new_element);
+  Become::ElementsForwardIdentity(before, after);
+
+  EXPECT(old_element.raw() == new_element.raw());
+  EXPECT(referrer.At(0) == new_element.raw());
+  EXPECT(referrer.raw()->ptr()->IsRemembered());
+  EXPECT(unrelated.raw()->ptr()->IsRemembered());
+
+  GCTestHelper::CollectNewSpace();
+
+  {
+    HANDLESCOPE(thread);
+    EXPECT_STREQ("new", Object::Handle(referrer.At(0)).ToCString());
+    EXPECT_STREQ("unrelated", Object::Handle(unrelated.At(0)).ToCString());
+  }
+}
+
 }  // namespace dart
@@ -9,6 +9,7 @@
 #include "vm/heap/become.h"
 #include "vm/heap/heap.h"
 #include "vm/heap/pages.h"
+#include "vm/os.h"
 #include "vm/thread_barrier.h"
 #include "vm/timeline.h"
 
@@ -135,7 +136,8 @@ class CompactorTask : public ThreadPool::Task {
         freelist_(freelist),
         free_page_(NULL),
         free_current_(0),
-        free_end_(0) {}
+        free_end_(0),
+        moved_bytes_(0) {}
 
   void Run();
   void RunEnteredIsolateGroup();
@@ -146,6 +148,7 @@ class CompactorTask : public ThreadPool::Task {
   uword PlanBlock(uword first_object, ForwardingPage* forwarding_page);
   uword SlideBlock(uword first_object, ForwardingPage* forwarding_page);
   void PlanMoveToContiguousSize(intptr_t size);
+  void FreeRange(uword addr, intptr_t size);
 
   IsolateGroup* isolate_group_;
   GCCompactor* compactor_;
@@ -157,6 +160,7 @@ class CompactorTask : public ThreadPool::Task {
   OldPage* free_page_;
   uword free_current_;
   uword free_end_;
+  intptr_t moved_bytes_;
 
   DISALLOW_COPY_AND_ASSIGN(CompactorTask);
 };
@@ -170,6 +174,46 @@ class CompactorTask : public ThreadPool::Task {
 void GCCompactor::Compact(OldPage* pages,
                           FreeList* freelist,
                           Mutex* pages_lock) {
+  OldPage* head;
+  OldPage* tail;
+  CompactPages(pages, freelist, pages_lock, &head, &tail);
+
+  MutexLocker ml(pages_lock);
+  heap_->old_space()->pages_ = head;
+  heap_->old_space()->pages_tail_ = tail;
+}
+
+void GCCompactor::Evacuate(OldPage* pages,
+                           Mutex* pages_lock,
+                           OldPage** head,
+                           OldPage** tail) {
+  unswept_ = true;
+  {
+    MutexLocker ml(pages_lock);
+    for (OldPage* page = heap_->old_space()->pages_; page != NULL;
+         page = page->next()) {
+      num_unswept_pages_++;
+    }
+    unswept_pages_ = new OldPage*[num_unswept_pages_];
+    intptr_t i = 0;
+    for (OldPage* page = heap_->old_space()->pages_; page != NULL;
+         page = page->next()) {
+      unswept_pages_[i++] = page;
+    }
+  }
+
+  CompactPages(pages, /*freelist=*/nullptr, pages_lock, head, tail);
+
+  delete[] unswept_pages_;
+  unswept_pages_ = nullptr;
+  num_unswept_pages_ = 0;
+}
+
+void GCCompactor::CompactPages(OldPage* pages,
+                               FreeList* freelist,
+                               Mutex* pages_lock,
+                               OldPage** head,
+                               OldPage** tail) {
   SetupImagePageBoundaries();
 
   // Divide the heap.
@@ -309,6 +353,7 @@ void GCCompactor::Compact(OldPage* pages,
         heap_->old_space()->IncreaseCapacityInWordsLocked(
             -(page->memory_->size() >> kWordSizeLog2));
         page->Deallocate();
+        freed_pages_++;
         page = next;
       }
     }
@@ -318,12 +363,27 @@ void GCCompactor::Compact(OldPage* pages,
       tails[task_index]->set_next(heads[task_index + 1]);
     }
     tails[num_tasks - 1]->set_next(NULL);
-    heap_->old_space()->pages_ = pages = heads[0];
-    heap_->old_space()->pages_tail_ = tails[num_tasks - 1];
+    *head = heads[0];
+    *tail = tails[num_tasks - 1];
 
     delete[] heads;
     delete[] tails;
   }
+
+  for (OldPage* page = *head; page != NULL; page = page->next()) {
+    page->set_evacuation_candidate(false);
+  }
+}
+
+void GCCompactor::RecordTaskStats(intptr_t moved_bytes,
+                                  int64_t plan_micros,
+                                  int64_t slide_micros,
+                                  int64_t forward_micros) {
+  MutexLocker ml(&stats_mutex_);
+  moved_bytes_ += moved_bytes;
+  plan_micros_ = Utils::Maximum(plan_micros_, plan_micros);
+  slide_micros_ = Utils::Maximum(slide_micros_, slide_micros);
+  forward_micros_ = Utils::Maximum(forward_micros_, forward_micros);
 }
 
 void CompactorTask::Run() {
@@ -345,6 +405,7 @@ void CompactorTask::RunEnteredIsolateGroup() {
   Thread* thread = Thread::Current();
 #endif
   {
+    const int64_t plan_start = OS::GetCurrentMonotonicMicros();
     {
       TIMELINE_FUNCTION_GC_DURATION(thread, "Plan");
       free_page_ = head_;
@@ -356,8 +417,11 @@ void CompactorTask::RunEnteredIsolateGroup() {
       }
     }
 
+    const int64_t plan_end = OS::GetCurrentMonotonicMicros();
+
     barrier_->Sync();
 
+    const int64_t slide_start = OS::GetCurrentMonotonicMicros();
     {
       TIMELINE_FUNCTION_GC_DURATION(thread, "Slide");
       free_page_ = head_;
@@ -372,15 +436,23 @@ void CompactorTask::RunEnteredIsolateGroup() {
       // required to make the page walkable during forwarding, etc.
       intptr_t free_remaining = free_end_ - free_current_;
       if (free_remaining != 0) {
-        freelist_->Free(free_current_, free_remaining);
+        FreeRange(free_current_, free_remaining);
       }
 
       ASSERT(free_page_ != NULL);
       *tail_ = free_page_;  // Last live page.
     }
+    const int64_t slide_end = OS::GetCurrentMonotonicMicros();
 
     // Heap: Regular pages already visited during sliding. Code and image pages
-    // have no pointers to forward. Visit large pages and new-space.
+    // have no pointers to forward. Visit large pages and new-space, and the
+    // regular pages outside of a partial evacuation.
+
+    for (;;) {
+      intptr_t index = compactor_->next_unswept_page_.fetch_add(1);
+      if (index >= compactor_->num_unswept_pages_) break;
+      compactor_->ForwardMarkedObjects(compactor_->unswept_pages_[index]);
+    }
 
     bool more_forwarding_tasks = true;
     while (more_forwarding_tasks) {
@@ -391,7 +463,11 @@ void CompactorTask::RunEnteredIsolateGroup() {
           for (OldPage* large_page =
                    isolate_group_->heap()->old_space()->large_pages_;
                large_page != NULL; large_page = large_page->next()) {
-            large_page->VisitObjectPointers(compactor_);
+            if (compactor_->unswept_) {
+              compactor_->ForwardMarkedObjects(large_page);
+            } else {
+              large_page->VisitObjectPointers(compactor_);
+            }
           }
           break;
         }
@@ -433,6 +509,11 @@ void CompactorTask::RunEnteredIsolateGroup() {
           more_forwarding_tasks = false;
       }
     }
+    const int64_t forward_end = OS::GetCurrentMonotonicMicros();
+
+    compactor_->RecordTaskStats(moved_bytes_, plan_end - plan_start,
+                                slide_end - slide_start,
+                                forward_end - slide_end);
 
     barrier_->Sync();
   }
@@ -445,6 +526,7 @@ void CompactorTask::PlanPage(OldPage* page) {
   ForwardingPage* forwarding_page = page->forwarding_page();
   ASSERT(forwarding_page != nullptr);
   forwarding_page->Clear();
+  page->set_evacuation_candidate(true);
   while (current < end) {
     current = PlanBlock(current, forwarding_page);
   }
@@ -518,7 +600,7 @@ uword CompactorTask::SlideBlock(uword first_object,
         intptr_t free_remaining = free_end_ - free_current_;
         // Add any leftover at the end of a page to the free list.
         if (free_remaining > 0) {
-          freelist_->Free(free_current_, free_remaining);
+          FreeRange(free_current_, free_remaining);
         }
         free_page_ = free_page_->next();
         ASSERT(free_page_ != NULL);
@@ -534,12 +616,15 @@ uword CompactorTask::SlideBlock(uword first_object,
         // Slide the object down.
         memmove(reinterpret_cast<void*>(new_addr),
                 reinterpret_cast<void*>(old_addr), size);
+        moved_bytes_ += size;
 
         if (IsTypedDataClassId(new_obj->GetClassId())) {
           static_cast<TypedDataPtr>(new_obj)->ptr()->RecomputeDataField();
         }
       }
-      new_obj->ptr()->ClearMarkBit();
+      if (!compactor_->unswept_) {
+        new_obj->ptr()->ClearMarkBit();
+      }
       new_obj->ptr()->VisitPointers(compactor_);
 
       ASSERT(free_current_ == new_addr);
@@ -570,6 +655,15 @@ void CompactorTask::PlanMoveToContiguousSize(intptr_t size) {
   }
 }
 
+void CompactorTask::FreeRange(uword addr, intptr_t size) {
+  if (compactor_->unswept_) {
+    // Leave the range as unmarked filler for the sweeper to collect.
+    FreeListElement::AsElement(addr, size);
+  } else {
+    freelist_->Free(addr, size);
+  }
+}
+
 void GCCompactor::SetupImagePageBoundaries() {
   MallocGrowableArray<ImagePageRange> ranges(4);
 
@@ -622,6 +716,9 @@ void GCCompactor::ForwardPointer(ObjectPtr* ptr) {
   if (forwarding_page == NULL) {
     return;  // Not moved (VM isolate, large page, code page).
   }
+  if (!page->is_evacuation_candidate()) {
+    return;  // Not moved (outside of a partial evacuation).
+  }
 
   ObjectPtr new_target =
       ObjectLayout::FromAddr(forwarding_page->Lookup(old_addr));
@@ -629,6 +726,20 @@ void GCCompactor::ForwardPointer(ObjectPtr* ptr) {
   *ptr = new_target;
 }
 
+void GCCompactor::ForwardMarkedObjects(OldPage* page) {
+  // The page has not been swept yet, so only marked objects are guaranteed to
+  // point to live objects.
+  uword current = page->object_start();
+  uword end = page->object_end();
+  while (current < end) {
+    ObjectPtr obj = ObjectLayout::FromAddr(current);
+    if (obj->ptr()->IsMarked()) {
+      obj->ptr()->VisitPointers(this);
+    }
+    current += obj->ptr()->HeapSize();
+  }
+}
+
 void GCCompactor::VisitTypedDataViewPointers(TypedDataViewPtr view,
                                              ObjectPtr* first,
                                              ObjectPtr* last) {
@@ -5,6 +5,7 @@
 #ifndef RUNTIME_VM_HEAP_COMPACTOR_H_
 #define RUNTIME_VM_HEAP_COMPACTOR_H_
 
+#include "platform/atomic.h"
 #include "platform/growable_array.h"
 
 #include "vm/allocation.h"
@@ -32,12 +33,39 @@ class GCCompactor : public ValueObject,
 
   void Compact(OldPage* pages, FreeList* freelist, Mutex* mutex);
 
+  // Evacuates the live objects of [pages], which have been unlinked from the
+  // regular pages of the old space, into as few of them as possible and frees
+  // the rest. Unlike Compact, this runs before sweeping: the remaining pages
+  // are only forwarded from their marked objects, and the evacuated objects
+  // stay marked, with free space left as unmarked filler, so the surviving
+  // pages returned in [head] and [tail] can be swept along with the rest.
+  void Evacuate(OldPage* pages, Mutex* mutex, OldPage** head, OldPage** tail);
+
+  // Statistics about the last call to Compact or Evacuate. Phase times are the
+  // maximum over all compactor tasks.
+  intptr_t moved_bytes() const { return moved_bytes_; }
+  intptr_t freed_pages() const { return freed_pages_; }
+  int64_t plan_micros() const { return plan_micros_; }
+  int64_t slide_micros() const { return slide_micros_; }
+  int64_t forward_micros() const { return forward_micros_; }
+
  private:
   friend class CompactorTask;
 
+  void CompactPages(OldPage* pages,
+                    FreeList* freelist,
+                    Mutex* pages_lock,
+                    OldPage** head,
+                    OldPage** tail);
+  void RecordTaskStats(intptr_t moved_bytes,
+                       int64_t plan_micros,
+                       int64_t slide_micros,
+                       int64_t forward_micros);
+
   void SetupImagePageBoundaries();
   void ForwardStackPointers();
   void ForwardPointer(ObjectPtr* ptr);
+  void ForwardMarkedObjects(OldPage* page);
   void VisitTypedDataViewPointers(TypedDataViewPtr view,
                                   ObjectPtr* first,
                                   ObjectPtr* last);
@@ -46,6 +74,15 @@ class GCCompactor : public ValueObject,
 
   Heap* heap_;
 
+  // Whether this is a partial evacuation that runs before sweeping.
+  bool unswept_ = false;
+
+  // The regular pages outside of a partial evacuation, claimed by the compactor
+  // tasks for forwarding.
+  OldPage** unswept_pages_ = nullptr;
+  intptr_t num_unswept_pages_ = 0;
+  RelaxedAtomic<intptr_t> next_unswept_page_ = {0};
+
   struct ImagePageRange {
     uword start;
     uword end;
@@ -67,6 +104,13 @@ class GCCompactor : public ValueObject,
   // complete.
   Mutex typed_data_view_mutex_;
   MallocGrowableArray<TypedDataViewPtr> typed_data_views_;
+
+  Mutex stats_mutex_;
+  intptr_t moved_bytes_ = 0;
+  intptr_t freed_pages_ = 0;
+  int64_t plan_micros_ = 0;
+  int64_t slide_micros_ = 0;
+  int64_t forward_micros_ = 0;
 };
 
 }  // namespace dart
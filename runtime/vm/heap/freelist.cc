@@ -73,7 +73,7 @@ uword FreeList::TryAllocateLocked(intptr_t size, bool is_protected) {
 
   // Postcondition: if allocation succeeds, the allocated block is writable.
   int index = IndexForSize(size);
-  if ((index != kNumLists) && free_map_.Test(index)) {
+  if ((index < kNumLists) && free_map_.Test(index)) {
     FreeListElement* element = DequeueElement(index);
     if (is_protected) {
       VirtualMemory::Protect(reinterpret_cast<void*>(element), size,
@@ -105,8 +105,26 @@ uword FreeList::TryAllocateLocked(intptr_t size, bool is_protected) {
     }
   }
 
-  FreeListElement* previous = NULL;
-  FreeListElement* current = free_lists_[kNumLists];
+  FreeListElement* element = DequeueLargeElement(size, is_protected);
+  if (element == NULL) {
+    return 0;  // Trigger allocation of new page.
+  }
+  if (is_protected) {
+    // Make the allocated block and the header of the remainder element
+    // writable.  The remainder will be non-writable if necessary after
+    // the call to SplitElementAfterAndEnqueue.
+    intptr_t remainder_size = element->HeapSize() - size;
+    intptr_t region_size =
+        size + FreeListElement::HeaderSizeFor(remainder_size);
+    VirtualMemory::Protect(reinterpret_cast<void*>(element), region_size,
+                           VirtualMemory::kReadWrite);
+  }
+  SplitElementAfterAndEnqueue(element, size, is_protected);
+  return reinterpret_cast<uword>(element);
+}
+
+FreeListElement* FreeList::DequeueLargeElement(intptr_t minimum_size,
+                                               bool is_protected) {
   // We are willing to search the freelist further for a big block.
   // For each successful free-list search we:
   //   * increase the search budget by #allocated-words
@@ -116,60 +134,51 @@ uword FreeList::TryAllocateLocked(intptr_t size, bool is_protected) {
   //
   // If we run out of search budget we fall back to allocating a new page and
   // reset the search budget.
-  intptr_t tries_left = freelist_search_budget_ + (size >> kWordSizeLog2);
-  while (current != NULL) {
-    if (current->HeapSize() >= size) {
-      // Found an element large enough to hold the requested size. Dequeue,
-      // split and enqueue the remainder.
-      intptr_t remainder_size = current->HeapSize() - size;
-      intptr_t region_size =
-          size + FreeListElement::HeaderSizeFor(remainder_size);
-      if (is_protected) {
-        // Make the allocated block and the header of the remainder element
-        // writable.  The remainder will be non-writable if necessary after
-        // the call to SplitElementAfterAndEnqueue.
-        VirtualMemory::Protect(reinterpret_cast<void*>(current), region_size,
-                               VirtualMemory::kReadWrite);
-      }
-
-      if (previous == NULL) {
-        free_lists_[kNumLists] = current->next();
-      } else {
-        // If the previous free list element's next field is protected, it
-        // needs to be unprotected before storing to it and reprotected
-        // after.
-        bool target_is_protected = false;
-        uword target_address = 0L;
-        if (is_protected) {
-          uword writable_start = reinterpret_cast<uword>(current);
-          uword writable_end = writable_start + region_size - 1;
-          target_address = previous->next_address();
-          target_is_protected =
-              !VirtualMemory::InSamePage(target_address, writable_start) &&
-              !VirtualMemory::InSamePage(target_address, writable_end);
-        }
-        if (target_is_protected) {
-          VirtualMemory::Protect(reinterpret_cast<void*>(target_address),
-                                 kWordSize, VirtualMemory::kReadWrite);
-        }
-        previous->set_next(current->next());
-        if (target_is_protected) {
-          VirtualMemory::Protect(reinterpret_cast<void*>(target_address),
-                                 kWordSize, VirtualMemory::kReadExecute);
+  //
+  // Only the list of the size class of 'minimum_size' needs to be searched:
+  // any element in a larger size class is big enough, except in the last list
+  // which holds all sizes above its class.
+  intptr_t tries_left =
+      freelist_search_budget_ + (minimum_size >> kWordSizeLog2);
+  intptr_t index = Utils::Maximum(IndexForSize(minimum_size),
+                                  static_cast<intptr_t>(kNumLists));
+  for (; index < kNumAllLists; index++) {
+    FreeListElement* previous = NULL;
+    FreeListElement* current = free_lists_[index];
+    while (current != NULL) {
+      FreeListElement* next = current->next();
+      if (current->HeapSize() >= minimum_size) {
+        // Found an element large enough to hold the requested size.
+        if (previous == NULL) {
+          free_lists_[index] = next;
+        } else {
+          // If the previous free list element's next field is protected, it
+          // needs to be unprotected before storing to it and reprotected
+          // after.
+          uword target_address = previous->next_address();
+          if (is_protected) {
+            VirtualMemory::Protect(reinterpret_cast<void*>(target_address),
+                                   kWordSize, VirtualMemory::kReadWrite);
+          }
+          previous->set_next(next);
+          if (is_protected) {
+            VirtualMemory::Protect(reinterpret_cast<void*>(target_address),
+                                   kWordSize, VirtualMemory::kReadExecute);
+          }
         }
+        freelist_search_budget_ =
+            Utils::Minimum(tries_left, kInitialFreeListSearchBudget);
+        return current;
+      } else if (tries_left-- < 0) {
+        freelist_search_budget_ = kInitialFreeListSearchBudget;
+        // The heads of the lists of larger size classes may still fit.
+        break;
       }
-      SplitElementAfterAndEnqueue(current, size, is_protected);
-      freelist_search_budget_ =
-          Utils::Minimum(tries_left, kInitialFreeListSearchBudget);
-      return reinterpret_cast<uword>(current);
-    } else if (tries_left-- < 0) {
-      freelist_search_budget_ = kInitialFreeListSearchBudget;
-      return 0;  // Trigger allocation of new page.
+      previous = current;
+      current = next;
     }
-    previous = current;
-    current = current->next();
   }
-  return 0;
+  return NULL;
 }
 
 void FreeList::Free(uword addr, intptr_t size) {
@@ -194,14 +203,14 @@ void FreeList::Reset() {
   MutexLocker ml(&mutex_);
   free_map_.Reset();
   last_free_small_size_ = -1;
-  for (int i = 0; i < (kNumLists + 1); i++) {
+  for (int i = 0; i < kNumAllLists; i++) {
     free_lists_[i] = NULL;
   }
 }
 
 void FreeList::EnqueueElement(FreeListElement* element, intptr_t index) {
   FreeListElement* next = free_lists_[index];
-  if (next == NULL && index != kNumLists) {
+  if (next == NULL && index < kNumLists) {
     free_map_.Set(index, true);
     last_free_small_size_ =
         Utils::Maximum(last_free_small_size_, index << kObjectAlignmentLog2);
@@ -274,15 +283,17 @@ void FreeList::PrintLarge() const {
   intptr_t large_bytes = 0;
   MallocDirectChainedHashMap<NumbersKeyValueTrait<IntptrPair> > map;
   FreeListElement* node;
-  for (node = free_lists_[kNumLists]; node != NULL; node = node->next()) {
-    IntptrPair* pair = map.Lookup(node->HeapSize());
-    if (pair == NULL) {
-      large_sizes += 1;
-      map.Insert(IntptrPair(node->HeapSize(), 1));
-    } else {
-      pair->set_second(pair->second() + 1);
+  for (intptr_t i = kNumLists; i < kNumAllLists; ++i) {
+    for (node = free_lists_[i]; node != NULL; node = node->next()) {
+      IntptrPair* pair = map.Lookup(node->HeapSize());
+      if (pair == NULL) {
+        large_sizes += 1;
+        map.Insert(IntptrPair(node->HeapSize(), 1));
+      } else {
+        pair->set_second(pair->second() + 1);
+      }
+      large_objects += 1;
     }
-    large_objects += 1;
   }
 
   MallocDirectChainedHashMap<NumbersKeyValueTrait<IntptrPair> >::Iterator it =
@@ -350,44 +361,37 @@ FreeListElement* FreeList::TryAllocateLarge(intptr_t minimum_size) {
 
 FreeListElement* FreeList::TryAllocateLargeLocked(intptr_t minimum_size) {
   DEBUG_ASSERT(mutex_.IsOwnedByCurrentThread());
-  FreeListElement* previous = NULL;
-  FreeListElement* current = free_lists_[kNumLists];
-  // TODO(koda): Find largest.
-  // We are willing to search the freelist further for a big block.
-  intptr_t tries_left =
-      freelist_search_budget_ + (minimum_size >> kWordSizeLog2);
-  while (current != NULL) {
-    FreeListElement* next = current->next();
-    if (current->HeapSize() >= minimum_size) {
-      if (previous == NULL) {
-        free_lists_[kNumLists] = next;
-      } else {
-        previous->set_next(next);
-      }
-      freelist_search_budget_ =
-          Utils::Minimum(tries_left, kInitialFreeListSearchBudget);
-      return current;
-    } else if (tries_left-- < 0) {
-      freelist_search_budget_ = kInitialFreeListSearchBudget;
-      return 0;  // Trigger allocation of new page.
+  return DequeueLargeElement(minimum_size, /*is_protected=*/false);
+}
+
+void FreeList::ComputeFreeSizesLocked(intptr_t* free_size,
+                                      intptr_t* largest_size) const {
+  DEBUG_ASSERT(mutex_.IsOwnedByCurrentThread());
+  intptr_t total = 0;
+  intptr_t largest = 0;
+  for (intptr_t i = 0; i < kNumAllLists; ++i) {
+    for (FreeListElement* element = free_lists_[i]; element != NULL;
+         element = element->next()) {
+      intptr_t size = element->HeapSize();
+      total += size;
+      largest = Utils::Maximum(largest, size);
     }
-    previous = current;
-    current = next;
   }
-  return NULL;
+  *free_size = total;
+  *largest_size = largest;
 }
 
 void FreeList::MergeFrom(FreeList* donor, bool is_protected) {
   // The [other] free list is from a dying isolate. There are no other threads
   // accessing it, so there is no need to lock here.
   MutexLocker ml(&mutex_);
-  for (intptr_t i = 0; i < (kNumLists + 1); ++i) {
+  for (intptr_t i = 0; i < kNumAllLists; ++i) {
     FreeListElement* donor_head = donor->free_lists_[i];
     if (donor_head != nullptr) {
       // If we didn't have a freelist element before we have to set the bit now,
       // since we will get 1+ elements from [other].
       FreeListElement* old_head = free_lists_[i];
-      if (old_head == nullptr && i != kNumLists) {
+      if (old_head == nullptr && i < kNumLists) {
         free_map_.Set(i, true);
       }
 
@@ -103,7 +103,7 @@ class FreeList {
       return 0;
     }
     int index = IndexForSize(size);
-    if (index != kNumLists && free_map_.Test(index)) {
+    if (index < kNumLists && free_map_.Test(index)) {
       return reinterpret_cast<uword>(DequeueElement(index));
     }
     if ((index + 1) < kNumLists) {
@@ -159,8 +159,20 @@ class FreeList {
 
   void MergeFrom(FreeList* donor, bool is_protected);
 
+  // Computes the total size of the free elements and the size of the largest
+  // one.
+  void ComputeFreeSizesLocked(intptr_t* free_size,
+                              intptr_t* largest_size) const;
+
  private:
   static const int kNumLists = 128;
+  static const int kNumListsLog2 = 7;
+  COMPILE_ASSERT((1 << kNumListsLog2) == kNumLists);
+  // Elements too large for the exact-size lists are segregated into lists of
+  // power-of-two size classes, the last of which also holds all larger
+  // elements.
+  static const int kNumLargeLists = 12;
+  static const int kNumAllLists = kNumLists + kNumLargeLists;
   static const intptr_t kInitialFreeListSearchBudget = 1000;
 
   static intptr_t IndexForSize(intptr_t size) {
@@ -169,7 +181,11 @@ class FreeList {
 
     intptr_t index = size >> kObjectAlignmentLog2;
     if (index >= kNumLists) {
-      index = kNumLists;
+      index = kNumLists + Utils::HighestBit(size) -
+              (kObjectAlignmentLog2 + kNumListsLog2);
+      if (index >= kNumAllLists) {
+        index = kNumAllLists - 1;
+      }
     }
     return index;
   }
@@ -180,7 +196,7 @@ class FreeList {
   FreeListElement* DequeueElement(intptr_t index) {
     FreeListElement* result = free_lists_[index];
     FreeListElement* next = result->next();
-    if (next == NULL && index != kNumLists) {
+    if (next == NULL && index < kNumLists) {
       intptr_t size = index << kObjectAlignmentLog2;
       if (size == last_free_small_size_) {
         // Note: This is -1 * kObjectAlignment if no other small sizes remain.
@@ -198,6 +214,11 @@ class FreeList {
                                    intptr_t size,
                                    bool is_protected);
 
+  // Dequeues an element of at least 'minimum_size' from the large lists, or
+  // returns NULL if none is found within the search budget.
+  FreeListElement* DequeueLargeElement(intptr_t minimum_size,
+                                       bool is_protected);
+
   void PrintSmall() const;
   void PrintLarge() const;
 
@@ -215,7 +236,7 @@ class FreeList {
 
   BitSet<kNumLists> free_map_;
 
-  FreeListElement* free_lists_[kNumLists + 1];
+  FreeListElement* free_lists_[kNumAllLists];
 
   intptr_t freelist_search_budget_ = kInitialFreeListSearchBudget;
 
@@ -107,6 +107,35 @@ TEST_CASE(FreeListProtected) {
   delete free_list;
 }
 
+TEST_CASE(FreeListLargeSizeClasses) {
+  FreeList* free_list = new FreeList();
+  const intptr_t kBlobSize = 1 * MB;
+  VirtualMemory* region =
+      VirtualMemory::Allocate(kBlobSize, /* is_executable */ false, "test");
+  const uword medium_block = region->start();
+  const intptr_t kMediumBlockSize = 16 * KB;
+  const uword huge_block = region->start() + 64 * KB;
+  const intptr_t kHugeBlockSize = 256 * KB;
+  free_list->Free(medium_block, kMediumBlockSize);
+  free_list->Free(huge_block, kHugeBlockSize);
+
+  // Large requests are served from the smallest size class that fits, even
+  // though the huge block was freed last.
+  uword object = Allocate(free_list, 10 * KB, false);
+  EXPECT_EQ(medium_block, object);
+  // The remainder of the medium block is too small for this request.
+  object = Allocate(free_list, 8 * KB, false);
+  EXPECT_EQ(huge_block, object);
+  // But it can still be taken whole.
+  FreeListElement* element = free_list->TryAllocateLarge(6 * KB);
+  EXPECT_EQ(medium_block + 10 * KB, reinterpret_cast<uword>(element));
+  EXPECT_EQ(6 * KB, element->HeapSize());
+
+  // Delete the memory associated with the test.
+  delete region;
+  delete free_list;
+}
+
 TEST_CASE(FreeListProtectedTinyObjects) {
   FreeList* free_list = new FreeList();
   const intptr_t kBlobSize = 1 * MB;
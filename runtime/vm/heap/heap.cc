@@ -11,6 +11,7 @@
 #include "platform/utils.h"
 #include "vm/compiler/jit/compiler.h"
 #include "vm/dart.h"
+#include "vm/dart_api_state.h"
 #include "vm/flags.h"
 #include "vm/heap/pages.h"
 #include "vm/heap/safepoint.h"
@@ -39,6 +40,19 @@ DEFINE_FLAG(bool,
             disable_heap_verification,
             false,
             "Explicitly disable heap verification.");
+DEFINE_FLAG(int,
+            isolate_soft_limit_mb,
+            0,
+            "Kill an isolate that is alone in its isolate group once the live "
+            "heap exceeds this many megabytes (0 disables). Live bytes cannot "
+            "be attributed to one of several isolates sharing a heap, so the "
+            "limit is not enforced for those.");
+DEFINE_FLAG(int,
+            finalizer_budget,
+            -1,
+            "Microseconds a GC may spend running handle finalizers before "
+            "leaving the rest to a background task. Negative runs all of them "
+            "in the GC.");
 
 // We ensure that the GC does not use the current isolate.
 class NoActiveIsolateScope {
@@ -63,6 +77,7 @@ Heap::Heap(IsolateGroup* isolate_group,
            intptr_t max_old_gen_words)
     : isolate_group_(isolate_group),
       is_vm_isolate_(is_vm_isolate),
+      numa_node_(FLAG_numa_heap_pages ? VirtualMemory::CurrentNumaNode() : -1),
       new_space_(this, max_new_gen_semi_words),
       old_space_(this, max_old_gen_words),
       barrier_(),
@@ -90,6 +105,7 @@ uword Heap::AllocateNew(intptr_t size) {
   ASSERT(Thread::Current()->no_safepoint_scope_depth() == 0);
   CollectForDebugging();
   Thread* thread = Thread::Current();
+  CheckIsolateSoftLimit(thread);
   uword addr = new_space_.TryAllocate(thread, size);
   if (LIKELY(addr != 0)) {
     return addr;
@@ -113,6 +129,14 @@ uword Heap::AllocateNew(intptr_t size) {
 
 uword Heap::AllocateOld(intptr_t size, OldPage::PageType type) {
   ASSERT(Thread::Current()->no_safepoint_scope_depth() == 0);
+  {
+    Thread* thread = Thread::Current();
+    Isolate* isolate = thread->isolate();
+    if (isolate != nullptr) {
+      isolate->AddAllocatedOldBytes(size);
+    }
+    CheckIsolateSoftLimit(thread);
+  }
   if (old_space_.GrowthControlState()) {
     CollectForDebugging();
     uword addr = old_space_.TryAllocate(size, type);
@@ -161,6 +185,65 @@ uword Heap::AllocateOld(intptr_t size, OldPage::PageType type) {
   return 0;
 }
 
+void Heap::CheckIsolateSoftLimit(Thread* thread) {
+  if (FLAG_isolate_soft_limit_mb <= 0) {
+    return;
+  }
+  Isolate* isolate = thread->isolate();
+  // Only the actual retained size is a reason to kill an isolate, not a
+  // share of it that is estimated from allocation volume.
+  if ((isolate == nullptr) || isolate->exceeded_soft_limit_ ||
+      !isolate->live_bytes_estimate_is_exact() ||
+      (isolate->live_bytes_estimate() <=
+       static_cast<intptr_t>(FLAG_isolate_soft_limit_mb) * MB)) {
+    return;
+  }
+  isolate->exceeded_soft_limit_ = true;
+  OS::PrintErr("Isolate %s retains %" Pd
+               " bytes, over its soft limit of %d MB. Killing it.\n",
+               isolate->name(), isolate->live_bytes_estimate(),
+               FLAG_isolate_soft_limit_mb);
+  Isolate::KillIfExists(isolate, Isolate::kKillMsg);
+}
+
+void Heap::UpdateIsolateLiveEstimates() {
+  // Objects do not record which isolate allocated them, so the live bytes
+  // found by marking are split between the isolates in proportion to what
+  // each allocated since the last marking plus what it was estimated to
+  // retain before.
+  const intptr_t live_bytes = UsedInWords(kNew) * kWordSize +
+                              UsedInWords(kOld) * kWordSize;
+  intptr_t total_weight = 0;
+  intptr_t num_isolates = 0;
+  auto weight = [](Isolate* isolate) {
+    return isolate->allocated_new_bytes() + isolate->allocated_old_bytes() -
+           isolate->allocated_bytes_at_last_mark_ +
+           isolate->live_bytes_estimate();
+  };
+  isolate_group_->ForEachIsolate(
+      [&](Isolate* isolate) {
+        total_weight += weight(isolate);
+        num_isolates++;
+      },
+      /*at_safepoint=*/true);
+  if (num_isolates == 0) {
+    return;
+  }
+  isolate_group_->ForEachIsolate(
+      [&](Isolate* isolate) {
+        const intptr_t estimate =
+            total_weight == 0
+                ? live_bytes / num_isolates
+                : static_cast<intptr_t>(static_cast<double>(live_bytes) *
+                                        weight(isolate) / total_weight);
+        isolate->live_bytes_estimate_ = estimate;
+        isolate->live_bytes_estimate_is_exact_ = (num_isolates == 1);
+        isolate->allocated_bytes_at_last_mark_ =
+            isolate->allocated_new_bytes() + isolate->allocated_old_bytes();
+      },
+      /*at_safepoint=*/true);
+}
+
 void Heap::AllocatedExternal(intptr_t size, Space space) {
   ASSERT(Thread::Current()->no_safepoint_scope_depth() == 0);
   if (space == kNew) {
@@ -421,10 +504,38 @@ void Heap::NotifyIdle(int64_t deadline) {
       StartConcurrentMarking(thread);
     }
   }
+
+  // Spend whatever idle time is left on the old-space work in progress, so
+  // less of it lands in the final marking pause or on allocation.
+  old_space_.PerformIdleSlice(deadline);
 }
 
-void Heap::NotifyLowMemory() {
-  CollectMostGarbage(kLowMemory);
+intptr_t Heap::NotifyLowMemory() {
+  Thread* thread = Thread::Current();
+  if (thread->isolate_group() == Dart::vm_isolate()->group()) {
+    return 0;
+  }
+
+  // Evacuate new space into a minimal semi-space and compact old space, so
+  // the memory that is left free is in whole pages.
+  new_space_.ShrinkOnNextScavenge();
+  CollectAllGarbage(kLowMemory);
+
+  // The new-space pages of the old semi-space are cached for reuse by the next
+  // flip; drop them along with the free pages of old space.
+  intptr_t released = SemiSpace::CachedSize();
+  SemiSpace::ClearCache();
+  {
+    SafepointOperationScope safepoint_operation(thread);
+    released += old_space_.ReleaseFreeMemory();
+  }
+#if !defined(PRODUCT)
+  if (FLAG_verbose_gc) {
+    OS::PrintErr("[ %-13.13s, released %" Pd " kB to the OS ]\n",
+                 isolate_group()->source()->name, released / KB);
+  }
+#endif  // !defined(PRODUCT)
+  return released;
 }
 
 void Heap::EvacuateNewSpace(Thread* thread, GCReason reason) {
@@ -480,6 +591,7 @@ void Heap::CollectNewSpaceGarbage(Thread* thread, GCReason reason) {
         CheckStartConcurrentMarking(thread, kPromotion);
       }
     }
+    RunPendingFinalizers(thread);
   }
 }
 
@@ -490,7 +602,7 @@ void Heap::CollectOldSpaceGarbage(Thread* thread,
 
   ASSERT(reason != kNewSpace);
   ASSERT(type != kScavenge);
-  if (FLAG_use_compactor) {
+  if (FLAG_use_compactor || old_space_.NearMemoryLimit()) {
     type = kMarkCompact;
   }
   if (thread->isolate_group() == Dart::vm_isolate()->group()) {
@@ -514,6 +626,8 @@ void Heap::CollectOldSpaceGarbage(Thread* thread,
                                                 : VMTag::kGCOldSpaceTagId);
     TIMELINE_FUNCTION_GC_DURATION_BASIC(thread, "CollectOldGeneration");
     old_space_.CollectGarbage(type == kMarkCompact, true /* finish */);
+    new_space_.allocation_site_feedback()->Reset(isolate_group_);
+    UpdateIsolateLiveEstimates();
     RecordAfterGC(type);
     PrintStats();
     NOT_IN_PRODUCT(PrintStatsToTimeline(&tbes, reason));
@@ -527,6 +641,29 @@ void Heap::CollectOldSpaceGarbage(Thread* thread,
         /*at_safepoint=*/true);
     last_gc_was_old_space_ = true;
     assume_scavenge_will_fail_ = false;
+    RunPendingFinalizers(thread);
+  }
+}
+
+void Heap::RunPendingFinalizers(Thread* thread) {
+  PendingFinalizers* finalizers =
+      isolate_group_->api_state()->pending_finalizers();
+  const intptr_t pending = finalizers->length();
+  if (pending == 0) {
+    return;
+  }
+  isolate_group_->GetFinalizersPendingMaxMetric()->SetValue(pending);
+  int64_t deadline = -1;
+  if (FLAG_finalizer_budget >= 0) {
+    deadline = OS::GetCurrentMonotonicMicros() + FLAG_finalizer_budget;
+  }
+  bool remaining;
+  {
+    TIMELINE_FUNCTION_GC_DURATION(thread, "RunFinalizers");
+    remaining = finalizers->Run(isolate_group_, deadline);
+  }
+  if (remaining) {
+    finalizers->ScheduleTask(isolate_group_);
   }
 }
 
@@ -798,10 +935,14 @@ bool Heap::VerifyGC(MarkExpectation mark_expectation) {
   auto thread = Thread::Current();
   StackZone stack_zone(thread);
 
-  ObjectSet* allocated_set =
-      CreateAllocatedObjectSet(stack_zone.GetZone(), mark_expectation);
-  VerifyPointersVisitor visitor(isolate_group(), allocated_set);
-  VisitObjectPointers(&visitor);
+  HeapVerifier verifier(isolate_group(), stack_zone.GetZone());
+  verifier.AddHeap(this, mark_expectation, /*visit_pointers=*/true);
+  Heap* vm_heap = Dart::vm_isolate()->heap();
+  if (vm_heap != this) {
+    // VM isolate heap is premarked.
+    verifier.AddHeap(vm_heap, kRequireMarked, /*visit_pointers=*/false);
+  }
+  verifier.Verify();
 
   // Only returning a value so that Heap::Validate can be called from an ASSERT.
   return true;
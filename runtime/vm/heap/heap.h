@@ -48,6 +48,9 @@ class Heap {
     kCanonicalHashes,
     kObjectIds,
     kLoadingUnits,
+#if !defined(PRODUCT)
+    kAllocationSamples,
+#endif
     kNumWeakSelectors
   };
 
@@ -125,7 +128,10 @@ class Heap {
 
   void HintFreed(intptr_t size);
   void NotifyIdle(int64_t deadline);
-  void NotifyLowMemory();
+  // Collects all garbage with a compacting GC, shrinks new space to its
+  // initial size and returns the memory left free to the OS. Returns the
+  // number of bytes released.
+  intptr_t NotifyLowMemory();
 
   // Collect a single generation.
   void CollectGarbage(Space space);
@@ -249,6 +255,19 @@ class Heap {
   }
 
   // Used by the GC algorithms to propagate weak entries.
+#if !defined(PRODUCT)
+  // Remembers the Sample::sampled_allocation_id() of a sampled allocation for
+  // as long as its object is alive.
+  void SetAllocationSample(ObjectPtr raw_obj, intptr_t sample_id) {
+    SetWeakEntry(raw_obj, kAllocationSamples, sample_id);
+  }
+  template <typename Visitor>
+  void ForEachAllocationSample(const Visitor& visitor) {
+    new_weak_tables_[kAllocationSamples]->ForEachValue(visitor);
+    old_weak_tables_[kAllocationSamples]->ForEachValue(visitor);
+  }
+#endif  // !defined(PRODUCT)
+
   intptr_t GetWeakEntry(ObjectPtr raw_obj, WeakSelector sel) const;
   void SetWeakEntry(ObjectPtr raw_obj, WeakSelector sel, intptr_t val);
 
@@ -303,11 +322,18 @@ class Heap {
   void PrintHeapMapToJSONStream(Isolate* isolate, JSONStream* stream) {
     old_space_.PrintHeapMapToJSONStream(isolate, stream);
   }
+  void PrintAllocationSiteFeedbackToJSONStream(Isolate* isolate,
+                                               JSONStream* stream) {
+    new_space_.allocation_site_feedback()->PrintToJSONStream(isolate, stream);
+  }
 #endif  // PRODUCT
 
   IsolateGroup* isolate_group() const { return isolate_group_; }
   bool is_vm_isolate() const { return is_vm_isolate_; }
 
+  // The NUMA node new heap pages prefer, or -1 for the default policy.
+  intptr_t numa_node() const { return numa_node_; }
+
   Monitor* barrier() const { return &barrier_; }
   Monitor* barrier_done() const { return &barrier_done_; }
 
@@ -380,6 +406,16 @@ class Heap {
   // Helper functions for garbage collection.
   void CollectNewSpaceGarbage(Thread* thread, GCReason reason);
   void CollectOldSpaceGarbage(Thread* thread, GCType type, GCReason reason);
+
+  // Kills the current isolate if it is alone in its group and the live heap
+  // has gone over FLAG_isolate_soft_limit_mb.
+  void CheckIsolateSoftLimit(Thread* thread);
+  // Splits the live bytes between the isolates of the group after marking.
+  void UpdateIsolateLiveEstimates();
+
+  // Runs the handle finalizers queued by the last GC, within
+  // FLAG_finalizer_budget, and leaves the rest to a background task.
+  void RunPendingFinalizers(Thread* thread);
   void EvacuateNewSpace(Thread* thread, GCReason reason);
 
   // GC stats collection.
@@ -396,6 +432,9 @@ class Heap {
   IsolateGroup* isolate_group_;
   bool is_vm_isolate_;
 
+  // The preferred NUMA node for heap pages (--numa_heap_pages), or -1.
+  intptr_t numa_node_;
+
   // The different spaces used for allocation.
   Scavenger new_space_;
   PageSpace old_space_;
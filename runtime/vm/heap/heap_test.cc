@@ -15,6 +15,8 @@
 #include "vm/globals.h"
 #include "vm/heap/become.h"
 #include "vm/heap/heap.h"
+#include "vm/heap/marker.h"
+#include "vm/heap/safepoint.h"
 #include "vm/message_handler.h"
 #include "vm/object_graph.h"
 #include "vm/port.h"
@@ -730,4 +732,569 @@ ISOLATE_UNIT_TEST_CASE(ArrayTruncationRaces) {
   }
 }
 
+DECLARE_FLAG(int, evacuation_live_percent);
+DECLARE_FLAG(int, evacuation_max_pages);
+DECLARE_FLAG(int, evacuation_pause_budget);
+
+ISOLATE_UNIT_TEST_CASE(PartialEvacuation) {
+  Heap* heap = thread->heap();
+  GCTestHelper::CollectAllGarbage();
+
+  // Fill some pages with arrays that all stay alive.
+  const intptr_t kNumDenseArrays = 16 * 1024;
+  const Array& dense = Array::Handle(Array::New(kNumDenseArrays, Heap::kOld));
+  Array& array = Array::Handle();
+  for (intptr_t i = 0; i < kNumDenseArrays; i++) {
+    array = Array::New(16, Heap::kOld);
+    dense.SetAt(i, array);
+  }
+
+  // Fragment the old generation by keeping every eighth array alive.
+  const intptr_t kNumArrays = 16 * 1024;
+  const intptr_t kLiveRatio = 8;
+  const Array& live = Array::Handle(Array::New(kNumArrays / kLiveRatio));
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    array = Array::New(16, Heap::kOld);
+    array.SetAt(0, Smi::Handle(Smi::New(i)));
+    if ((i % kLiveRatio) == 0) {
+      live.SetAt(i / kLiveRatio, array);
+    }
+  }
+
+  // Remember where the dense arrays are on pages that they fill to more than
+  // the evacuation threshold. Those pages must not be picked.
+  std::map<OldPage*, intptr_t> dense_bytes;
+  for (intptr_t i = 0; i < kNumDenseArrays; i++) {
+    dense_bytes[OldPage::Of(dense.At(i))] += dense.At(i)->ptr()->HeapSize();
+  }
+  MallocGrowableArray<intptr_t> unmovable;
+  MallocGrowableArray<uword> unmovable_addresses;
+  for (intptr_t i = 0; i < kNumDenseArrays; i++) {
+    OldPage* page = OldPage::Of(dense.At(i));
+    const intptr_t capacity = page->object_end() - page->object_start();
+    if (dense_bytes[page] * 100 > capacity * FLAG_evacuation_live_percent) {
+      unmovable.Add(i);
+      unmovable_addresses.Add(static_cast<uword>(dense.At(i)));
+    }
+  }
+  EXPECT(unmovable.length() > 0);
+  MallocGrowableArray<uword> fragmented_addresses;
+  for (intptr_t i = 0; i < kNumArrays / kLiveRatio; i++) {
+    fragmented_addresses.Add(static_cast<uword>(live.At(i)));
+  }
+
+  const intptr_t saved_max_pages = FLAG_evacuation_max_pages;
+  const intptr_t saved_pause_budget = FLAG_evacuation_pause_budget;
+  FLAG_evacuation_max_pages = 1000;
+  FLAG_evacuation_pause_budget = 1000000;
+  const intptr_t compactions_before = heap->old_space()->compactions();
+  GCTestHelper::CollectOldSpace();
+  FLAG_evacuation_max_pages = saved_max_pages;
+  FLAG_evacuation_pause_budget = saved_pause_budget;
+
+  EXPECT_EQ(compactions_before + 1, heap->old_space()->compactions());
+  // Only the fragmented pages were evacuated.
+  for (intptr_t i = 0; i < unmovable.length(); i++) {
+    EXPECT_EQ(unmovable_addresses[i],
+              static_cast<uword>(dense.At(unmovable[i])));
+  }
+  intptr_t moved = 0;
+  for (intptr_t i = 0; i < kNumArrays / kLiveRatio; i++) {
+    if (fragmented_addresses[i] != static_cast<uword>(live.At(i))) {
+      moved++;
+    }
+  }
+  EXPECT(moved > 0);
+  Object& element = Object::Handle();
+  for (intptr_t i = 0; i < kNumArrays / kLiveRatio; i++) {
+    array ^= live.At(i);
+    EXPECT_EQ(16, array.Length());
+    element = array.At(0);
+    EXPECT(element.IsSmi());
+    EXPECT_EQ(i * kLiveRatio, Smi::Cast(element).Value());
+  }
+}
+
+#if !defined(PRODUCT)
+DECLARE_FLAG(bool, pretenure);
+DECLARE_FLAG(int, pretenure_sample_interval);
+DECLARE_FLAG(int, pretenure_min_kb);
+
+TEST_CASE(Pretenuring) {
+  const char* kScriptChars =
+      "class A {\n"
+      "  var a;\n"
+      "  A(this.a);\n"
+      "}\n"
+      "var retained = [];\n"
+      "main() {\n"
+      "  for (var i = 0; i < 200000; i++) {\n"
+      "    retained.add(new A(i));\n"
+      "    retained.add(new List<int>.filled(2, i));\n"
+      "  }\n"
+      "  return new List<int>.filled(2, 0);\n"
+      "}\n";
+  const bool saved_pretenure = FLAG_pretenure;
+  const intptr_t saved_sample_interval = FLAG_pretenure_sample_interval;
+  const intptr_t saved_min_kb = FLAG_pretenure_min_kb;
+  FLAG_pretenure = true;
+  FLAG_pretenure_sample_interval = 2;
+  FLAG_pretenure_min_kb = 1;
+
+  Dart_Handle h_lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  Dart_EnterScope();
+  Dart_Handle result = Dart_Invoke(h_lib, NewString("main"), 0, NULL);
+  EXPECT_VALID(result);
+  {
+    TransitionNativeToVM transition(thread);
+    Library& lib = Library::Handle();
+    lib ^= Api::UnwrapHandle(h_lib);
+    const Class& cls = Class::Handle(GetClass(lib, "A"));
+    SharedClassTable* class_table =
+        thread->isolate_group()->shared_class_table();
+
+    // Every instance of A and every array survives, so both are pretenured
+    // after the first sample. The generic allocation stubs only check the
+    // pretenure bit when --pretenure was set at startup, but the array stub
+    // always does, so the last array is allocated directly in old space.
+    EXPECT(class_table->PretenureFor(cls.id()));
+    EXPECT(!cls.TraceAllocation(thread->isolate()));
+    EXPECT(class_table->PretenureFor(kArrayCid));
+    Instance& instance = Instance::Handle();
+    instance ^= Api::UnwrapHandle(result);
+    EXPECT(instance.IsArray());
+    EXPECT(instance.raw()->IsOldObject());
+
+    // Old-space collections drop the pretenuring decisions.
+    GCTestHelper::CollectOldSpace();
+    EXPECT(!class_table->PretenureFor(cls.id()));
+    EXPECT(!class_table->PretenureFor(kArrayCid));
+  }
+  Dart_ExitScope();
+
+  FLAG_pretenure = saved_pretenure;
+  FLAG_pretenure_sample_interval = saved_sample_interval;
+  FLAG_pretenure_min_kb = saved_min_kb;
+}
+#endif  // !defined(PRODUCT)
+
+ISOLATE_UNIT_TEST_CASE(ParallelLazySweep) {
+  const intptr_t saved_sweeper_tasks = FLAG_sweeper_tasks;
+  const bool saved_lazy_sweep = FLAG_lazy_sweep;
+  FLAG_sweeper_tasks = 4;
+  FLAG_lazy_sweep = true;
+  Heap* heap = thread->heap();
+
+  const intptr_t kNumArrays = 20000;
+  const intptr_t kLength = 30;
+  const Array& retained =
+      Array::Handle(Array::New(kNumArrays / 10, Heap::kOld));
+  Array& array = Array::Handle();
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    array = Array::New(kLength, Heap::kOld);
+    if ((i % 10) == 0) {
+      retained.SetAt(i / 10, array);
+    }
+  }
+
+  // Allocate while the sweeper tasks are running, which sweeps some pages
+  // lazily.
+  heap->CollectGarbage(Heap::kMarkSweep, Heap::kDebugging);
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    array = Array::New(kLength, Heap::kOld);
+  }
+  GCTestHelper::WaitForGCTasks();
+  EXPECT_EQ(PageSpace::kDone, heap->old_space()->phase());
+
+  for (intptr_t i = 0; i < retained.Length(); i++) {
+    array ^= retained.At(i);
+    EXPECT_EQ(kLength, array.Length());
+  }
+  {
+    HeapIterationScope iteration(thread);
+    NoSafepointScope no_safepoint;
+    FindNothing find_nothing;
+    EXPECT(Object::null() == heap->FindObject(&find_nothing));
+  }
+
+  FLAG_sweeper_tasks = saved_sweeper_tasks;
+  FLAG_lazy_sweep = saved_lazy_sweep;
+}
+
+DECLARE_FLAG(bool, old_gen_tlabs);
+
+ISOLATE_UNIT_TEST_CASE(OldSpaceTLAB) {
+  const bool saved_old_gen_tlabs = FLAG_old_gen_tlabs;
+  FLAG_old_gen_tlabs = true;
+  Heap* heap = thread->heap();
+  const intptr_t kLength = 8;
+
+  // Allocate until the thread takes a new buffer.
+  Array& array = Array::Handle();
+  const uword end = thread->old_end();
+  for (intptr_t i = 0; (i < 100000) && (thread->old_end() == end); i++) {
+    array = Array::New(kLength, Heap::kOld);
+  }
+  EXPECT(thread->old_end() != end);
+
+  // Further small allocations are bump allocated from the buffer.
+  const Array& first = Array::Handle(Array::New(kLength, Heap::kOld));
+  const Array& second = Array::Handle(Array::New(kLength, Heap::kOld));
+  const intptr_t size = first.raw()->ptr()->HeapSize();
+  EXPECT_EQ(ObjectLayout::ToAddr(first.raw()) + size,
+            ObjectLayout::ToAddr(second.raw()));
+  EXPECT_EQ(ObjectLayout::ToAddr(second.raw()) + size, thread->old_top());
+
+  // The unused part of the buffer can be walked.
+  {
+    HeapIterationScope iteration(thread);
+    NoSafepointScope no_safepoint;
+    FindNothing find_nothing;
+    EXPECT(Object::null() == heap->FindObject(&find_nothing));
+  }
+
+  // Collections take the buffer away from the thread.
+  GCTestHelper::CollectOldSpace();
+  EXPECT(thread->old_end() == 0);
+  EXPECT_EQ(kLength, first.Length());
+  EXPECT_EQ(kLength, second.Length());
+
+  FLAG_old_gen_tlabs = saved_old_gen_tlabs;
+}
+
+class MarkerTestHelper {
+ public:
+  static intptr_t ResetSlices(GCMarker* marker) {
+    marker->ResetSlices();
+    return marker->root_slices_count_;
+  }
+  static void IterateRoots(GCMarker* marker, ObjectPointerVisitor* visitor) {
+    marker->IterateRoots(visitor);
+  }
+};
+
+// Records the root slots it is given. On the first one, it lets the next
+// collector claim root slices, as another marker task would while this one
+// is still busy with its slice.
+class RootSlotCollector : public ObjectPointerVisitor {
+ public:
+  RootSlotCollector(IsolateGroup* isolate_group,
+                    GCMarker* marker,
+                    RootSlotCollector* next)
+      : ObjectPointerVisitor(isolate_group), marker_(marker), next_(next) {}
+
+  void VisitPointers(ObjectPtr* first, ObjectPtr* last) {
+    for (ObjectPtr* current = first; current <= last; current++) {
+      slots_.Add(current);
+    }
+    if (next_ != nullptr) {
+      RootSlotCollector* next = next_;
+      next_ = nullptr;
+      MarkerTestHelper::IterateRoots(marker_, next);
+    }
+  }
+
+  const MallocGrowableArray<ObjectPtr*>& slots() const { return slots_; }
+
+  bool Contains(ObjectPtr* slot) const {
+    for (intptr_t i = 0; i < slots_.length(); i++) {
+      if (slots_[i] == slot) return true;
+    }
+    return false;
+  }
+
+  bool ContainsValue(ObjectPtr value) const {
+    for (intptr_t i = 0; i < slots_.length(); i++) {
+      if (*slots_[i] == value) return true;
+    }
+    return false;
+  }
+
+ private:
+  GCMarker* marker_;
+  RootSlotCollector* next_;
+  MallocGrowableArray<ObjectPtr*> slots_;
+};
+
+static void CountRootSlots(const RootSlotCollector& collector,
+                           std::map<ObjectPtr*, intptr_t>* counts) {
+  for (intptr_t i = 0; i < collector.slots().length(); i++) {
+    (*counts)[collector.slots()[i]]++;
+  }
+}
+
+ISOLATE_UNIT_TEST_CASE(MarkRootSlices) {
+  Heap* heap = thread->heap();
+  IsolateGroup* isolate_group = thread->isolate_group();
+  ApiState* state = isolate_group->api_state();
+  heap->CollectAllGarbage();
+
+  // Reachable only from a persistent handle and from this thread's zone
+  // handles respectively, which are in different root slices.
+  PersistentHandle* persistent = state->AllocatePersistentHandle();
+  persistent->set_raw(Array::New(10, Heap::kOld));
+  const Array& local = Array::Handle(Array::New(10, Heap::kOld));
+
+  {
+    SafepointOperationScope safepoint(thread);
+    GCMarker marker(isolate_group, heap);
+
+    // All the roots, as visited by a single task.
+    MarkerTestHelper::ResetSlices(&marker);
+    RootSlotCollector all(isolate_group, &marker, nullptr);
+    MarkerTestHelper::IterateRoots(&marker, &all);
+    std::map<ObjectPtr*, intptr_t> expected;
+    CountRootSlots(all, &expected);
+
+    // More tasks than slices, each claiming slices while the previous ones
+    // are still visiting theirs.
+    const intptr_t num_slices = MarkerTestHelper::ResetSlices(&marker);
+    const intptr_t num_collectors = num_slices + 2;
+    RootSlotCollector** collectors = new RootSlotCollector*[num_collectors];
+    RootSlotCollector* next = nullptr;
+    for (intptr_t i = num_collectors - 1; i >= 0; i--) {
+      collectors[i] = new RootSlotCollector(isolate_group, &marker, next);
+      next = collectors[i];
+    }
+    MarkerTestHelper::IterateRoots(&marker, collectors[0]);
+
+    // Every root is visited exactly once, by one of the tasks.
+    std::map<ObjectPtr*, intptr_t> visited;
+    intptr_t busy_collectors = 0;
+    intptr_t persistent_index = -1;
+    intptr_t local_index = -1;
+    for (intptr_t i = 0; i < num_collectors; i++) {
+      CountRootSlots(*collectors[i], &visited);
+      if (collectors[i]->slots().length() > 0) {
+        busy_collectors++;
+      }
+      if (collectors[i]->Contains(persistent->raw_addr())) {
+        persistent_index = i;
+      }
+      if (collectors[i]->ContainsValue(local.raw())) {
+        local_index = i;
+      }
+    }
+    EXPECT(expected == visited);
+    for (auto it = visited.begin(); it != visited.end(); ++it) {
+      EXPECT_EQ(1, it->second);
+    }
+
+    // The group's roots, the persistent handles and the isolate's roots were
+    // each visited by a different task.
+    EXPECT(busy_collectors >= 3);
+    EXPECT(persistent_index != -1);
+    EXPECT(local_index != -1);
+    EXPECT(persistent_index != local_index);
+
+    for (intptr_t i = 0; i < num_collectors; i++) {
+      delete collectors[i];
+    }
+    delete[] collectors;
+  }
+  state->FreePersistentHandle(persistent);
+}
+
+DECLARE_FLAG(bool, idle_gc_slices);
+
+// Idle slices check the clock once per page or marking block, so they may
+// overrun the deadline by about that much work.
+static const int64_t kIdleSliceSlackMicros = 10000;
+
+ISOLATE_UNIT_TEST_CASE(IdleSliceMarking) {
+  const bool saved_idle_gc_slices = FLAG_idle_gc_slices;
+  const intptr_t saved_marker_tasks = FLAG_marker_tasks;
+  FLAG_idle_gc_slices = true;
+  FLAG_marker_tasks = 2;
+  Heap* heap = thread->heap();
+  PageSpace* old_space = heap->old_space();
+  GCTestHelper::CollectAllGarbage();
+
+  // An old-space chain that is unreachable while the concurrent marker runs.
+  const intptr_t kChainLength = 100000;
+  const Array& root = Array::Handle(Array::New(1, Heap::kOld));
+  Array& array = Array::Handle();
+  Array& next = Array::Handle();
+  for (intptr_t i = 0; i < kChainLength; i++) {
+    array = Array::New(1, Heap::kOld);
+    array.SetAt(0, next);
+    next = array.raw();
+  }
+  const ArrayPtr head = array.raw();
+  array = Array::null();
+  next = Array::null();
+
+  heap->StartConcurrentMarking(thread);
+  {
+    MonitorLocker ml(old_space->tasks_lock());
+    while (old_space->phase() == PageSpace::kMarking) {
+      ml.WaitWithSafepointCheck(thread);
+    }
+  }
+  EXPECT_EQ(PageSpace::kAwaitingFinalization, old_space->phase());
+  EXPECT(!head->ptr()->IsMarked());
+
+  // Reviving the chain leaves its head on the marking stack for the final
+  // pause, unless an idle slice gets to it first.
+  array = head;
+  root.SetAt(0, array);
+  thread->MarkingStackBlockProcess();
+
+  int64_t deadline = OS::GetCurrentMonotonicMicros() + 1000;
+  old_space->PerformIdleSlice(deadline);
+  EXPECT_LE(OS::GetCurrentMonotonicMicros(), deadline + kIdleSliceSlackMicros);
+  EXPECT_EQ(PageSpace::kAwaitingFinalization, old_space->phase());
+  next ^= array.At(0);
+  EXPECT(next.raw()->ptr()->IsMarked());
+
+  deadline = OS::GetCurrentMonotonicMicros() + 10 * kMicrosecondsPerSecond;
+  old_space->PerformIdleSlice(deadline);
+  intptr_t marked = 0;
+  for (array ^= root.At(0); !array.IsNull(); array ^= array.At(0)) {
+    if (array.raw()->ptr()->IsMarked()) {
+      marked++;
+    }
+  }
+  EXPECT_EQ(kChainLength, marked);
+
+  GCTestHelper::WaitForGCTasks();
+  intptr_t length = 0;
+  for (array ^= root.At(0); !array.IsNull(); array ^= array.At(0)) {
+    length++;
+  }
+  EXPECT_EQ(kChainLength, length);
+
+  FLAG_idle_gc_slices = saved_idle_gc_slices;
+  FLAG_marker_tasks = saved_marker_tasks;
+}
+
+ISOLATE_UNIT_TEST_CASE(IdleSliceSweeping) {
+  const bool saved_idle_gc_slices = FLAG_idle_gc_slices;
+  const intptr_t saved_sweeper_tasks = FLAG_sweeper_tasks;
+  const bool saved_lazy_sweep = FLAG_lazy_sweep;
+  FLAG_idle_gc_slices = true;
+  FLAG_sweeper_tasks = 1;
+  FLAG_lazy_sweep = false;
+  Heap* heap = thread->heap();
+  PageSpace* old_space = heap->old_space();
+
+  // The sweeper task may take every page before the mutator gets one, so
+  // try a few collections.
+  intptr_t idle_swept = 0;
+  Array& array = Array::Handle();
+  for (intptr_t attempt = 0; (attempt < 10) && (idle_swept == 0); attempt++) {
+    // Garbage on many regular pages, and on large pages that the single
+    // sweeper task sweeps first.
+    for (intptr_t i = 0; i < 50000; i++) {
+      array = Array::New(30, Heap::kOld);
+    }
+    for (intptr_t i = 0; i < 32; i++) {
+      array = Array::New(128 * KB, Heap::kOld);
+    }
+    array = Array::null();
+
+    heap->CollectGarbage(Heap::kMarkSweep, Heap::kDebugging);
+    while ((old_space->phase() == PageSpace::kSweepingLarge) ||
+           (old_space->phase() == PageSpace::kSweepingRegular)) {
+      const int64_t deadline = OS::GetCurrentMonotonicMicros() + 100;
+      old_space->PerformIdleSlice(deadline);
+      EXPECT_LE(OS::GetCurrentMonotonicMicros(),
+                deadline + kIdleSliceSlackMicros);
+      if (old_space->sweep_work_list()->Exhausted()) {
+        break;
+      }
+    }
+    GCTestHelper::WaitForGCTasks();
+    EXPECT_EQ(PageSpace::kDone, old_space->phase());
+    idle_swept = old_space->sweep_work_list()->lazily_swept();
+  }
+  EXPECT(idle_swept > 0);
+
+  FLAG_idle_gc_slices = saved_idle_gc_slices;
+  FLAG_sweeper_tasks = saved_sweeper_tasks;
+  FLAG_lazy_sweep = saved_lazy_sweep;
+}
+
+ISOLATE_UNIT_TEST_CASE(IsolateAllocationAccounting) {
+  Isolate* isolate = thread->isolate();
+  const intptr_t new_before = isolate->allocated_new_bytes();
+  const intptr_t old_before = isolate->allocated_old_bytes();
+
+  Array::Handle(Array::New(100, Heap::kOld));
+  EXPECT_EQ(old_before + Array::InstanceSize(100),
+            isolate->allocated_old_bytes());
+
+  Array::Handle(Array::New(100, Heap::kNew));
+  // New-space bytes are counted when the allocation buffer is given up.
+  GCTestHelper::CollectNewSpace();
+  EXPECT_LE(new_before + Array::InstanceSize(100),
+            isolate->allocated_new_bytes());
+
+  GCTestHelper::CollectOldSpace();
+  EXPECT_LT(0, isolate->live_bytes_estimate());
+  // The test isolate is alone in its group, so all live bytes are its own.
+  EXPECT(isolate->live_bytes_estimate_is_exact());
+}
+
+ISOLATE_UNIT_TEST_CASE(ParallelSampledHeapVerification) {
+  Heap* heap = thread->isolate_group()->heap();
+  for (intptr_t i = 0; i < 100; i++) {
+    Array::New(10, Heap::kOld);
+  }
+
+  SetFlagScope<int> sfs_tasks(&FLAG_verify_gc_tasks, 4);
+  {
+    HeapIterationScope iteration(thread);
+    StackZone zone(thread);
+    HeapVerifier verifier(thread->isolate_group(), zone.GetZone());
+    verifier.AddHeap(heap, kForbidMarked, /*visit_pointers=*/true);
+    verifier.Verify();
+    EXPECT_LT(0, verifier.num_ranges());
+    EXPECT_EQ(verifier.num_ranges(), verifier.num_sampled_ranges());
+  }
+  {
+    SetFlagScope<int> sfs_sample(&FLAG_verify_gc_sample_percent, 0);
+    HeapIterationScope iteration(thread);
+    StackZone zone(thread);
+    HeapVerifier verifier(thread->isolate_group(), zone.GetZone());
+    verifier.AddHeap(heap, kForbidMarked, /*visit_pointers=*/true);
+    verifier.Verify();
+    EXPECT_EQ(0, verifier.num_sampled_ranges());
+  }
+  EXPECT(heap->Verify());
+}
+
+ISOLATE_UNIT_TEST_CASE(NotifyLowMemory) {
+  Heap* heap = thread->heap();
+  const Array& live = Array::Handle(Array::New(1024, Heap::kOld));
+  Array& array = Array::Handle();
+  for (intptr_t i = 0; i < 16 * 1024; i++) {
+    array = Array::New(16, (i % 2) == 0 ? Heap::kOld : Heap::kNew);
+    if ((i % 16) == 0) {
+      array.SetAt(0, Smi::Handle(Smi::New(i)));
+      live.SetAt(i / 16, array);
+    }
+  }
+  array = Array::null();
+
+  const intptr_t released = heap->NotifyLowMemory();
+  EXPECT_LE(0, released);
+  EXPECT_EQ(0, heap->new_space()->UsedInWords());
+  EXPECT_LE(heap->new_space()->CapacityInWords(),
+            FLAG_new_gen_semi_initial_size * MBInWords);
+
+  // Released pages are zero-filled or keep their contents; either way the
+  // heap must stay intact and allocatable.
+  Object& element = Object::Handle();
+  for (intptr_t i = 0; i < 1024; i++) {
+    array ^= live.At(i);
+    element = array.At(0);
+    EXPECT_EQ(i * 16, Smi::Cast(element).Value());
+  }
+  for (intptr_t i = 0; i < 1024; i++) {
+    array = Array::New(16, Heap::kOld);
+  }
+  EXPECT(heap->Verify());
+}
+
 }  // namespace dart
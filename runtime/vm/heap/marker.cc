@@ -28,15 +28,23 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
   MarkingVisitorBase(IsolateGroup* isolate_group,
                      PageSpace* page_space,
                      MarkingStack* marking_stack,
-                     MarkingStack* deferred_marking_stack)
+                     MarkingStack* deferred_marking_stack,
+                     MarkingStack* precleaned_marking_stack,
+                     BlockDeques<MarkingStackBlock>* marking_deques,
+                     intptr_t task_index)
       : ObjectPointerVisitor(isolate_group),
         thread_(Thread::Current()),
         page_space_(page_space),
-        work_list_(marking_stack),
+        work_list_(marking_stack, marking_deques, task_index),
         deferred_work_list_(deferred_marking_stack),
+        precleaned_work_list_(precleaned_marking_stack),
         delayed_weak_properties_(nullptr),
         marked_bytes_(0),
-        marked_micros_(0) {
+        marked_micros_(0),
+        idle_micros_(0),
+        count_live_bytes_(FLAG_evacuation_max_pages > 0),
+        live_page_(nullptr),
+        live_page_bytes_(0) {
     ASSERT(thread_->isolate_group() == isolate_group);
   }
   ~MarkingVisitorBase() {}
@@ -44,6 +52,13 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
   uintptr_t marked_bytes() const { return marked_bytes_; }
   int64_t marked_micros() const { return marked_micros_; }
   void AddMicros(int64_t micros) { marked_micros_ += micros; }
+  intptr_t steals() const { return work_list_.steals(); }
+  int64_t idle_micros() const { return idle_micros_; }
+  void AddIdleMicros(int64_t micros) { idle_micros_ += micros; }
+
+  // Whether any marking work is available, including work this visitor can
+  // steal from other tasks.
+  bool HasWork() { return !work_list_.IsEmpty(); }
 
   bool ProcessPendingWeakProperties() {
     bool marked = false;
@@ -95,6 +110,7 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
           size = ProcessWeakProperty(raw_weak, /* did_mark */ true);
         }
         marked_bytes_ += size;
+        AddLiveBytes(raw_obj, size);
 
         raw_obj = work_list_.Pop();
       } while (raw_obj != nullptr);
@@ -106,6 +122,41 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
       // by the handling of weak properties.
       raw_obj = work_list_.Pop();
     } while (raw_obj != nullptr);
+    FlushLiveBytes();
+  }
+
+  // Like DrainMarkingStack, but checks the clock every block's worth of
+  // objects and returns false if [deadline] passes before the stack is
+  // drained. The remaining work stays in this visitor's work list.
+  bool DrainMarkingStackWithDeadline(int64_t deadline) {
+    intptr_t visited = 0;
+    for (;;) {
+      ObjectPtr raw_obj = work_list_.Pop();
+      if (raw_obj == nullptr) {
+        ProcessPendingWeakProperties();
+        raw_obj = work_list_.Pop();
+        if (raw_obj == nullptr) {
+          FlushLiveBytes();
+          return true;
+        }
+      }
+      const intptr_t class_id = raw_obj->GetClassId();
+      intptr_t size;
+      if (class_id != kWeakPropertyCid) {
+        size = raw_obj->ptr()->VisitPointersNonvirtual(this);
+      } else {
+        WeakPropertyPtr raw_weak = static_cast<WeakPropertyPtr>(raw_obj);
+        size = ProcessWeakProperty(raw_weak, /* did_mark */ true);
+      }
+      marked_bytes_ += size;
+      AddLiveBytes(raw_obj, size);
+
+      if (((++visited % kMarkingStackBlockSize) == 0) &&
+          (OS::GetCurrentMonotonicMicros() >= deadline)) {
+        FlushLiveBytes();
+        return false;
+      }
+    }
   }
 
   // Races: The concurrent marker is racing with the mutator, but this race is
@@ -156,28 +207,37 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
   void ProcessDeferredMarking() {
     ObjectPtr raw_obj;
     while ((raw_obj = deferred_work_list_.Pop()) != nullptr) {
-      ASSERT(raw_obj->IsHeapObject() && raw_obj->IsOldObject());
-      // N.B. We are scanning the object even if it is already marked.
-      bool did_mark = TryAcquireMarkBit(raw_obj);
-      const intptr_t class_id = raw_obj->GetClassId();
-      intptr_t size;
-      if (class_id != kWeakPropertyCid) {
-        size = raw_obj->ptr()->VisitPointersNonvirtual(this);
-      } else {
-        WeakPropertyPtr raw_weak = static_cast<WeakPropertyPtr>(raw_obj);
-        size = ProcessWeakProperty(raw_weak, did_mark);
-      }
-      // Add the size only if we win the marking race to prevent
-      // double-counting.
-      if (did_mark) {
-        marked_bytes_ += size;
+      ScanDeferred(raw_obj);
+    }
+    while ((raw_obj = precleaned_work_list_.Pop()) != nullptr) {
+      ScanDeferred(raw_obj);
+    }
+    FlushLiveBytes();
+  }
+
+  // Called by the concurrent marker: scan the objects deferred so far, so
+  // that by the final pause most of what they reference is already marked and
+  // rescanning them is cheap. Instructions may be on non-writable pages and
+  // are left for the final pause.
+  intptr_t PrecleanDeferredMarking() {
+    ASSERT(sync);
+    intptr_t precleaned = 0;
+    ObjectPtr raw_obj;
+    while ((raw_obj = deferred_work_list_.Pop()) != nullptr) {
+      if (raw_obj->GetClassId() != kInstructionsCid) {
+        ScanDeferred(raw_obj);
+        precleaned++;
       }
+      precleaned_work_list_.Push(raw_obj);
     }
+    FlushLiveBytes();
+    return precleaned;
   }
 
   void FinalizeDeferredMarking() {
     ProcessDeferredMarking();
     deferred_work_list_.Finalize();
+    precleaned_work_list_.Finalize();
   }
 
   // Called when all marking is complete.
@@ -201,9 +261,30 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
   void AbandonWork() {
     work_list_.AbandonWork();
     deferred_work_list_.AbandonWork();
+    precleaned_work_list_.AbandonWork();
   }
 
  private:
+  void ScanDeferred(ObjectPtr raw_obj) {
+    ASSERT(raw_obj->IsHeapObject() && raw_obj->IsOldObject());
+    // N.B. We are scanning the object even if it is already marked.
+    bool did_mark = TryAcquireMarkBit(raw_obj);
+    const intptr_t class_id = raw_obj->GetClassId();
+    intptr_t size;
+    if (class_id != kWeakPropertyCid) {
+      size = raw_obj->ptr()->VisitPointersNonvirtual(this);
+    } else {
+      WeakPropertyPtr raw_weak = static_cast<WeakPropertyPtr>(raw_obj);
+      size = ProcessWeakProperty(raw_weak, did_mark);
+    }
+    // Add the size only if we win the marking race to prevent
+    // double-counting.
+    if (did_mark) {
+      marked_bytes_ += size;
+      AddLiveBytes(raw_obj, size);
+    }
+  }
+
   void PushMarked(ObjectPtr raw_obj) {
     ASSERT(raw_obj->IsHeapObject());
     ASSERT(raw_obj->IsOldObject());
@@ -213,6 +294,31 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
     work_list_.Push(raw_obj);
   }
 
+  // Per-page live bytes are only used to select pages for partial
+  // evacuation. They are summed per visitor while consecutive objects come
+  // from the same page and added to the page in one step.
+  void AddLiveBytes(ObjectPtr raw_obj, intptr_t size) {
+    if (!count_live_bytes_) {
+      return;
+    }
+    OldPage* page = OldPage::Of(raw_obj);
+    if (page != live_page_) {
+      FlushLiveBytes();
+      live_page_ = page;
+    }
+    live_page_bytes_ += size;
+  }
+
+  // Only regular data pages are evacuated; code pages may be
+  // write-protected.
+  void FlushLiveBytes() {
+    if ((live_page_ != nullptr) && (live_page_->type() == OldPage::kData)) {
+      live_page_->AddLiveBytes(live_page_bytes_);
+    }
+    live_page_ = nullptr;
+    live_page_bytes_ = 0;
+  }
+
   static bool TryAcquireMarkBit(ObjectPtr raw_obj) {
     if (FLAG_write_protect_code && raw_obj->IsInstructions()) {
       // A non-writable alias mapping may exist for instruction pages.
@@ -266,9 +372,14 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
   PageSpace* page_space_;
   MarkerWorkList work_list_;
   MarkerWorkList deferred_work_list_;
+  MarkerWorkList precleaned_work_list_;
   WeakPropertyPtr delayed_weak_properties_;
   uintptr_t marked_bytes_;
   int64_t marked_micros_;
+  int64_t idle_micros_;
+  const bool count_live_bytes_;
+  OldPage* live_page_;
+  intptr_t live_page_bytes_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(MarkingVisitorBase);
 };
@@ -317,8 +428,10 @@ void GCMarker::Prologue() {
 void GCMarker::Epilogue() {}
 
 enum RootSlices {
-  kIsolate = 0,
-  kNumFixedRootSlices = 1,
+  kIsolateGroup = 0,
+  kPersistentHandles,
+  kThreads,
+  kNumFixedRootSlices,
 };
 
 void GCMarker::ResetSlices() {
@@ -326,7 +439,11 @@ void GCMarker::ResetSlices() {
 
   root_slices_started_ = 0;
   root_slices_finished_ = 0;
-  root_slices_count_ = kNumFixedRootSlices;
+  root_isolates_.Clear();
+  isolate_group_->ForEachIsolate(
+      [&](Isolate* isolate) { root_isolates_.Add(isolate); },
+      /*at_safepoint=*/true);
+  root_slices_count_ = kNumFixedRootSlices + root_isolates_.length();
   new_page_ = heap_->new_space()->head();
   for (NewPage* p = new_page_; p != nullptr; p = p->next()) {
     root_slices_count_++;
@@ -343,14 +460,43 @@ void GCMarker::IterateRoots(ObjectPointerVisitor* visitor) {
     }
 
     switch (slice) {
-      case kIsolate: {
+      case kIsolateGroup: {
         TIMELINE_FUNCTION_GC_DURATION(Thread::Current(),
                                       "ProcessIsolateGroupRoots");
-        isolate_group_->VisitObjectPointers(
-            visitor, ValidationPolicy::kDontValidateFrames);
+        isolate_group_->VisitSharedPointers(visitor);
+        break;
+      }
+      case kPersistentHandles: {
+        TIMELINE_FUNCTION_GC_DURATION(Thread::Current(),
+                                      "ProcessPersistentHandles");
+        isolate_group_->api_state()->VisitObjectPointersUnlocked(visitor);
+        break;
+      }
+      case kThreads: {
+        TIMELINE_FUNCTION_GC_DURATION(Thread::Current(), "ProcessThreads");
+        // All threads but the mutators, which are visited with their
+        // isolates.
+        isolate_group_->thread_registry()->VisitObjectPointers(
+            isolate_group_, visitor, ValidationPolicy::kDontValidateFrames);
         break;
       }
       default: {
+        const intptr_t isolate_index = slice - kNumFixedRootSlices;
+        if (isolate_index < root_isolates_.length()) {
+          TIMELINE_FUNCTION_GC_DURATION(Thread::Current(),
+                                        "ProcessIsolateRoots");
+          Isolate* isolate = root_isolates_[isolate_index];
+          isolate->VisitObjectPointers(visitor,
+                                       ValidationPolicy::kDontValidateFrames);
+          // Visit the mutator thread, even if the isolate isn't scheduled
+          // (there might be live API handles to visit).
+          Thread* mutator_thread = isolate->mutator_thread();
+          if (mutator_thread != nullptr) {
+            mutator_thread->VisitObjectPointers(
+                visitor, ValidationPolicy::kDontValidateFrames);
+          }
+          break;
+        }
         NewPage* page;
         {
           MonitorLocker ml(&root_slices_monitor_);
@@ -371,18 +517,20 @@ void GCMarker::IterateRoots(ObjectPointerVisitor* visitor) {
   }
 }
 
+// Followed by one slice per weak table.
 enum WeakSlices {
   kWeakHandles = 0,
-  kWeakTables,
   kObjectIdRing,
   kRememberedSet,
-  kNumWeakSlices,
+  kNumFixedWeakSlices,
 };
 
 void GCMarker::IterateWeakRoots(Thread* thread) {
+  const intptr_t num_weak_slices =
+      kNumFixedWeakSlices + Heap::kNumWeakSelectors;
   for (;;) {
     intptr_t slice = weak_slices_started_.fetch_add(1);
-    if (slice >= kNumWeakSlices) {
+    if (slice >= num_weak_slices) {
       return;  // No more slices.
     }
 
@@ -390,9 +538,6 @@ void GCMarker::IterateWeakRoots(Thread* thread) {
       case kWeakHandles:
         ProcessWeakHandles(thread);
         break;
-      case kWeakTables:
-        ProcessWeakTables(thread);
-        break;
       case kObjectIdRing:
         ProcessObjectIdTable(thread);
         break;
@@ -400,7 +545,8 @@ void GCMarker::IterateWeakRoots(Thread* thread) {
         ProcessRememberedSet(thread);
         break;
       default:
-        UNREACHABLE();
+        ProcessWeakTable(thread, slice - kNumFixedWeakSlices);
+        break;
     }
   }
 }
@@ -413,21 +559,20 @@ void GCMarker::ProcessWeakHandles(Thread* thread) {
   isolate_group_->VisitWeakPersistentHandles(&visitor);
 }
 
-void GCMarker::ProcessWeakTables(Thread* thread) {
-  TIMELINE_FUNCTION_GC_DURATION(thread, "ProcessWeakTables");
-  for (int sel = 0; sel < Heap::kNumWeakSelectors; sel++) {
-    WeakTable* table =
-        heap_->GetWeakTable(Heap::kOld, static_cast<Heap::WeakSelector>(sel));
-    intptr_t size = table->size();
-    for (intptr_t i = 0; i < size; i++) {
-      if (table->IsValidEntryAtExclusive(i)) {
-        ObjectPtr raw_obj = table->ObjectAtExclusive(i);
-        if (raw_obj->IsHeapObject() && !raw_obj->ptr()->IsMarked()) {
-          table->InvalidateAtExclusive(i);
-        }
+void GCMarker::ProcessWeakTable(Thread* thread, intptr_t sel) {
+  TIMELINE_FUNCTION_GC_DURATION(thread, "ProcessWeakTable");
+  WeakTable* table =
+      heap_->GetWeakTable(Heap::kOld, static_cast<Heap::WeakSelector>(sel));
+  intptr_t size = table->size();
+  for (intptr_t i = 0; i < size; i++) {
+    if (table->IsValidEntryAtExclusive(i)) {
+      ObjectPtr raw_obj = table->ObjectAtExclusive(i);
+      if (raw_obj->IsHeapObject() && !raw_obj->ptr()->IsMarked()) {
+        table->InvalidateAtExclusive(i);
       }
     }
   }
+  table->ReleaseRetiredExclusive();
 }
 
 void GCMarker::ProcessRememberedSet(Thread* thread) {
@@ -489,13 +634,11 @@ class ParallelMarkTask : public ThreadPool::Task {
  public:
   ParallelMarkTask(GCMarker* marker,
                    IsolateGroup* isolate_group,
-                   MarkingStack* marking_stack,
                    ThreadBarrier* barrier,
                    SyncMarkingVisitor* visitor,
                    RelaxedAtomic<uintptr_t>* num_busy)
       : marker_(marker),
         isolate_group_(isolate_group),
-        marking_stack_(marking_stack),
         barrier_(barrier),
         visitor_(visitor),
         num_busy_(num_busy) {}
@@ -536,8 +679,11 @@ class ParallelMarkTask : public ThreadPool::Task {
           // Wait for some work to appear.
           // TODO(40695): Replace busy-waiting with a solution using Monitor,
           // and redraw the boundaries between stack/visitor/task as needed.
-          while (marking_stack_->IsEmpty() && num_busy_->load() > 0) {
+          int64_t idle_start = OS::GetCurrentMonotonicMicros();
+          while (!visitor_->HasWork() && num_busy_->load() > 0) {
           }
+          visitor_->AddIdleMicros(OS::GetCurrentMonotonicMicros() -
+                                  idle_start);
 
           // If no tasks are busy, there will never be more work.
           if (num_busy_->load() == 0) break;
@@ -588,8 +734,10 @@ class ParallelMarkTask : public ThreadPool::Task {
       int64_t stop = OS::GetCurrentMonotonicMicros();
       visitor_->AddMicros(stop - start);
       if (FLAG_log_marker_tasks) {
-        THR_Print("Task marked %" Pd " bytes in %" Pd64 " micros.\n",
-                  visitor_->marked_bytes(), visitor_->marked_micros());
+        THR_Print("Task marked %" Pd " bytes in %" Pd64 " micros, stole %" Pd
+                  " blocks, idle %" Pd64 " micros.\n",
+                  visitor_->marked_bytes(), visitor_->marked_micros(),
+                  visitor_->steals(), visitor_->idle_micros());
       }
       marker_->FinalizeResultsFrom(visitor_);
 
@@ -600,7 +748,6 @@ class ParallelMarkTask : public ThreadPool::Task {
  private:
   GCMarker* marker_;
   IsolateGroup* isolate_group_;
-  MarkingStack* marking_stack_;
   ThreadBarrier* barrier_;
   SyncMarkingVisitor* visitor_;
   RelaxedAtomic<uintptr_t>* num_busy_;
@@ -634,12 +781,20 @@ class ConcurrentMarkTask : public ThreadPool::Task {
 
       marker_->IterateRoots(visitor_);
 
+      visitor_->DrainMarkingStack();
+
+      // Shorten the final pause by scanning what the mutator has deferred so
+      // far, then marking what that reaches.
+      const intptr_t precleaned = visitor_->PrecleanDeferredMarking();
       visitor_->DrainMarkingStack();
       int64_t stop = OS::GetCurrentMonotonicMicros();
       visitor_->AddMicros(stop - start);
       if (FLAG_log_marker_tasks) {
-        THR_Print("Task marked %" Pd " bytes in %" Pd64 " micros.\n",
-                  visitor_->marked_bytes(), visitor_->marked_micros());
+        THR_Print("Task marked %" Pd " bytes in %" Pd64 " micros, stole %" Pd
+                  " blocks, idle %" Pd64 " micros.\n",
+                  visitor_->marked_bytes(), visitor_->marked_micros(),
+                  visitor_->steals(), visitor_->idle_micros());
+        THR_Print("Task precleaned %" Pd " deferred objects.\n", precleaned);
       }
     }
 
@@ -699,6 +854,7 @@ GCMarker::GCMarker(IsolateGroup* isolate_group, Heap* heap)
     : isolate_group_(isolate_group),
       heap_(heap),
       marking_stack_(),
+      marking_deques_(FLAG_marker_tasks),
       visitors_(),
       marked_bytes_(0),
       marked_micros_(0) {
@@ -742,8 +898,11 @@ void GCMarker::StartConcurrentMark(PageSpace* page_space) {
   ResetSlices();
   for (intptr_t i = 0; i < num_tasks; i++) {
     ASSERT(visitors_[i] == NULL);
-    visitors_[i] = new SyncMarkingVisitor(
-        isolate_group_, page_space, &marking_stack_, &deferred_marking_stack_);
+    visitors_[i] = new SyncMarkingVisitor(isolate_group_, page_space,
+                                          &marking_stack_,
+                                          &deferred_marking_stack_,
+                                          &precleaned_marking_stack_,
+                                          &marking_deques_, i);
 
     // Begin marking on a helper thread.
     bool result = Dart::thread_pool()->Run<ConcurrentMarkTask>(
@@ -760,6 +919,40 @@ void GCMarker::StartConcurrentMark(PageSpace* page_space) {
   }
 }
 
+bool GCMarker::IncrementalMarkWithTimeBudget(PageSpace* page_space,
+                                             int64_t deadline) {
+#if defined(DEBUG)
+  {
+    MonitorLocker ml(page_space->tasks_lock());
+    ASSERT(page_space->phase() == PageSpace::kAwaitingFinalization);
+  }
+#endif
+  if ((FLAG_marker_tasks == 0) || (visitors_[0] == NULL)) {
+    return false;
+  }
+  // No concurrent marker task is running, so the mutator can borrow the
+  // first task's visitor. Its unfinished work and pending weak properties
+  // are picked up by MarkObjects.
+  SyncMarkingVisitor* visitor = visitors_[0];
+#if defined(SUPPORT_TIMELINE)
+  Thread* thread = Thread::Current();
+#endif
+  TIMELINE_FUNCTION_GC_DURATION(thread, "IncrementalMark");
+  const int64_t start = OS::GetCurrentMonotonicMicros();
+  const intptr_t precleaned = visitor->PrecleanDeferredMarking();
+  const uintptr_t marked_before = visitor->marked_bytes();
+  const bool drained = visitor->DrainMarkingStackWithDeadline(deadline);
+  const int64_t stop = OS::GetCurrentMonotonicMicros();
+  visitor->AddMicros(stop - start);
+  if (FLAG_log_marker_tasks) {
+    THR_Print("Idle slice marked %" Pd " bytes in %" Pd64
+              " micros, precleaned %" Pd " deferred objects%s.\n",
+              visitor->marked_bytes() - marked_before, stop - start,
+              precleaned, drained ? "" : ", deadline passed");
+  }
+  return drained;
+}
+
 void GCMarker::MarkObjects(PageSpace* page_space) {
   if (isolate_group_->marking_stack() != NULL) {
     isolate_group_->DisableIncrementalBarrier();
@@ -774,7 +967,9 @@ void GCMarker::MarkObjects(PageSpace* page_space) {
       int64_t start = OS::GetCurrentMonotonicMicros();
       // Mark everything on main thread.
       UnsyncMarkingVisitor mark(isolate_group_, page_space, &marking_stack_,
-                                &deferred_marking_stack_);
+                                &deferred_marking_stack_,
+                                &precleaned_marking_stack_,
+                                /*marking_deques=*/nullptr, 0);
       ResetSlices();
       IterateRoots(&mark);
       mark.ProcessDeferredMarking();
@@ -797,20 +992,20 @@ void GCMarker::MarkObjects(PageSpace* page_space) {
           visitor = visitors_[i];
           visitors_[i] = NULL;
         } else {
-          visitor =
-              new SyncMarkingVisitor(isolate_group_, page_space,
-                                     &marking_stack_, &deferred_marking_stack_);
+          visitor = new SyncMarkingVisitor(
+              isolate_group_, page_space, &marking_stack_,
+              &deferred_marking_stack_, &precleaned_marking_stack_,
+              &marking_deques_, i);
         }
         if (i < (num_tasks - 1)) {
           // Begin marking on a helper thread.
           bool result = Dart::thread_pool()->Run<ParallelMarkTask>(
-              this, isolate_group_, &marking_stack_, &barrier, visitor,
-              &num_busy);
+              this, isolate_group_, &barrier, visitor, &num_busy);
           ASSERT(result);
         } else {
           // Last worker is the main thread.
-          ParallelMarkTask task(this, isolate_group_, &marking_stack_, &barrier,
-                                visitor, &num_busy);
+          ParallelMarkTask task(this, isolate_group_, &barrier, visitor,
+                                &num_busy);
           task.RunEnteredIsolateGroup();
           barrier.Exit();
         }
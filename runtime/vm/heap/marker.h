@@ -6,6 +6,7 @@
 #define RUNTIME_VM_HEAP_MARKER_H_
 
 #include "vm/allocation.h"
+#include "vm/growable_array.h"
 #include "vm/heap/pointer_block.h"
 #include "vm/os_thread.h"  // Mutex.
 
@@ -14,6 +15,7 @@ namespace dart {
 // Forward declarations.
 class HandleVisitor;
 class Heap;
+class Isolate;
 class IsolateGroup;
 class ObjectPointerVisitor;
 class PageSpace;
@@ -42,6 +44,12 @@ class GCMarker {
   // Does not required StartConcurrentMark to have been previously called.
   void MarkObjects(PageSpace* page_space);
 
+  // Called by the mutator at a safepoint when it is idle, after the
+  // concurrent marker tasks have finished. Marks what the mutator has pushed
+  // since then until [deadline], leaving less for MarkObjects. Returns whether
+  // the marking stack was drained.
+  bool IncrementalMarkWithTimeBudget(PageSpace* page_space, int64_t deadline);
+
   intptr_t marked_words() const { return marked_bytes_ >> kWordSizeLog2; }
   intptr_t MarkedWordsPerMicro() const;
 
@@ -52,7 +60,7 @@ class GCMarker {
   void IterateRoots(ObjectPointerVisitor* visitor);
   void IterateWeakRoots(Thread* thread);
   void ProcessWeakHandles(Thread* thread);
-  void ProcessWeakTables(Thread* thread);
+  void ProcessWeakTable(Thread* thread, intptr_t sel);
   void ProcessRememberedSet(Thread* thread);
   void ProcessObjectIdTable(Thread* thread);
 
@@ -64,8 +72,16 @@ class GCMarker {
   Heap* const heap_;
   MarkingStack marking_stack_;
   MarkingStack deferred_marking_stack_;
+  // Deferred objects already scanned by the concurrent marker. They still have
+  // to be rescanned in the final pause, since the mutator may have stored into
+  // them without a barrier.
+  MarkingStack precleaned_marking_stack_;
+  BlockDeques<MarkingStackBlock> marking_deques_;
   MarkingVisitorBase<true>** visitors_;
 
+  // Root slices are the group's own roots, persistent handles, thread stacks,
+  // then one slice per isolate and one per new-space page.
+  MallocGrowableArray<Isolate*> root_isolates_;
   NewPage* new_page_;
   Monitor root_slices_monitor_;
   RelaxedAtomic<intptr_t> root_slices_started_;
@@ -79,6 +95,7 @@ class GCMarker {
 
   friend class ConcurrentMarkTask;
   friend class ParallelMarkTask;
+  friend class MarkerTestHelper;
   DISALLOW_IMPLICIT_CONSTRUCTORS(GCMarker);
 };
 
@@ -17,6 +17,7 @@
 #include "vm/object.h"
 #include "vm/object_set.h"
 #include "vm/os_thread.h"
+#include "vm/thread_registry.h"
 #include "vm/virtual_memory.h"
 
 namespace dart {
@@ -33,6 +34,27 @@ DEFINE_FLAG(int,
             old_gen_growth_rate,
             280,
             "The max number of pages the old generation can grow at a time");
+DEFINE_FLAG(int,
+            gc_target_pause,
+            0,
+            "Target maximum GC pause in milliseconds. When non-zero, new-gen "
+            "size and the concurrent marking threshold adapt to the measured "
+            "pauses (0 disables the adaptive policy)");
+DEFINE_FLAG(int,
+            gc_time_budget,
+            0,
+            "Target maximum percentage of time spent in old gen GC for the "
+            "adaptive policy, overriding old_gen_growth_time_ratio");
+DEFINE_FLAG(int,
+            old_gen_cgroup_limit_percent,
+            0,
+            "Keep old gen below this percentage of the cgroup memory limit, "
+            "compacting instead of growing when it gets close (0 disables)");
+DEFINE_FLAG(bool,
+            idle_gc_slices,
+            true,
+            "Spend idle time that cannot fit a whole GC on slices of the "
+            "old-space marking or sweeping in progress.");
 DEFINE_FLAG(bool,
             print_free_list_before_gc,
             false,
@@ -42,6 +64,25 @@ DEFINE_FLAG(bool,
             false,
             "Print free list statistics after a GC");
 DEFINE_FLAG(bool, log_growth, false, "Log PageSpace growth policy decisions.");
+DEFINE_FLAG(bool,
+            old_gen_tlabs,
+            false,
+            "Allocate small old-space objects from thread-local buffers.");
+DEFINE_FLAG(int,
+            evacuation_max_pages,
+            0,
+            "Maximum number of the most fragmented pages to evacuate after a "
+            "mark-sweep (0 disables partial evacuation)");
+DEFINE_FLAG(int,
+            evacuation_live_percent,
+            50,
+            "Only pages with at most this percentage of live bytes are "
+            "evacuated");
+DEFINE_FLAG(int,
+            evacuation_pause_budget,
+            2000,
+            "Maximum estimated time in microseconds to copy the live objects "
+            "of evacuated pages");
 
 OldPage* OldPage::Allocate(intptr_t size_in_words,
                            PageType type,
@@ -61,7 +102,9 @@ OldPage* OldPage::Allocate(intptr_t size_in_words,
   result->used_in_bytes_ = 0;
   result->forwarding_page_ = NULL;
   result->card_table_ = NULL;
+  result->live_bytes_ = 0;
   result->type_ = type;
+  result->evacuation_candidate_ = false;
 
   LSAN_REGISTER_ROOT_REGION(result, sizeof(*result));
 
@@ -126,7 +169,7 @@ void OldPage::VisitRememberedCards(ObjectPointerVisitor* visitor) {
     return;
   }
 
-  bool table_is_empty = false;
+  bool table_is_empty = true;
 
   ArrayPtr obj = static_cast<ArrayPtr>(ObjectLayout::FromAddr(object_start()));
   ASSERT(obj->IsArray());
@@ -218,6 +261,11 @@ void OldPage::WriteProtect(bool read_only) {
 // based on the device's actual speed.
 static const intptr_t kConservativeInitialMarkSpeed = 20;
 
+// The initial estimate of how many bytes the compactor can slide per
+// microsecond, used to bound partial evacuation before any compaction has been
+// timed.
+static const intptr_t kConservativeInitialCopySpeed = 200;
+
 PageSpace::PageSpace(Heap* heap, intptr_t max_capacity_in_words)
     : heap_(heap),
       num_freelists_(Utils::Maximum(FLAG_scavenger_tasks, 1) + 1),
@@ -241,6 +289,17 @@ PageSpace::PageSpace(Heap* heap, intptr_t max_capacity_in_words)
       gc_time_micros_(0),
       collections_(0),
       mark_words_per_micro_(kConservativeInitialMarkSpeed),
+      compactions_(0),
+      compaction_time_micros_(0),
+      last_compaction_pause_micros_(0),
+      max_compaction_pause_micros_(0),
+      last_compaction_copy_micros_(0),
+      last_compaction_moved_bytes_(0),
+      evacuations_(0),
+      tlab_refills_(0),
+      tlab_contended_refills_(0),
+      tlab_fallbacks_(0),
+      tlab_abandoned_bytes_(0),
       enable_concurrent_mark_(FLAG_concurrent_mark) {
   // We aren't holding the lock but no one can reference us yet.
   UpdateMaxCapacityLocked();
@@ -366,6 +425,9 @@ OldPage* PageSpace::AllocatePage(OldPage::PageType type, bool link) {
     }
   }
 
+  if ((heap_ != nullptr) && (heap_->numa_node() >= 0)) {
+    page->memory_->PreferNumaNode(heap_->numa_node());
+  }
   page->set_object_end(page->memory_->end());
   if ((type != OldPage::kExecutable) && (heap_ != nullptr) &&
       (!heap_->is_vm_isolate())) {
@@ -397,6 +459,9 @@ OldPage* PageSpace::AllocateLargePage(intptr_t size, OldPage::PageType type) {
   } else {
     AddLargePageLocked(page);
   }
+  if ((heap_ != nullptr) && (heap_->numa_node() >= 0)) {
+    page->memory_->PreferNumaNode(heap_->numa_node());
+  }
 
   // Only one object in this page (at least until Array::MakeFixedLength
   // is called).
@@ -547,6 +612,10 @@ uword PageSpace::TryAllocateInternal(intptr_t size,
     } else {
       result = freelist->TryAllocate(size, is_protected);
     }
+    if ((result == 0) && FLAG_lazy_sweep && !is_locked &&
+        (type == OldPage::kData)) {
+      result = TryAllocateLazySweep(size, freelist);
+    }
     if (result == 0) {
       result = TryAllocateInFreshPage(size, freelist, type, growth_policy,
                                       is_locked);
@@ -562,6 +631,105 @@ uword PageSpace::TryAllocateInternal(intptr_t size,
   return result;
 }
 
+uword PageSpace::TryAllocateInTLABSlow(Thread* thread,
+                                       intptr_t size,
+                                       GrowthPolicy growth_policy) {
+  FreeList* freelist = &freelists_[OldPage::kData];
+  if (!freelist->mutex()->TryLock()) {
+    tlab_contended_refills_.fetch_add(1);
+    freelist->mutex()->Lock();
+  }
+  AbandonRemainingTLABLocked(thread, /*account=*/true);
+
+  FreeListElement* block = freelist->TryAllocateLargeLocked(kTLABMinSize);
+  if (block != NULL) {
+    tlab_refills_.fetch_add(1);
+    uword start = reinterpret_cast<uword>(block);
+    intptr_t block_size = block->HeapSize();
+    // Leave the rest of a large block to other threads.
+    if (block_size - kTLABSize >= kTLABSize) {
+      freelist->FreeLocked(start + kTLABSize, block_size - kTLABSize);
+      block_size = kTLABSize;
+    }
+    thread->set_old_top(start + size);
+    thread->set_old_end(start + block_size);
+    thread->set_old_unaccounted_size(size);
+    freelist->mutex()->Unlock();
+    return start;
+  }
+  freelist->mutex()->Unlock();
+
+  // No free block is large enough for a buffer. Allocate the object
+  // directly, which adds the remainder of a fresh page to the freelist if
+  // needed. This must not hold the freelist lock, as it may start a GC.
+  tlab_fallbacks_.fetch_add(1);
+  return TryAllocateInternal(size, freelist, OldPage::kData, growth_policy,
+                             /*is_protected=*/false, /*is_locked=*/false);
+}
+
+void PageSpace::AbandonRemainingTLABLocked(Thread* thread, bool account) {
+  FreeList* freelist = &freelists_[OldPage::kData];
+  DEBUG_ASSERT(freelist->mutex()->IsOwnedByCurrentThread());
+  uword top = thread->old_top();
+  uword end = thread->old_end();
+  if (top < end) {
+    freelist->FreeLocked(top, end - top);
+    tlab_abandoned_bytes_.fetch_add(end - top);
+  }
+  thread->set_old_top(0);
+  thread->set_old_end(0);
+  if (account) {
+    usage_.used_in_words += (thread->old_unaccounted_size() >> kWordSizeLog2);
+  }
+  thread->set_old_unaccounted_size(0);
+}
+
+void PageSpace::AbandonRemainingTLAB(Thread* thread) {
+  if ((thread->old_end() == 0) && (thread->old_unaccounted_size() == 0)) {
+    return;
+  }
+  FreeList* freelist = &freelists_[OldPage::kData];
+  MutexLocker ml(freelist->mutex());
+  AbandonRemainingTLABLocked(thread, /*account=*/true);
+}
+
+void PageSpace::AbandonRemainingTLABs(bool account) {
+  if (heap_ == NULL) {  // Some unit tests.
+    return;
+  }
+  ThreadRegistry* registry = heap_->isolate_group()->thread_registry();
+  FreeList* freelist = &freelists_[OldPage::kData];
+  MonitorLocker ml(registry->threads_lock());
+  MutexLocker fl(freelist->mutex());
+  for (Thread* thread = registry->active_list(); thread != NULL;
+       thread = thread->next()) {
+    if ((thread->old_end() == 0) && (thread->old_unaccounted_size() == 0)) {
+      continue;
+    }
+    // Other threads' buffers can only be taken from them at a safepoint.
+    ASSERT((thread == Thread::Current()) ||
+           Thread::Current()->IsAtSafepoint());
+    AbandonRemainingTLABLocked(thread, account);
+  }
+}
+
+void PageSpace::MakeTLABsIterable() const {
+  if ((heap_ == NULL) || !Thread::Current()->IsAtSafepoint()) {
+    // Without a safepoint the buffers may be in use. Walks that need data
+    // pages to be iterable happen at a safepoint.
+    return;
+  }
+  ThreadRegistry* registry = heap_->isolate_group()->thread_registry();
+  MonitorLocker ml(registry->threads_lock());
+  for (Thread* thread = registry->active_list(); thread != NULL;
+       thread = thread->next()) {
+    if (thread->old_top() < thread->old_end()) {
+      FreeListElement::AsElement(thread->old_top(),
+                                 thread->old_end() - thread->old_top());
+    }
+  }
+}
+
 void PageSpace::AcquireLock(FreeList* freelist) {
   freelist->mutex()->Lock();
 }
@@ -676,12 +844,55 @@ void PageSpace::MakeIterable() const {
   for (intptr_t i = 0; i < num_freelists_; i++) {
     freelists_[i].MakeIterable();
   }
+  MakeTLABsIterable();
 }
 
 void PageSpace::AbandonBumpAllocation() {
   for (intptr_t i = 0; i < num_freelists_; i++) {
     freelists_[i].AbandonBumpAllocation();
   }
+  AbandonRemainingTLABs(/*account=*/true);
+}
+
+intptr_t PageSpace::ReleaseFreeMemory() {
+  ASSERT(Thread::Current()->IsAtSafepoint());
+  {
+    // Another mutator may have started a collection since the caller's. Its
+    // sweeper tasks ignore safepoints, so wait for them to finish. Concurrent
+    // marker tasks are paused at the safepoint; leave the memory alone then.
+    MonitorLocker ml(tasks_lock());
+    while ((phase() == kSweepingLarge) || (phase() == kSweepingRegular)) {
+      ml.Wait();
+    }
+    if ((phase() != kDone) || (tasks() != 0)) {
+      return 0;
+    }
+  }
+  AbandonBumpAllocation();
+  const intptr_t page_size = VirtualMemory::PageSize();
+  intptr_t released = 0;
+  MutexLocker ml(&pages_lock_);
+  for (OldPage* page = pages_; page != nullptr; page = page->next()) {
+    uword addr = page->object_start();
+    const uword end = page->object_end();
+    while (addr < end) {
+      ObjectPtr obj = ObjectLayout::FromAddr(addr);
+      const intptr_t size = obj->ptr()->HeapSize();
+      if (obj->GetClassId() == kFreeListElement) {
+        // Keep the element's header, which the freelist still reads.
+        const uword start = Utils::RoundUp(
+            addr + FreeListElement::HeaderSizeFor(size), page_size);
+        const uword stop = Utils::RoundDown(addr + size, page_size);
+        if (stop > start) {
+          VirtualMemory::DontNeed(reinterpret_cast<void*>(start),
+                                  stop - start);
+          released += stop - start;
+        }
+      }
+      addr += size;
+    }
+  }
+  return released;
 }
 
 void PageSpace::AbandonMarkingForShutdown() {
@@ -881,6 +1092,37 @@ void PageSpace::PrintToJSONObject(JSONObject* object) const {
   } else {
     space.AddProperty("avgCollectionPeriodMillis", 0.0);
   }
+  space.AddProperty("compactions", compactions_);
+  space.AddProperty("evacuations", evacuations_);
+  space.AddProperty("compactionTime",
+                    MicrosecondsToSeconds(compaction_time_micros_));
+  space.AddProperty("lastCompactionPauseMillis",
+                    MicrosecondsToMilliseconds(last_compaction_pause_micros_));
+  space.AddProperty("maxCompactionPauseMillis",
+                    MicrosecondsToMilliseconds(max_compaction_pause_micros_));
+  space.AddProperty("lastCompactionCopyMillis",
+                    MicrosecondsToMilliseconds(last_compaction_copy_micros_));
+  space.AddProperty64("lastCompactionMovedBytes",
+                      last_compaction_moved_bytes_);
+  space.AddProperty("tlabRefills", tlab_refills_.load());
+  space.AddProperty("tlabContendedRefills", tlab_contended_refills_.load());
+  space.AddProperty("tlabFallbacks", tlab_fallbacks_.load());
+  space.AddProperty64("tlabAbandonedBytes", tlab_abandoned_bytes_.load());
+  intptr_t free_size = 0;
+  intptr_t largest_free_size = 0;
+  {
+    FreeList* freelist = &freelists_[OldPage::kData];
+    MutexLocker ml(freelist->mutex());
+    freelist->ComputeFreeSizesLocked(&free_size, &largest_free_size);
+  }
+  space.AddProperty64("freeBytes", free_size);
+  space.AddProperty64("largestFreeBlock", largest_free_size);
+  space.AddProperty("markingHeadroomPercent",
+                    page_space_controller_.marking_headroom_percent_);
+  space.AddProperty64(
+      "memoryLimit", page_space_controller_.memory_limit_in_words_ * kWordSize);
+  space.AddProperty("nearMemoryLimit",
+                    page_space_controller_.NearMemoryLimit());
 }
 
 class HeapMapAsJSONVisitor : public ObjectVisitor {
@@ -1022,6 +1264,53 @@ bool PageSpace::ShouldPerformIdleMarkCompact(int64_t deadline) {
   return estimated_mark_compact_completion <= deadline;
 }
 
+void PageSpace::PerformIdleSlice(int64_t deadline) {
+  if (!FLAG_idle_gc_slices || (OS::GetCurrentMonotonicMicros() >= deadline)) {
+    return;
+  }
+  Phase phase;
+  {
+    MonitorLocker ml(tasks_lock());
+    phase = phase_;
+  }
+  switch (phase) {
+    case kAwaitingFinalization:
+      // The concurrent marker tasks are done, and no new ones start while we
+      // are at a safepoint.
+      marker_->IncrementalMarkWithTimeBudget(this, deadline);
+      break;
+    case kSweepingLarge:
+      // While the first sweeper task sweeps the large pages, the regular
+      // pages can already be claimed.
+    case kSweepingRegular:
+      IdleSweep(deadline);
+      break;
+    default:
+      // Concurrent marking progresses on its own tasks.
+      break;
+  }
+}
+
+void PageSpace::IdleSweep(int64_t deadline) {
+  if (sweep_work_list_.Exhausted()) {
+    return;
+  }
+  TIMELINE_FUNCTION_GC_DURATION(Thread::Current(), "IdleSweep");
+  GCSweeper sweeper;
+  OldPage* page;
+  while ((OS::GetCurrentMonotonicMicros() < deadline) &&
+         ((page = sweep_work_list_.Claim()) != NULL)) {
+    ASSERT(page->type() == OldPage::kData);
+    // Empty pages are freed by the last sweeper task.
+    sweeper.SweepPage(page, DataFreeList(), false);
+    sweep_work_list_.AddLazilySwept();
+    if (sweep_work_list_.Swept()) {
+      MonitorLocker ml(tasks_lock());
+      ml.NotifyAll();
+    }
+  }
+}
+
 void PageSpace::TryReleaseReservation() {
   if (oom_reservation_ == nullptr) return;
   uword addr = reinterpret_cast<uword>(oom_reservation_);
@@ -1168,6 +1457,7 @@ void PageSpace::CollectGarbageHelper(bool compact,
   // Mark all reachable old-gen objects.
   if (marker_ == NULL) {
     ASSERT(phase() == kDone);
+    ResetLiveBytes();
     marker_ = new GCMarker(isolate_group, heap_);
   } else {
     ASSERT(phase() == kAwaitingFinalization);
@@ -1180,6 +1470,9 @@ void PageSpace::CollectGarbageHelper(bool compact,
   }
 
   marker_->MarkObjects(this);
+  // Objects in the thread-local allocation buffers are accounted for by
+  // marking.
+  AbandonRemainingTLABs(/*account=*/false);
   usage_.used_in_words = marker_->marked_words() + allocated_black_in_words_;
   allocated_black_in_words_ = 0;
   mark_words_per_micro_ = marker_->MarkedWordsPerMicro();
@@ -1231,6 +1524,10 @@ void PageSpace::CollectGarbageHelper(bool compact,
 
   bool has_reservation = MarkReservation();
 
+  if (!compact && (FLAG_evacuation_max_pages > 0)) {
+    EvacuateFragmentedPages(thread);
+  }
+
   if (compact) {
     SweepLarge();
     Compact(thread);
@@ -1334,17 +1631,65 @@ void PageSpace::Sweep() {
 }
 
 void PageSpace::ConcurrentSweep(IsolateGroup* isolate_group) {
-  // Start the concurrent sweeper task now.
+  // Start the concurrent sweeper tasks now.
   GCSweeper::SweepConcurrent(isolate_group, pages_, pages_tail_, large_pages_,
                              large_pages_tail_, &freelists_[OldPage::kData]);
 }
 
+uword PageSpace::TryAllocateLazySweep(intptr_t size, FreeList* freelist) {
+  if (sweep_work_list_.Exhausted()) {
+    return 0;
+  }
+  GCSweeper sweeper;
+  OldPage* page;
+  while ((page = sweep_work_list_.Claim()) != NULL) {
+    ASSERT(page->type() == OldPage::kData);
+    // Empty pages are freed by the last sweeper task.
+    sweeper.SweepPage(page, freelist, false);
+    sweep_work_list_.AddLazilySwept();
+    if (sweep_work_list_.Swept()) {
+      MonitorLocker ml(tasks_lock());
+      ml.NotifyAll();
+    }
+    uword result = freelist->TryAllocate(size, /*is_protected=*/false);
+    if (result != 0) {
+      return result;
+    }
+  }
+  return 0;
+}
+
+void PageSpace::FreeEmptySweptPages(OldPage* first, OldPage* last) {
+  OldPage* prev_page = NULL;
+  OldPage* page = first;
+  while (page != NULL) {
+    OldPage* next_page;
+    if (page == last) {
+      // Don't access page->next(), which would be a race with mutator
+      // allocating new pages.
+      next_page = NULL;
+    } else {
+      next_page = page->next();
+    }
+    if (page->used_in_bytes() == 0) {
+      FreePage(page, prev_page);
+    } else {
+      prev_page = page;
+    }
+    page = next_page;
+  }
+}
+
 void PageSpace::Compact(Thread* thread) {
   thread->isolate_group()->set_compaction_in_progress(true);
+  const int64_t start = OS::GetCurrentMonotonicMicros();
   GCCompactor compactor(thread, heap_);
   compactor.Compact(pages_, &freelists_[OldPage::kData], &pages_lock_);
+  const int64_t pause = OS::GetCurrentMonotonicMicros() - start;
   thread->isolate_group()->set_compaction_in_progress(false);
 
+  RecordCompaction(compactor, pause, "Compacted");
+
   if (FLAG_verify_after_gc) {
     OS::PrintErr("Verifying after compacting...");
     heap_->VerifyGC(kForbidMarked);
@@ -1352,6 +1697,148 @@ void PageSpace::Compact(Thread* thread) {
   }
 }
 
+static int CompareLiveBytes(OldPage* const* a, OldPage* const* b) {
+  const intptr_t a_live = (*a)->live_bytes();
+  const intptr_t b_live = (*b)->live_bytes();
+  if (a_live < b_live) {
+    return -1;
+  } else if (a_live == b_live) {
+    return 0;
+  } else {
+    return 1;
+  }
+}
+
+void PageSpace::EvacuateFragmentedPages(Thread* thread) {
+  TIMELINE_FUNCTION_GC_DURATION(thread, "EvacuateFragmentedPages");
+
+  // Choose the pages with the fewest live bytes, as many as fit in the pause
+  // budget given the observed compaction speed.
+  MallocGrowableArray<OldPage*> candidates;
+  for (OldPage* page = pages_; page != NULL; page = page->next()) {
+    if (page->forwarding_page() == NULL) {
+      continue;  // VM isolate.
+    }
+    const intptr_t capacity = page->object_end() - page->object_start();
+    if (page->live_bytes() * 100 <= capacity * FLAG_evacuation_live_percent) {
+      candidates.Add(page);
+    }
+  }
+  candidates.Sort(CompareLiveBytes);
+
+  intptr_t copy_bytes_per_micro = kConservativeInitialCopySpeed;
+  if ((last_compaction_copy_micros_ > 0) &&
+      (last_compaction_moved_bytes_ > 0)) {
+    copy_bytes_per_micro = Utils::Maximum(
+        static_cast<intptr_t>(1),
+        static_cast<intptr_t>(last_compaction_moved_bytes_ /
+                              last_compaction_copy_micros_));
+  }
+  const intptr_t budget_in_bytes =
+      FLAG_evacuation_pause_budget * copy_bytes_per_micro;
+  intptr_t num_selected = 0;
+  intptr_t selected_live_bytes = 0;
+  while ((num_selected < candidates.length()) &&
+         (num_selected < FLAG_evacuation_max_pages)) {
+    const intptr_t live_bytes = candidates[num_selected]->live_bytes();
+    if (selected_live_bytes + live_bytes > budget_in_bytes) {
+      break;
+    }
+    selected_live_bytes += live_bytes;
+    num_selected++;
+  }
+  if (num_selected < 2) {
+    // Evacuating a single page cannot free it, and the sweeper already frees
+    // empty pages.
+    return;
+  }
+
+  // Unlink the selected pages. The rest stay unswept until the evacuation is
+  // done.
+  OldPage* selected = NULL;
+  OldPage* selected_tail = NULL;
+  {
+    MutexLocker ml(&pages_lock_);
+    for (intptr_t i = 0; i < num_selected; i++) {
+      candidates[i]->set_evacuation_candidate(true);
+    }
+    OldPage* prev_page = NULL;
+    OldPage* page = pages_;
+    while (page != NULL) {
+      OldPage* next_page = page->next();
+      if (page->is_evacuation_candidate()) {
+        RemovePageLocked(page, prev_page);
+        page->set_next(NULL);
+        if (selected_tail == NULL) {
+          selected = page;
+        } else {
+          selected_tail->set_next(page);
+        }
+        selected_tail = page;
+      } else {
+        prev_page = page;
+      }
+      page = next_page;
+    }
+  }
+
+  thread->isolate_group()->set_compaction_in_progress(true);
+  const int64_t start = OS::GetCurrentMonotonicMicros();
+  GCCompactor compactor(thread, heap_);
+  OldPage* head;
+  OldPage* tail;
+  compactor.Evacuate(selected, &pages_lock_, &head, &tail);
+  const int64_t pause = OS::GetCurrentMonotonicMicros() - start;
+  thread->isolate_group()->set_compaction_in_progress(false);
+
+  {
+    // The surviving pages are still marked and are swept with the rest.
+    MutexLocker ml(&pages_lock_);
+    if (pages_tail_ == NULL) {
+      pages_ = head;
+    } else {
+      pages_tail_->set_next(head);
+    }
+    pages_tail_ = tail;
+  }
+
+  evacuations_++;
+  RecordCompaction(compactor, pause, "Evacuated");
+}
+
+void PageSpace::RecordCompaction(const GCCompactor& compactor,
+                                 int64_t pause,
+                                 const char* kind) {
+  compactions_++;
+  compaction_time_micros_ += pause;
+  last_compaction_pause_micros_ = pause;
+  max_compaction_pause_micros_ =
+      Utils::Maximum(max_compaction_pause_micros_, pause);
+  last_compaction_copy_micros_ = compactor.slide_micros();
+  last_compaction_moved_bytes_ = compactor.moved_bytes();
+
+  if (FLAG_verbose_gc) {
+    THR_Print("%s %" Pd " kB, freed %" Pd
+              " pages in %.3f ms (plan %.3f ms, slide %.3f ms, forward %.3f "
+              "ms)\n",
+              kind, compactor.moved_bytes() / KB, compactor.freed_pages(),
+              MicrosecondsToMilliseconds(pause),
+              MicrosecondsToMilliseconds(compactor.plan_micros()),
+              MicrosecondsToMilliseconds(compactor.slide_micros()),
+              MicrosecondsToMilliseconds(compactor.forward_micros()));
+  }
+}
+
+void PageSpace::ResetLiveBytes() {
+  MutexLocker ml(&pages_lock_);
+  for (OldPage* page = pages_; page != NULL; page = page->next()) {
+    page->ResetLiveBytes();
+  }
+  for (OldPage* page = large_pages_; page != NULL; page = page->next()) {
+    page->ResetLiveBytes();
+  }
+}
+
 uword PageSpace::TryAllocateDataBumpLocked(FreeList* freelist, intptr_t size) {
   ASSERT(size >= kObjectAlignment);
   ASSERT(Utils::IsAligned(size, kObjectAlignment));
@@ -1424,6 +1911,8 @@ void PageSpace::SetupImagePage(void* pointer, uword size, bool is_executable) {
   page->used_in_bytes_ = page->object_end_ - page->object_start();
   page->forwarding_page_ = NULL;
   page->card_table_ = NULL;
+  page->live_bytes_ = 0;
+  page->evacuation_candidate_ = false;
   if (is_executable) {
     page->type_ = OldPage::kExecutable;
   } else {
@@ -1526,6 +2015,9 @@ void PageSpace::MergeFrom(PageSpace* donor) {
   allocated_black_in_words_ += donor->allocated_black_in_words_;
   gc_time_micros_ += donor->gc_time_micros_;
   collections_ += donor->collections_;
+  compactions_ += donor->compactions_;
+  evacuations_ += donor->evacuations_;
+  compaction_time_micros_ += donor->compaction_time_micros_;
 
   usage_.capacity_in_words += donor->usage_.capacity_in_words;
   usage_.used_in_words += donor->usage_.used_in_words;
@@ -1536,6 +2028,55 @@ void PageSpace::MergeFrom(PageSpace* donor) {
   ASSERT(FLAG_concurrent_mark || donor->enable_concurrent_mark_ == false);
 }
 
+// Bounds for PageSpaceController::marking_headroom_percent_.
+static const intptr_t kMinMarkingHeadroomPercent = 5;
+static const intptr_t kMaxMarkingHeadroomPercent = 50;
+
+// Returns the memory limit of the cgroup this process runs in, or 0 if there
+// is none.
+static int64_t CgroupMemoryLimit() {
+#if defined(HOST_OS_LINUX) || defined(HOST_OS_ANDROID)
+  // cgroup v2 and v1 respectively. An unlimited v2 group reports "max", which
+  // fails to parse.
+  const char* kLimitPaths[] = {
+      "/sys/fs/cgroup/memory.max",
+      "/sys/fs/cgroup/memory/memory.limit_in_bytes",
+  };
+  for (const char* path : kLimitPaths) {
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+      continue;
+    }
+    int64_t limit = 0;
+    const int matches = fscanf(file, "%" Pd64 "", &limit);
+    fclose(file);
+    if (matches != 1) {
+      continue;
+    }
+    // An unlimited v1 group reports a value close to kMaxInt64.
+    if ((limit <= 0) || (limit >= kMaxInt64 / 2)) {
+      return 0;
+    }
+    return limit;
+  }
+#endif
+  return 0;
+}
+
+static intptr_t MemoryLimitInWords() {
+  if (FLAG_old_gen_cgroup_limit_percent <= 0) {
+    return 0;
+  }
+  const int64_t limit = CgroupMemoryLimit();
+  if (limit == 0) {
+    return 0;
+  }
+  const int64_t limit_in_words =
+      (limit / 100 * FLAG_old_gen_cgroup_limit_percent) >> kWordSizeLog2;
+  return static_cast<intptr_t>(
+      Utils::Minimum(limit_in_words, static_cast<int64_t>(kIntptrMax)));
+}
+
 PageSpaceController::PageSpaceController(Heap* heap,
                                          int heap_growth_ratio,
                                          int heap_growth_max,
@@ -1546,6 +2087,9 @@ PageSpaceController::PageSpaceController(Heap* heap,
       desired_utilization_((100.0 - heap_growth_ratio) / 100.0),
       heap_growth_max_(heap_growth_max),
       garbage_collection_time_ratio_(garbage_collection_time_ratio),
+      marking_headroom_percent_(kMinMarkingHeadroomPercent),
+      memory_limit_in_words_(MemoryLimitInWords()),
+      near_memory_limit_(false),
       idle_gc_threshold_in_words_(0) {
   const intptr_t growth_in_pages = heap_growth_max / 2;
   RecordUpdate(last_usage_, last_usage_, growth_in_pages, "initial");
@@ -1591,6 +2135,26 @@ void PageSpaceController::EvaluateGarbageCollection(SpaceUsage before,
   history_.AddGarbageCollectionTime(start, end);
   const int gc_time_fraction = history_.GarbageCollectionTimeFraction();
   heap_->RecordData(PageSpace::kGCTimeFraction, gc_time_fraction);
+  const int gc_time_ratio = FLAG_gc_time_budget > 0
+                                ? FLAG_gc_time_budget
+                                : garbage_collection_time_ratio_;
+
+  if (FLAG_gc_target_pause > 0) {
+    // The final pause of a concurrent mark shrinks the more of the heap was
+    // marked before it. If the pause is too long, start marking earlier; if
+    // all recent pauses are well within the target, move the start back to
+    // save marking work.
+    const int64_t target_micros =
+        static_cast<int64_t>(FLAG_gc_target_pause) *
+        kMicrosecondsPerMillisecond;
+    if ((end - start) > target_micros) {
+      marking_headroom_percent_ = Utils::Minimum(
+          kMaxMarkingHeadroomPercent, 2 * marking_headroom_percent_);
+    } else if (2 * history_.MaxPauseMicros() < target_micros) {
+      marking_headroom_percent_ = Utils::Maximum(
+          kMinMarkingHeadroomPercent, marking_headroom_percent_ / 2);
+    }
+  }
 
   // Assume garbage increases linearly with allocation:
   // G = kA, and estimate k from the previous cycle.
@@ -1613,8 +2177,12 @@ void PageSpaceController::EvaluateGarbageCollection(SpaceUsage before,
     // Define GC to be 'worthwhile' iff at least fraction t of heap is garbage.
     double t = 1.0 - desired_utilization_;
     // If we spend too much time in GC, strive for even more free space.
-    if (gc_time_fraction > garbage_collection_time_ratio_) {
-      t += (gc_time_fraction - garbage_collection_time_ratio_) / 100.0;
+    if (gc_time_fraction > gc_time_ratio) {
+      t += (gc_time_fraction - gc_time_ratio) / 100.0;
+    } else if ((FLAG_gc_time_budget > 0) &&
+               (2 * gc_time_fraction < gc_time_ratio)) {
+      // Well within the budget: trade some of it for a smaller heap.
+      t *= 0.75;
     }
 
     // Number of pages we can allocate and still be within the desired growth
@@ -1716,16 +2284,34 @@ void PageSpaceController::RecordUpdate(SpaceUsage before,
   hard_gc_threshold_in_words_ =
       after.CombinedUsedInWords() + (kOldPageSizeInWords * growth_in_pages);
 
+  // Note that heap_ can be null in some unit tests.
+  const intptr_t new_space =
+      heap_ == nullptr ? 0 : heap_->new_space()->CapacityInWords();
+
+  // Don't grow past the cgroup memory limit, which also has to fit both
+  // semi-spaces. Compacting returns the free space of fragmented pages, so
+  // prefer it over growing once the limit is near. A minimum step is still
+  // allowed to make progress when the live data alone exceeds the limit.
+  near_memory_limit_ = false;
+  if (memory_limit_in_words_ != 0) {
+    const intptr_t limit = memory_limit_in_words_ - 2 * new_space;
+    if (hard_gc_threshold_in_words_ > limit) {
+      hard_gc_threshold_in_words_ =
+          Utils::Maximum(limit, after.CombinedUsedInWords() +
+                                    ((2 * MB) >> kWordSizeLog2));
+      near_memory_limit_ = true;
+    }
+  }
+
   // Start concurrent marking when old-space has less than half of new-space
-  // available or less than 5% available.
+  // available or less than marking_headroom_percent_ (by default 5%)
+  // available.
 #if defined(TARGET_ARCH_IA32)
   const intptr_t headroom = 0;  // No concurrent marking.
 #else
-  // Note that heap_ can be null in some unit tests.
-  const intptr_t new_space =
-      heap_ == nullptr ? 0 : heap_->new_space()->CapacityInWords();
   const intptr_t headroom =
-      Utils::Maximum(new_space / 2, hard_gc_threshold_in_words_ / 20);
+      Utils::Maximum(new_space / 2, hard_gc_threshold_in_words_ / 100 *
+                                        marking_headroom_percent_);
 #endif
   soft_gc_threshold_in_words_ = hard_gc_threshold_in_words_ - headroom;
 
@@ -1753,10 +2339,13 @@ void PageSpaceController::RecordUpdate(SpaceUsage before,
 #endif
 
   if (FLAG_log_growth) {
-    THR_Print("%s: threshold=%" Pd "kB, idle_threshold=%" Pd "kB, reason=%s\n",
+    THR_Print("%s: threshold=%" Pd "kB, soft_threshold=%" Pd
+              "kB, idle_threshold=%" Pd "kB, near_limit=%s, reason=%s\n",
               heap_->isolate_group()->source()->name,
               hard_gc_threshold_in_words_ / KBInWords,
-              idle_gc_threshold_in_words_ / KBInWords, reason);
+              soft_gc_threshold_in_words_ / KBInWords,
+              idle_gc_threshold_in_words_ / KBInWords,
+              near_memory_limit_ ? "true" : "false", reason);
   }
 }
 
@@ -1785,6 +2374,15 @@ void PageSpaceGarbageCollectionHistory::AddGarbageCollectionTime(int64_t start,
   history_.Add(entry);
 }
 
+int64_t PageSpaceGarbageCollectionHistory::MaxPauseMicros() const {
+  int64_t max_pause = 0;
+  for (int i = 0; i < history_.Size(); i++) {
+    Entry entry = history_.Get(i);
+    max_pause = Utils::Maximum(max_pause, entry.end - entry.start);
+  }
+  return max_pause;
+}
+
 int PageSpaceGarbageCollectionHistory::GarbageCollectionTimeFraction() {
   int64_t gc_time = 0;
   int64_t total_time = 0;
@@ -9,6 +9,7 @@
 #include "vm/globals.h"
 #include "vm/heap/freelist.h"
 #include "vm/heap/spaces.h"
+#include "vm/heap/sweeper.h"
 #include "vm/lockers.h"
 #include "vm/ring_buffer.h"
 #include "vm/thread.h"
@@ -16,6 +17,8 @@
 
 namespace dart {
 
+DECLARE_FLAG(int, evacuation_max_pages);
+DECLARE_FLAG(bool, old_gen_tlabs);
 DECLARE_FLAG(bool, write_protect_code);
 
 // Forward declarations.
@@ -24,6 +27,7 @@ class JSONObject;
 class ObjectPointerVisitor;
 class ObjectSet;
 class ForwardingPage;
+class GCCompactor;
 class GCMarker;
 
 static constexpr intptr_t kOldPageSize = 512 * KB;
@@ -58,6 +62,17 @@ class OldPage {
   ForwardingPage* forwarding_page() const { return forwarding_page_; }
   void AllocateForwardingPage();
 
+  // Bytes of the objects found live by the last marking, used to pick the
+  // most fragmented pages for partial evacuation. Objects allocated black
+  // during concurrent marking are counted when they are allocated.
+  intptr_t live_bytes() const { return live_bytes_; }
+  void AddLiveBytes(intptr_t size) { live_bytes_.fetch_add(size); }
+  void ResetLiveBytes() { live_bytes_ = 0; }
+
+  // Whether the compactor is moving the objects of this page.
+  bool is_evacuation_candidate() const { return evacuation_candidate_; }
+  void set_evacuation_candidate(bool value) { evacuation_candidate_ = value; }
+
   PageType type() const { return type_; }
 
   bool is_image_page() const { return !memory_->vm_owns_region(); }
@@ -168,7 +183,9 @@ class OldPage {
   uword used_in_bytes_;
   ForwardingPage* forwarding_page_;
   uint8_t* card_table_;  // Remembered set, not marking.
+  RelaxedAtomic<intptr_t> live_bytes_;
   PageType type_;
+  bool evacuation_candidate_;
 
   friend class PageSpace;
   friend class GCCompactor;
@@ -188,6 +205,9 @@ class PageSpaceGarbageCollectionHistory {
 
   int GarbageCollectionTimeFraction();
 
+  // The longest pause among the recorded collections.
+  int64_t MaxPauseMicros() const;
+
   bool IsEmpty() const { return history_.Size() == 0; }
 
  private:
@@ -230,6 +250,11 @@ class PageSpaceController {
   void EvaluateAfterLoading(SpaceUsage after);
   void HintFreed(intptr_t size);
 
+  // Returns whether the hard threshold was capped by the cgroup memory limit,
+  // in which case the next collection should compact to release pages rather
+  // than let the heap grow.
+  bool NearMemoryLimit() const { return near_memory_limit_; }
+
   void set_last_usage(SpaceUsage current) { last_usage_ = current; }
 
   void Enable() { is_enabled_ = true; }
@@ -269,6 +294,17 @@ class PageSpaceController {
   // we grow the heap more aggressively.
   const int garbage_collection_time_ratio_;
 
+  // Percentage of the hard threshold left free when concurrent marking starts.
+  // With --gc_target_pause this grows when pauses exceed the target, so that
+  // marking has more time to finish before the mutator reaches the hard
+  // threshold.
+  intptr_t marking_headroom_percent_;
+
+  // Upper bound on the hard threshold derived from the cgroup memory limit,
+  // or 0 if there is none.
+  intptr_t memory_limit_in_words_;
+  bool near_memory_limit_;
+
   // Perform a stop-the-world GC when usage exceeds this amount.
   intptr_t hard_gc_threshold_in_words_;
 
@@ -300,6 +336,13 @@ class PageSpace {
   uword TryAllocate(intptr_t size,
                     OldPage::PageType type = OldPage::kData,
                     GrowthPolicy growth_policy = kControlGrowth) {
+    if (FLAG_old_gen_tlabs && (type == OldPage::kData) &&
+        (size <= kTLABMaxObjectSize)) {
+      Thread* thread = Thread::Current();
+      if ((thread->heap() == heap_) && thread->IsMutatorThread()) {
+        return TryAllocateInTLAB(thread, size, growth_policy);
+      }
+    }
     bool is_protected =
         (type == OldPage::kExecutable) && FLAG_write_protect_code;
     bool is_locked = false;
@@ -318,6 +361,9 @@ class PageSpace {
   bool ReachedSoftThreshold() const {
     return page_space_controller_.ReachedSoftThreshold(usage_);
   }
+  bool NearMemoryLimit() const {
+    return page_space_controller_.NearMemoryLimit();
+  }
   bool ReachedIdleThreshold() const {
     return page_space_controller_.ReachedIdleThreshold(usage_);
   }
@@ -402,6 +448,12 @@ class PageSpace {
   bool ShouldStartIdleMarkSweep(int64_t deadline);
   bool ShouldPerformIdleMarkCompact(int64_t deadline);
 
+  // Called by the mutator at a safepoint when it is idle. Does a slice of the
+  // old-space collection in progress, if any, until [deadline]: marking what
+  // the mutator pushed after the concurrent marker finished, or sweeping
+  // pages ahead of the allocator.
+  void PerformIdleSlice(int64_t deadline);
+
   void AddGCTime(int64_t micros) { gc_time_micros_ += micros; }
 
   int64_t gc_time_micros() const { return gc_time_micros_; }
@@ -410,13 +462,19 @@ class PageSpace {
 
   intptr_t collections() const { return collections_; }
 
+  intptr_t compactions() const { return compactions_; }
+  int64_t compaction_time_micros() const { return compaction_time_micros_; }
+
 #ifndef PRODUCT
   void PrintToJSONObject(JSONObject* object) const;
   void PrintHeapMapToJSONStream(Isolate* isolate, JSONStream* stream) const;
 #endif  // PRODUCT
 
-  void AllocateBlack(intptr_t size) {
+  void AllocateBlack(ObjectPtr raw_obj, intptr_t size) {
     allocated_black_in_words_.fetch_add(size >> kWordSizeLog2);
+    if (FLAG_evacuation_max_pages > 0) {
+      OldPage::Of(raw_obj)->AddLiveBytes(size);
+    }
   }
 
   void AllocatedExternal(intptr_t size) {
@@ -460,6 +518,8 @@ class PageSpace {
   Phase phase() const { return phase_; }
   void set_phase(Phase val) { phase_ = val; }
 
+  SweepWorkList* sweep_work_list() { return &sweep_work_list_; }
+
   // Attempt to allocate from bump block rather than normal freelist.
   uword TryAllocateDataBumpLocked(intptr_t size) {
     return TryAllocateDataBumpLocked(&freelists_[OldPage::kData], size);
@@ -479,6 +539,13 @@ class PageSpace {
 
   // Return any bump allocation block to the freelist.
   void AbandonBumpAllocation();
+  // Return the remainder of the thread's old-space allocation buffer to the
+  // freelist.
+  void AbandonRemainingTLAB(Thread* thread);
+  // Lets the OS reclaim the whole pages covered by free-list elements in the
+  // data pages. Returns the number of bytes released. Called at a safepoint;
+  // waits for running sweeper tasks and does nothing while marking.
+  intptr_t ReleaseFreeMemory();
   // Have threads release marking stack blocks, etc.
   void AbandonMarkingForShutdown();
 
@@ -523,6 +590,39 @@ class PageSpace {
                                     OldPage::PageType type,
                                     GrowthPolicy growth_policy);
 
+  // Small data objects allocated by mutators are bump allocated from
+  // thread-local buffers carved from the data freelist, so that mutators of
+  // different isolates in the group only contend for the freelist lock once
+  // per buffer.
+  static constexpr intptr_t kTLABSize = 32 * KB;
+  static constexpr intptr_t kTLABMinSize = kTLABSize / 4;
+  static constexpr intptr_t kTLABMaxObjectSize = kTLABSize / 8;
+
+  DART_FORCE_INLINE
+  uword TryAllocateInTLAB(Thread* thread,
+                          intptr_t size,
+                          GrowthPolicy growth_policy) {
+    ASSERT(Utils::IsAligned(size, kObjectAlignment));
+    uword result = thread->old_top();
+    uword new_top = result + size;
+    if (new_top <= thread->old_end()) {
+      thread->set_old_top(new_top);
+      thread->set_old_unaccounted_size(thread->old_unaccounted_size() + size);
+      return result;
+    }
+    return TryAllocateInTLABSlow(thread, size, growth_policy);
+  }
+  uword TryAllocateInTLABSlow(Thread* thread,
+                              intptr_t size,
+                              GrowthPolicy growth_policy);
+  void AbandonRemainingTLABLocked(Thread* thread, bool account);
+  // Abandons the buffers of all threads. If 'account' is false, the bytes
+  // allocated from them are dropped rather than added to usage_, which is
+  // recomputed by marking.
+  void AbandonRemainingTLABs(bool account);
+  // Makes the buffers of all threads walkable; only done at a safepoint.
+  void MakeTLABsIterable() const;
+
   void EvaluateConcurrentMarking(GrowthPolicy growth_policy);
 
   // Makes bump block walkable; do not call concurrently with mutator.
@@ -550,7 +650,19 @@ class PageSpace {
   void SweepLarge();
   void Sweep();
   void ConcurrentSweep(IsolateGroup* isolate_group);
+  // Sweeps pages left by the concurrent sweeper until the allocation succeeds.
+  uword TryAllocateLazySweep(intptr_t size, FreeList* freelist);
+  // Sweeps pages left by the concurrent sweeper until [deadline].
+  void IdleSweep(int64_t deadline);
+  // Frees the pages between first and last inclusive that concurrent sweeping
+  // found empty.
+  void FreeEmptySweptPages(OldPage* first, OldPage* last);
   void Compact(Thread* thread);
+  void EvacuateFragmentedPages(Thread* thread);
+  void RecordCompaction(const GCCompactor& compactor,
+                        int64_t pause,
+                        const char* kind);
+  void ResetLiveBytes();
 
   static intptr_t LargePageSizeInWordsFor(intptr_t size);
 
@@ -600,6 +712,7 @@ class PageSpace {
   intptr_t tasks_;
   intptr_t concurrent_marker_tasks_;
   Phase phase_;
+  SweepWorkList sweep_work_list_;
 
 #if defined(DEBUG)
   Thread* iterating_thread_;
@@ -611,6 +724,28 @@ class PageSpace {
   intptr_t collections_;
   intptr_t mark_words_per_micro_;
 
+  // Statistics about sliding compactions. The copy time is the time spent
+  // sliding objects, which is the part of the pause that scales with the
+  // amount of live data moved.
+  intptr_t compactions_;
+  int64_t compaction_time_micros_;
+  int64_t last_compaction_pause_micros_;
+  int64_t max_compaction_pause_micros_;
+  int64_t last_compaction_copy_micros_;
+  intptr_t last_compaction_moved_bytes_;
+  // Partial evacuations of the most fragmented pages, also counted above.
+  intptr_t evacuations_;
+
+  // Statistics about thread-local allocation buffers. Contended refills had
+  // to wait for the freelist lock. Fallbacks found no free block of
+  // kTLABMinSize and allocated the object directly from the freelist, which
+  // indicates fragmentation, as do the remainders of abandoned buffers that
+  // are returned to the freelist.
+  RelaxedAtomic<intptr_t> tlab_refills_;
+  RelaxedAtomic<intptr_t> tlab_contended_refills_;
+  RelaxedAtomic<intptr_t> tlab_fallbacks_;
+  RelaxedAtomic<intptr_t> tlab_abandoned_bytes_;
+
   bool enable_concurrent_mark_;
 
   friend class BasePageIterator;
@@ -619,6 +754,8 @@ class PageSpace {
   friend class ExclusiveLargePageIterator;
   friend class HeapIterationScope;
   friend class HeapSnapshotWriter;
+  friend class HeapVerifier;
+  friend class ForwardingReferrerScanner;
   friend class PageSpaceController;
   friend class ConcurrentSweeperTask;
   friend class GCCompactor;
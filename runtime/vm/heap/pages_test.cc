@@ -32,4 +32,18 @@ TEST_CASE(Pages) {
   delete space;
 }
 
+TEST_CASE(PageSpaceGarbageCollectionHistory) {
+  PageSpaceGarbageCollectionHistory history;
+  EXPECT(history.IsEmpty());
+  EXPECT_EQ(0, history.MaxPauseMicros());
+  history.AddGarbageCollectionTime(0, 100);
+  history.AddGarbageCollectionTime(1000, 1400);
+  history.AddGarbageCollectionTime(2000, 2200);
+  EXPECT(!history.IsEmpty());
+  EXPECT_EQ(400, history.MaxPauseMicros());
+  // 600us of the 2100us between the first and last collection are spent in
+  // the last two collections.
+  EXPECT_EQ(28, history.GarbageCollectionTimeFraction());
+}
+
 }  // namespace dart
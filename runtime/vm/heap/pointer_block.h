@@ -5,6 +5,8 @@
 #ifndef RUNTIME_VM_HEAP_POINTER_BLOCK_H_
 #define RUNTIME_VM_HEAP_POINTER_BLOCK_H_
 
+#include <atomic>
+
 #include "platform/assert.h"
 #include "vm/globals.h"
 #include "vm/os_thread.h"
@@ -145,17 +147,152 @@ class BlockStack {
   DISALLOW_COPY_AND_ASSIGN(BlockStack);
 };
 
+// A Chase-Lev work-stealing deque of blocks (see "Correct and Efficient
+// Work-Stealing for Weak Memory Models", Le et al., PPoPP 2013). The owning
+// task pushes and pops at the bottom without locking; other tasks steal the
+// oldest blocks from the top. The capacity is fixed: when the deque is full,
+// the owner falls back to the shared BlockStack.
+template <typename Block>
+class BlockDeque {
+ public:
+  static const intptr_t kCapacity = 256;
+
+  BlockDeque() : top_(0), bottom_(0) {}
+  ~BlockDeque() { ASSERT(IsEmpty()); }
+
+  // Owner only. Returns false if the deque is full.
+  bool Push(Block* block) {
+    const intptr_t bottom = bottom_.load(std::memory_order_relaxed);
+    const intptr_t top = top_.load(std::memory_order_acquire);
+    if (bottom - top >= kCapacity) {
+      return false;
+    }
+    blocks_[bottom & kMask].store(block, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Owner only. Returns nullptr if the deque is empty.
+  Block* Pop() {
+    const intptr_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    intptr_t top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    Block* block = blocks_[bottom & kMask].load(std::memory_order_relaxed);
+    if (top == bottom) {
+      // Last block: race against thieves.
+      if (!top_.compare_exchange_strong(top, top + 1,
+                                        std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        block = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return block;
+  }
+
+  // Any task. Returns nullptr if the deque is empty or another task won the
+  // race for the top block.
+  Block* Steal() {
+    intptr_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const intptr_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return nullptr;
+    }
+    Block* block = blocks_[top & kMask].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return block;
+  }
+
+  // Racy unless called by the owner with no thieves around.
+  bool IsEmpty() const {
+    return top_.load(std::memory_order_relaxed) >=
+           bottom_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static const intptr_t kMask = kCapacity - 1;
+  COMPILE_ASSERT((kCapacity & kMask) == 0);
+
+  std::atomic<intptr_t> top_;
+  std::atomic<intptr_t> bottom_;
+  std::atomic<Block*> blocks_[kCapacity];
+
+  DISALLOW_COPY_AND_ASSIGN(BlockDeque);
+};
+
+// One BlockDeque per task of a parallel marking or scavenging phase.
+template <typename Block>
+class BlockDeques {
+ public:
+  explicit BlockDeques(intptr_t length)
+      : length_(length), deques_(new BlockDeque<Block>[length]) {}
+  ~BlockDeques() { delete[] deques_; }
+
+  intptr_t length() const { return length_; }
+  BlockDeque<Block>* At(intptr_t index) {
+    ASSERT((index >= 0) && (index < length_));
+    return &deques_[index];
+  }
+
+  // Tries each of the other tasks' deques in turn, starting after [thief]'s
+  // own to spread thieves over victims.
+  Block* Steal(intptr_t thief) {
+    for (intptr_t i = 1; i < length_; i++) {
+      Block* block = deques_[(thief + i) % length_].Steal();
+      if (block != nullptr) {
+        return block;
+      }
+    }
+    return nullptr;
+  }
+
+  bool IsEmpty() const {
+    for (intptr_t i = 0; i < length_; i++) {
+      if (!deques_[i].IsEmpty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  const intptr_t length_;
+  BlockDeque<Block>* const deques_;
+
+  DISALLOW_COPY_AND_ASSIGN(BlockDeques);
+};
+
 template <typename Stack>
 class BlockWorkList : public ValueObject {
  public:
   typedef typename Stack::Block Block;
 
-  explicit BlockWorkList(Stack* stack) : stack_(stack) {
+  explicit BlockWorkList(Stack* stack) : BlockWorkList(stack, nullptr, 0) {}
+
+  // With [deques], full blocks are kept in this task's deque at
+  // [deque_index] rather than handed off through [stack], and an idle task
+  // steals from the other tasks' deques.
+  BlockWorkList(Stack* stack, BlockDeques<Block>* deques, intptr_t deque_index)
+      : stack_(stack),
+        deques_(deques),
+        deque_(deques != nullptr ? deques->At(deque_index) : nullptr),
+        deque_index_(deque_index) {
     work_ = stack_->PopEmptyBlock();
   }
 
   ~BlockWorkList() {
     ASSERT(work_ == nullptr);
+    ASSERT(spare_ == nullptr);
     ASSERT(stack_ == nullptr);
   }
 
@@ -163,13 +300,16 @@ class BlockWorkList : public ValueObject {
   ObjectPtr Pop() {
     ASSERT(work_ != nullptr);
     if (work_->IsEmpty()) {
-      // TODO(koda): Track over/underflow events and use in heuristics to
-      // distribute work and prevent degenerate flip-flopping.
-      Block* new_work = stack_->PopNonEmptyBlock();
+      Block* new_work = PopNonEmptyBlock();
       if (new_work == nullptr) {
         return nullptr;
       }
-      stack_->PushBlock(work_);
+      // Keep one empty block around to avoid the global empty block cache.
+      if (spare_ == nullptr) {
+        spare_ = work_;
+      } else {
+        stack_->PushBlock(work_);
+      }
       work_ = new_work;
       // Generated code appends to marking stacks; tell MemorySanitizer.
       MSAN_UNPOISON(work_, sizeof(*work_));
@@ -179,18 +319,25 @@ class BlockWorkList : public ValueObject {
 
   void Push(ObjectPtr raw_obj) {
     if (work_->IsFull()) {
-      // TODO(koda): Track over/underflow events and use in heuristics to
-      // distribute work and prevent degenerate flip-flopping.
-      stack_->PushBlock(work_);
-      work_ = stack_->PopEmptyBlock();
+      if ((deque_ == nullptr) || !deque_->Push(work_)) {
+        stack_->PushBlock(work_);
+      }
+      if (spare_ != nullptr) {
+        work_ = spare_;
+        spare_ = nullptr;
+      } else {
+        work_ = stack_->PopEmptyBlock();
+      }
     }
     work_->Push(raw_obj);
   }
 
   void Finalize() {
     ASSERT(work_->IsEmpty());
+    ASSERT((deque_ == nullptr) || deque_->IsEmpty());
     stack_->PushBlock(work_);
     work_ = nullptr;
+    ReleaseSpare();
     // Fail fast on attempts to mark after finalizing.
     stack_ = nullptr;
   }
@@ -198,6 +345,13 @@ class BlockWorkList : public ValueObject {
   void AbandonWork() {
     stack_->PushBlock(work_);
     work_ = nullptr;
+    ReleaseSpare();
+    if (deque_ != nullptr) {
+      Block* block;
+      while ((block = deque_->Pop()) != nullptr) {
+        stack_->PushBlock(block);
+      }
+    }
     stack_ = nullptr;
   }
 
@@ -205,12 +359,47 @@ class BlockWorkList : public ValueObject {
     if (!work_->IsEmpty()) {
       return false;
     }
+    if ((deques_ != nullptr) && !deques_->IsEmpty()) {
+      return false;
+    }
     return stack_->IsEmpty();
   }
 
+  // Number of blocks taken from other tasks' deques.
+  intptr_t steals() const { return steals_; }
+
  private:
+  Block* PopNonEmptyBlock() {
+    if (deque_ != nullptr) {
+      Block* block = deque_->Pop();
+      if (block != nullptr) {
+        return block;
+      }
+    }
+    Block* block = stack_->PopNonEmptyBlock();
+    if ((block == nullptr) && (deques_ != nullptr)) {
+      block = deques_->Steal(deque_index_);
+      if (block != nullptr) {
+        steals_++;
+      }
+    }
+    return block;
+  }
+
+  void ReleaseSpare() {
+    if (spare_ != nullptr) {
+      stack_->PushBlock(spare_);
+      spare_ = nullptr;
+    }
+  }
+
   Block* work_;
+  Block* spare_ = nullptr;
   Stack* stack_;
+  BlockDeques<Block>* deques_;
+  BlockDeque<Block>* deque_;
+  intptr_t deque_index_;
+  intptr_t steals_ = 0;
 };
 
 static const int kStoreBufferBlockSize = 1024;
@@ -0,0 +1,202 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/heap/pretenuring.h"
+
+#include "vm/class_table.h"
+#include "vm/flags.h"
+#include "vm/heap/scavenger.h"
+#include "vm/isolate.h"
+#include "vm/json_stream.h"
+#include "vm/log.h"
+#include "vm/object.h"
+#include "vm/raw_object.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool,
+            pretenure,
+            false,
+            "Allocate instances of classes that mostly survive scavenges "
+            "directly in old space.");
+DEFINE_FLAG(int,
+            pretenure_sample_interval,
+            4,
+            "Sample allocation-site feedback every this many scavenges.");
+DEFINE_FLAG(int,
+            pretenure_survival_percent,
+            90,
+            "Pretenure a class when at least this percentage of its new-space "
+            "allocations are promoted.");
+DEFINE_FLAG(int,
+            pretenure_min_kb,
+            256,
+            "Only pretenure classes with at least this much recent new-space "
+            "allocation.");
+DEFINE_FLAG(bool, trace_pretenuring, false, "Trace pretenuring decisions.");
+
+// Whether allocations of [cid] that take the slow path reach a runtime entry
+// that honors the pretenure bit. Setting the bit for other classes would only
+// slow down their allocation.
+static bool CanPretenure(intptr_t cid) {
+  switch (cid) {
+    case kArrayCid:
+    case kContextCid:
+    case kGrowableObjectArrayCid:
+    case kLinkedHashMapCid:
+      return true;
+    default:
+      return cid >= kNumPredefinedCids;
+  }
+}
+
+AllocationSiteFeedback::~AllocationSiteFeedback() {
+  free(sites_);
+}
+
+void AllocationSiteFeedback::EnsureCapacity(intptr_t num_cids) {
+  if (num_cids <= capacity_) {
+    return;
+  }
+  Site* sites =
+      reinterpret_cast<Site*>(realloc(sites_, num_cids * sizeof(Site)));
+  memset(&sites[capacity_], 0, (num_cids - capacity_) * sizeof(Site));
+  sites_ = sites;
+  capacity_ = num_cids;
+}
+
+void AllocationSiteFeedback::BeginScavenge(IsolateGroup* isolate_group,
+                                           NewPage* head) {
+  counting_promotions_ = false;
+#if !defined(PRODUCT)
+  if (!FLAG_pretenure || (FLAG_pretenure_sample_interval <= 0)) {
+    return;
+  }
+  const intptr_t phase = scavenges_++ % FLAG_pretenure_sample_interval;
+  if (phase == 0) {
+    // Start a sample: record the bytes allocated per class since the last
+    // scavenge. These are the objects this scavenge copies within new space
+    // and the next one promotes.
+    num_cids_ = isolate_group->shared_class_table()->NumCids();
+    EnsureCapacity(num_cids_);
+    for (intptr_t cid = 0; cid < num_cids_; cid++) {
+      sites_[cid].sample_allocated_bytes = 0;
+      sites_[cid].sample_promoted_bytes = 0;
+    }
+    for (NewPage* page = head; page != nullptr; page = page->next()) {
+      uword addr = page->object_start();
+      const uword end = page->object_end();
+      while (addr < end) {
+        ObjectPtr obj = ObjectLayout::FromAddr(addr);
+        const intptr_t size = obj->ptr()->HeapSize();
+        if (!page->IsSurvivor(addr)) {
+          sites_[obj->GetClassId()].sample_allocated_bytes += size;
+        }
+        addr += size;
+      }
+    }
+  } else if ((phase == 1) && (num_cids_ > 0)) {
+    // Complete the sample.
+    counting_promotions_ = true;
+  }
+#endif  // !defined(PRODUCT)
+}
+
+void AllocationSiteFeedback::AddPromoted(const intptr_t* promoted_by_cid) {
+  ASSERT(counting_promotions_);
+  for (intptr_t cid = 0; cid < num_cids_; cid++) {
+    sites_[cid].sample_promoted_bytes += promoted_by_cid[cid];
+  }
+}
+
+void AllocationSiteFeedback::EndScavenge(IsolateGroup* isolate_group) {
+  if (!counting_promotions_) {
+    return;
+  }
+  counting_promotions_ = false;
+  samples_++;
+  for (intptr_t cid = 0; cid < num_cids_; cid++) {
+    Site* site = &sites_[cid];
+    site->allocated_bytes =
+        site->allocated_bytes / 2 + site->sample_allocated_bytes;
+    site->promoted_bytes =
+        site->promoted_bytes / 2 + site->sample_promoted_bytes;
+  }
+  UpdateDecisions(isolate_group);
+}
+
+void AllocationSiteFeedback::UpdateDecisions(IsolateGroup* isolate_group) {
+#if !defined(PRODUCT)
+  SharedClassTable* class_table = isolate_group->shared_class_table();
+  const intptr_t min_bytes = static_cast<intptr_t>(FLAG_pretenure_min_kb) * KB;
+  for (intptr_t cid = kIllegalCid + 1; cid < num_cids_; cid++) {
+    Site* site = &sites_[cid];
+    if (site->pretenured || (site->allocated_bytes < min_bytes) ||
+        !CanPretenure(cid) || !class_table->HasValidClassAt(cid)) {
+      continue;
+    }
+    if (site->promoted_bytes * 100 >=
+        site->allocated_bytes * FLAG_pretenure_survival_percent) {
+      site->pretenured = true;
+      pretenured_classes_++;
+      class_table->SetPretenureFor(cid, true);
+      if (FLAG_trace_pretenuring) {
+        THR_Print("Pretenuring cid %" Pd ": %" Pd " of %" Pd
+                  " bytes promoted\n",
+                  cid, site->promoted_bytes, site->allocated_bytes);
+      }
+    }
+  }
+#endif  // !defined(PRODUCT)
+}
+
+void AllocationSiteFeedback::Reset(IsolateGroup* isolate_group) {
+  if (pretenured_classes_ == 0) {
+    return;
+  }
+#if !defined(PRODUCT)
+  SharedClassTable* class_table = isolate_group->shared_class_table();
+  for (intptr_t cid = 0; cid < num_cids_; cid++) {
+    Site* site = &sites_[cid];
+    if (site->pretenured) {
+      site->pretenured = false;
+      site->allocated_bytes = 0;
+      site->promoted_bytes = 0;
+      class_table->SetPretenureFor(cid, false);
+    }
+  }
+#endif  // !defined(PRODUCT)
+  pretenured_classes_ = 0;
+}
+
+#ifndef PRODUCT
+void AllocationSiteFeedback::PrintToJSONStream(Isolate* isolate,
+                                               JSONStream* stream) const {
+  JSONObject obj(stream);
+  obj.AddProperty("type", "_AllocationSiteFeedback");
+  obj.AddProperty("enabled", FLAG_pretenure);
+  obj.AddProperty("samples", samples_);
+  obj.AddProperty("pretenuredClasses", pretenured_classes_);
+  ClassTable* class_table = isolate->class_table();
+  Class& cls = Class::Handle();
+  JSONArray sites(&obj, "sites");
+  for (intptr_t cid = kIllegalCid + 1; cid < num_cids_; cid++) {
+    const Site& site = sites_[cid];
+    if ((site.allocated_bytes == 0) || !CanPretenure(cid) ||
+        !class_table->HasValidClassAt(cid)) {
+      continue;
+    }
+    cls = class_table->At(cid);
+    JSONObject site_obj(&sites);
+    site_obj.AddProperty("class", cls);
+    site_obj.AddProperty64("allocatedBytes", site.allocated_bytes);
+    site_obj.AddProperty64("promotedBytes", site.promoted_bytes);
+    site_obj.AddProperty("survivalPercent",
+                         100.0 * site.promoted_bytes / site.allocated_bytes);
+    site_obj.AddProperty("pretenured", site.pretenured);
+  }
+}
+#endif  // !PRODUCT
+
+}  // namespace dart
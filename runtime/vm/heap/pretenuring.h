@@ -0,0 +1,92 @@
+// Copyright (c) 2020, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef RUNTIME_VM_HEAP_PRETENURING_H_
+#define RUNTIME_VM_HEAP_PRETENURING_H_
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+// Forward declarations.
+class Isolate;
+class IsolateGroup;
+class JSONStream;
+class NewPage;
+
+// Allocation-site feedback used to pretenure objects that would otherwise be
+// copied twice by the scavenger, once within new space and once more when
+// they are promoted.
+//
+// Sites are identified by the class id of the allocated object, which is the
+// key the allocation stubs and AllocateObjectInstr already use to decide
+// whether to take the allocation slow path. Feedback is sampled over a pair of
+// consecutive scavenges: the first records the bytes allocated per class since
+// the previous scavenge, the second records how many of those bytes are
+// promoted. Classes whose allocations are mostly promoted get their pretenure
+// bit set in the shared class table, which sends their allocations to the
+// runtime, where they are allocated directly in old space.
+//
+// Pretenuring decisions are dropped at every old-space collection, after which
+// the classes are sampled again.
+class AllocationSiteFeedback {
+ public:
+  AllocationSiteFeedback() {}
+  ~AllocationSiteFeedback();
+
+  // Called at the start of every scavenge, at a safepoint, before the
+  // semi-spaces are flipped.
+  void BeginScavenge(IsolateGroup* isolate_group, NewPage* head);
+
+  // Called at the end of every scavenge that was not aborted.
+  void EndScavenge(IsolateGroup* isolate_group);
+
+  // Called at every old-space collection.
+  void Reset(IsolateGroup* isolate_group);
+
+  // Whether the current scavenge counts promoted bytes per class, and the
+  // number of entries the per-task counters must have.
+  bool counting_promotions() const { return counting_promotions_; }
+  intptr_t num_cids() const { return num_cids_; }
+
+  // Adds the promoted bytes counted by one scavenger task.
+  void AddPromoted(const intptr_t* promoted_by_cid);
+
+  intptr_t pretenured_classes() const { return pretenured_classes_; }
+
+#ifndef PRODUCT
+  void PrintToJSONStream(Isolate* isolate, JSONStream* stream) const;
+#endif  // !PRODUCT
+
+ private:
+  struct Site {
+    // Exponentially decayed sums over the samples taken so far.
+    intptr_t allocated_bytes;
+    intptr_t promoted_bytes;
+    // Bytes allocated and promoted in the current sample.
+    intptr_t sample_allocated_bytes;
+    intptr_t sample_promoted_bytes;
+    bool pretenured;
+  };
+
+  void EnsureCapacity(intptr_t num_cids);
+  void UpdateDecisions(IsolateGroup* isolate_group);
+
+  Site* sites_ = nullptr;
+  intptr_t capacity_ = 0;
+  intptr_t num_cids_ = 0;
+
+  intptr_t scavenges_ = 0;
+  intptr_t samples_ = 0;
+  bool counting_promotions_ = false;
+
+  intptr_t pretenured_classes_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(AllocationSiteFeedback);
+};
+
+}  // namespace dart
+
+#endif  // RUNTIME_VM_HEAP_PRETENURING_H_
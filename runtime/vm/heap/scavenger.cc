@@ -4,6 +4,8 @@
 
 #include "vm/heap/scavenger.h"
 
+#include <math.h>
+
 #include "platform/leak_sanitizer.h"
 #include "vm/dart.h"
 #include "vm/dart_api_state.h"
@@ -15,6 +17,7 @@
 #include "vm/heap/weak_table.h"
 #include "vm/isolate.h"
 #include "vm/lockers.h"
+#include "vm/log.h"
 #include "vm/longjump.h"
 #include "vm/object.h"
 #include "vm/object_id_ring.h"
@@ -37,6 +40,8 @@ DEFINE_FLAG(int,
             90,
             "Grow new gen when less than this percentage is garbage.");
 DEFINE_FLAG(int, new_gen_growth_factor, 2, "Grow new gen by this factor.");
+DECLARE_FLAG(int, gc_target_pause);
+DECLARE_FLAG(int, allocation_sample_interval);
 
 // Scavenger uses the kCardRememberedBit to distinguish forwarded and
 // non-forwarded objects. We must choose a bit that is clear for all new-space
@@ -109,7 +114,9 @@ class ScavengerVisitorBase : public ObjectPointerVisitor {
                                 Scavenger* scavenger,
                                 SemiSpace* from,
                                 FreeList* freelist,
-                                PromotionStack* promotion_stack)
+                                PromotionStack* promotion_stack,
+                                BlockDeques<PromotionStackBlock>* deques,
+                                intptr_t task_index)
       : ObjectPointerVisitor(isolate_group),
         thread_(nullptr),
         scavenger_(scavenger),
@@ -117,8 +124,20 @@ class ScavengerVisitorBase : public ObjectPointerVisitor {
         page_space_(scavenger->heap_->old_space()),
         freelist_(freelist),
         bytes_promoted_(0),
+        bytes_copied_(0),
+        idle_micros_(0),
+        promoted_by_cid_(nullptr),
+        num_promoted_cids_(0),
         visiting_old_object_(nullptr),
-        promoted_list_(promotion_stack) {}
+        promoted_list_(promotion_stack, deques, task_index) {
+    AllocationSiteFeedback* feedback = scavenger->allocation_site_feedback();
+    if (feedback->counting_promotions()) {
+      num_promoted_cids_ = feedback->num_cids();
+      promoted_by_cid_ = reinterpret_cast<intptr_t*>(
+          calloc(num_promoted_cids_, sizeof(intptr_t)));
+    }
+  }
+  ~ScavengerVisitorBase() { free(promoted_by_cid_); }
 
   virtual void VisitTypedDataViewPointers(TypedDataViewPtr view,
                                           ObjectPtr* first,
@@ -176,6 +195,12 @@ class ScavengerVisitorBase : public ObjectPointerVisitor {
   }
 
   intptr_t bytes_promoted() const { return bytes_promoted_; }
+  intptr_t bytes_copied() const { return bytes_copied_; }
+  // Bytes promoted per class id, when sampling allocation-site feedback.
+  const intptr_t* promoted_by_cid() const { return promoted_by_cid_; }
+  intptr_t steals() const { return promoted_list_.steals(); }
+  int64_t idle_micros() const { return idle_micros_; }
+  void AddIdleMicros(int64_t micros) { idle_micros_ += micros; }
 
   void ProcessRoots() {
     thread_ = Thread::Current();
@@ -289,6 +314,9 @@ class ScavengerVisitorBase : public ObjectPointerVisitor {
         // Not a survivor of a previous scavenge. Just copy the object into the
         // to space.
         new_addr = TryAllocateCopy(size);
+        if (LIKELY(new_addr != 0)) {
+          bytes_copied_ += size;
+        }
       }
       if (new_addr == 0) {
         // This object is a survivor of a previous scavenge. Attempt to promote
@@ -308,6 +336,7 @@ class ScavengerVisitorBase : public ObjectPointerVisitor {
           if (UNLIKELY(new_addr == 0)) {
             AbortScavenge();
           }
+          bytes_copied_ += size;
         }
       }
       ASSERT(new_addr != 0);
@@ -315,8 +344,14 @@ class ScavengerVisitorBase : public ObjectPointerVisitor {
       objcpy(reinterpret_cast<void*>(new_addr),
              reinterpret_cast<void*>(raw_addr), size);
 
+      intptr_t cid = ObjectLayout::ClassIdTag::decode(header);
       new_obj = ObjectLayout::FromAddr(new_addr);
       if (new_obj->IsOldObject()) {
+        // Classes registered since the scavenge started are not counted.
+        if (UNLIKELY(promoted_by_cid_ != nullptr) &&
+            (cid < num_promoted_cids_)) {
+          promoted_by_cid_[cid] += size;
+        }
         // Promoted: update age/barrier tags.
         uint32_t tags = static_cast<uint32_t>(header);
         tags = ObjectLayout::OldBit::update(true, tags);
@@ -332,7 +367,6 @@ class ScavengerVisitorBase : public ObjectPointerVisitor {
         new_obj->ptr()->tags_ = tags;
       }
 
-      intptr_t cid = ObjectLayout::ClassIdTag::decode(header);
       if (IsTypedDataClassId(cid)) {
         static_cast<TypedDataPtr>(new_obj)->ptr()->RecomputeDataField();
       }
@@ -345,9 +379,14 @@ class ScavengerVisitorBase : public ObjectPointerVisitor {
           // Abandon as a free list element.
           FreeListElement::AsElement(new_addr, size);
           bytes_promoted_ -= size;
+          if (UNLIKELY(promoted_by_cid_ != nullptr) &&
+              (cid < num_promoted_cids_)) {
+            promoted_by_cid_[cid] -= size;
+          }
         } else {
           // Undo to-space allocation.
           tail_->Unallocate(new_addr, size);
+          bytes_copied_ -= size;
         }
         // Use the winner's forwarding target.
         new_obj = ForwardedObj(header);
@@ -423,6 +462,10 @@ class ScavengerVisitorBase : public ObjectPointerVisitor {
   PageSpace* page_space_;
   FreeList* freelist_;
   intptr_t bytes_promoted_;
+  intptr_t bytes_copied_;  // Within new space.
+  int64_t idle_micros_;
+  intptr_t* promoted_by_cid_;
+  intptr_t num_promoted_cids_;
   ObjectPtr visiting_old_object_;
 
   PromotionWorkList promoted_list_;
@@ -507,8 +550,10 @@ class ParallelScavengerTask : public ThreadPool::Task {
         // Wait for some work to appear.
         // TODO(iposva): Replace busy-waiting with a solution using Monitor,
         // and redraw the boundaries between stack/visitor/task as needed.
+        int64_t idle_start = OS::GetCurrentMonotonicMicros();
         while (!visitor_->HasWork() && num_busy_->load() > 0) {
         }
+        visitor_->AddIdleMicros(OS::GetCurrentMonotonicMicros() - idle_start);
 
         // If no tasks are busy, there will never be more work.
         if (num_busy_->load() == 0) break;
@@ -588,22 +633,47 @@ void SemiSpace::Init() {
 }
 
 void SemiSpace::Cleanup() {
-  {
-    MutexLocker ml(page_cache_mutex);
-    ASSERT(page_cache_size >= 0);
-    ASSERT(page_cache_size <= kPageCacheCapacity);
-    while (page_cache_size > 0) {
-      delete page_cache[--page_cache_size];
-    }
-  }
+  ClearCache();
   delete page_cache_mutex;
   page_cache_mutex = nullptr;
 }
 
+void SemiSpace::ClearCache() {
+  MutexLocker ml(page_cache_mutex);
+  ASSERT(page_cache_size >= 0);
+  ASSERT(page_cache_size <= kPageCacheCapacity);
+  while (page_cache_size > 0) {
+    delete page_cache[--page_cache_size];
+  }
+}
+
 intptr_t SemiSpace::CachedSize() {
   return page_cache_size * kNewPageSize;
 }
 
+// Reserves a huge-page backed chunk of new-space pages. All but the returned
+// page go to the page cache, so later semi-space flips reuse the chunk rather
+// than mapping and unmapping individual pages.
+static VirtualMemory* AllocateHugePageChunk(intptr_t numa_node) {
+  const intptr_t kPagesPerChunk = (2 * MB) / kNewPageSize;
+  VirtualMemory* pages[kPagesPerChunk];
+  const intptr_t count = VirtualMemory::AllocateHugePageSegments(
+      kNewPageSize, kPagesPerChunk, numa_node, pages);
+  if (count == 0) {
+    return nullptr;
+  }
+  MutexLocker ml(page_cache_mutex);
+  for (intptr_t i = 1; i < count; i++) {
+    if (page_cache_size < kPageCacheCapacity) {
+      MSAN_POISON(pages[i]->address(), pages[i]->size());
+      page_cache[page_cache_size++] = pages[i];
+    } else {
+      delete pages[i];
+    }
+  }
+  return pages[0];
+}
+
 NewPage* NewPage::Allocate() {
   const intptr_t size = kNewPageSize;
   VirtualMemory* memory = nullptr;
@@ -616,11 +686,24 @@ NewPage* NewPage::Allocate() {
     }
   }
   if (memory == nullptr) {
-    const intptr_t alignment = kNewPageSize;
-    const bool is_executable = false;
-    const char* const name = Heap::RegionName(Heap::kNew);
-    memory =
-        VirtualMemory::AllocateAligned(size, alignment, is_executable, name);
+    Thread* thread = Thread::Current();
+    const intptr_t numa_node =
+        (thread != nullptr) && (thread->heap() != nullptr)
+            ? thread->heap()->numa_node()
+            : -1;
+    if (FLAG_huge_heap_pages) {
+      memory = AllocateHugePageChunk(numa_node);
+    }
+    if (memory == nullptr) {
+      const intptr_t alignment = kNewPageSize;
+      const bool is_executable = false;
+      const char* const name = Heap::RegionName(Heap::kNew);
+      memory =
+          VirtualMemory::AllocateAligned(size, alignment, is_executable, name);
+      if ((memory != nullptr) && (numa_node >= 0)) {
+        memory->PreferNumaNode(numa_node);
+      }
+    }
   }
   if (memory == nullptr) {
     return nullptr;  // Out of memory.
@@ -636,6 +719,7 @@ NewPage* NewPage::Allocate() {
   result->memory_ = memory;
   result->next_ = nullptr;
   result->owner_ = nullptr;
+  result->owner_isolate_ = nullptr;
   uword top = result->object_start();
   result->top_ = top;
   result->end_ = memory->end() - kNewObjectAlignmentOffset;
@@ -668,6 +752,82 @@ void NewPage::Deallocate() {
   delete memory;
 }
 
+void NewPage::Release(Thread* thread) {
+  ASSERT(owner_ == thread);
+  if (owner_isolate_ != nullptr) {
+    owner_isolate_->AddAllocatedNewBytes(thread->top() - top_);
+  }
+#if !defined(PRODUCT)
+  thread->set_allocation_sample_bytes_left(
+      thread->allocation_sample_bytes_left() -
+      (thread->top() - thread->allocation_sample_top()));
+#endif
+  owner_ = nullptr;
+  owner_isolate_ = nullptr;
+  top_ = thread->top();
+  thread->set_top(0);
+  thread->set_end(0);
+}
+
+#if !defined(PRODUCT)
+// The number of bytes to allocate until the next sample. Drawn from an
+// exponential distribution, so that the samples form a Poisson process over
+// the allocated bytes and are not biased by regular allocation patterns.
+static intptr_t NextAllocationSampleInterval(Thread* thread) {
+  // Uniform in (0, 1].
+  const double uniform =
+      (static_cast<double>(thread->GetRandomUInt64() >> 11) + 1.0) /
+      static_cast<double>(static_cast<uint64_t>(1) << 53);
+  const intptr_t interval =
+      static_cast<intptr_t>(-log(uniform) * FLAG_allocation_sample_interval);
+  return Utils::Maximum<intptr_t>(
+      Utils::RoundUp(interval, kObjectAlignment), kObjectAlignment);
+}
+
+uword NewPage::SampledEnd(Thread* thread, uword top, uword end) {
+  thread->set_allocation_sample_top(top);
+  if (FLAG_allocation_sample_interval <= 0) {
+    return end;
+  }
+  if (thread->allocation_sample_bytes_left() <= 0) {
+    thread->set_allocation_sample_bytes_left(
+        NextAllocationSampleInterval(thread));
+  }
+  const intptr_t available = end - top;
+  if (thread->allocation_sample_bytes_left() >= available) {
+    return end;
+  }
+  return top + thread->allocation_sample_bytes_left();
+}
+
+bool NewPage::TrySampleAllocation(Thread* thread, intptr_t size) {
+  const uword top = thread->top();
+  if (top == 0) {
+    return false;  // No TLAB.
+  }
+  NewPage* page = NewPage::Of(top - 1);
+  ASSERT(page->owner() == thread);
+  if ((thread->end() == page->end_) ||
+      (size > static_cast<intptr_t>(page->end_ - top))) {
+    // The TLAB is not cut short, or the allocation needs a new TLAB anyway.
+    return false;
+  }
+
+  if (FLAG_allocation_sample_interval > 0) {
+    // Weigh the sample by the inverse of the probability that an allocation
+    // of this size is sampled, so the sampled bytes are an unbiased estimate
+    // of the allocated bytes.
+    const double mean = FLAG_allocation_sample_interval;
+    const double probability = 1.0 - exp(-size / mean);
+    thread->set_pending_allocation_sample_bytes(
+        static_cast<intptr_t>(size / probability));
+  }
+  thread->set_allocation_sample_bytes_left(0);
+  thread->set_end(SampledEnd(thread, top + size, page->end_));
+  return true;
+}
+#endif  // !defined(PRODUCT)
+
 NewPage* SemiSpace::TryAllocatePageLocked(bool link) {
   if (capacity_in_words_ >= max_capacity_in_words_) {
     return nullptr;  // Full.
@@ -749,8 +909,7 @@ Scavenger::Scavenger(Heap* heap, intptr_t max_semi_capacity_in_words)
   ASSERT(Object::tags_offset() == 0);
 
   // Set initial semi space size in words.
-  const intptr_t initial_semi_capacity_in_words = Utils::Minimum(
-      max_semi_capacity_in_words, FLAG_new_gen_semi_initial_size * MBInWords);
+  const intptr_t initial_semi_capacity_in_words = MinSizeInWords();
 
   to_ = new SemiSpace(initial_semi_capacity_in_words);
   idle_scavenge_threshold_in_words_ = initial_semi_capacity_in_words;
@@ -765,12 +924,34 @@ Scavenger::~Scavenger() {
   ASSERT(blocks_ == nullptr);
 }
 
+intptr_t Scavenger::MinSizeInWords() const {
+  return Utils::Minimum(max_semi_capacity_in_words_,
+                        FLAG_new_gen_semi_initial_size * MBInWords);
+}
+
 intptr_t Scavenger::NewSizeInWords(intptr_t old_size_in_words) const {
+  if (shrink_) {
+    return MinSizeInWords();
+  }
   if (stats_history_.Size() == 0) {
     return old_size_in_words;
   }
+  bool can_grow = true;
+  if (FLAG_gc_target_pause > 0) {
+    // Scavenge pauses grow with the size of new space. Shrink it when the
+    // last pause exceeded the target, and only grow it when the pause is
+    // expected to stay within the target afterwards.
+    const int64_t target_micros =
+        static_cast<int64_t>(FLAG_gc_target_pause) *
+        kMicrosecondsPerMillisecond;
+    const int64_t pause_micros = stats_history_.Get(0).DurationMicros();
+    if (pause_micros > target_micros) {
+      return Utils::Maximum(MinSizeInWords(), old_size_in_words / 2);
+    }
+    can_grow = pause_micros * FLAG_new_gen_growth_factor <= target_micros;
+  }
   double garbage = stats_history_.Get(0).ExpectedGarbageFraction();
-  if (garbage < (FLAG_new_gen_garbage_threshold / 100.0)) {
+  if (can_grow && (garbage < (FLAG_new_gen_garbage_threshold / 100.0))) {
     return Utils::Minimum(max_semi_capacity_in_words_,
                           old_size_in_words * FLAG_new_gen_growth_factor);
   } else {
@@ -889,6 +1070,7 @@ SemiSpace* Scavenger::Prologue() {
   SemiSpace* from = to_;
 
   to_ = new SemiSpace(NewSizeInWords(from->max_capacity_in_words()));
+  shrink_ = false;
   UpdateMaxHeapCapacity();
 
   return from;
@@ -1298,6 +1480,14 @@ void Scavenger::MournWeakTables() {
     const auto selector = static_cast<Heap::WeakSelector>(sel);
     auto table = heap_->GetWeakTable(Heap::kNew, selector);
     auto table_old = heap_->GetWeakTable(Heap::kOld, selector);
+    table_old->ReleaseRetiredExclusive();
+
+    // Most tables have no new-space entries. Keep those as they are instead of
+    // allocating a replacement.
+    if (table->used() == 0) {
+      table->ReleaseRetiredExclusive();
+      continue;
+    }
 
     // Create a new weak table for the new-space.
     auto table_new = WeakTable::NewFrom(table);
@@ -1501,6 +1691,7 @@ void Scavenger::Scavenge() {
     }
     promo_candidate_words += page->promo_candidate_words();
   }
+  allocation_site_feedback_.BeginScavenge(heap_->isolate_group(), to_->head());
   SemiSpace* from = Prologue();
 
   intptr_t bytes_promoted;
@@ -1512,10 +1703,14 @@ void Scavenger::Scavenge() {
   if (abort_) {
     ReverseScavenge(&from);
     bytes_promoted = 0;
-  } else if ((CapacityInWords() - UsedInWords()) < KBInWords) {
-    // Don't scavenge again until the next old-space GC has occurred. Prevents
-    // performing one scavenge per allocation as the heap limit is approached.
-    heap_->assume_scavenge_will_fail_ = true;
+  } else {
+    allocation_site_feedback_.EndScavenge(heap_->isolate_group());
+    if ((CapacityInWords() - UsedInWords()) < KBInWords) {
+      // Don't scavenge again until the next old-space GC has occurred.
+      // Prevents performing one scavenge per allocation as the heap limit is
+      // approached.
+      heap_->assume_scavenge_will_fail_ = true;
+    }
   }
   ASSERT(promotion_stack_.IsEmpty());
   MournWeakHandles();
@@ -1528,7 +1723,9 @@ void Scavenger::Scavenge() {
   int64_t end = OS::GetCurrentMonotonicMicros();
   stats_history_.Add(ScavengeStats(
       start, end, usage_before, GetCurrentUsage(), promo_candidate_words,
-      bytes_promoted >> kWordSizeLog2, abandoned_bytes >> kWordSizeLog2));
+      bytes_promoted >> kWordSizeLog2, abandoned_bytes >> kWordSizeLog2,
+      bytes_copied_ >> kWordSizeLog2, max_task_bytes_copied_ >> kWordSizeLog2,
+      steals_, idle_micros_));
   Epilogue(from);
 
   if (FLAG_verify_after_gc) {
@@ -1546,7 +1743,7 @@ void Scavenger::Scavenge() {
 intptr_t Scavenger::SerialScavenge(SemiSpace* from) {
   FreeList* freelist = heap_->old_space()->DataFreeList(0);
   SerialScavengerVisitor visitor(heap_->isolate_group(), this, from, freelist,
-                                 &promotion_stack_);
+                                 &promotion_stack_, /*deques=*/nullptr, 0);
   visitor.ProcessRoots();
   {
     TIMELINE_FUNCTION_GC_DURATION(Thread::Current(), "ProcessToSpace");
@@ -1555,6 +1752,12 @@ intptr_t Scavenger::SerialScavenge(SemiSpace* from) {
   visitor.Finalize();
 
   to_->AddList(visitor.head(), visitor.tail());
+  if (visitor.promoted_by_cid() != nullptr) {
+    allocation_site_feedback_.AddPromoted(visitor.promoted_by_cid());
+  }
+  bytes_copied_ = max_task_bytes_copied_ = visitor.bytes_copied();
+  steals_ = 0;
+  idle_micros_ = 0;
   return visitor.bytes_promoted();
 }
 
@@ -1565,13 +1768,15 @@ intptr_t Scavenger::ParallelScavenge(SemiSpace* from) {
 
   ThreadBarrier barrier(num_tasks, heap_->barrier(), heap_->barrier_done());
   RelaxedAtomic<uintptr_t> num_busy = num_tasks;
+  BlockDeques<PromotionStackBlock> deques(num_tasks);
 
   ParallelScavengerVisitor** visitors =
       new ParallelScavengerVisitor*[num_tasks];
   for (intptr_t i = 0; i < num_tasks; i++) {
     FreeList* freelist = heap_->old_space()->DataFreeList(i);
-    visitors[i] = new ParallelScavengerVisitor(
-        heap_->isolate_group(), this, from, freelist, &promotion_stack_);
+    visitors[i] = new ParallelScavengerVisitor(heap_->isolate_group(), this,
+                                               from, freelist,
+                                               &promotion_stack_, &deques, i);
     if (i < (num_tasks - 1)) {
       // Begin scavenging on a helper thread.
       bool result = Dart::thread_pool()->Run<ParallelScavengerTask>(
@@ -1586,10 +1791,29 @@ intptr_t Scavenger::ParallelScavenge(SemiSpace* from) {
     }
   }
 
+  bytes_copied_ = 0;
+  max_task_bytes_copied_ = 0;
+  steals_ = 0;
+  idle_micros_ = 0;
   for (intptr_t i = 0; i < num_tasks; i++) {
-    to_->AddList(visitors[i]->head(), visitors[i]->tail());
-    bytes_promoted += visitors[i]->bytes_promoted();
-    delete visitors[i];
+    ParallelScavengerVisitor* visitor = visitors[i];
+    if (FLAG_log_scavenger_tasks) {
+      THR_Print("Task %" Pd " copied %" Pd " bytes, promoted %" Pd
+                " bytes, stole %" Pd " blocks, idle %" Pd64 " micros.\n",
+                i, visitor->bytes_copied(), visitor->bytes_promoted(),
+                visitor->steals(), visitor->idle_micros());
+    }
+    to_->AddList(visitor->head(), visitor->tail());
+    bytes_promoted += visitor->bytes_promoted();
+    bytes_copied_ += visitor->bytes_copied();
+    max_task_bytes_copied_ =
+        Utils::Maximum(max_task_bytes_copied_, visitor->bytes_copied());
+    steals_ += visitor->steals();
+    idle_micros_ += visitor->idle_micros();
+    if (visitor->promoted_by_cid() != nullptr) {
+      allocation_site_feedback_.AddPromoted(visitor->promoted_by_cid());
+    }
+    delete visitor;
   }
 
   delete[] visitors;
@@ -1698,6 +1922,16 @@ void Scavenger::PrintToJSONObject(JSONObject* object) const {
   space.AddProperty64("capacity", CapacityInWords() * kWordSize);
   space.AddProperty64("external", ExternalInWords() * kWordSize);
   space.AddProperty("time", MicrosecondsToSeconds(gc_time_micros()));
+  if (stats_history_.Size() > 0) {
+    const ScavengeStats& last = stats_history_.Get(0);
+    space.AddProperty64("lastScavengeCopiedBytes",
+                        last.CopiedInWords() * kWordSize);
+    space.AddProperty64("lastScavengeMaxTaskCopiedBytes",
+                        last.MaxTaskCopiedInWords() * kWordSize);
+    space.AddProperty("lastScavengeSteals", last.Steals());
+    space.AddProperty("lastScavengeIdleMillis",
+                      MicrosecondsToMilliseconds(last.IdleMicros()));
+  }
 }
 #endif  // !PRODUCT
 
@@ -11,6 +11,7 @@
 #include "vm/dart.h"
 #include "vm/flags.h"
 #include "vm/globals.h"
+#include "vm/heap/pretenuring.h"
 #include "vm/heap/spaces.h"
 #include "vm/lockers.h"
 #include "vm/raw_object.h"
@@ -100,16 +101,27 @@ class NewPage {
   void Acquire(Thread* thread) {
     ASSERT(owner_ == nullptr);
     owner_ = thread;
+    owner_isolate_ = thread->isolate();
     thread->set_top(top_);
+#if !defined(PRODUCT)
+    thread->set_end(SampledEnd(thread, top_, end_));
+#else
     thread->set_end(end_);
+#endif
   }
-  void Release(Thread* thread) {
-    ASSERT(owner_ == thread);
-    owner_ = nullptr;
-    top_ = thread->top();
-    thread->set_top(0);
-    thread->set_end(0);
-  }
+#if !defined(PRODUCT)
+  // The end of a TLAB [top, end) owned by [thread], cut short at the thread's
+  // next allocation sample point when allocations are sampled.
+  static uword SampledEnd(Thread* thread, uword top, uword end);
+
+  // Called when an allocation of [size] bytes does not fit the TLAB of
+  // [thread]. If the TLAB was cut short at a sample point that the
+  // allocation crosses, marks the allocation as sampled, extends the TLAB to
+  // the following sample point and returns true.
+  static bool TrySampleAllocation(Thread* thread, intptr_t size);
+#endif
+  // Counts the bytes allocated since Acquire towards the owner's isolate.
+  void Release(Thread* thread);
   void Release() {
     if (owner_ != nullptr) {
       Release(owner_);
@@ -141,6 +153,9 @@ class NewPage {
 
   // The thread using this page for allocation, otherwise NULL.
   Thread* owner_;
+  // The isolate of owner_ when it acquired this page. The owner's current
+  // isolate is hidden while it runs a GC.
+  Isolate* owner_isolate_;
 
   // The address of the next allocation. If owner is non-NULL, this value is
   // stale and the current value is at owner->top_. Called "NEXT" in the
@@ -169,6 +184,8 @@ class SemiSpace {
   static void Init();
   static void Cleanup();
   static intptr_t CachedSize();
+  // Releases the pages kept for reuse by later semi-spaces.
+  static void ClearCache();
 
   explicit SemiSpace(intptr_t max_capacity_in_words);
   ~SemiSpace();
@@ -207,14 +224,22 @@ class ScavengeStats {
                 SpaceUsage after,
                 intptr_t promo_candidates_in_words,
                 intptr_t promoted_in_words,
-                intptr_t abandoned_in_words)
+                intptr_t abandoned_in_words,
+                intptr_t copied_in_words,
+                intptr_t max_task_copied_in_words,
+                intptr_t steals,
+                int64_t idle_micros)
       : start_micros_(start_micros),
         end_micros_(end_micros),
         before_(before),
         after_(after),
         promo_candidates_in_words_(promo_candidates_in_words),
         promoted_in_words_(promoted_in_words),
-        abandoned_in_words_(abandoned_in_words) {}
+        abandoned_in_words_(abandoned_in_words),
+        copied_in_words_(copied_in_words),
+        max_task_copied_in_words_(max_task_copied_in_words),
+        steals_(steals),
+        idle_micros_(idle_micros) {}
 
   // Of all data before scavenge, what fraction was found to be garbage?
   // If this scavenge included growth, assume the extra capacity would become
@@ -238,6 +263,14 @@ class ScavengeStats {
 
   int64_t DurationMicros() const { return end_micros_ - start_micros_; }
 
+  // Load balance between scavenger tasks: words copied within new space (in
+  // total and by the busiest task), blocks of promoted objects stolen from
+  // other tasks, and total time tasks spent waiting for work.
+  intptr_t CopiedInWords() const { return copied_in_words_; }
+  intptr_t MaxTaskCopiedInWords() const { return max_task_copied_in_words_; }
+  intptr_t Steals() const { return steals_; }
+  int64_t IdleMicros() const { return idle_micros_; }
+
  private:
   int64_t start_micros_;
   int64_t end_micros_;
@@ -246,6 +279,10 @@ class ScavengeStats {
   intptr_t promo_candidates_in_words_;
   intptr_t promoted_in_words_;
   intptr_t abandoned_in_words_;
+  intptr_t copied_in_words_;
+  intptr_t max_task_copied_in_words_;
+  intptr_t steals_;
+  int64_t idle_micros_;
 };
 
 class Scavenger {
@@ -269,8 +306,19 @@ class Scavenger {
     if (LIKELY(addr != 0)) {
       return addr;
     }
+#if !defined(PRODUCT)
+    if (NewPage::TrySampleAllocation(thread, size)) {
+      return TryAllocateFromTLAB(thread, size);
+    }
+#endif
     TryAllocateNewTLAB(thread, size);
-    return TryAllocateFromTLAB(thread, size);
+    addr = TryAllocateFromTLAB(thread, size);
+#if !defined(PRODUCT)
+    if ((addr == 0) && NewPage::TrySampleAllocation(thread, size)) {
+      addr = TryAllocateFromTLAB(thread, size);
+    }
+#endif
+    return addr;
   }
   void AbandonRemainingTLAB(Thread* thread);
   void AbandonRemainingTLABForDebugging(Thread* thread);
@@ -281,6 +329,10 @@ class Scavenger {
   // Promote all live objects.
   void Evacuate();
 
+  // Makes the next scavenge allocate a semi-space of the initial size rather
+  // than one sized by the survival rate, e.g., to give memory back to the OS.
+  void ShrinkOnNextScavenge() { shrink_ = true; }
+
   void MergeFrom(Scavenger* donor);
 
   int64_t UsedInWords() const {
@@ -357,6 +409,10 @@ class Scavenger {
 
   NewPage* head() const { return to_->head(); }
 
+  AllocationSiteFeedback* allocation_site_feedback() {
+    return &allocation_site_feedback_;
+  }
+
  private:
   // Ids for time and data records in Heap::GCStats.
   enum {
@@ -416,6 +472,7 @@ class Scavenger {
   void MournWeakTables();
 
   intptr_t NewSizeInWords(intptr_t old_size_in_words) const;
+  intptr_t MinSizeInWords() const;
 
   Heap* heap_;
 
@@ -428,9 +485,18 @@ class Scavenger {
   // Keep track whether a scavenge is currently running.
   bool scavenging_;
   bool early_tenure_ = false;
+  bool shrink_ = false;
   RelaxedAtomic<intptr_t> root_slices_started_;
   StoreBufferBlock* blocks_ = nullptr;
 
+  // Work distribution among the tasks of the current scavenge.
+  intptr_t bytes_copied_ = 0;
+  intptr_t max_task_bytes_copied_ = 0;
+  intptr_t steals_ = 0;
+  int64_t idle_micros_ = 0;
+
+  AllocationSiteFeedback allocation_site_feedback_;
+
   int64_t gc_time_micros_;
   intptr_t collections_;
   static const int kStatsHistoryCapacity = 4;
@@ -452,6 +518,8 @@ class Scavenger {
 
   template <bool>
   friend class ScavengerVisitorBase;
+  friend class HeapVerifier;
+  friend class ForwardingReferrerScanner;
   friend class ScavengerWeakVisitor;
 
   DISALLOW_COPY_AND_ASSIGN(Scavenger);
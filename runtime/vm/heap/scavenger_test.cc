@@ -4,6 +4,8 @@
 
 #include "vm/heap/scavenger.h"
 #include "platform/assert.h"
+#include "vm/benchmark_test.h"
+#include "vm/timer.h"
 #include "vm/unit_test.h"
 #include "vm/visitor.h"
 
@@ -35,4 +37,61 @@ class FailingFindObjectVisitor : public FindObjectVisitor {
   }
 };
 
+// Measures the time spent scavenging while old arrays of [length] elements,
+// about 8MB in total, keep getting a few of their elements pointed at new
+// objects. Arrays above Array::kCardMarkingThresholdSize only have their dirty
+// cards rescanned, the others are rescanned in full from the store buffer.
+static void BenchmarkScavengeOldArrays(Benchmark* benchmark,
+                                      Thread* thread,
+                                      intptr_t length) {
+  TransitionNativeToVM transition(thread);
+  StackZone zone(thread);
+  HANDLESCOPE(thread);
+  const intptr_t kTotalSize = 8 * MB;
+  const intptr_t kStoresPerArray = 4;
+  const intptr_t kLoopCount = 100;
+  const intptr_t num_arrays =
+      Utils::Maximum<intptr_t>(1, kTotalSize / Array::InstanceSize(length));
+  const Array& arrays = Array::Handle(Array::New(num_arrays, Heap::kOld));
+  Array& array = Array::Handle();
+  for (intptr_t i = 0; i < num_arrays; i++) {
+    array = Array::New(length, Heap::kOld);
+    arrays.SetAt(i, array);
+  }
+  EXPECT(Array::UseCardMarkingForAllocation(length) ==
+         array.raw()->ptr()->IsCardRemembered());
+
+  Object& element = Object::Handle();
+  Timer timer(true, "Scavenge Old Arrays");
+  for (intptr_t iteration = 0; iteration < kLoopCount; iteration++) {
+    for (intptr_t i = 0; i < num_arrays; i++) {
+      array ^= arrays.At(i);
+      for (intptr_t j = 0; j < kStoresPerArray; j++) {
+        element = String::New("new", Heap::kNew);
+        array.SetAt((iteration * kStoresPerArray + j) * 97 % length, element);
+      }
+    }
+    timer.Start();
+    GCTestHelper::CollectNewSpace();
+    timer.Stop();
+  }
+  benchmark->set_score(timer.TotalElapsedTime());
+}
+
+BENCHMARK(ScavengeOldArrays1K) {
+  BenchmarkScavengeOldArrays(benchmark, thread, 1 * KB);
+}
+
+BENCHMARK(ScavengeOldArrays4K) {
+  BenchmarkScavengeOldArrays(benchmark, thread, 4 * KB);
+}
+
+BENCHMARK(ScavengeOldArrays16K) {
+  BenchmarkScavengeOldArrays(benchmark, thread, 16 * KB);
+}
+
+BENCHMARK(ScavengeOldArrays64K) {
+  BenchmarkScavengeOldArrays(benchmark, thread, 64 * KB);
+}
+
 }  // namespace dart
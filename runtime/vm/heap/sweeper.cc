@@ -10,6 +10,7 @@
 #include "vm/heap/pages.h"
 #include "vm/heap/safepoint.h"
 #include "vm/lockers.h"
+#include "vm/log.h"
 #include "vm/thread_pool.h"
 #include "vm/timeline.h"
 
@@ -102,27 +103,37 @@ intptr_t GCSweeper::SweepLargePage(OldPage* page) {
   return words_to_end;
 }
 
+void SweepWorkList::Init(OldPage* first, OldPage* last, intptr_t num_tasks) {
+  pages_.Clear();
+  for (OldPage* page = first; page != NULL; page = page->next()) {
+    pages_.Add(page);
+    if (page == last) break;
+  }
+  first_ = first;
+  last_ = last;
+  next_ = 0;
+  swept_ = 0;
+  running_tasks_ = num_tasks;
+  lazily_swept_ = 0;
+}
+
 class ConcurrentSweeperTask : public ThreadPool::Task {
  public:
   ConcurrentSweeperTask(IsolateGroup* isolate_group,
                         PageSpace* old_space,
-                        OldPage* first,
-                        OldPage* last,
+                        SweepWorkList* work_list,
+                        intptr_t task_index,
                         OldPage* large_first,
                         OldPage* large_last)
       : task_isolate_group_(isolate_group),
         old_space_(old_space),
-        first_(first),
-        last_(last),
+        work_list_(work_list),
+        task_index_(task_index),
         large_first_(large_first),
         large_last_(large_last) {
     ASSERT(task_isolate_group_ != NULL);
-    ASSERT(first_ != NULL);
     ASSERT(old_space_ != NULL);
-    ASSERT(last_ != NULL);
-    MonitorLocker ml(old_space_->tasks_lock());
-    old_space_->set_tasks(old_space_->tasks() + 1);
-    old_space_->set_phase(PageSpace::kSweepingLarge);
+    ASSERT(work_list_ != NULL);
   }
 
   virtual void Run() {
@@ -134,65 +145,90 @@ class ConcurrentSweeperTask : public ThreadPool::Task {
       ASSERT(thread->BypassSafepoints());  // Or we should be checking in.
       TIMELINE_FUNCTION_GC_DURATION(thread, "ConcurrentSweep");
       GCSweeper sweeper;
+      const int64_t start = OS::GetCurrentMonotonicMicros();
 
-      OldPage* page = large_first_;
-      OldPage* prev_page = NULL;
-      while (page != NULL) {
-        OldPage* next_page;
-        if (page == large_last_) {
-          // Don't access page->next(), which would be a race with mutator
-          // allocating new pages.
-          next_page = NULL;
-        } else {
-          next_page = page->next();
-        }
-        ASSERT(page->type() == OldPage::kData);
-        const intptr_t words_to_end = sweeper.SweepLargePage(page);
-        if (words_to_end == 0) {
-          old_space_->FreeLargePage(page, prev_page);
-        } else {
-          old_space_->TruncateLargePage(page, words_to_end << kWordSizeLog2);
-          prev_page = page;
+      // The first task sweeps the large pages, while the others start on the
+      // regular pages.
+      if (task_index_ == 0) {
+        OldPage* page = large_first_;
+        OldPage* prev_page = NULL;
+        while (page != NULL) {
+          OldPage* next_page;
+          if (page == large_last_) {
+            // Don't access page->next(), which would be a race with mutator
+            // allocating new pages.
+            next_page = NULL;
+          } else {
+            next_page = page->next();
+          }
+          ASSERT(page->type() == OldPage::kData);
+          const intptr_t words_to_end = sweeper.SweepLargePage(page);
+          if (words_to_end == 0) {
+            old_space_->FreeLargePage(page, prev_page);
+          } else {
+            old_space_->TruncateLargePage(page,
+                                          words_to_end << kWordSizeLog2);
+            prev_page = page;
+          }
+          page = next_page;
         }
-        page = next_page;
-      }
 
-      {
-        MonitorLocker ml(old_space_->tasks_lock());
-        ASSERT(old_space_->phase() == PageSpace::kSweepingLarge);
-        old_space_->set_phase(PageSpace::kSweepingRegular);
-        ml.NotifyAll();
+        {
+          MonitorLocker ml(old_space_->tasks_lock());
+          ASSERT(old_space_->phase() == PageSpace::kSweepingLarge);
+          old_space_->set_phase(PageSpace::kSweepingRegular);
+          ml.NotifyAll();
+        }
       }
 
-      intptr_t shard = 0;
+      intptr_t pages_swept = 0;
+      intptr_t bytes_swept = 0;
+      intptr_t shard = task_index_;
       const intptr_t num_shards = Utils::Maximum(FLAG_scavenger_tasks, 1);
-      page = first_;
-      prev_page = NULL;
-      while (page != NULL) {
-        OldPage* next_page;
-        if (page == last_) {
-          // Don't access page->next(), which would be a race with mutator
-          // allocating new pages.
-          next_page = NULL;
-        } else {
-          next_page = page->next();
-        }
+      OldPage* page;
+      while ((page = work_list_->Claim()) != NULL) {
         ASSERT(page->type() == OldPage::kData);
         shard = (shard + 1) % num_shards;
-        bool page_in_use =
-            sweeper.SweepPage(page, old_space_->DataFreeList(shard), false);
-        if (page_in_use) {
-          prev_page = page;
-        } else {
-          old_space_->FreePage(page, prev_page);
-        }
+        // Empty pages are freed after all pages are swept.
+        sweeper.SweepPage(page, old_space_->DataFreeList(shard), false);
+        pages_swept++;
+        bytes_swept += page->object_end() - page->object_start();
+        const bool last_page = work_list_->Swept();
         {
           // Notify the mutator thread that we have added elements to the free
-          // list or that more capacity is available.
+          // list, or the last sweeper task that all pages are swept.
           MonitorLocker ml(old_space_->tasks_lock());
-          ml.Notify();
+          if (last_page) {
+            ml.NotifyAll();
+          } else {
+            ml.Notify();
+          }
+        }
+      }
+
+      if (FLAG_verbose_gc) {
+        const int64_t micros = OS::GetCurrentMonotonicMicros() - start;
+        THR_Print("Sweeper task %" Pd ": %" Pd " pages, %" Pd
+                  " KB in %" Pd64 " us (%.1f MB/s)\n",
+                  task_index_, pages_swept, bytes_swept / KB, micros,
+                  micros > 0 ? static_cast<double>(bytes_swept) / micros : 0.0);
+      }
+
+      if (work_list_->TaskDone()) {
+        // Wait for pages the mutator is still sweeping lazily, then free the
+        // empty pages.
+        {
+          MonitorLocker ml(old_space_->tasks_lock());
+          while (!work_list_->AllSwept()) {
+            ml.Wait();
+          }
+        }
+        old_space_->FreeEmptySweptPages(work_list_->first(),
+                                        work_list_->last());
+        if (FLAG_verbose_gc && (work_list_->lazily_swept() > 0)) {
+          THR_Print("Mutator swept %" Pd " of %" Pd " pages lazily.\n",
+                    work_list_->lazily_swept(), work_list_->length());
         }
-        page = next_page;
       }
     }
     // Exit isolate cleanly *before* notifying it, to avoid shutdown race.
@@ -201,8 +237,10 @@ class ConcurrentSweeperTask : public ThreadPool::Task {
     {
       MonitorLocker ml(old_space_->tasks_lock());
       old_space_->set_tasks(old_space_->tasks() - 1);
-      ASSERT(old_space_->phase() == PageSpace::kSweepingRegular);
-      old_space_->set_phase(PageSpace::kDone);
+      if (old_space_->tasks() == 0) {
+        ASSERT(old_space_->phase() == PageSpace::kSweepingRegular);
+        old_space_->set_phase(PageSpace::kDone);
+      }
       ml.NotifyAll();
     }
   }
@@ -210,8 +248,8 @@ class ConcurrentSweeperTask : public ThreadPool::Task {
  private:
   IsolateGroup* task_isolate_group_;
   PageSpace* old_space_;
-  OldPage* first_;
-  OldPage* last_;
+  SweepWorkList* work_list_;
+  intptr_t task_index_;
   OldPage* large_first_;
   OldPage* large_last_;
 };
@@ -222,10 +260,22 @@ void GCSweeper::SweepConcurrent(IsolateGroup* isolate_group,
                                 OldPage* large_first,
                                 OldPage* large_last,
                                 FreeList* freelist) {
-  bool result = Dart::thread_pool()->Run<ConcurrentSweeperTask>(
-      isolate_group, isolate_group->heap()->old_space(), first, last,
-      large_first, large_last);
-  ASSERT(result);
+  PageSpace* old_space = isolate_group->heap()->old_space();
+  const intptr_t num_tasks = Utils::Maximum(FLAG_sweeper_tasks, 1);
+  SweepWorkList* work_list = old_space->sweep_work_list();
+  work_list->Init(first, last, num_tasks);
+  {
+    // Account for all tasks before any of them starts, so that an early
+    // task's phase change is not overwritten.
+    MonitorLocker ml(old_space->tasks_lock());
+    old_space->set_tasks(old_space->tasks() + num_tasks);
+    old_space->set_phase(PageSpace::kSweepingLarge);
+  }
+  for (intptr_t i = 0; i < num_tasks; i++) {
+    bool result = Dart::thread_pool()->Run<ConcurrentSweeperTask>(
+        isolate_group, old_space, work_list, i, large_first, large_last);
+    ASSERT(result);
+  }
 }
 
 }  // namespace dart
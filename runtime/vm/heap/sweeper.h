@@ -5,7 +5,9 @@
 #ifndef RUNTIME_VM_HEAP_SWEEPER_H_
 #define RUNTIME_VM_HEAP_SWEEPER_H_
 
+#include "platform/atomic.h"
 #include "vm/globals.h"
+#include "vm/growable_array.h"
 
 namespace dart {
 
@@ -34,7 +36,9 @@ class GCSweeper {
   // last marked object.
   intptr_t SweepLargePage(OldPage* page);
 
-  // Sweep the regular sized data pages between first and last inclusive.
+  // Sweep the regular sized data pages between first and last inclusive, and
+  // the large pages between large_first and large_last inclusive, using
+  // FLAG_sweeper_tasks tasks.
   static void SweepConcurrent(IsolateGroup* isolate_group,
                               OldPage* first,
                               OldPage* last,
@@ -43,6 +47,60 @@ class GCSweeper {
                               FreeList* freelist);
 };
 
+// The regular sized data pages that remain to be swept concurrently. Pages
+// are claimed one at a time by the sweeper tasks and, on the allocation slow
+// path, by the mutator. Pages found empty are only freed once all pages are
+// swept, by the last sweeper task, so that claiming pages never races with
+// unlinking them from the page list.
+class SweepWorkList {
+ public:
+  SweepWorkList() {}
+  ~SweepWorkList() {}
+
+  // Called at a safepoint.
+  void Init(OldPage* first, OldPage* last, intptr_t num_tasks);
+
+  // Returns the next page to sweep, or NULL if all pages are claimed.
+  OldPage* Claim() {
+    const intptr_t index = next_.fetch_add(1);
+    return (index < pages_.length()) ? pages_[index] : NULL;
+  }
+
+  // Whether all pages are claimed, without claiming one.
+  bool Exhausted() const { return next_ >= pages_.length(); }
+
+  // Records that a claimed page was swept. Returns true for the last page.
+  bool Swept() {
+    return (swept_.fetch_add(1, std::memory_order_acq_rel) + 1) ==
+           pages_.length();
+  }
+  bool AllSwept() const {
+    return swept_.load(std::memory_order_acquire) >= pages_.length();
+  }
+
+  // Records that a sweeper task ran out of pages to claim. Returns true for
+  // the last task.
+  bool TaskDone() { return running_tasks_.fetch_sub(1) == 1; }
+
+  void AddLazilySwept() { lazily_swept_.fetch_add(1); }
+  intptr_t lazily_swept() const { return lazily_swept_; }
+  intptr_t length() const { return pages_.length(); }
+
+  OldPage* first() const { return first_; }
+  OldPage* last() const { return last_; }
+
+ private:
+  MallocGrowableArray<OldPage*> pages_;
+  OldPage* first_ = nullptr;
+  OldPage* last_ = nullptr;
+  RelaxedAtomic<intptr_t> next_ = {0};
+  RelaxedAtomic<intptr_t> swept_ = {0};
+  RelaxedAtomic<intptr_t> running_tasks_ = {0};
+  RelaxedAtomic<intptr_t> lazily_swept_ = {0};
+
+  DISALLOW_COPY_AND_ASSIGN(SweepWorkList);
+};
+
 }  // namespace dart
 
 #endif  // RUNTIME_VM_HEAP_SWEEPER_H_
@@ -8,11 +8,17 @@
 #include "vm/dart.h"
 #include "vm/dart_api_state.h"
 #include "vm/heap/heap.h"
+#include "vm/heap/pages.h"
+#include "vm/heap/scavenger.h"
 #include "vm/isolate.h"
 #include "vm/object.h"
 #include "vm/object_set.h"
+#include "vm/random.h"
 #include "vm/raw_object.h"
 #include "vm/stack_frame.h"
+#include "vm/thread_barrier.h"
+#include "vm/thread_pool.h"
+#include "vm/timeline.h"
 
 namespace dart {
 
@@ -84,6 +90,169 @@ void VerifyPointersVisitor::VerifyPointers(MarkExpectation mark_expectation) {
   isolate_group->VisitWeakPersistentHandles(&weak_visitor);
 }
 
+class VerifierTask : public ThreadPool::Task {
+ public:
+  VerifierTask(IsolateGroup* isolate_group,
+               HeapVerifier* verifier,
+               ThreadBarrier* barrier)
+      : isolate_group_(isolate_group), verifier_(verifier), barrier_(barrier) {}
+
+  void Run() {
+    bool result =
+        Thread::EnterIsolateGroupAsHelper(isolate_group_, Thread::kUnknownTask,
+                                          /*bypass_safepoint=*/true);
+    ASSERT(result);
+
+    RunEnteredIsolateGroup();
+
+    Thread::ExitIsolateGroupAsHelper(/*bypass_safepoint=*/true);
+
+    // This task is done. Notify the original thread.
+    barrier_->Exit();
+  }
+
+  void RunEnteredIsolateGroup() {
+    const intptr_t num_ranges = verifier_->ranges_.length();
+    for (intptr_t i = verifier_->next_object_range_.fetch_add(1);
+         i < num_ranges; i = verifier_->next_object_range_.fetch_add(1)) {
+      verifier_->VerifyObjects(verifier_->ranges_[i]);
+    }
+
+    // The allocated set is complete once every task is done adding objects.
+    barrier_->Sync();
+    VerifyPointersVisitor visitor(isolate_group_, verifier_->allocated_set_);
+    for (intptr_t i = verifier_->next_pointer_range_.fetch_add(1);
+         i < num_ranges; i = verifier_->next_pointer_range_.fetch_add(1)) {
+      verifier_->VerifyPointers(verifier_->ranges_[i], &visitor);
+    }
+  }
+
+ private:
+  IsolateGroup* isolate_group_;
+  HeapVerifier* verifier_;
+  ThreadBarrier* barrier_;
+
+  DISALLOW_COPY_AND_ASSIGN(VerifierTask);
+};
+
+HeapVerifier::HeapVerifier(IsolateGroup* isolate_group, Zone* zone)
+    : isolate_group_(isolate_group),
+      allocated_set_(new (zone) ObjectSet(zone)),
+      ranges_(zone, 16) {}
+
+void HeapVerifier::AddRange(uword start,
+                            uword end,
+                            MarkExpectation mark_expectation,
+                            bool visit_pointers) {
+  if (start == end) {
+    return;
+  }
+  allocated_set_->AddRegion(start, end);
+  Range range = {start, end, mark_expectation, visit_pointers, false};
+  ranges_.Add(range);
+}
+
+void HeapVerifier::AddHeap(Heap* heap,
+                           MarkExpectation mark_expectation,
+                           bool visit_pointers) {
+  Scavenger* new_space = heap->new_space();
+  for (NewPage* page = new_space->to_->head(); page != nullptr;
+       page = page->next()) {
+    AddRange(page->object_start(), page->object_end(), mark_expectation,
+             visit_pointers);
+  }
+
+  PageSpace* old_space = heap->old_space();
+  MutexLocker ml(&old_space->pages_lock_);
+  old_space->MakeIterable();
+  OldPage* const lists[] = {old_space->pages_, old_space->exec_pages_,
+                            old_space->large_pages_};
+  for (OldPage* page : lists) {
+    for (; page != nullptr; page = page->next()) {
+      AddRange(page->object_start(), page->object_end(), mark_expectation,
+               visit_pointers);
+    }
+  }
+  for (OldPage* page = old_space->image_pages_; page != nullptr;
+       page = page->next()) {
+    AddRange(page->object_start(), page->object_end(), kRequireMarked,
+             visit_pointers);
+  }
+}
+
+void HeapVerifier::VerifyObjects(const Range& range) {
+  VerifyObjectVisitor visitor(isolate_group_, allocated_set_,
+                              range.mark_expectation);
+  uword addr = range.start;
+  while (addr < range.end) {
+    ObjectPtr obj = ObjectLayout::FromAddr(addr);
+    if (range.sampled) {
+      visitor.VisitObject(obj);
+    } else {
+      allocated_set_->Add(obj);
+    }
+    addr += obj->ptr()->HeapSize();
+  }
+}
+
+void HeapVerifier::VerifyPointers(const Range& range,
+                                  VerifyPointersVisitor* visitor) {
+  if (!range.sampled || !range.visit_pointers) {
+    return;
+  }
+  uword addr = range.start;
+  while (addr < range.end) {
+    ObjectPtr obj = ObjectLayout::FromAddr(addr);
+    addr += obj->ptr()->VisitPointers(visitor);
+  }
+}
+
+void HeapVerifier::Verify() {
+#if defined(SUPPORT_TIMELINE)
+  Thread* thread = Thread::Current();
+#endif
+  TIMELINE_FUNCTION_GC_DURATION(thread, "VerifyHeap");
+
+  allocated_set_->SortRegions();
+
+  num_sampled_ranges_ = 0;
+  if (FLAG_verify_gc_sample_percent >= 100) {
+    for (intptr_t i = 0; i < ranges_.length(); i++) {
+      ranges_[i].sampled = true;
+    }
+    num_sampled_ranges_ = ranges_.length();
+  } else {
+    Random random;
+    for (intptr_t i = 0; i < ranges_.length(); i++) {
+      ranges_[i].sampled = static_cast<intptr_t>(random.NextUInt32() % 100) <
+                           FLAG_verify_gc_sample_percent;
+      if (ranges_[i].sampled) {
+        num_sampled_ranges_++;
+      }
+    }
+  }
+
+  intptr_t num_tasks = Utils::Minimum<intptr_t>(
+      Utils::Maximum(FLAG_verify_gc_tasks, 1), ranges_.length());
+  if (num_tasks == 0) {
+    return;
+  }
+
+  Heap* heap = isolate_group_->heap();
+  ThreadBarrier barrier(num_tasks, heap->barrier(), heap->barrier_done());
+  for (intptr_t task_index = 0; task_index < num_tasks; task_index++) {
+    if (task_index < (num_tasks - 1)) {
+      // Begin verifying on a helper thread.
+      Dart::thread_pool()->Run<VerifierTask>(isolate_group_, this, &barrier);
+    } else {
+      // Last worker is the main thread.
+      VerifierTask task(isolate_group_, this, &barrier);
+      task.RunEnteredIsolateGroup();
+      barrier.Exit();
+    }
+  }
+}
+
 #if defined(DEBUG)
 VerifyCanonicalVisitor::VerifyCanonicalVisitor(Thread* thread)
     : thread_(thread), instanceHandle_(Instance::Handle(thread->zone())) {}
@@ -5,8 +5,10 @@
 #ifndef RUNTIME_VM_HEAP_VERIFIER_H_
 #define RUNTIME_VM_HEAP_VERIFIER_H_
 
+#include "platform/atomic.h"
 #include "vm/flags.h"
 #include "vm/globals.h"
+#include "vm/growable_array.h"
 #include "vm/handle_visitor.h"
 #include "vm/handles.h"
 #include "vm/thread.h"
@@ -15,6 +17,7 @@
 namespace dart {
 
 // Forward declarations.
+class Heap;
 class IsolateGroup;
 class ObjectSet;
 
@@ -57,6 +60,62 @@ class VerifyPointersVisitor : public ObjectPointerVisitor {
   DISALLOW_COPY_AND_ASSIGN(VerifyPointersVisitor);
 };
 
+// Verifies the objects and pointers of an isolate group's heap, splitting its
+// pages across FLAG_verify_gc_tasks tasks.
+//
+// With FLAG_verify_gc_sample_percent below 100, only a random subset of the
+// pages has its objects validated and its pointers checked. Every page is
+// still walked to record where its objects start, so the pointers on the
+// sampled pages are checked against the whole heap.
+class HeapVerifier : public ValueObject {
+ public:
+  HeapVerifier(IsolateGroup* isolate_group, Zone* zone);
+
+  // Adds the pages of [heap]. Objects on image pages and in the VM isolate's
+  // heap must always be marked. The pointers of [heap]'s objects are only
+  // checked when [visit_pointers] is set.
+  void AddHeap(Heap* heap,
+               MarkExpectation mark_expectation,
+               bool visit_pointers);
+
+  void Verify();
+
+  intptr_t num_ranges() const { return ranges_.length(); }
+  intptr_t num_sampled_ranges() const { return num_sampled_ranges_; }
+
+ private:
+  struct Range {
+    uword start;
+    uword end;
+    MarkExpectation mark_expectation;
+    bool visit_pointers;
+    bool sampled;
+  };
+
+  void AddRange(uword start,
+                uword end,
+                MarkExpectation mark_expectation,
+                bool visit_pointers);
+
+  // Records the objects of a range in the allocated set, and validates them
+  // if the range is sampled.
+  void VerifyObjects(const Range& range);
+  // Checks the pointers of the objects of a sampled range.
+  void VerifyPointers(const Range& range, VerifyPointersVisitor* visitor);
+
+  IsolateGroup* isolate_group_;
+  ObjectSet* allocated_set_;
+  GrowableArray<Range> ranges_;
+  intptr_t num_sampled_ranges_ = 0;
+
+  RelaxedAtomic<intptr_t> next_object_range_ = {0};
+  RelaxedAtomic<intptr_t> next_pointer_range_ = {0};
+
+  friend class VerifierTask;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapVerifier);
+};
+
 class VerifyWeakPointersVisitor : public HandleVisitor {
  public:
   explicit VerifyWeakPointersVisitor(VerifyPointersVisitor* visitor)
@@ -29,6 +29,40 @@ intptr_t WeakTable::SizeFor(intptr_t count, intptr_t size) {
   return result;
 }
 
+intptr_t* WeakTable::AllocateData(intptr_t size) {
+  intptr_t* data = reinterpret_cast<intptr_t*>(
+      malloc((kHeaderSize + size * kEntrySize) * kWordSize));
+  data[kSizeIndex] = size;
+  data[kNextRetiredIndex] = 0;
+  for (intptr_t i = 0; i < size; i++) {
+    data[ObjectIndex(i)] = kNoEntry;
+    data[ValueIndex(i)] = kNoValue;
+  }
+  return data;
+}
+
+intptr_t WeakTable::GetValue(ObjectPtr key) const {
+  // The backing store read here stays allocated until the next
+  // ReleaseRetiredExclusive, even if a concurrent SetValue replaces it.
+  const intptr_t* data = published_data_.load();
+  const intptr_t mask = data[kSizeIndex] - 1;
+  intptr_t idx = Hash(key) & mask;
+  while (true) {
+    const intptr_t obj =
+        reinterpret_cast<const std::atomic<intptr_t>*>(&data[ObjectIndex(idx)])
+            ->load(std::memory_order_acquire);
+    if (obj == static_cast<intptr_t>(key)) {
+      return reinterpret_cast<const std::atomic<intptr_t>*>(
+                 &data[ValueIndex(idx)])
+          ->load(std::memory_order_relaxed);
+    }
+    if (obj == kNoEntry) {
+      return kNoValue;
+    }
+    idx = (idx + 1) & mask;
+  }
+}
+
 void WeakTable::SetValueExclusive(ObjectPtr key, intptr_t val) {
   intptr_t mask = size() - 1;
   intptr_t idx = Hash(key) & mask;
@@ -61,9 +95,10 @@ void WeakTable::SetValueExclusive(ObjectPtr key, intptr_t val) {
   }
 
   ASSERT(!IsValidEntryAtExclusive(idx));
-  // Set the key and value.
-  SetObjectAt(idx, key);
+  // Set the value and key. The key is set last, so that concurrent readers
+  // which find it also find the value.
   SetValueAt(idx, val);
+  SetObjectAt(idx, key);
   // Update the counts.
   set_used(used() + 1);
   set_count(count() + 1);
@@ -79,16 +114,31 @@ void WeakTable::Reset() {
   used_ = 0;
   count_ = 0;
   size_ = kMinSize;
-  free(old_data);
-  data_ = reinterpret_cast<intptr_t*>(malloc(size_ * kEntrySize * kWordSize));
-  for (intptr_t i = 0; i < size_; i++) {
-    data_[ObjectIndex(i)] = kNoEntry;
-    data_[ValueIndex(i)] = kNoValue;
+  data_ = AllocateData(size_);
+  published_data_.store(data_);
+  Retire(old_data);
+}
+
+void WeakTable::Retire(intptr_t* old_data) {
+  old_data[kNextRetiredIndex] = reinterpret_cast<intptr_t>(retired_);
+  retired_ = old_data;
+}
+
+void WeakTable::ReleaseRetiredExclusive() {
+  intptr_t* data = retired_;
+  retired_ = nullptr;
+  while (data != nullptr) {
+    intptr_t* next = reinterpret_cast<intptr_t*>(data[kNextRetiredIndex]);
+    free(data);
+    data = next;
   }
 }
 
 void WeakTable::Forward(ObjectPointerVisitor* visitor) {
-  if (used_ == 0) return;
+  if (used_ == 0) {
+    ReleaseRetiredExclusive();
+    return;
+  }
 
   for (intptr_t i = 0; i < size_; i++) {
     if (IsValidEntryAtExclusive(i)) {
@@ -97,6 +147,7 @@ void WeakTable::Forward(ObjectPointerVisitor* visitor) {
   }
 
   Rehash();
+  ReleaseRetiredExclusive();
 }
 
 void WeakTable::Rehash() {
@@ -105,12 +156,7 @@ void WeakTable::Rehash() {
 
   intptr_t new_size = SizeFor(count(), size());
   ASSERT(Utils::IsPowerOfTwo(new_size));
-  intptr_t* new_data =
-      reinterpret_cast<intptr_t*>(malloc(new_size * kEntrySize * kWordSize));
-  for (intptr_t i = 0; i < new_size; i++) {
-    new_data[ObjectIndex(i)] = kNoEntry;
-    new_data[ValueIndex(i)] = kNoValue;
-  }
+  intptr_t* new_data = AllocateData(new_size);
 
   intptr_t mask = new_size - 1;
   set_used(0);
@@ -134,10 +180,12 @@ void WeakTable::Rehash() {
   // We should only have used valid entries.
   ASSERT(used() == count());
 
-  // Switch to using the newly allocated backing store.
+  // Switch to using the newly allocated backing store. Concurrent readers may
+  // still be probing the old one.
   size_ = new_size;
   data_ = new_data;
-  free(old_data);
+  published_data_.store(data_);
+  Retire(old_data);
 }
 
 void WeakTable::MergeFrom(WeakTable* donor) {
@@ -8,17 +8,28 @@
 #include "vm/globals.h"
 
 #include "platform/assert.h"
+#include "platform/atomic.h"
 #include "vm/lockers.h"
 #include "vm/raw_object.h"
 
 namespace dart {
 
+// An open-addressed hash table associating values with objects, keyed by the
+// address of the object.
+//
+// Lookups from mutator and helper threads do not take the lock. The backing
+// store is only modified under the lock, and entries are published with
+// release semantics so that a reader which finds a key also sees its value.
+// When the backing store is grown or shrunk, the old one is retired rather
+// than freed, since concurrent readers may still be probing it. Retired
+// backing stores are released by the GC when it has exclusive access to the
+// table.
 class WeakTable {
  public:
   static constexpr intptr_t kNoValue = 0;
 
   WeakTable() : WeakTable(kMinSize) {}
-  explicit WeakTable(intptr_t size) : used_(0), count_(0) {
+  explicit WeakTable(intptr_t size) : used_(0), count_(0), retired_(nullptr) {
     ASSERT(size >= 0);
     ASSERT(Utils::IsPowerOfTwo(kMinSize));
     if (size < kMinSize) {
@@ -33,14 +44,14 @@ class WeakTable {
     }
     size_ = size;
     ASSERT(Utils::IsPowerOfTwo(size_));
-    data_ = reinterpret_cast<intptr_t*>(malloc(size_ * kEntrySize * kWordSize));
-    for (intptr_t i = 0; i < size_; i++) {
-      data_[ObjectIndex(i)] = kNoEntry;
-      data_[ValueIndex(i)] = kNoValue;
-    }
+    data_ = AllocateData(size_);
+    published_data_.store(data_);
   }
 
-  ~WeakTable() { free(data_); }
+  ~WeakTable() {
+    ReleaseRetiredExclusive();
+    free(data_);
+  }
 
   static WeakTable* NewFrom(WeakTable* original) {
     return new WeakTable(SizeFor(original->count(), original->size()));
@@ -50,12 +61,10 @@ class WeakTable {
   intptr_t used() const { return used_; }
   intptr_t count() const { return count_; }
 
-  // The following methods can be called concurrently and are guarded by a lock.
+  // The following methods can be called concurrently. Only SetValue is
+  // guarded by a lock.
 
-  intptr_t GetValue(ObjectPtr key) {
-    MutexLocker ml(&mutex_);
-    return GetValueExclusive(key);
-  }
+  intptr_t GetValue(ObjectPtr key) const;
 
   void SetValue(ObjectPtr key, intptr_t val) {
     MutexLocker ml(&mutex_);
@@ -95,6 +104,17 @@ class WeakTable {
 
   void SetValueExclusive(ObjectPtr key, intptr_t val);
 
+  // Calls [visitor] with the value of every entry.
+  template <typename Visitor>
+  void ForEachValue(const Visitor& visitor) {
+    MutexLocker ml(&mutex_);
+    for (intptr_t i = 0; i < size(); i++) {
+      if (IsValidEntryAtExclusive(i)) {
+        visitor(ValueAtExclusive(i));
+      }
+    }
+  }
+
   intptr_t GetValueExclusive(ObjectPtr key) const {
     intptr_t mask = size() - 1;
     intptr_t idx = Hash(key) & mask;
@@ -133,6 +153,10 @@ class WeakTable {
 
   void Reset();
 
+  // Frees the backing stores replaced since the last call. Must only be called
+  // when no thread can be in GetValue, e.g. at a safepoint.
+  void ReleaseRetiredExclusive();
+
   void MergeFrom(WeakTable* donor);
 
  private:
@@ -142,10 +166,21 @@ class WeakTable {
     kEntrySize,
   };
 
+  // Each backing store starts with a header holding its size, so that
+  // concurrent readers never see a size that does not match the entries, and
+  // a link used to chain it into the list of retired backing stores.
+  enum {
+    kSizeIndex = 0,
+    kNextRetiredIndex,
+    kHeaderSize,
+  };
+
   static const intptr_t kNoEntry = 1;       // Not a valid OOP.
   static const intptr_t kDeletedEntry = 3;  // Not a valid OOP.
   static const intptr_t kMinSize = 8;
 
+  static intptr_t* AllocateData(intptr_t size);
+
   static intptr_t SizeFor(intptr_t count, intptr_t size);
   static intptr_t LimitFor(intptr_t size) {
     // Maintain a maximum of 75% fill rate.
@@ -153,7 +188,7 @@ class WeakTable {
   }
   intptr_t limit() const { return LimitFor(size()); }
 
-  intptr_t index(intptr_t i) const { return i * kEntrySize; }
+  static intptr_t index(intptr_t i) { return kHeaderSize + i * kEntrySize; }
 
   void set_used(intptr_t val) {
     ASSERT(val <= limit());
@@ -166,9 +201,9 @@ class WeakTable {
     count_ = val;
   }
 
-  intptr_t ObjectIndex(intptr_t i) const { return index(i) + kObjectOffset; }
+  static intptr_t ObjectIndex(intptr_t i) { return index(i) + kObjectOffset; }
 
-  intptr_t ValueIndex(intptr_t i) const { return index(i) + kValueOffset; }
+  static intptr_t ValueIndex(intptr_t i) { return index(i) + kValueOffset; }
 
   ObjectPtr* ObjectPointerAt(intptr_t i) const {
     ASSERT(i >= 0);
@@ -176,10 +211,13 @@ class WeakTable {
     return reinterpret_cast<ObjectPtr*>(&data_[ObjectIndex(i)]);
   }
 
+  // Keys are stored with release semantics: a concurrent reader which sees
+  // a key also sees the value stored before it.
   void SetObjectAt(intptr_t i, ObjectPtr key) {
     ASSERT(i >= 0);
     ASSERT(i < size());
-    data_[ObjectIndex(i)] = static_cast<intptr_t>(key);
+    reinterpret_cast<std::atomic<intptr_t>*>(&data_[ObjectIndex(i)])
+        ->store(static_cast<intptr_t>(key), std::memory_order_release);
   }
 
   void SetValueAt(intptr_t i, intptr_t val) {
@@ -187,13 +225,16 @@ class WeakTable {
     ASSERT(i < size());
     // Setting a value of 0 is equivalent to invalidating the entry.
     if (val == 0) {
-      data_[ObjectIndex(i)] = kDeletedEntry;
+      reinterpret_cast<std::atomic<intptr_t>*>(&data_[ObjectIndex(i)])
+          ->store(kDeletedEntry, std::memory_order_release);
       set_count(count() - 1);
     }
-    data_[ValueIndex(i)] = val;
+    reinterpret_cast<std::atomic<intptr_t>*>(&data_[ValueIndex(i)])
+        ->store(val, std::memory_order_relaxed);
   }
 
   void Rehash();
+  void Retire(intptr_t* old_data);
 
   static intptr_t Hash(ObjectPtr key) {
     return static_cast<uintptr_t>(key) * 92821;
@@ -201,14 +242,18 @@ class WeakTable {
 
   Mutex mutex_;
 
-  // data_ contains size_ tuples of key/value.
+  // data_ contains size_ tuples of key/value. published_data_ is the same
+  // backing store, as seen by lock-free readers.
   intptr_t* data_;
+  AcqRelAtomic<intptr_t*> published_data_;
   // size_ keeps the number of entries in data_. used_ maintains the number of
   // non-NULL entries and will trigger rehashing if needed. count_ stores the
   // number valid entries, and will determine the size_ after rehashing.
   intptr_t size_;
   intptr_t used_;
   intptr_t count_;
+  // Backing stores replaced while readers may still use them.
+  intptr_t* retired_;
 
   DISALLOW_COPY_AND_ASSIGN(WeakTable);
 };
@@ -8,6 +8,8 @@
 #include "vm/globals.h"
 #include "vm/heap/heap.h"
 #include "vm/heap/weak_table.h"
+#include "vm/lockers.h"
+#include "vm/os_thread.h"
 #include "vm/unit_test.h"
 
 namespace dart {
@@ -59,4 +61,74 @@ ISOLATE_UNIT_TEST_CASE(WeakTables) {
   EXPECT_EQ(kNoValue, heap->GetObjectId(imm_obj.raw()));
 }
 
+static const intptr_t kNumConcurrentKeys = 10000;
+
+static ObjectPtr ConcurrentKey(intptr_t i) {
+  return static_cast<ObjectPtr>(kHeapObjectTag + (i + 1) * kObjectAlignment);
+}
+
+struct WeakTableReaderState {
+  WeakTable* table = nullptr;
+  RelaxedAtomic<bool> done = {false};
+  intptr_t lookups = 0;
+  intptr_t mismatches = 0;
+  Monitor monitor;
+  ThreadJoinId join_id = OSThread::kInvalidThreadJoinId;
+};
+
+static void WeakTableReader(uword arg) {
+  auto state = reinterpret_cast<WeakTableReaderState*>(arg);
+  intptr_t lookups = 0;
+  intptr_t mismatches = 0;
+  while (!state->done) {
+    for (intptr_t i = 0; i < kNumConcurrentKeys; i++) {
+      // A key is either not inserted yet or has the value it was inserted
+      // with, even while the table is being rehashed.
+      const intptr_t value = state->table->GetValue(ConcurrentKey(i));
+      if ((value != WeakTable::kNoValue) && (value != i + 1)) {
+        mismatches++;
+      }
+      lookups++;
+    }
+  }
+  MonitorLocker ml(&state->monitor);
+  state->lookups = lookups;
+  state->mismatches = mismatches;
+  state->join_id = OSThread::GetCurrentThreadJoinId(OSThread::Current());
+  ml.Notify();
+}
+
+TEST_CASE(WeakTableConcurrentReads) {
+  WeakTable table;
+  WeakTableReaderState state;
+  state.table = &table;
+  if (OSThread::Start("WeakTableReader", &WeakTableReader,
+                      reinterpret_cast<uword>(&state)) != 0) {
+    FATAL("Could not start reader thread");
+  }
+
+  // Grows the table many times while the reader is probing it.
+  for (intptr_t i = 0; i < kNumConcurrentKeys; i++) {
+    table.SetValue(ConcurrentKey(i), i + 1);
+  }
+  for (intptr_t i = 0; i < kNumConcurrentKeys; i++) {
+    EXPECT_EQ(i + 1, table.GetValue(ConcurrentKey(i)));
+  }
+
+  state.done = true;
+  {
+    MonitorLocker ml(&state.monitor);
+    while (state.join_id == OSThread::kInvalidThreadJoinId) {
+      ml.Wait();
+    }
+  }
+  OSThread::Join(state.join_id);
+  EXPECT(state.lookups > 0);
+  EXPECT_EQ(0, state.mismatches);
+
+  // No reader is left, so the replaced backing stores can be freed.
+  table.ReleaseRetiredExclusive();
+  EXPECT_EQ(kNumConcurrentKeys, table.count());
+}
+
 }  // namespace dart
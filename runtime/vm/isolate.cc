@@ -408,6 +408,7 @@ IsolateGroup::~IsolateGroup() {
   // Finalize any weak persistent handles with a non-null referent.
   FinalizeWeakPersistentHandlesVisitor visitor(this);
   api_state()->VisitWeakHandlesUnlocked(&visitor);
+  api_state()->pending_finalizers()->Run(this, /*deadline_micros=*/-1);
 
   // Ensure we destroy the heap before the other members.
   heap_ = nullptr;
@@ -475,6 +476,9 @@ void IsolateGroup::Shutdown() {
     thread_pool_.reset();
   }
 
+  // Wait for any finalizers a GC left to a background task.
+  api_state()->pending_finalizers()->WaitForTasks();
+
   // Wait for any pending GC tasks.
   if (heap_ != nullptr) {
     // Wait for any concurrent GC tasks to finish before shutting down.
@@ -586,6 +590,7 @@ void IsolateGroup::UnscheduleThreadLocked(MonitorLocker* ml,
                                           bool is_mutator,
                                           bool bypass_safepoint) {
   thread->heap()->new_space()->AbandonRemainingTLAB(thread);
+  thread->heap()->old_space()->AbandonRemainingTLAB(thread);
 
   // Clear since GC will not visit the thread once it is unscheduled. Do this
   // under the thread lock to prevent races with the GC visiting thread roots.
@@ -2893,15 +2898,20 @@ void IsolateGroup::RunWithStoppedMutatorsCallable(
 
 void IsolateGroup::VisitObjectPointers(ObjectPointerVisitor* visitor,
                                        ValidationPolicy validate_frames) {
+  VisitSharedPointers(visitor);
+  for (Isolate* isolate : isolates_) {
+    isolate->VisitObjectPointers(visitor, validate_frames);
+  }
+  api_state()->VisitObjectPointersUnlocked(visitor);
+  VisitStackPointers(visitor, validate_frames);
+}
+
+void IsolateGroup::VisitSharedPointers(ObjectPointerVisitor* visitor) {
   // if class table is shared, it's stored on isolate group
   if (class_table() != nullptr) {
     // Visit objects in the class table.
     class_table()->VisitObjectPointers(visitor);
   }
-  for (Isolate* isolate : isolates_) {
-    isolate->VisitObjectPointers(visitor, validate_frames);
-  }
-  api_state()->VisitObjectPointersUnlocked(visitor);
   // Visit objects in the object store.
   if (object_store() != nullptr) {
     object_store()->VisitObjectPointers(visitor);
@@ -2910,7 +2920,6 @@ void IsolateGroup::VisitObjectPointers(ObjectPointerVisitor* visitor,
   if (saved_initial_field_table() != nullptr) {
     saved_initial_field_table()->VisitObjectPointers(visitor);
   }
-  VisitStackPointers(visitor, validate_frames);
 }
 
 void IsolateGroup::VisitStackPointers(ObjectPointerVisitor* visitor,
@@ -3228,7 +3237,13 @@ void Isolate::PrintJSON(JSONStream* stream, bool ref) {
 }
 
 void Isolate::PrintMemoryUsageJSON(JSONStream* stream) {
-  heap()->PrintMemoryUsageJSON(stream);
+  JSONObject jsobj(stream);
+  heap()->PrintMemoryUsageJSON(&jsobj);
+  // The heap is shared by the isolate group. These report this isolate's
+  // part of it.
+  jsobj.AddProperty64("_isolateNewAllocated", allocated_new_bytes());
+  jsobj.AddProperty64("_isolateOldAllocated", allocated_old_bytes());
+  jsobj.AddProperty64("_isolateLiveEstimate", live_bytes_estimate());
 }
 
 #endif
@@ -591,6 +591,10 @@ class IsolateGroup : public IntrusiveDListEntry<IsolateGroup> {
   // running, and the visitor must not allocate.
   void VisitObjectPointers(ObjectPointerVisitor* visitor,
                            ValidationPolicy validate_frames);
+  // Visit the object pointers held by the group itself (class table, object
+  // store and field table), but not those of its isolates, persistent handles
+  // or threads. Lets the marker visit the remaining roots in parallel.
+  void VisitSharedPointers(ObjectPointerVisitor* visitor);
   void VisitStackPointers(ObjectPointerVisitor* visitor,
                           ValidationPolicy validate_frames);
   void VisitObjectIdRingPointers(ObjectPointerVisitor* visitor);
@@ -906,6 +910,27 @@ class Isolate : public BaseIsolate, public IntrusiveDListEntry<Isolate> {
 
   Heap* heap() const { return isolate_group_->heap(); }
 
+  // Bytes this isolate has allocated. New-space bytes are counted when one of
+  // its threads gives up an allocation buffer, old-space bytes at each
+  // allocation.
+  intptr_t allocated_new_bytes() const { return allocated_new_bytes_; }
+  intptr_t allocated_old_bytes() const { return allocated_old_bytes_; }
+  void AddAllocatedNewBytes(intptr_t size) {
+    allocated_new_bytes_.fetch_add(size);
+  }
+  void AddAllocatedOldBytes(intptr_t size) {
+    allocated_old_bytes_.fetch_add(size);
+  }
+
+  // The share of the heap's live bytes attributed to this isolate after the
+  // last old-space marking. See Heap::UpdateIsolateLiveEstimates.
+  intptr_t live_bytes_estimate() const { return live_bytes_estimate_; }
+  // Whether the estimate is the actual live size of the heap, because this
+  // isolate was the only one in its group.
+  bool live_bytes_estimate_is_exact() const {
+    return live_bytes_estimate_is_exact_;
+  }
+
   void set_init_callback_data(void* value) { init_callback_data_ = value; }
   void* init_callback_data() const { return init_callback_data_; }
 
@@ -1652,6 +1677,16 @@ class Isolate : public BaseIsolate, public IntrusiveDListEntry<Isolate> {
 
   std::unique_ptr<VirtualMemory> regexp_backtracking_stack_cache_ = nullptr;
 
+  RelaxedAtomic<intptr_t> allocated_new_bytes_ = {0};
+  RelaxedAtomic<intptr_t> allocated_old_bytes_ = {0};
+  // Total of the above when live_bytes_estimate_ was last updated.
+  intptr_t allocated_bytes_at_last_mark_ = 0;
+  RelaxedAtomic<intptr_t> live_bytes_estimate_ = {0};
+  RelaxedAtomic<bool> live_bytes_estimate_is_exact_ = {false};
+  // Whether this isolate was sent a kill message for exceeding
+  // --isolate_soft_limit_mb.
+  bool exceeded_soft_limit_ = false;
+
   static Dart_IsolateGroupCreateCallback create_group_callback_;
   static Dart_InitializeIsolateCallback initialize_callback_;
   static Dart_IsolateShutdownCallback shutdown_callback_;
@@ -1683,6 +1718,7 @@ class Isolate : public BaseIsolate, public IntrusiveDListEntry<Isolate> {
   friend class Become;       // VisitObjectPointers
   friend class GCCompactor;  // VisitObjectPointers
   friend class GCMarker;     // VisitObjectPointers
+  friend class Heap;         // live_bytes_estimate_
   friend class SafepointHandler;
   friend class ObjectGraph;         // VisitObjectPointers
   friend class HeapSnapshotWriter;  // VisitObjectPointers
@@ -4,6 +4,7 @@
 
 #include "vm/metrics.h"
 
+#include "vm/dart_api_state.h"
 #include "vm/isolate.h"
 #include "vm/json_stream.h"
 #include "vm/log.h"
@@ -177,6 +178,11 @@ int64_t MetricHeapUsed::Value() const {
          isolate_group()->heap()->UsedInWords(Heap::kOld) * kWordSize;
 }
 
+int64_t MetricFinalizersPending::Value() const {
+  ASSERT(isolate_group() == IsolateGroup::Current());
+  return isolate_group()->api_state()->pending_finalizers()->length();
+}
+
 #if !defined(PRODUCT)
 int64_t MetricIsolateCount::Value() const {
   return Isolate::IsolateListLength();
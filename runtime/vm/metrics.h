@@ -26,7 +26,10 @@ class JSONStream;
   V(MaxMetric, HeapNewCapacityMax, "heap.new.capacity.max", kByte)             \
   V(MetricHeapNewExternal, HeapNewExternal, "heap.new.external", kByte)        \
   V(MetricHeapUsed, HeapGlobalUsed, "heap.global.used", kByte)                 \
-  V(MaxMetric, HeapGlobalUsedMax, "heap.global.used.max", kByte)
+  V(MaxMetric, HeapGlobalUsedMax, "heap.global.used.max", kByte)               \
+  V(MetricFinalizersPending, FinalizersPending, "heap.finalizers.pending",     \
+    kCounter)                                                                  \
+  V(MaxMetric, FinalizersPendingMax, "heap.finalizers.pending.max", kCounter)
 
 // Metrics for each isolate.
 #define ISOLATE_METRIC_LIST(V)                                                 \
@@ -183,6 +186,11 @@ class MetricHeapUsed : public Metric {
   virtual int64_t Value() const;
 };
 
+class MetricFinalizersPending : public Metric {
+ public:
+  virtual int64_t Value() const;
+};
+
 #if !defined(PRODUCT)
 #define VM_METRIC_VARIABLE(type, variable, name, unit)                         \
   extern type vm_metric_##variable;
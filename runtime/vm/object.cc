@@ -84,6 +84,11 @@ DEFINE_FLAG(
     "Show names of internal classes (e.g. \"OneByteString\") in error messages "
     "instead of showing the corresponding interface names (e.g. \"String\"). "
     "Also show legacy nullability in type names.");
+DEFINE_FLAG(bool,
+            pack_unboxed_fields,
+            true,
+            "In precompiled mode, lay out the unboxed fields of a class before "
+            "its boxed fields.");
 DEFINE_FLAG(bool, use_lib_cache, false, "Use library name cache");
 DEFINE_FLAG(bool, use_exp_cache, false, "Use library exported name cache");
 
@@ -2619,15 +2624,28 @@ ObjectPtr Object::Allocate(intptr_t cls_id, intptr_t size, Heap::Space space) {
     }
   }
 #ifndef PRODUCT
-  auto class_table = thread->isolate_group()->shared_class_table();
-  if (class_table->TraceAllocationFor(cls_id)) {
-    Profiler::SampleAllocation(thread, cls_id);
+  Sample* allocation_sample = nullptr;
+  const intptr_t sampled_bytes = thread->TakePendingAllocationSample();
+  if (UNLIKELY(sampled_bytes != 0)) {
+    allocation_sample =
+        Profiler::SampleAllocation(thread, cls_id, sampled_bytes);
+  } else {
+    auto class_table = thread->isolate_group()->shared_class_table();
+    if (class_table->TraceAllocationFor(cls_id)) {
+      Profiler::SampleAllocation(thread, cls_id);
+    }
   }
 #endif  // !PRODUCT
   NoSafepointScope no_safepoint;
   InitializeObject(address, cls_id, size);
   ObjectPtr raw_obj = static_cast<ObjectPtr>(address + kHeapObjectTag);
   ASSERT(cls_id == ObjectLayout::ClassIdTag::decode(raw_obj->ptr()->tags_));
+#ifndef PRODUCT
+  if (allocation_sample != nullptr) {
+    heap->SetAllocationSample(raw_obj,
+                              allocation_sample->sampled_allocation_id());
+  }
+#endif  // !PRODUCT
   if (raw_obj->IsOldObject() && UNLIKELY(thread->is_marking())) {
     // Black allocation. Prevents a data race between the mutator and concurrent
     // marker on ARM and ARM64 (the marker may observe a publishing store of
@@ -2638,7 +2656,7 @@ ObjectPtr Object::Allocate(intptr_t cls_id, intptr_t size, Heap::Space space) {
     // object. Adding a barrier here is cheaper than making every store into the
     // heap a store-release. Compare Scavenger::ScavengePointer.
     std::atomic_thread_fence(std::memory_order_release);
-    heap->old_space()->AllocateBlack(size);
+    heap->old_space()->AllocateBlack(raw_obj, size);
   }
   return raw_obj;
 }
@@ -3301,6 +3319,24 @@ TypeParameterPtr Class::LookupTypeParameter(const String& type_name) const {
   return TypeParameter::null();
 }
 
+intptr_t Class::UnboxedFieldSize(const Field& field) {
+  switch (field.guarded_cid()) {
+    case kDoubleCid:
+      return sizeof(DoubleLayout::value_);
+    case kFloat32x4Cid:
+      return sizeof(Float32x4Layout::value_);
+    case kFloat64x2Cid:
+      return sizeof(Float64x2Layout::value_);
+    default:
+      if (field.is_non_nullable_integer()) {
+        return sizeof(MintLayout::value_);
+      } else {
+        UNREACHABLE();
+        return 0;
+      }
+  }
+}
+
 UnboxedFieldBitmap Class::CalculateFieldOffsets() const {
   Array& flds = Array::Handle(fields());
   const Class& super = Class::Handle(SuperClass());
@@ -3357,69 +3393,63 @@ UnboxedFieldBitmap Class::CalculateFieldOffsets() const {
                                   target_type_args_field_offset);
   ASSERT(host_offset > 0);
   ASSERT(target_offset > 0);
-  Field& field = Field::Handle();
-  const intptr_t len = flds.Length();
-  for (intptr_t i = 0; i < len; i++) {
-    field ^= flds.At(i);
-    // Offset is computed only for instance fields.
-    if (!field.is_static()) {
-      ASSERT(field.HostOffset() == 0);
-      ASSERT(field.TargetOffset() == 0);
-      field.SetOffset(host_offset, target_offset);
-
-      if (FLAG_precompiled_mode && field.is_unboxing_candidate()) {
-        intptr_t field_size;
-        switch (field.guarded_cid()) {
-          case kDoubleCid:
-            field_size = sizeof(DoubleLayout::value_);
-            break;
-          case kFloat32x4Cid:
-            field_size = sizeof(Float32x4Layout::value_);
-            break;
-          case kFloat64x2Cid:
-            field_size = sizeof(Float64x2Layout::value_);
-            break;
-          default:
-            if (field.is_non_nullable_integer()) {
-              field_size = sizeof(MintLayout::value_);
-            } else {
-              UNREACHABLE();
-              field_size = 0;
-            }
-            break;
-        }
-
-        const intptr_t host_num_words = field_size / kWordSize;
-        const intptr_t host_next_offset = host_offset + field_size;
-        const intptr_t host_next_position = host_next_offset / kWordSize;
-
-        const intptr_t target_next_offset = target_offset + field_size;
-        const intptr_t target_next_position =
-            target_next_offset / compiler::target::kWordSize;
-
-        // The bitmap has fixed length. Checks if the offset position is smaller
-        // than its length. If it is not, than the field should be boxed
-        if (host_next_position <= UnboxedFieldBitmap::Length() &&
-            target_next_position <= UnboxedFieldBitmap::Length()) {
-          for (intptr_t j = 0; j < host_num_words; j++) {
-            // Activate the respective bit in the bitmap, indicating that the
-            // content is not a pointer
-            host_bitmap.Set(host_offset / kWordSize);
-            host_offset += kWordSize;
-          }
-
-          ASSERT(host_offset == host_next_offset);
-          target_offset = target_next_offset;
-        } else {
-          // Make the field boxed
-          field.set_is_unboxing_candidate(false);
+  auto lay_out_field = [&](const Field& field) {
+    ASSERT(field.HostOffset() == 0);
+    ASSERT(field.TargetOffset() == 0);
+    field.SetOffset(host_offset, target_offset);
+
+    if (FLAG_precompiled_mode && field.is_unboxing_candidate()) {
+      const intptr_t field_size = UnboxedFieldSize(field);
+      const intptr_t host_num_words = field_size / kWordSize;
+      const intptr_t host_next_offset = host_offset + field_size;
+      const intptr_t host_next_position = host_next_offset / kWordSize;
+
+      const intptr_t target_next_offset = target_offset + field_size;
+      const intptr_t target_next_position =
+          target_next_offset / compiler::target::kWordSize;
+
+      // The bitmap has fixed length. Checks if the offset position is smaller
+      // than its length. If it is not, than the field should be boxed
+      if (host_next_position <= UnboxedFieldBitmap::Length() &&
+          target_next_position <= UnboxedFieldBitmap::Length()) {
+        for (intptr_t j = 0; j < host_num_words; j++) {
+          // Activate the respective bit in the bitmap, indicating that the
+          // content is not a pointer
+          host_bitmap.Set(host_offset / kWordSize);
           host_offset += kWordSize;
-          target_offset += compiler::target::kWordSize;
         }
+
+        ASSERT(host_offset == host_next_offset);
+        target_offset = target_next_offset;
       } else {
+        // Make the field boxed
+        field.set_is_unboxing_candidate(false);
         host_offset += kWordSize;
         target_offset += compiler::target::kWordSize;
       }
+    } else {
+      host_offset += kWordSize;
+      target_offset += compiler::target::kWordSize;
+    }
+  };
+
+  Field& field = Field::Handle();
+  const intptr_t len = flds.Length();
+  if (FLAG_precompiled_mode && FLAG_pack_unboxed_fields) {
+    // Lay out the unboxing candidates first, so that as many of them as
+    // possible fit in the unboxed fields bitmap instead of being boxed.
+    for (intptr_t i = 0; i < len; i++) {
+      field ^= flds.At(i);
+      if (!field.is_static() && field.is_unboxing_candidate()) {
+        lay_out_field(field);
+      }
+    }
+  }
+  for (intptr_t i = 0; i < len; i++) {
+    field ^= flds.At(i);
+    // Offset is computed only for instance fields.
+    if (!field.is_static() && (field.HostOffset() == 0)) {
+      lay_out_field(field);
     }
   }
   set_instance_size(RoundedAllocationSize(host_offset),
@@ -3429,6 +3459,58 @@ UnboxedFieldBitmap Class::CalculateFieldOffsets() const {
   return host_bitmap;
 }
 
+#if !defined(PRODUCT)
+intptr_t Class::FieldPackingSavings() const {
+  if (!FLAG_precompiled_mode || !FLAG_pack_unboxed_fields || !is_finalized() ||
+      is_prefinalized()) {
+    return 0;
+  }
+  Zone* zone = Thread::Current()->zone();
+  const Class& super = Class::Handle(zone, SuperClass());
+  intptr_t offset = super.IsNull() ? Instance::NextFieldOffset()
+                                   : super.host_next_field_offset();
+  if (host_type_arguments_field_offset() == offset) {
+    offset += kWordSize;  // The type_arguments field introduced by this class.
+  }
+  // Replay the layout in declaration order. The unboxed fields that would no
+  // longer fit in the unboxed fields bitmap would need a box each.
+  intptr_t boxes_size = 0;
+  const Array& flds = Array::Handle(zone, fields());
+  Field& field = Field::Handle(zone);
+  for (intptr_t i = 0; i < flds.Length(); i++) {
+    field ^= flds.At(i);
+    if (field.is_static()) {
+      continue;
+    }
+    if (!field.is_unboxing_candidate()) {
+      offset += kWordSize;
+      continue;
+    }
+    const intptr_t field_size = UnboxedFieldSize(field);
+    if ((offset + field_size) / kWordSize <= UnboxedFieldBitmap::Length()) {
+      offset += field_size;
+      continue;
+    }
+    switch (field.guarded_cid()) {
+      case kDoubleCid:
+        boxes_size += Double::InstanceSize();
+        break;
+      case kFloat32x4Cid:
+        boxes_size += Float32x4::InstanceSize();
+        break;
+      case kFloat64x2Cid:
+        boxes_size += Float64x2::InstanceSize();
+        break;
+      default:
+        boxes_size += Mint::InstanceSize();
+        break;
+    }
+    offset += kWordSize;
+  }
+  return RoundedAllocationSize(offset) + boxes_size - host_instance_size();
+}
+#endif  // !defined(PRODUCT)
+
 void Class::AddInvocationDispatcher(const String& target_name,
                                     const Array& args_desc,
                                     const Function& dispatcher) const {
@@ -22998,8 +23080,15 @@ uint32_t Array::CanonicalizeHash() const {
 
 ArrayPtr Array::New(intptr_t len, Heap::Space space) {
   ASSERT(Isolate::Current()->object_store()->array_class() != Class::null());
+  const bool use_card_marking = UseCardMarkingForAllocation(len);
+  if (use_card_marking) {
+    // The card table belongs to the page, so the array must be old and alone
+    // on its page. Arrays above the threshold never fit the freelists.
+    ASSERT(!Heap::IsAllocatableViaFreeLists(InstanceSize(len)));
+    space = Heap::kOld;
+  }
   ArrayPtr result = New(kClassId, len, space);
-  if (UseCardMarkingForAllocation(len)) {
+  if (use_card_marking) {
     ASSERT(result->IsOldObject());
     result->ptr()->SetCardRememberedBitUnsynchronized();
   }
@@ -930,6 +930,13 @@ class Class : public Object {
     ASSERT(is_finalized() || is_prefinalized());
     return (raw_ptr()->host_instance_size_in_words_ * kWordSize);
   }
+
+#if !defined(PRODUCT)
+  // Returns how many bytes per instance, counting the boxes of unboxed
+  // fields, the field packing done by CalculateFieldOffsets saves over laying
+  // out the fields in declaration order.
+  intptr_t FieldPackingSavings() const;
+#endif  // !defined(PRODUCT)
   intptr_t target_instance_size() const {
     ASSERT(is_finalized() || is_prefinalized());
 #if !defined(DART_PRECOMPILED_RUNTIME)
@@ -1677,6 +1684,9 @@ class Class : public Object {
   // Returns the bitmap of unboxed fields
   UnboxedFieldBitmap CalculateFieldOffsets() const;
 
+  // Returns the size of the payload of an unboxed field.
+  static intptr_t UnboxedFieldSize(const Field& field);
+
   // functions_hash_table is in use iff there are at least this many functions.
   static const intptr_t kFunctionLookupHashTreshold = 16;
 
@@ -9427,9 +9437,14 @@ class Array : public Instance {
   // architecture.
   static const intptr_t kHashBits = 30;
 
+  // Arrays larger than this are allocated in old space, each on its own large
+  // page, and use card marking instead of the store buffer so that a scavenge
+  // only rescans the cards that were stored into rather than the whole array.
+  static const intptr_t kCardMarkingThresholdSize = Heap::kAllocatablePageSize;
+
   // Returns `true` if we use card marking for arrays of length [array_length].
   static bool UseCardMarkingForAllocation(const intptr_t array_length) {
-    return Array::InstanceSize(array_length) > Heap::kNewAllocatableSize;
+    return Array::InstanceSize(array_length) > kCardMarkingThresholdSize;
   }
 
   intptr_t Length() const { return LengthOf(raw()); }
@@ -9511,7 +9526,7 @@ class Array : public Instance {
   static const intptr_t kBytesPerElement = kWordSize;
   static const intptr_t kMaxElements = kSmiMax / kBytesPerElement;
   static const intptr_t kMaxNewSpaceElements =
-      (Heap::kNewAllocatableSize - sizeof(ArrayLayout)) / kBytesPerElement;
+      (kCardMarkingThresholdSize - sizeof(ArrayLayout)) / kBytesPerElement;
 
   static intptr_t type_arguments_offset() {
     return OFFSET_OF(ArrayLayout, type_arguments_);
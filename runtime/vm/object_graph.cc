@@ -15,12 +15,23 @@
 #include "vm/raw_object.h"
 #include "vm/raw_object_fields.h"
 #include "vm/reusable_handles.h"
+#include "vm/thread_barrier.h"
 #include "vm/visitor.h"
 
 namespace dart {
 
 #if !defined(PRODUCT)
 
+DEFINE_FLAG(int,
+            heap_snapshot_tasks,
+            1,
+            "The number of tasks to use when writing heap snapshots.");
+DEFINE_FLAG(charp,
+            write_heap_snapshot_to,
+            nullptr,
+            "Write heap snapshots requested through the service to this file "
+            "instead of streaming them to the client.");
+
 static bool IsUserClass(intptr_t cid) {
   if (cid == kContextCid) return true;
   if (cid == kTypeArgumentsCid) return false;
@@ -566,6 +577,13 @@ class CountingBlock {
     count_bitvector_ |= static_cast<uword>(1) << bitvector_shift;
   }
 
+  // Offsets the ids recorded with ids relative to the start of the page.
+  void Rebase(intptr_t base) {
+    if (base_count_ != 0) {
+      base_count_ += base;
+    }
+  }
+
  private:
   intptr_t base_count_;
   uword count_bitvector_;
@@ -586,6 +604,11 @@ class CountingPage {
   void Record(uword addr, intptr_t id) {
     return BlockFor(addr)->Record(addr, id);
   }
+  void Rebase(intptr_t base) {
+    for (intptr_t i = 0; i < kBlocksPerPage; i++) {
+      blocks_[i].Rebase(base);
+    }
+  }
 
   CountingBlock* BlockFor(uword addr) {
     intptr_t page_offset = addr & ~kOldPageMask;
@@ -602,16 +625,44 @@ class CountingPage {
   DISALLOW_IMPLICIT_CONSTRUCTORS(CountingPage);
 };
 
-void HeapSnapshotWriter::EnsureAvailable(intptr_t needed) {
-  intptr_t available = capacity_ - size_;
-  if (available >= needed) {
+HeapSnapshotWriter::HeapSnapshotWriter(Thread* thread, const char* filename)
+    : ThreadStackResource(thread) {
+  if (filename == nullptr) {
     return;
   }
+  auto file_open = Dart::file_open_callback();
+  if ((file_open == nullptr) || (Dart::file_write_callback() == nullptr) ||
+      (Dart::file_close_callback() == nullptr)) {
+    OS::PrintErr("Could not access file callbacks to write heap snapshot.\n");
+    failed_to_open_file_ = true;
+    return;
+  }
+  file_ = file_open(filename, /*write=*/true);
+  if (file_ == nullptr) {
+    OS::PrintErr("Failed to open file %s\n", filename);
+    failed_to_open_file_ = true;
+  }
+}
+
+HeapSnapshotWriter::~HeapSnapshotWriter() {
+  free(buffer_);
+  if (file_ != nullptr) {
+    Dart::file_close_callback()(file_);
+  }
+}
 
+void HeapSnapshotWriter::Grow(intptr_t needed) {
   if (buffer_ != nullptr) {
     Flush();
   }
-  ASSERT(buffer_ == nullptr);
+  if (buffer_ != nullptr) {
+    // The chunk was written to the file and can be reused.
+    if ((capacity_ - size_) >= needed) {
+      return;
+    }
+    free(buffer_);
+    buffer_ = nullptr;
+  }
 
   intptr_t chunk_size = kPreferredChunkSize;
   if (chunk_size < needed + kMetadataReservation) {
@@ -627,6 +678,22 @@ void HeapSnapshotWriter::Flush(bool last) {
     return;
   }
 
+  if (file_ != nullptr) {
+    if (size_ > kMetadataReservation) {
+      Dart::file_write_callback()(&buffer_[kMetadataReservation],
+                                  size_ - kMetadataReservation, file_);
+    }
+    if (last) {
+      free(buffer_);
+      buffer_ = nullptr;
+      size_ = 0;
+      capacity_ = 0;
+    } else {
+      size_ = kMetadataReservation;
+    }
+    return;
+  }
+
   JSONStream js;
   {
     JSONObject jsobj(&js);
@@ -679,15 +746,34 @@ void HeapSnapshotWriter::SetupCountingPages() {
     next_offset++;
   }
 
-  OldPage* page = isolate()->heap()->old_space()->pages_;
+  PageSpace* old_space = isolate()->heap()->old_space();
+  MutexLocker ml(&old_space->pages_lock_);
+  old_space->MakeIterable();
+  counting_pages_.Clear();
+  uncounted_pages_.Clear();
+  OldPage* page = old_space->pages_;
   while (page != NULL) {
-    page->forwarding_page();
     CountingPage* counting_page =
         reinterpret_cast<CountingPage*>(page->forwarding_page());
     ASSERT(counting_page != NULL);
     counting_page->Clear();
+    counting_pages_.Add(page);
     page = page->next();
   }
+  OldPage* const other_pages[] = {old_space->exec_pages_,
+                                  old_space->large_pages_,
+                                  old_space->image_pages_};
+  for (OldPage* page : other_pages) {
+    for (; page != NULL; page = page->next()) {
+      uncounted_pages_.Add(page);
+    }
+  }
+}
+
+void HeapSnapshotWriter::VisitUncountedPages(ObjectVisitor* visitor) const {
+  for (intptr_t i = 0; i < uncounted_pages_.length(); i++) {
+    uncounted_pages_[i]->VisitObjects(visitor);
+  }
 }
 
 bool HeapSnapshotWriter::OnImagePage(ObjectPtr obj) const {
@@ -740,8 +826,9 @@ intptr_t HeapSnapshotWriter::GetObjectId(ObjectPtr obj) const {
     // Likely: object on an ordinary page.
     id = counting_page->Lookup(ObjectLayout::ToAddr(obj));
   } else {
-    // Unlikely: new space object, or object on a large or image page.
-    id = thread()->heap()->GetObjectId(obj);
+    // Unlikely: new space object, or object on a large or image page. This
+    // may be called from a task, so bypass the mutator-only accessor.
+    id = thread()->heap()->GetWeakEntry(obj, Heap::kObjectIds);
   }
   ASSERT(id != 0);
   return id;
@@ -800,6 +887,42 @@ class Pass1Visitor : public ObjectVisitor,
   DISALLOW_COPY_AND_ASSIGN(Pass1Visitor);
 };
 
+// Like Pass1Visitor, for the objects on a single regular old-space page. The
+// ids are relative to the start of the page until the number of objects on
+// the preceding pages is known.
+class Pass1PageVisitor : public ObjectVisitor, public ObjectPointerVisitor {
+ public:
+  explicit Pass1PageVisitor(CountingPage* counting_page)
+      : ObjectVisitor(),
+        ObjectPointerVisitor(IsolateGroup::Current()),
+        counting_page_(counting_page) {}
+
+  virtual bool trace_values_through_fields() const { return true; }
+
+  void VisitObject(ObjectPtr obj) {
+    if (obj->IsPseudoObject()) return;
+
+    counting_page_->Record(ObjectLayout::ToAddr(obj), ++object_count_);
+    obj->ptr()->VisitPointers(this);
+  }
+
+  void VisitPointers(ObjectPtr* from, ObjectPtr* to) {
+    intptr_t count = to - from + 1;
+    ASSERT(count >= 0);
+    reference_count_ += count;
+  }
+
+  intptr_t object_count() const { return object_count_; }
+  intptr_t reference_count() const { return reference_count_; }
+
+ private:
+  CountingPage* const counting_page_;
+  intptr_t object_count_ = 0;
+  intptr_t reference_count_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(Pass1PageVisitor);
+};
+
 enum NonReferenceDataTags {
   kNoData = 0,
   kNullData,
@@ -822,8 +945,9 @@ class Pass2Visitor : public ObjectVisitor,
       : ObjectVisitor(),
         ObjectPointerVisitor(IsolateGroup::Current()),
         HandleVisitor(Thread::Current()),
-        isolate_(thread()->isolate()),
-        writer_(writer) {}
+        isolate_(writer->isolate()),
+        writer_(writer),
+        out_(writer) {}
 
   virtual bool trace_values_through_fields() const { return true; }
 
@@ -831,107 +955,107 @@ class Pass2Visitor : public ObjectVisitor,
     if (obj->IsPseudoObject()) return;
 
     intptr_t cid = obj->GetClassId();
-    writer_->WriteUnsigned(cid);
-    writer_->WriteUnsigned(discount_sizes_ ? 0 : obj->ptr()->HeapSize());
+    out_->WriteUnsigned(cid);
+    out_->WriteUnsigned(discount_sizes_ ? 0 : obj->ptr()->HeapSize());
 
     if (cid == kNullCid) {
-      writer_->WriteUnsigned(kNullData);
+      out_->WriteUnsigned(kNullData);
     } else if (cid == kBoolCid) {
-      writer_->WriteUnsigned(kBoolData);
-      writer_->WriteUnsigned(
+      out_->WriteUnsigned(kBoolData);
+      out_->WriteUnsigned(
           static_cast<uintptr_t>(static_cast<BoolPtr>(obj)->ptr()->value_));
     } else if (cid == kSmiCid) {
       UNREACHABLE();
     } else if (cid == kMintCid) {
-      writer_->WriteUnsigned(kIntData);
-      writer_->WriteSigned(static_cast<MintPtr>(obj)->ptr()->value_);
+      out_->WriteUnsigned(kIntData);
+      out_->WriteSigned(static_cast<MintPtr>(obj)->ptr()->value_);
     } else if (cid == kDoubleCid) {
-      writer_->WriteUnsigned(kDoubleData);
-      writer_->WriteBytes(&(static_cast<DoublePtr>(obj)->ptr()->value_),
-                          sizeof(double));
+      out_->WriteUnsigned(kDoubleData);
+      out_->WriteBytes(&(static_cast<DoublePtr>(obj)->ptr()->value_),
+                       sizeof(double));
     } else if (cid == kOneByteStringCid) {
       OneByteStringPtr str = static_cast<OneByteStringPtr>(obj);
       intptr_t len = Smi::Value(str->ptr()->length_);
       intptr_t trunc_len = Utils::Minimum(len, kMaxStringElements);
-      writer_->WriteUnsigned(kLatin1Data);
-      writer_->WriteUnsigned(len);
-      writer_->WriteUnsigned(trunc_len);
-      writer_->WriteBytes(&str->ptr()->data()[0], trunc_len);
+      out_->WriteUnsigned(kLatin1Data);
+      out_->WriteUnsigned(len);
+      out_->WriteUnsigned(trunc_len);
+      out_->WriteBytes(&str->ptr()->data()[0], trunc_len);
     } else if (cid == kExternalOneByteStringCid) {
       ExternalOneByteStringPtr str = static_cast<ExternalOneByteStringPtr>(obj);
       intptr_t len = Smi::Value(str->ptr()->length_);
       intptr_t trunc_len = Utils::Minimum(len, kMaxStringElements);
-      writer_->WriteUnsigned(kLatin1Data);
-      writer_->WriteUnsigned(len);
-      writer_->WriteUnsigned(trunc_len);
-      writer_->WriteBytes(&str->ptr()->external_data_[0], trunc_len);
+      out_->WriteUnsigned(kLatin1Data);
+      out_->WriteUnsigned(len);
+      out_->WriteUnsigned(trunc_len);
+      out_->WriteBytes(&str->ptr()->external_data_[0], trunc_len);
     } else if (cid == kTwoByteStringCid) {
       TwoByteStringPtr str = static_cast<TwoByteStringPtr>(obj);
       intptr_t len = Smi::Value(str->ptr()->length_);
       intptr_t trunc_len = Utils::Minimum(len, kMaxStringElements);
-      writer_->WriteUnsigned(kUTF16Data);
-      writer_->WriteUnsigned(len);
-      writer_->WriteUnsigned(trunc_len);
-      writer_->WriteBytes(&str->ptr()->data()[0], trunc_len * 2);
+      out_->WriteUnsigned(kUTF16Data);
+      out_->WriteUnsigned(len);
+      out_->WriteUnsigned(trunc_len);
+      out_->WriteBytes(&str->ptr()->data()[0], trunc_len * 2);
     } else if (cid == kExternalTwoByteStringCid) {
       ExternalTwoByteStringPtr str = static_cast<ExternalTwoByteStringPtr>(obj);
       intptr_t len = Smi::Value(str->ptr()->length_);
       intptr_t trunc_len = Utils::Minimum(len, kMaxStringElements);
-      writer_->WriteUnsigned(kUTF16Data);
-      writer_->WriteUnsigned(len);
-      writer_->WriteUnsigned(trunc_len);
-      writer_->WriteBytes(&str->ptr()->external_data_[0], trunc_len * 2);
+      out_->WriteUnsigned(kUTF16Data);
+      out_->WriteUnsigned(len);
+      out_->WriteUnsigned(trunc_len);
+      out_->WriteBytes(&str->ptr()->external_data_[0], trunc_len * 2);
     } else if (cid == kArrayCid || cid == kImmutableArrayCid) {
-      writer_->WriteUnsigned(kLengthData);
-      writer_->WriteUnsigned(
+      out_->WriteUnsigned(kLengthData);
+      out_->WriteUnsigned(
           Smi::Value(static_cast<ArrayPtr>(obj)->ptr()->length_));
     } else if (cid == kGrowableObjectArrayCid) {
-      writer_->WriteUnsigned(kLengthData);
-      writer_->WriteUnsigned(
+      out_->WriteUnsigned(kLengthData);
+      out_->WriteUnsigned(
           Smi::Value(static_cast<GrowableObjectArrayPtr>(obj)->ptr()->length_));
     } else if (cid == kLinkedHashMapCid) {
-      writer_->WriteUnsigned(kLengthData);
-      writer_->WriteUnsigned(
+      out_->WriteUnsigned(kLengthData);
+      out_->WriteUnsigned(
           Smi::Value(static_cast<LinkedHashMapPtr>(obj)->ptr()->used_data_));
     } else if (cid == kObjectPoolCid) {
-      writer_->WriteUnsigned(kLengthData);
-      writer_->WriteUnsigned(static_cast<ObjectPoolPtr>(obj)->ptr()->length_);
+      out_->WriteUnsigned(kLengthData);
+      out_->WriteUnsigned(static_cast<ObjectPoolPtr>(obj)->ptr()->length_);
     } else if (IsTypedDataClassId(cid)) {
-      writer_->WriteUnsigned(kLengthData);
-      writer_->WriteUnsigned(
+      out_->WriteUnsigned(kLengthData);
+      out_->WriteUnsigned(
           Smi::Value(static_cast<TypedDataPtr>(obj)->ptr()->length_));
     } else if (IsExternalTypedDataClassId(cid)) {
-      writer_->WriteUnsigned(kLengthData);
-      writer_->WriteUnsigned(
+      out_->WriteUnsigned(kLengthData);
+      out_->WriteUnsigned(
           Smi::Value(static_cast<ExternalTypedDataPtr>(obj)->ptr()->length_));
     } else if (cid == kFunctionCid) {
-      writer_->WriteUnsigned(kNameData);
+      out_->WriteUnsigned(kNameData);
       ScrubAndWriteUtf8(static_cast<FunctionPtr>(obj)->ptr()->name_);
     } else if (cid == kCodeCid) {
       ObjectPtr owner = static_cast<CodePtr>(obj)->ptr()->owner_;
       if (owner->IsFunction()) {
-        writer_->WriteUnsigned(kNameData);
+        out_->WriteUnsigned(kNameData);
         ScrubAndWriteUtf8(static_cast<FunctionPtr>(owner)->ptr()->name_);
       } else if (owner->IsClass()) {
-        writer_->WriteUnsigned(kNameData);
+        out_->WriteUnsigned(kNameData);
         ScrubAndWriteUtf8(static_cast<ClassPtr>(owner)->ptr()->name_);
       } else {
-        writer_->WriteUnsigned(kNoData);
+        out_->WriteUnsigned(kNoData);
       }
     } else if (cid == kFieldCid) {
-      writer_->WriteUnsigned(kNameData);
+      out_->WriteUnsigned(kNameData);
       ScrubAndWriteUtf8(static_cast<FieldPtr>(obj)->ptr()->name_);
     } else if (cid == kClassCid) {
-      writer_->WriteUnsigned(kNameData);
+      out_->WriteUnsigned(kNameData);
       ScrubAndWriteUtf8(static_cast<ClassPtr>(obj)->ptr()->name_);
     } else if (cid == kLibraryCid) {
-      writer_->WriteUnsigned(kNameData);
+      out_->WriteUnsigned(kNameData);
       ScrubAndWriteUtf8(static_cast<LibraryPtr>(obj)->ptr()->url_);
     } else if (cid == kScriptCid) {
-      writer_->WriteUnsigned(kNameData);
+      out_->WriteUnsigned(kNameData);
       ScrubAndWriteUtf8(static_cast<ScriptPtr>(obj)->ptr()->url_);
     } else {
-      writer_->WriteUnsigned(kNoData);
+      out_->WriteUnsigned(kNoData);
     }
 
     DoCount();
@@ -942,17 +1066,18 @@ class Pass2Visitor : public ObjectVisitor,
 
   void ScrubAndWriteUtf8(StringPtr str) {
     if (str == String::null()) {
-      writer_->WriteUtf8("null");
+      out_->WriteUtf8("null");
     } else {
       String handle;
       handle = str;
       char* value = handle.ToMallocCString();
-      writer_->ScrubAndWriteUtf8(value);
+      out_->ScrubAndWriteUtf8(value);
       free(value);
     }
   }
 
   void set_discount_sizes(bool value) { discount_sizes_ = value; }
+  void set_output(HeapSnapshotEncoder* out) { out_ = out; }
 
   void DoCount() {
     writing_ = false;
@@ -961,7 +1086,7 @@ class Pass2Visitor : public ObjectVisitor,
   }
   void DoWrite() {
     writing_ = true;
-    writer_->WriteUnsigned(counted_);
+    out_->WriteUnsigned(counted_);
   }
 
   void VisitPointers(ObjectPtr* from, ObjectPtr* to) {
@@ -970,7 +1095,7 @@ class Pass2Visitor : public ObjectVisitor,
         ObjectPtr target = *ptr;
         written_++;
         total_++;
-        writer_->WriteUnsigned(writer_->GetObjectId(target));
+        out_->WriteUnsigned(writer_->GetObjectId(target));
       }
     } else {
       intptr_t count = to - from + 1;
@@ -986,12 +1111,12 @@ class Pass2Visitor : public ObjectVisitor,
       return;  // Free handle.
     }
 
-    writer_->WriteUnsigned(writer_->GetObjectId(weak_persistent_handle->raw()));
-    writer_->WriteUnsigned(weak_persistent_handle->external_size());
+    out_->WriteUnsigned(writer_->GetObjectId(weak_persistent_handle->raw()));
+    out_->WriteUnsigned(weak_persistent_handle->external_size());
     // Attempt to include a native symbol name.
     auto const name = NativeSymbolResolver::LookupSymbolName(
         reinterpret_cast<uword>(weak_persistent_handle->callback()), nullptr);
-    writer_->WriteUtf8((name == nullptr) ? "Unknown native function" : name);
+    out_->WriteUtf8((name == nullptr) ? "Unknown native function" : name);
     if (name != nullptr) {
       NativeSymbolResolver::FreeSymbolName(name);
     }
@@ -1003,6 +1128,7 @@ class Pass2Visitor : public ObjectVisitor,
   // descriptor), we can remove this dependency on the current isolate.
   Isolate* isolate_;
   HeapSnapshotWriter* const writer_;
+  HeapSnapshotEncoder* out_;
   bool writing_ = false;
   intptr_t counted_ = 0;
   intptr_t written_ = 0;
@@ -1012,8 +1138,155 @@ class Pass2Visitor : public ObjectVisitor,
   DISALLOW_COPY_AND_ASSIGN(Pass2Visitor);
 };
 
+// Holds the serialization of the objects on one old-space page until it can
+// be written in page order.
+class HeapSnapshotPageBuffer : public HeapSnapshotEncoder {
+ public:
+  HeapSnapshotPageBuffer() {}
+  ~HeapSnapshotPageBuffer() { free(buffer_); }
+
+  const uint8_t* buffer() const { return buffer_; }
+  intptr_t size() const { return size_; }
+
+  // Keeps the buffer, which is reused for the next page.
+  void Reset() { size_ = 0; }
+
+ protected:
+  virtual void Grow(intptr_t needed) {
+    intptr_t capacity = Utils::Maximum(capacity_ * 2, kInitialCapacity);
+    while ((capacity - size_) < needed) {
+      capacity *= 2;
+    }
+    buffer_ = reinterpret_cast<uint8_t*>(realloc(buffer_, capacity));
+    capacity_ = capacity;
+  }
+
+ private:
+  static const intptr_t kInitialCapacity = 64 * KB;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapSnapshotPageBuffer);
+};
+
+class HeapSnapshotTask : public ThreadPool::Task {
+ public:
+  enum Phase {
+    kAssignObjectIds,
+    kWriteObjects,
+  };
+
+  HeapSnapshotTask(IsolateGroup* isolate_group,
+                   HeapSnapshotWriter* writer,
+                   ThreadBarrier* barrier,
+                   Phase phase)
+      : isolate_group_(isolate_group),
+        writer_(writer),
+        barrier_(barrier),
+        phase_(phase) {}
+
+  void Run() {
+    bool result = Thread::EnterIsolateGroupAsHelper(
+        isolate_group_, Thread::kUnknownTask, /*bypass_safepoint=*/true);
+    ASSERT(result);
+
+    RunEnteredIsolateGroup(/*is_main=*/false);
+
+    Thread::ExitIsolateGroupAsHelper(/*bypass_safepoint=*/true);
+
+    // This task is done. Notify the original thread.
+    barrier_->Exit();
+  }
+
+  void RunEnteredIsolateGroup(bool is_main) {
+    switch (phase_) {
+      case kAssignObjectIds:
+        writer_->AssignPageObjectIds();
+        break;
+      case kWriteObjects:
+        writer_->WritePageObjects(barrier_, is_main);
+        break;
+    }
+  }
+
+ private:
+  IsolateGroup* isolate_group_;
+  HeapSnapshotWriter* writer_;
+  ThreadBarrier* barrier_;
+  Phase phase_;
+
+  DISALLOW_COPY_AND_ASSIGN(HeapSnapshotTask);
+};
+
+void HeapSnapshotWriter::RunTasks(intptr_t phase) {
+  Heap* heap = thread()->heap();
+  ThreadBarrier barrier(num_tasks_, heap->barrier(), heap->barrier_done());
+  next_page_ = 0;
+  for (intptr_t i = 0; i < num_tasks_; i++) {
+    if (i < (num_tasks_ - 1)) {
+      Dart::thread_pool()->Run<HeapSnapshotTask>(
+          thread()->isolate_group(), this, &barrier,
+          static_cast<HeapSnapshotTask::Phase>(phase));
+    } else {
+      // Last worker is the main thread, which also writes the output.
+      HeapSnapshotTask task(thread()->isolate_group(), this, &barrier,
+                            static_cast<HeapSnapshotTask::Phase>(phase));
+      task.RunEnteredIsolateGroup(/*is_main=*/true);
+      barrier.Exit();
+    }
+  }
+}
+
+void HeapSnapshotWriter::AssignPageObjectIds() {
+  const intptr_t num_pages = counting_pages_.length();
+  intptr_t reference_count = 0;
+  for (intptr_t i = next_page_.fetch_add(1); i < num_pages;
+       i = next_page_.fetch_add(1)) {
+    OldPage* page = counting_pages_[i];
+    Pass1PageVisitor visitor(
+        reinterpret_cast<CountingPage*>(page->forwarding_page()));
+    page->VisitObjects(&visitor);
+    page_object_counts_[i] = visitor.object_count();
+    reference_count += visitor.reference_count();
+  }
+  page_reference_count_.fetch_add(reference_count);
+}
+
+void HeapSnapshotWriter::WritePageObjects(ThreadBarrier* barrier,
+                                          bool is_main) {
+  // Pages are serialized in batches into per-page buffers, which the main
+  // thread then writes in page order. This bounds the memory used to the
+  // buffers of one batch.
+  const intptr_t num_pages = counting_pages_.length();
+  const intptr_t batch_size = num_tasks_ * kBufferedPagesPerTask;
+  Pass2Visitor visitor(this);
+  for (intptr_t batch_start = 0; batch_start < num_pages;
+       batch_start += batch_size) {
+    const intptr_t batch_end =
+        Utils::Minimum(batch_start + batch_size, num_pages);
+    for (intptr_t i = next_page_.fetch_add(1); i < batch_end;
+         i = next_page_.fetch_add(1)) {
+      HeapSnapshotPageBuffer* buffer = &page_buffers_[i - batch_start];
+      buffer->Reset();
+      visitor.set_output(buffer);
+      counting_pages_[i]->VisitObjects(&visitor);
+    }
+    barrier->Sync();
+    if (is_main) {
+      for (intptr_t i = batch_start; i < batch_end; i++) {
+        HeapSnapshotPageBuffer* buffer = &page_buffers_[i - batch_start];
+        WriteBytes(buffer->buffer(), buffer->size());
+      }
+      next_page_ = batch_end;
+    }
+    barrier->Sync();
+  }
+}
+
 void HeapSnapshotWriter::Write() {
+  if (failed_to_open_file_) {
+    return;
+  }
   HeapIterationScope iteration(thread());
+  num_tasks_ = Utils::Maximum(FLAG_heap_snapshot_tasks, 1);
 
   WriteBytes("dartheap", 8);  // Magic value.
   WriteUnsigned(0);           // Flags.
@@ -1143,14 +1416,34 @@ void HeapSnapshotWriter::Write() {
     isolate()->VisitObjectPointers(&visitor,
                                    ValidationPolicy::kDontValidateFrames);
 
-    // Heap objects.
+    // Heap objects. Those on regular old-space pages are numbered last, by
+    // the tasks.
     iteration.IterateVMIsolateObjects(&visitor);
-    iteration.IterateObjects(&visitor);
+    thread()->heap()->new_space()->VisitObjects(&visitor);
+    VisitUncountedPages(&visitor);
 
     // External properties.
     isolate()->group()->VisitWeakPersistentHandles(&visitor);
   }
 
+  {
+    const intptr_t num_pages = counting_pages_.length();
+    page_object_counts_.reset(new intptr_t[num_pages]);
+    page_reference_count_ = 0;
+    RunTasks(HeapSnapshotTask::kAssignObjectIds);
+
+    // Now that the number of objects on each page is known, make their ids
+    // follow those of the objects on the preceding pages.
+    for (intptr_t i = 0; i < num_pages; i++) {
+      OldPage* page = counting_pages_[i];
+      CountingPage* counting_page =
+          reinterpret_cast<CountingPage*>(page->forwarding_page());
+      counting_page->Rebase(object_count_);
+      object_count_ += page_object_counts_[i];
+    }
+    reference_count_ += page_reference_count_;
+  }
+
   {
     Pass2Visitor visitor(this);
 
@@ -1172,7 +1465,15 @@ void HeapSnapshotWriter::Write() {
     visitor.set_discount_sizes(true);
     iteration.IterateVMIsolateObjects(&visitor);
     visitor.set_discount_sizes(false);
-    iteration.IterateObjects(&visitor);
+    thread()->heap()->new_space()->VisitObjects(&visitor);
+    VisitUncountedPages(&visitor);
+    {
+      std::unique_ptr<HeapSnapshotPageBuffer[]> page_buffers(
+          new HeapSnapshotPageBuffer[num_tasks_ * kBufferedPagesPerTask]);
+      page_buffers_ = page_buffers.get();
+      RunTasks(HeapSnapshotTask::kWriteObjects);
+      page_buffers_ = nullptr;
+    }
 
     // External properties.
     WriteUnsigned(external_property_count_);
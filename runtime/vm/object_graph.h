@@ -7,8 +7,10 @@
 
 #include <memory>
 
+#include "platform/atomic.h"
 #include "vm/allocation.h"
 #include "vm/dart_api_state.h"
+#include "vm/growable_array.h"
 #include "vm/thread_stack_resource.h"
 
 namespace dart {
@@ -16,6 +18,9 @@ namespace dart {
 class Array;
 class Object;
 class CountingPage;
+class HeapSnapshotPageBuffer;
+class OldPage;
+class ThreadBarrier;
 
 #if !defined(PRODUCT)
 
@@ -117,11 +122,12 @@ class ObjectGraph : public ThreadStackResource {
   DISALLOW_IMPLICIT_CONSTRUCTORS(ObjectGraph);
 };
 
-// Generates a dump of the heap, whose format is described in
-// runtime/vm/service/heap_snapshot.md.
-class HeapSnapshotWriter : public ThreadStackResource {
+// Encodes the values of a heap snapshot, whose format is described in
+// runtime/vm/service/heap_snapshot.md, into a buffer.
+class HeapSnapshotEncoder {
  public:
-  explicit HeapSnapshotWriter(Thread* thread) : ThreadStackResource(thread) {}
+  HeapSnapshotEncoder() {}
+  virtual ~HeapSnapshotEncoder() {}
 
   void WriteSigned(int64_t value) {
     EnsureAvailable((sizeof(value) * kBitsPerByte) / 7 + 1);
@@ -178,6 +184,38 @@ class HeapSnapshotWriter : public ThreadStackResource {
     WriteBytes(value, len);
   }
 
+ protected:
+  void EnsureAvailable(intptr_t needed) {
+    if ((capacity_ - size_) < needed) {
+      Grow(needed);
+    }
+  }
+
+  // Makes room for at least [needed] more bytes in buffer_.
+  virtual void Grow(intptr_t needed) = 0;
+
+  uint8_t* buffer_ = nullptr;
+  intptr_t size_ = 0;
+  intptr_t capacity_ = 0;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(HeapSnapshotEncoder);
+};
+
+// Generates a dump of the heap, whose format is described in
+// runtime/vm/service/heap_snapshot.md.
+//
+// The dump is either streamed to the service in chunks, or written to a file,
+// in which case a single chunk is reused and the memory used by the writer
+// stays bounded. The objects on regular old-space pages, which make up most
+// of a large heap, are numbered and serialized by FLAG_heap_snapshot_tasks
+// tasks in parallel.
+class HeapSnapshotWriter : public ThreadStackResource,
+                           public HeapSnapshotEncoder {
+ public:
+  explicit HeapSnapshotWriter(Thread* thread, const char* filename = nullptr);
+  ~HeapSnapshotWriter();
+
   void AssignObjectId(ObjectPtr obj);
   intptr_t GetObjectId(ObjectPtr obj) const;
   void ClearObjectIds();
@@ -186,26 +224,49 @@ class HeapSnapshotWriter : public ThreadStackResource {
 
   void Write();
 
+  // Whether the file given to the constructor could not be opened, in which
+  // case Write does nothing.
+  bool failed_to_open_file() const { return failed_to_open_file_; }
+
  private:
+  friend class HeapSnapshotTask;
+
   static const intptr_t kMetadataReservation = 512;
   static const intptr_t kPreferredChunkSize = MB;
+  // The number of pages whose serialization each task may buffer before they
+  // are written out in order.
+  static const intptr_t kBufferedPagesPerTask = 2;
 
   void SetupCountingPages();
   bool OnImagePage(ObjectPtr obj) const;
   CountingPage* FindCountingPage(ObjectPtr obj) const;
 
-  void EnsureAvailable(intptr_t needed);
+  void VisitUncountedPages(ObjectVisitor* visitor) const;
+  void RunTasks(intptr_t phase);
+  void AssignPageObjectIds();
+  void WritePageObjects(ThreadBarrier* barrier, bool is_main);
+
+  virtual void Grow(intptr_t needed);
   void Flush(bool last = false);
 
-  uint8_t* buffer_ = nullptr;
-  intptr_t size_ = 0;
-  intptr_t capacity_ = 0;
+  void* file_ = nullptr;
+  bool failed_to_open_file_ = false;
 
   intptr_t class_count_ = 0;
   intptr_t object_count_ = 0;
   intptr_t reference_count_ = 0;
   intptr_t external_property_count_ = 0;
 
+  // Regular old-space pages, whose objects' ids are recorded in their
+  // CountingPage, and all other old-space pages.
+  MallocGrowableArray<OldPage*> counting_pages_;
+  MallocGrowableArray<OldPage*> uncounted_pages_;
+  std::unique_ptr<intptr_t[]> page_object_counts_;
+  RelaxedAtomic<intptr_t> page_reference_count_ = {0};
+  RelaxedAtomic<intptr_t> next_page_ = {0};
+  HeapSnapshotPageBuffer* page_buffers_ = nullptr;
+  intptr_t num_tasks_ = 1;
+
   struct ImagePageRange {
     uword base;
     uword size;
@@ -3,6 +3,8 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "vm/object_graph.h"
+#include "bin/directory.h"
+#include "bin/file.h"
 #include "platform/assert.h"
 #include "vm/unit_test.h"
 
@@ -191,6 +193,65 @@ ISOLATE_UNIT_TEST_CASE(RetainingPathGCRoot) {
   EXPECT_STREQ(result.gc_root_type, "local handle");
 }
 
+DECLARE_FLAG(int, heap_snapshot_tasks);
+
+// Writes a heap snapshot to [path] using [num_tasks] tasks and returns the
+// contents of the file, which the caller must free.
+static uint8_t* WriteHeapSnapshot(Thread* thread,
+                                  const char* path,
+                                  intptr_t num_tasks,
+                                  intptr_t* length) {
+  const intptr_t saved_tasks = FLAG_heap_snapshot_tasks;
+  FLAG_heap_snapshot_tasks = num_tasks;
+  {
+    HeapSnapshotWriter writer(thread, path);
+    EXPECT(!writer.failed_to_open_file());
+    writer.Write();
+  }
+  FLAG_heap_snapshot_tasks = saved_tasks;
+
+  void* file = Dart::file_open_callback()(path, /*write=*/false);
+  EXPECT(file != nullptr);
+  uint8_t* data = nullptr;
+  *length = 0;
+  Dart::file_read_callback()(&data, length, file);
+  Dart::file_close_callback()(file);
+  bin::File::Delete(nullptr, path);
+  EXPECT(data != nullptr);
+  EXPECT(*length > 8);
+  return data;
+}
+
+ISOLATE_UNIT_TEST_CASE(HeapSnapshotParallelTasks) {
+  // Spread objects over many old-space pages, so that every task gets some.
+  const intptr_t kNumArrays = 64 * 1024;
+  const Array& arrays = Array::Handle(Array::New(kNumArrays, Heap::kOld));
+  Array& array = Array::Handle();
+  for (intptr_t i = 0; i < kNumArrays; i++) {
+    array = Array::New(16, Heap::kOld);
+    array.SetAt(0, Smi::Handle(Smi::New(i)));
+    arrays.SetAt(i, array);
+  }
+  GCTestHelper::CollectAllGarbage();
+
+  const char* path = OS::SCreate(thread->zone(), "%s/heap_snapshot_%" Pd64,
+                                 bin::Directory::SystemTemp(nullptr),
+                                 OS::GetCurrentMonotonicMicros());
+  intptr_t serial_length;
+  uint8_t* serial = WriteHeapSnapshot(thread, path, 1, &serial_length);
+  intptr_t parallel_length;
+  uint8_t* parallel = WriteHeapSnapshot(thread, path, 4, &parallel_length);
+
+  // The tasks only change who serializes the pages, not the output.
+  EXPECT_EQ(0, memcmp("dartheap", serial, 8));
+  EXPECT_EQ(serial_length, parallel_length);
+  if (serial_length == parallel_length) {
+    EXPECT_EQ(0, memcmp(serial, parallel, serial_length));
+  }
+  free(serial);
+  free(parallel);
+}
+
 #endif  // !defined(PRODUCT)
 
 }  // namespace dart
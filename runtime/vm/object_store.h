@@ -236,6 +236,9 @@ class ObjectPointerVisitor;
   RW(Array, dispatch_table_code_entries)                                       \
   RW(GrowableObjectArray, code_order_tables)                                   \
   RW(Array, obfuscation_map)                                                   \
+  RW(Array, aot_type_feedback)                                                 \
+  RW(GrowableObjectArray, hot_code_order)                                      \
+  RW(GrowableObjectArray, cold_code)                                           \
   RW(GrowableObjectArray, ffi_callback_functions)                              \
   RW(Class, ffi_pointer_class)                                                 \
   RW(Class, ffi_native_type_class)                                             \
@@ -33,6 +33,7 @@ namespace dart {
 #define Z (thread->zone())
 
 DECLARE_FLAG(bool, dual_map_code);
+DECLARE_FLAG(bool, pack_unboxed_fields);
 DECLARE_FLAG(bool, write_protect_code);
 
 static ClassPtr CreateDummyClass(const String& class_name,
@@ -346,6 +347,126 @@ ISOLATE_UNIT_TEST_CASE(InstanceClass) {
   EXPECT(one_field_class.is_implemented());
 }
 
+#if defined(DART_PRECOMPILER)
+static const intptr_t kNumPackingTestBoxedFields = 70;
+static const intptr_t kNumPackingTestUnboxedFields = 4;
+
+// Creates a class whose boxed fields alone do not fit in the unboxed fields
+// bitmap, followed by unboxed double fields.
+static ClassPtr CreateFieldPackingTestClass(Thread* thread,
+                                            const char* class_name) {
+  Zone* zone = thread->zone();
+  const String& name = String::Handle(zone, Symbols::New(thread, class_name));
+  const Class& cls =
+      Class::Handle(zone, CreateDummyClass(name, Script::Handle(zone)));
+  ClassFinalizer::FinalizeTypesInClass(cls);
+
+  const intptr_t num_fields =
+      kNumPackingTestBoxedFields + kNumPackingTestUnboxedFields;
+  const Array& fields = Array::Handle(zone, Array::New(num_fields));
+  String& field_name = String::Handle(zone);
+  AbstractType& type = AbstractType::Handle(zone);
+  Field& field = Field::Handle(zone);
+  for (intptr_t i = 0; i < num_fields; i++) {
+    const bool is_unboxed = (i >= kNumPackingTestBoxedFields);
+    field_name = Symbols::New(thread, OS::SCreate(zone, "field%" Pd, i));
+    type = is_unboxed ? Type::Double() : Object::dynamic_type().raw();
+    field = Field::New(field_name, false, false, false, true, false, cls, type,
+                       TokenPosition::kMinSource, TokenPosition::kMinSource);
+    if (is_unboxed) {
+      // Normally set by the kernel loader from the inferred field types.
+      field.set_guarded_cid(kDoubleCid);
+      field.set_is_nullable(false);
+      field.set_is_unboxing_candidate(true);
+    }
+    fields.SetAt(i, field);
+  }
+  {
+    SafepointWriteRwLocker ml(thread, thread->isolate_group()->program_lock());
+    cls.SetFunctions(Array::empty_array());
+    cls.SetFields(fields);
+  }
+  cls.Finalize();
+  return cls.raw();
+}
+
+ISOLATE_UNIT_TEST_CASE(Class_PackUnboxedFields) {
+  SetFlagScope<bool> sfs_aot(&FLAG_precompiled_mode, true);
+  SetFlagScope<bool> sfs_pack(&FLAG_pack_unboxed_fields, true);
+  const Class& cls =
+      Class::Handle(CreateFieldPackingTestClass(thread, "PackedClass"));
+
+  // The unboxed fields come first and are all unboxed, the boxed fields keep
+  // their declaration order after them.
+  const intptr_t header_size = Instance::NextFieldOffset();
+  const intptr_t double_size = sizeof(double);
+  const intptr_t unboxed_size = kNumPackingTestUnboxedFields * double_size;
+  const Array& fields = Array::Handle(cls.fields());
+  Field& field = Field::Handle();
+  for (intptr_t i = 0; i < fields.Length(); i++) {
+    field ^= fields.At(i);
+    if (i < kNumPackingTestBoxedFields) {
+      EXPECT_EQ(header_size + unboxed_size + i * kWordSize,
+                field.HostOffset());
+    } else {
+      EXPECT(field.is_unboxing_candidate());
+      EXPECT_EQ(header_size + (i - kNumPackingTestBoxedFields) * double_size,
+                field.HostOffset());
+    }
+  }
+  const intptr_t instance_size =
+      header_size + unboxed_size + kNumPackingTestBoxedFields * kWordSize;
+  EXPECT_EQ(Utils::RoundUp(instance_size, kObjectAlignment),
+            cls.host_instance_size());
+
+  const UnboxedFieldBitmap bitmap =
+      thread->isolate_group()->shared_class_table()->GetUnboxedFieldsMapAt(
+          cls.id());
+  for (intptr_t i = 0; i < UnboxedFieldBitmap::Length(); i++) {
+    const intptr_t offset = i * kWordSize;
+    EXPECT_EQ((offset >= header_size) && (offset < header_size + unboxed_size),
+              bitmap.Get(i));
+  }
+
+#if !defined(PRODUCT)
+  // In declaration order the unboxed fields would not fit in the bitmap and
+  // would each point to a box instead.
+  const intptr_t unpacked_size =
+      Utils::RoundUp(header_size + fields.Length() * kWordSize,
+                     kObjectAlignment) +
+      kNumPackingTestUnboxedFields * Double::InstanceSize();
+  EXPECT_LT(0, cls.FieldPackingSavings());
+  EXPECT_EQ(unpacked_size - cls.host_instance_size(),
+            cls.FieldPackingSavings());
+#endif  // !defined(PRODUCT)
+}
+
+ISOLATE_UNIT_TEST_CASE(Class_PackUnboxedFieldsDisabled) {
+  SetFlagScope<bool> sfs_aot(&FLAG_precompiled_mode, true);
+  SetFlagScope<bool> sfs_pack(&FLAG_pack_unboxed_fields, false);
+  const Class& cls =
+      Class::Handle(CreateFieldPackingTestClass(thread, "UnpackedClass"));
+
+  // The unboxed fields are laid out past the end of the bitmap, so they are
+  // boxed.
+  const intptr_t header_size = Instance::NextFieldOffset();
+  const Array& fields = Array::Handle(cls.fields());
+  Field& field = Field::Handle();
+  for (intptr_t i = 0; i < fields.Length(); i++) {
+    field ^= fields.At(i);
+    EXPECT(!field.is_unboxing_candidate());
+    EXPECT_EQ(header_size + i * kWordSize, field.HostOffset());
+  }
+  EXPECT(thread->isolate_group()
+             ->shared_class_table()
+             ->GetUnboxedFieldsMapAt(cls.id())
+             .IsEmpty());
+#if !defined(PRODUCT)
+  EXPECT_EQ(0, cls.FieldPackingSavings());
+#endif  // !defined(PRODUCT)
+}
+#endif  // defined(DART_PRECOMPILER)
+
 ISOLATE_UNIT_TEST_CASE(Smi) {
   const Smi& smi = Smi::Handle(Smi::New(5));
   Object& smi_object = Object::Handle(smi.raw());
@@ -49,6 +49,11 @@ DEFINE_FLAG(bool,
             profile_vm_allocation,
             false,
             "Collect native stack traces when tracing Dart allocations.");
+DEFINE_FLAG(int,
+            allocation_sample_interval,
+            0,
+            "When positive, sample the stacks of new-space allocations of all "
+            "classes with a mean interval of this many bytes.");
 
 DEFINE_FLAG(
     int,
@@ -62,6 +67,7 @@ DEFINE_FLAG(
 #ifndef PRODUCT
 
 RelaxedAtomic<bool> Profiler::initialized_ = false;
+RelaxedAtomic<intptr_t> Profiler::next_sampled_allocation_id_ = 1;
 SampleBuffer* Profiler::sample_buffer_ = NULL;
 AllocationSampleBuffer* Profiler::allocation_sample_buffer_ = NULL;
 ProfilerCounters Profiler::counters_ = {};
@@ -1137,13 +1143,15 @@ void Profiler::DumpStackTrace(uword sp, uword fp, uword pc, bool for_crash) {
   }
 }
 
-void Profiler::SampleAllocation(Thread* thread, intptr_t cid) {
+Sample* Profiler::SampleAllocation(Thread* thread,
+                                   intptr_t cid,
+                                   intptr_t sampled_bytes) {
   ASSERT(thread != NULL);
   OSThread* os_thread = thread->os_thread();
   ASSERT(os_thread != NULL);
   Isolate* isolate = thread->isolate();
   if (!CheckIsolate(isolate)) {
-    return;
+    return NULL;
   }
 
   const bool exited_dart_code = thread->HasExitedDartCode();
@@ -1151,7 +1159,7 @@ void Profiler::SampleAllocation(Thread* thread, intptr_t cid) {
   SampleBuffer* sample_buffer = Profiler::sample_buffer();
   if (sample_buffer == NULL) {
     // Profiler not initialized.
-    return;
+    return NULL;
   }
 
   uintptr_t sp = OSThread::GetCurrentStackPointer();
@@ -1164,17 +1172,21 @@ void Profiler::SampleAllocation(Thread* thread, intptr_t cid) {
   uword stack_upper = 0;
 
   if (!InitialRegisterCheck(pc, fp, sp)) {
-    return;
+    return NULL;
   }
 
   if (!GetAndValidateThreadStackBounds(os_thread, thread, fp, sp, &stack_lower,
                                        &stack_upper)) {
     // Could not get stack boundary.
-    return;
+    return NULL;
   }
 
   Sample* sample = SetupSample(thread, sample_buffer, os_thread->trace_id());
   sample->SetAllocationCid(cid);
+  sample->set_sampled_allocation_bytes(sampled_bytes);
+  if (sampled_bytes != 0) {
+    sample->set_sampled_allocation_id(next_sampled_allocation_id_.fetch_add(1));
+  }
 
   if (FLAG_profile_vm_allocation) {
     ProfilerNativeStackWalker native_stack_walker(
@@ -1188,10 +1200,9 @@ void Profiler::SampleAllocation(Thread* thread, intptr_t cid) {
   } else {
     // Fall back.
     uintptr_t pc = OS::GetProgramCounter();
-    Sample* sample = SetupSample(thread, sample_buffer, os_thread->trace_id());
-    sample->SetAllocationCid(cid);
     sample->SetAt(0, pc);
   }
+  return sample;
 }
 
 Sample* Profiler::SampleNativeAllocation(intptr_t skip_count,
@@ -1555,6 +1566,10 @@ ProcessedSample* SampleBuffer::BuildProcessedSample(
   // Copy state bits from sample.
   processed_sample->set_native_allocation_size_bytes(
       sample->native_allocation_size_bytes());
+  processed_sample->set_sampled_allocation_bytes(
+      sample->sampled_allocation_bytes());
+  processed_sample->set_sampled_allocation_live(
+      sample->sampled_allocation_live());
   processed_sample->set_timestamp(sample->timestamp());
   processed_sample->set_tid(sample->tid());
   processed_sample->set_vm_tag(sample->vm_tag());
@@ -77,7 +77,12 @@ class Profiler : public AllStatic {
   static void DumpStackTrace(void* context);
   static void DumpStackTrace(bool for_crash = true);
 
-  static void SampleAllocation(Thread* thread, intptr_t cid);
+  // Records the stack of an allocation of class [cid]. [sampled_bytes] is
+  // the number of allocated bytes the sample stands for when it was taken by
+  // FLAG_allocation_sample_interval sampling, or 0 when the class is traced.
+  static Sample* SampleAllocation(Thread* thread,
+                                  intptr_t cid,
+                                  intptr_t sampled_bytes = 0);
   static Sample* SampleNativeAllocation(intptr_t skip_count,
                                         uword address,
                                         uintptr_t allocation_size);
@@ -112,6 +117,10 @@ class Profiler : public AllStatic {
   static void SampleThreadSingleFrame(Thread* thread, uintptr_t pc);
   static RelaxedAtomic<bool> initialized_;
 
+  // Identifies the samples taken by FLAG_allocation_sample_interval sampling.
+  // Zero is never handed out.
+  static RelaxedAtomic<intptr_t> next_sampled_allocation_id_;
+
   static SampleBuffer* sample_buffer_;
   static AllocationSampleBuffer* allocation_sample_buffer_;
 
@@ -212,6 +221,8 @@ class Sample {
     state_ = 0;
     native_allocation_address_ = 0;
     native_allocation_size_bytes_ = 0;
+    sampled_allocation_bytes_ = 0;
+    sampled_allocation_id_ = 0;
     continuation_index_ = -1;
     next_free_ = NULL;
     uword* pcs = GetPCArray();
@@ -329,6 +340,31 @@ class Sample {
     native_allocation_size_bytes_ = size;
   }
 
+  intptr_t sampled_allocation_bytes() const {
+    return sampled_allocation_bytes_;
+  }
+
+  void set_sampled_allocation_bytes(intptr_t bytes) {
+    sampled_allocation_bytes_ = bytes;
+  }
+
+  // Identifies the sampled allocation independently of the slot the sample
+  // occupies, which is reused once the sample buffer wraps around. Zero if
+  // the sample is not a sampled allocation.
+  intptr_t sampled_allocation_id() const { return sampled_allocation_id_; }
+
+  void set_sampled_allocation_id(intptr_t id) { sampled_allocation_id_ = id; }
+
+  // Whether the object of a sampled allocation was still alive when the
+  // samples were last reported.
+  bool sampled_allocation_live() const {
+    return SampledAllocationLiveBit::decode(state_);
+  }
+
+  void set_sampled_allocation_live(bool live) {
+    state_ = SampledAllocationLiveBit::update(live, state_);
+  }
+
   Sample* next_free() const { return next_free_; }
   void set_next_free(Sample* next_free) { next_free_ = next_free; }
 
@@ -395,7 +431,8 @@ class Sample {
     kClassAllocationSampleBit = 6,
     kContinuationSampleBit = 7,
     kThreadTaskBit = 8,  // 6 bits.
-    kNextFreeBit = 14,
+    kSampledAllocationLiveBit = 14,
+    kNextFreeBit = 15,
   };
   class HeadSampleBit : public BitField<uword, bool, kHeadSampleBit, 1> {};
   class LeafFrameIsDart : public BitField<uword, bool, kLeafFrameIsDartBit, 1> {
@@ -412,6 +449,8 @@ class Sample {
       : public BitField<uword, bool, kContinuationSampleBit, 1> {};
   class ThreadTaskBit
       : public BitField<uword, Thread::TaskKind, kThreadTaskBit, 6> {};
+  class SampledAllocationLiveBit
+      : public BitField<uword, bool, kSampledAllocationLiveBit, 1> {};
 
   int64_t timestamp_;
   ThreadId tid_;
@@ -425,6 +464,8 @@ class Sample {
   uword state_;
   uword native_allocation_address_;
   uintptr_t native_allocation_size_bytes_;
+  intptr_t sampled_allocation_bytes_;
+  intptr_t sampled_allocation_id_;
   intptr_t continuation_index_;
   Sample* next_free_;
 
@@ -760,6 +801,18 @@ class ProcessedSample : public ZoneAllocated {
     native_allocation_size_bytes_ = allocation_size;
   }
 
+  intptr_t sampled_allocation_bytes() const {
+    return sampled_allocation_bytes_;
+  }
+  void set_sampled_allocation_bytes(intptr_t bytes) {
+    sampled_allocation_bytes_ = bytes;
+  }
+
+  bool sampled_allocation_live() const { return sampled_allocation_live_; }
+  void set_sampled_allocation_live(bool live) {
+    sampled_allocation_live_ = live;
+  }
+
   // Was the stack trace truncated?
   bool truncated() const { return truncated_; }
   void set_truncated(bool truncated) { truncated_ = truncated; }
@@ -804,6 +857,8 @@ class ProcessedSample : public ZoneAllocated {
   bool first_frame_executing_;
   uword native_allocation_address_;
   uintptr_t native_allocation_size_bytes_;
+  intptr_t sampled_allocation_bytes_ = 0;
+  bool sampled_allocation_live_ = false;
   ProfileTrieNode* timeline_code_trie_;
   ProfileTrieNode* timeline_function_trie_;
 
@@ -1754,6 +1754,12 @@ void Profile::PrintSamplesJSON(JSONObject* obj, bool code_samples) {
       sample_obj.AddProperty64("_nativeAllocationSizeBytes",
                                sample->native_allocation_size_bytes());
     }
+    if (sample->sampled_allocation_bytes() != 0) {
+      sample_obj.AddProperty64("classId", sample->allocation_cid());
+      sample_obj.AddProperty64("_sampledAllocationBytes",
+                               sample->sampled_allocation_bytes());
+      sample_obj.AddProperty("_live", sample->sampled_allocation_live());
+    }
     {
       JSONArray stack(&sample_obj, "stack");
       // Walk the sampled PCs.
@@ -1902,6 +1908,87 @@ void ProfilerService::PrintNativeAllocationJSON(JSONStream* stream,
                 include_code_samples);
 }
 
+class SampledAllocationSampleFilter : public SampleFilter {
+ public:
+  SampledAllocationSampleFilter(Dart_Port port,
+                                intptr_t thread_task_mask,
+                                int64_t time_origin_micros,
+                                int64_t time_extent_micros)
+      : SampleFilter(port,
+                     thread_task_mask,
+                     time_origin_micros,
+                     time_extent_micros) {}
+
+  bool FilterSample(Sample* sample) {
+    return sample->is_allocation_sample() &&
+           (sample->sampled_allocation_bytes() != 0);
+  }
+};
+
+static int CompareSampledAllocationIds(const intptr_t* a, const intptr_t* b) {
+  if (*a < *b) {
+    return -1;
+  }
+  return (*a > *b) ? 1 : 0;
+}
+
+static bool ContainsSampledAllocationId(
+    const MallocGrowableArray<intptr_t>& ids,
+    intptr_t id) {
+  intptr_t lo = 0;
+  intptr_t hi = ids.length() - 1;
+  while (lo <= hi) {
+    const intptr_t mid = lo + (hi - lo) / 2;
+    if (ids[mid] < id) {
+      lo = mid + 1;
+    } else if (ids[mid] > id) {
+      hi = mid - 1;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Marks the sampled allocations whose objects are still alive. The heap keeps
+// a weak entry with the sample id of every sampled object, which the GC drops
+// when the object dies. The sample itself may have been overwritten by an
+// unrelated one since, so samples are matched by id rather than by slot.
+static void MarkLiveSampledAllocations(Thread* thread) {
+  SampleBuffer* sample_buffer = Profiler::sample_buffer();
+  if (sample_buffer == NULL) {
+    return;
+  }
+
+  MallocGrowableArray<intptr_t> live_ids;
+  thread->heap()->ForEachAllocationSample(
+      [&](intptr_t id) { live_ids.Add(id); });
+  live_ids.Sort(CompareSampledAllocationIds);
+
+  // Disable thread interrupts while processing the buffer.
+  DisableThreadInterruptsScope dtis(thread);
+  ThreadInterrupter::SampleBufferReaderScope scope;
+
+  for (intptr_t i = 0; i < sample_buffer->capacity(); i++) {
+    Sample* sample = sample_buffer->At(i);
+    const intptr_t id = sample->sampled_allocation_id();
+    sample->set_sampled_allocation_live(
+        (id != 0) && ContainsSampledAllocationId(live_ids, id));
+  }
+}
+
+void ProfilerService::PrintSampledAllocationJSON(JSONStream* stream,
+                                                 int64_t time_origin_micros,
+                                                 int64_t time_extent_micros) {
+  Thread* thread = Thread::Current();
+  Isolate* isolate = thread->isolate();
+  MarkLiveSampledAllocations(thread);
+  SampledAllocationSampleFilter filter(isolate->main_port(),
+                                       Thread::kMutatorTask,
+                                       time_origin_micros, time_extent_micros);
+  PrintJSONImpl(thread, stream, &filter, Profiler::sample_buffer(), true);
+}
+
 void ProfilerService::ClearSamples() {
   SampleBuffer* sample_buffer = Profiler::sample_buffer();
   if (sample_buffer == NULL) {
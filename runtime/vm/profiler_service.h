@@ -435,6 +435,13 @@ class ProfilerService : public AllStatic {
                                         int64_t time_extent_micros,
                                         bool include_code_samples);
 
+  // Prints the allocations sampled every FLAG_allocation_sample_interval
+  // bytes, each with the bytes it stands for and whether its object is still
+  // alive.
+  static void PrintSampledAllocationJSON(JSONStream* stream,
+                                         int64_t time_origin_micros,
+                                         int64_t time_extent_micros);
+
   static void ClearSamples();
 
  private:
@@ -21,6 +21,7 @@ DECLARE_FLAG(bool, profile_vm);
 DECLARE_FLAG(bool, profile_vm_allocation);
 DECLARE_FLAG(int, max_profile_depth);
 DECLARE_FLAG(int, optimization_counter_threshold);
+DECLARE_FLAG(int, allocation_sample_interval);
 
 // Some tests are written assuming native stack trace profiling is disabled.
 class DisableNativeProfileScope : public ValueObject {
@@ -676,6 +677,50 @@ ISOLATE_UNIT_TEST_CASE(Profiler_ToggleRecordAllocation) {
   }
 }
 
+ISOLATE_UNIT_TEST_CASE(Profiler_SampledAllocation) {
+  EnableProfiler();
+  DisableNativeProfileScope dnps;
+  DisableBackgroundCompilationScope dbcs;
+  SetFlagScope<int> sfs(&FLAG_allocation_sample_interval, 4 * KB);
+  const char* kScript =
+      "class A {\n"
+      "  var a;\n"
+      "  var b;\n"
+      "}\n"
+      "main() {\n"
+      "  var list = [];\n"
+      "  for (var i = 0; i < 10000; i++) {\n"
+      "    list.add(new A());\n"
+      "  }\n"
+      "  return list;\n"
+      "}\n";
+
+  const Library& root_library = Library::Handle(LoadTestScript(kScript));
+  const Class& class_a = Class::Handle(GetClass(root_library, "A"));
+  EXPECT(!class_a.IsNull());
+
+  // Start from a fresh TLAB so that its end is placed at a sample point.
+  thread->isolate_group()->heap()->new_space()->AbandonRemainingTLAB(thread);
+
+  Invoke(root_library, "main");
+
+  {
+    Thread* thread = Thread::Current();
+    Isolate* isolate = thread->isolate();
+    StackZone zone(thread);
+    HANDLESCOPE(thread);
+    Profile profile(isolate);
+    AllocationFilter filter(isolate->main_port(), class_a.id());
+    profile.Build(thread, &filter, Profiler::sample_buffer());
+    // The allocations of A are not traced, so every sample of them was taken
+    // by the byte-interval sampler and carries its weight.
+    EXPECT_LT(0, profile.sample_count());
+    for (intptr_t i = 0; i < profile.sample_count(); i++) {
+      EXPECT_LT(0, profile.SampleAt(i)->sampled_allocation_bytes());
+    }
+  }
+}
+
 ISOLATE_UNIT_TEST_CASE(Profiler_CodeTicks) {
   EnableProfiler();
   DisableNativeProfileScope dnps;
@@ -233,8 +233,19 @@ DEFINE_RUNTIME_ENTRY(IntegerDivisionByZeroException, 0) {
   Exceptions::ThrowByType(Exceptions::kIntegerDivisionByZeroException, args);
 }
 
-static Heap::Space SpaceForRuntimeAllocation() {
-  return FLAG_stress_write_barrier_elimination ? Heap::kOld : Heap::kNew;
+// Allocation stubs fall back to the runtime for classes marked as pretenured
+// by the scavenger's allocation-site feedback, which are allocated in old
+// space here. The stubs remember such objects on return.
+static Heap::Space SpaceForRuntimeAllocation(intptr_t cid) {
+  if (FLAG_stress_write_barrier_elimination) {
+    return Heap::kOld;
+  }
+#if !defined(PRODUCT)
+  if (IsolateGroup::Current()->shared_class_table()->PretenureFor(cid)) {
+    return Heap::kOld;
+  }
+#endif  // !defined(PRODUCT)
+  return Heap::kNew;
 }
 
 // Allocation of a fixed length array of given element type.
@@ -267,7 +278,8 @@ DEFINE_RUNTIME_ENTRY(AllocateArray, 2) {
 
   const Array& array = Array::Handle(
       zone,
-      Array::New(static_cast<intptr_t>(len), SpaceForRuntimeAllocation()));
+      Array::New(static_cast<intptr_t>(len),
+                 SpaceForRuntimeAllocation(kArrayCid)));
   arguments.SetReturn(array);
   TypeArguments& element_type =
       TypeArguments::CheckedHandle(zone, arguments.ArgAt(1));
@@ -331,8 +343,8 @@ DEFINE_RUNTIME_ENTRY(AllocateObject, 2) {
   const Error& error =
       Error::Handle(zone, cls.EnsureIsAllocateFinalized(thread));
   ThrowIfError(error);
-  const Instance& instance =
-      Instance::Handle(zone, Instance::New(cls, SpaceForRuntimeAllocation()));
+  const Instance& instance = Instance::Handle(
+      zone, Instance::New(cls, SpaceForRuntimeAllocation(cls.id())));
 
   arguments.SetReturn(instance);
   if (cls.NumTypeArguments() == 0) {
@@ -499,7 +511,8 @@ DEFINE_RUNTIME_ENTRY(SubtypeCheck, 5) {
 DEFINE_RUNTIME_ENTRY(AllocateContext, 1) {
   const Smi& num_variables = Smi::CheckedHandle(zone, arguments.ArgAt(0));
   const Context& context = Context::Handle(
-      zone, Context::New(num_variables.Value(), SpaceForRuntimeAllocation()));
+      zone, Context::New(num_variables.Value(),
+                         SpaceForRuntimeAllocation(kContextCid)));
   arguments.SetReturn(context);
 }
 
@@ -510,7 +523,8 @@ DEFINE_RUNTIME_ENTRY(AllocateContext, 1) {
 DEFINE_RUNTIME_ENTRY(CloneContext, 1) {
   const Context& ctx = Context::CheckedHandle(zone, arguments.ArgAt(0));
   Context& cloned_ctx = Context::Handle(
-      zone, Context::New(ctx.num_variables(), SpaceForRuntimeAllocation()));
+      zone, Context::New(ctx.num_variables(),
+                         SpaceForRuntimeAllocation(kContextCid)));
   cloned_ctx.set_parent(Context::Handle(zone, ctx.parent()));
   Object& inst = Object::Handle(zone);
   for (int i = 0; i < ctx.num_variables(); i++) {
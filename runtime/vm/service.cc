@@ -56,6 +56,7 @@ namespace dart {
 
 DECLARE_FLAG(bool, trace_service);
 DECLARE_FLAG(bool, trace_service_pause_events);
+DECLARE_FLAG(charp, write_heap_snapshot_to);
 DECLARE_FLAG(bool, profile_vm);
 DEFINE_FLAG(charp,
             vm_name,
@@ -4041,6 +4042,26 @@ static bool GetAllocationSamples(Thread* thread, JSONStream* js) {
   return true;
 }
 
+static const MethodParameter* get_sampled_allocations_params[] = {
+    RUNNABLE_ISOLATE_PARAMETER,
+    new Int64Parameter("timeOriginMicros", false),
+    new Int64Parameter("timeExtentMicros", false),
+    NULL,
+};
+
+static bool GetSampledAllocations(Thread* thread, JSONStream* js) {
+  int64_t time_origin_micros =
+      Int64Parameter::Parse(js->LookupParam("timeOriginMicros"));
+  int64_t time_extent_micros =
+      Int64Parameter::Parse(js->LookupParam("timeExtentMicros"));
+  if (CheckProfilerDisabled(thread, js)) {
+    return true;
+  }
+  ProfilerService::PrintSampledAllocationJSON(js, time_origin_micros,
+                                              time_extent_micros);
+  return true;
+}
+
 static const MethodParameter* get_native_allocation_samples_params[] = {
     NO_ISOLATE_PARAMETER,
     new Int64Parameter("timeOriginMicros", false),
@@ -4136,6 +4157,20 @@ static bool CollectAllGarbage(Thread* thread, JSONStream* js) {
   return true;
 }
 
+static const MethodParameter* release_memory_params[] = {
+    RUNNABLE_ISOLATE_PARAMETER,
+    NULL,
+};
+
+static bool ReleaseMemory(Thread* thread, JSONStream* js) {
+  Isolate* isolate = thread->isolate();
+  const intptr_t released = isolate->heap()->NotifyLowMemory();
+  JSONObject jsobj(js);
+  jsobj.AddProperty("type", "_ReleasedMemory");
+  jsobj.AddProperty64("bytes", released);
+  return true;
+}
+
 static const MethodParameter* get_heap_map_params[] = {
     RUNNABLE_ISOLATE_PARAMETER,
     NULL,
@@ -4159,13 +4194,33 @@ static bool GetHeapMap(Thread* thread, JSONStream* js) {
   return true;
 }
 
+static const MethodParameter* get_allocation_site_feedback_params[] = {
+    RUNNABLE_ISOLATE_PARAMETER,
+    NULL,
+};
+
+static bool GetAllocationSiteFeedback(Thread* thread, JSONStream* js) {
+  Isolate* isolate = thread->isolate();
+  isolate->heap()->PrintAllocationSiteFeedbackToJSONStream(isolate, js);
+  return true;
+}
+
 static const MethodParameter* request_heap_snapshot_params[] = {
     RUNNABLE_ISOLATE_PARAMETER,
     NULL,
 };
 
 static bool RequestHeapSnapshot(Thread* thread, JSONStream* js) {
-  if (Service::heapsnapshot_stream.enabled()) {
+  if (FLAG_write_heap_snapshot_to != nullptr) {
+    HeapSnapshotWriter writer(thread, FLAG_write_heap_snapshot_to);
+    if (writer.failed_to_open_file()) {
+      js->PrintError(kInternalError,
+                     "Could not open '%s' to write the heap snapshot.",
+                     FLAG_write_heap_snapshot_to);
+      return true;
+    }
+    writer.Write();
+  } else if (Service::heapsnapshot_stream.enabled()) {
     HeapSnapshotWriter writer(thread);
     writer.Write();
   }
@@ -5090,6 +5145,8 @@ static const ServiceMethodDescriptor service_methods_[] = {
     get_allocation_profile_params },
   { "_getAllocationSamples", GetAllocationSamples,
       get_allocation_samples_params },
+  { "_getAllocationSiteFeedback", GetAllocationSiteFeedback,
+    get_allocation_site_feedback_params },
   { "_getNativeAllocationSamples", GetNativeAllocationSamples,
       get_native_allocation_samples_params },
   { "getClassList", GetClassList,
@@ -5134,6 +5191,8 @@ static const ServiceMethodDescriptor service_methods_[] = {
     get_reachable_size_params },
   { "_getRetainedSize", GetRetainedSize,
     get_retained_size_params },
+  { "_getSampledAllocations", GetSampledAllocations,
+    get_sampled_allocations_params },
   { "getRetainingPath", GetRetainingPath,
     get_retaining_path_params },
   { "getScripts", GetScripts,
@@ -5192,6 +5251,8 @@ static const ServiceMethodDescriptor service_methods_[] = {
     set_vm_timeline_flags_params },
   { "_collectAllGarbage", CollectAllGarbage,
     collect_all_garbage_params },
+  { "_releaseMemory", ReleaseMemory,
+    release_memory_params },
   { "_getDefaultClassesAliases", GetDefaultClassesAliases,
     get_default_classes_aliases_params },
 };
@@ -6,6 +6,8 @@
 
 #include "platform/globals.h"
 
+#include "bin/directory.h"
+#include "bin/file.h"
 #include "include/dart_tools_api.h"
 #include "vm/dart_api_impl.h"
 #include "vm/dart_entry.h"
@@ -672,6 +674,77 @@ ISOLATE_UNIT_TEST_CASE(Service_EmbedderIsolateHandler) {
                handler.msg());
 }
 
+DECLARE_FLAG(charp, write_heap_snapshot_to);
+
+ISOLATE_UNIT_TEST_CASE(Service_RequestHeapSnapshotToFile) {
+  const char* kScript =
+      "var port;\n"  // Set to our mock port by C++.
+      "\n"
+      "main() {\n"
+      "}";
+
+  Isolate* isolate = thread->isolate();
+  isolate->set_is_runnable(true);
+  Dart_Handle lib;
+  {
+    TransitionVMToNative transition(thread);
+    lib = TestCase::LoadTestScript(kScript, NULL);
+    EXPECT_VALID(lib);
+    Dart_Handle result = Dart_Invoke(lib, NewString("main"), 0, NULL);
+    EXPECT_VALID(result);
+  }
+
+  // Build a mock message handler and wrap it in a dart port.
+  ServiceTestMessageHandler handler;
+  Dart_Port port_id = PortMap::CreatePort(&handler);
+  Dart_Handle port = Api::NewHandle(thread, SendPort::New(port_id));
+  {
+    TransitionVMToNative transition(thread);
+    EXPECT_VALID(port);
+    EXPECT_VALID(Dart_SetField(lib, NewString("port"), port));
+  }
+
+  const char* saved_path = FLAG_write_heap_snapshot_to;
+  const char* temp = bin::Directory::SystemTemp(nullptr);
+  const int64_t stamp = OS::GetCurrentMonotonicMicros();
+  Array& service_msg = Array::Handle();
+
+  // The snapshot is written to the file.
+  const char* path = OS::SCreate(thread->zone(), "%s/heap_snapshot_%" Pd64,
+                                 temp, stamp);
+  FLAG_write_heap_snapshot_to = path;
+  service_msg = Eval(lib, "[0, port, '0', 'requestHeapSnapshot', [], []]");
+  HandleIsolateMessage(isolate, service_msg);
+  EXPECT_EQ(MessageHandler::kOK, handler.HandleNextMessage());
+  EXPECT_SUBSTRING("\"type\":\"Success\"", handler.msg());
+  void* file = Dart::file_open_callback()(path, /*write=*/false);
+  EXPECT(file != nullptr);
+  if (file != nullptr) {
+    uint8_t* data = nullptr;
+    intptr_t length = 0;
+    Dart::file_read_callback()(&data, &length, file);
+    Dart::file_close_callback()(file);
+    EXPECT(length > 8);
+    if (length > 8) {
+      EXPECT_EQ(0, memcmp("dartheap", data, 8));
+    }
+    free(data);
+    bin::File::Delete(nullptr, path);
+  }
+
+  // A file that cannot be opened is reported as an error.
+  FLAG_write_heap_snapshot_to =
+      OS::SCreate(thread->zone(), "%s/missing_%" Pd64 "/heap_snapshot", temp,
+                  stamp);
+  service_msg = Eval(lib, "[0, port, '0', 'requestHeapSnapshot', [], []]");
+  HandleIsolateMessage(isolate, service_msg);
+  EXPECT_EQ(MessageHandler::kOK, handler.HandleNextMessage());
+  EXPECT_SUBSTRING("\"error\"", handler.msg());
+  EXPECT_SUBSTRING("Could not open", handler.msg());
+
+  FLAG_write_heap_snapshot_to = saved_path;
+}
+
 // TODO(zra): Remove when tests are ready to enable.
 #if !defined(TARGET_ARCH_ARM64)
 
@@ -518,6 +518,19 @@ class Thread : public ThreadState {
   static intptr_t top_offset() { return OFFSET_OF(Thread, top_); }
   static intptr_t end_offset() { return OFFSET_OF(Thread, end_); }
 
+  // Old-space allocation buffer, managed by PageSpace. Unlike the new-space
+  // TLAB above it is not used by generated code.
+  uword old_top() const { return old_top_; }
+  uword old_end() const { return old_end_; }
+  void set_old_top(uword top) { old_top_ = top; }
+  void set_old_end(uword end) { old_end_ = end; }
+  // Bytes allocated from the old-space allocation buffer that are not yet
+  // added to PageSpace::usage_.
+  intptr_t old_unaccounted_size() const { return old_unaccounted_size_; }
+  void set_old_unaccounted_size(intptr_t size) {
+    old_unaccounted_size_ = size;
+  }
+
   int32_t no_safepoint_scope_depth() const {
 #if defined(DEBUG)
     return no_safepoint_scope_depth_;
@@ -865,6 +878,32 @@ class Thread : public ThreadState {
 
   uint64_t GetRandomUInt64() { return thread_random_.NextUInt64(); }
 
+#if !defined(PRODUCT)
+  // State of the sampling of new-space allocations, see
+  // Scavenger::TrySampleAllocation. The TLAB is cut short at the next sample
+  // point, which lies [allocation_sample_bytes_left] bytes past
+  // [allocation_sample_top].
+  intptr_t allocation_sample_bytes_left() const {
+    return allocation_sample_bytes_left_;
+  }
+  void set_allocation_sample_bytes_left(intptr_t bytes) {
+    allocation_sample_bytes_left_ = bytes;
+  }
+  uword allocation_sample_top() const { return allocation_sample_top_; }
+  void set_allocation_sample_top(uword top) { allocation_sample_top_ = top; }
+
+  // The number of allocated bytes the next allocation is to be recorded for
+  // in the profiler, or 0 if it is not sampled.
+  intptr_t TakePendingAllocationSample() {
+    const intptr_t bytes = pending_allocation_sample_bytes_;
+    pending_allocation_sample_bytes_ = 0;
+    return bytes;
+  }
+  void set_pending_allocation_sample_bytes(intptr_t bytes) {
+    pending_allocation_sample_bytes_ = bytes;
+  }
+#endif  // !defined(PRODUCT)
+
   uint64_t* GetFfiMarshalledArguments(intptr_t size) {
     if (ffi_marshalled_arguments_size_ < size) {
       if (ffi_marshalled_arguments_size_ > 0) {
@@ -995,6 +1034,16 @@ class Thread : public ThreadState {
   intptr_t ffi_marshalled_arguments_size_ = 0;
   uint64_t* ffi_marshalled_arguments_;
 
+  uword old_top_ = 0;
+  uword old_end_ = 0;
+  intptr_t old_unaccounted_size_ = 0;
+
+#if !defined(PRODUCT)
+  intptr_t allocation_sample_bytes_left_ = 0;
+  uword allocation_sample_top_ = 0;
+  intptr_t pending_allocation_sample_bytes_ = 0;
+#endif  // !defined(PRODUCT)
+
   InstancePtr* field_table_values() const { return field_table_values_; }
 
 // Reusable handles support.
@@ -45,6 +45,11 @@ class VirtualMemory {
   static void Protect(void* address, intptr_t size, Protection mode);
   void Protect(Protection mode) { return Protect(address(), size(), mode); }
 
+  // Lets the OS reclaim the physical pages backing a page-aligned range that
+  // stays reserved and accessible. The contents of the range are undefined
+  // afterwards.
+  static void DontNeed(void* address, intptr_t size);
+
   // Reserves and commits a virtual memory segment with size. If a segment of
   // the requested size cannot be allocated, NULL is returned.
   static VirtualMemory* Allocate(intptr_t size,
@@ -57,6 +62,26 @@ class VirtualMemory {
                                         bool is_executable,
                                         const char* name);
 
+  // Allocates [count] segments of [size] bytes, each aligned to [size], out of
+  // one reservation that the OS is advised to back with transparent huge
+  // pages. If [numa_node] is not negative, it becomes the preferred node of
+  // the reservation. The segments are released independently. Returns the
+  // number of segments written to [segments], which is 0 if huge pages are
+  // not supported.
+  static intptr_t AllocateHugePageSegments(intptr_t size,
+                                           intptr_t count,
+                                           intptr_t numa_node,
+                                           VirtualMemory** segments);
+
+  // Returns the NUMA node of the CPU the calling thread runs on, or -1 if it
+  // cannot be determined.
+  static intptr_t CurrentNumaNode();
+
+  // Makes [numa_node] the preferred node for the pages of this segment that
+  // have not been faulted in yet. Has no effect where NUMA memory policies
+  // are not supported.
+  void PreferNumaNode(intptr_t numa_node);
+
   // Returns the cached page size. Use only if Init() has been called.
   static intptr_t PageSize() {
     ASSERT(page_size_ != 0);
@@ -157,6 +157,19 @@ VirtualMemory* VirtualMemory::AllocateAligned(intptr_t size,
   return result;
 }
 
+intptr_t VirtualMemory::AllocateHugePageSegments(intptr_t size,
+                                                 intptr_t count,
+                                                 intptr_t numa_node,
+                                                 VirtualMemory** segments) {
+  return 0;  // Not supported.
+}
+
+intptr_t VirtualMemory::CurrentNumaNode() {
+  return -1;
+}
+
+void VirtualMemory::PreferNumaNode(intptr_t numa_node) {}
+
 VirtualMemory::~VirtualMemory() {
   // Reserved region may be empty due to VirtualMemory::Truncate.
   if (vm_owns_region() && reserved_.size() != 0) {
@@ -218,6 +231,19 @@ void VirtualMemory::Protect(void* address, intptr_t size, Protection mode) {
   }
 }
 
+void VirtualMemory::DontNeed(void* address, intptr_t size) {
+  ASSERT(Utils::IsAligned(reinterpret_cast<uword>(address), PageSize()));
+  ASSERT(Utils::IsAligned(size, PageSize()));
+  zx_status_t status =
+      zx_vmar_op_range(zx_vmar_root_self(), ZX_VMAR_OP_DECOMMIT,
+                       reinterpret_cast<uword>(address), size, nullptr, 0);
+  LOG_INFO("zx_vmar_op_range(DECOMMIT, 0x%p, 0x%lx)\n", address, size);
+  if (status != ZX_OK) {
+    LOG_INFO("zx_vmar_op_range(DECOMMIT, 0x%p, 0x%lx) failed: %s\n", address,
+             size, zx_status_get_string(status));
+  }
+}
+
 }  // namespace dart
 
 #endif  // defined(HOST_OS_FUCHSIA)
@@ -269,6 +269,87 @@ VirtualMemory* VirtualMemory::AllocateAligned(intptr_t size,
   return new VirtualMemory(region, region);
 }
 
+#if defined(HOST_OS_ANDROID) || defined(HOST_OS_LINUX)
+// From <numaif.h>, which not all C libraries provide.
+static const int kMemoryPolicyPreferred = 1;
+
+static void PreferNumaNodeForRange(uword start,
+                                   intptr_t size,
+                                   intptr_t numa_node) {
+#if defined(__NR_mbind)
+  if ((numa_node < 0) || (numa_node >= kBitsPerWord)) {
+    return;
+  }
+  uword node_mask = static_cast<uword>(1) << numa_node;
+  // Failure only means the default (first touch) policy stays in effect.
+  syscall(__NR_mbind, reinterpret_cast<void*>(start), size,
+          kMemoryPolicyPreferred, &node_mask, kBitsPerWord + 1, 0);
+  LOG_INFO("mbind(0x%" Px ", 0x%" Px ", node %" Pd ")\n", start, size,
+           numa_node);
+#endif
+}
+#endif  // defined(HOST_OS_ANDROID) || defined(HOST_OS_LINUX)
+
+intptr_t VirtualMemory::AllocateHugePageSegments(intptr_t size,
+                                                 intptr_t count,
+                                                 intptr_t numa_node,
+                                                 VirtualMemory** segments) {
+#if (defined(HOST_OS_ANDROID) || defined(HOST_OS_LINUX)) &&                   \
+    defined(MADV_HUGEPAGE)
+  ASSERT(Utils::IsPowerOfTwo(size));
+  ASSERT(Utils::IsAligned(size, PageSize()));
+  ASSERT(count > 0);
+  const intptr_t kHugePageSize = 2 * MB;
+  const intptr_t alignment = Utils::Maximum(size, kHugePageSize);
+  const intptr_t total_size = size * count;
+  const intptr_t allocated_size = total_size + alignment - PageSize();
+  void* address = mmap(NULL, allocated_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  LOG_INFO("mmap(NULL, 0x%" Px ", ...): %p\n", allocated_size, address);
+  if (address == MAP_FAILED) {
+    return 0;
+  }
+
+  const uword base = reinterpret_cast<uword>(address);
+  const uword aligned_base = Utils::RoundUp(base, alignment);
+  unmap(base, aligned_base);
+  unmap(aligned_base + total_size, base + allocated_size);
+
+  // Fails if transparent huge pages are disabled, in which case the segments
+  // are ordinary pages.
+  madvise(reinterpret_cast<void*>(aligned_base), total_size, MADV_HUGEPAGE);
+  PreferNumaNodeForRange(aligned_base, total_size, numa_node);
+
+  for (intptr_t i = 0; i < count; i++) {
+    MemoryRegion region(reinterpret_cast<void*>(aligned_base + i * size),
+                        size);
+    segments[i] = new VirtualMemory(region, region);
+  }
+  return count;
+#else
+  return 0;
+#endif
+}
+
+intptr_t VirtualMemory::CurrentNumaNode() {
+#if (defined(HOST_OS_ANDROID) || defined(HOST_OS_LINUX)) &&                   \
+    defined(__NR_getcpu)
+  unsigned cpu = 0;
+  unsigned node = 0;
+  if (syscall(__NR_getcpu, &cpu, &node, nullptr) == 0) {
+    return node;
+  }
+#endif
+  return -1;
+}
+
+void VirtualMemory::PreferNumaNode(intptr_t numa_node) {
+#if defined(HOST_OS_ANDROID) || defined(HOST_OS_LINUX)
+  ASSERT(vm_owns_region());
+  PreferNumaNodeForRange(start(), size(), numa_node);
+#endif
+}
+
 VirtualMemory::~VirtualMemory() {
   if (vm_owns_region()) {
     unmap(reserved_.start(), reserved_.end());
@@ -327,6 +408,24 @@ void VirtualMemory::Protect(void* address, intptr_t size, Protection mode) {
            end_address - page_address, prot);
 }
 
+void VirtualMemory::DontNeed(void* address, intptr_t size) {
+  ASSERT(Utils::IsAligned(reinterpret_cast<uword>(address), PageSize()));
+  ASSERT(Utils::IsAligned(size, PageSize()));
+#if defined(HOST_OS_MACOS)
+  // MADV_DONTNEED is only a hint on macOS; MADV_FREE releases the pages.
+  const int advice = MADV_FREE;
+#else
+  const int advice = MADV_DONTNEED;
+#endif
+  if (madvise(address, size, advice) != 0) {
+    LOG_INFO("madvise(0x%" Px ", 0x%" Px ", %d) failed\n",
+             reinterpret_cast<uword>(address), size, advice);
+    return;
+  }
+  LOG_INFO("madvise(0x%" Px ", 0x%" Px ", %d) ok\n",
+           reinterpret_cast<uword>(address), size, advice);
+}
+
 }  // namespace dart
 
 #endif  // defined(HOST_OS_ANDROID ... HOST_OS_LINUX ... HOST_OS_MACOS)
@@ -88,4 +88,26 @@ VM_UNIT_TEST_CASE(FreeVirtualMemory) {
   }
 }
 
+VM_UNIT_TEST_CASE(HugePageSegments) {
+  const intptr_t kSegmentSize = kOldPageSize;
+  const intptr_t kNumSegments = 4;
+  VirtualMemory* segments[kNumSegments];
+  const intptr_t count = VirtualMemory::AllocateHugePageSegments(
+      kSegmentSize, kNumSegments, VirtualMemory::CurrentNumaNode(), segments);
+  // Not supported on all platforms.
+  EXPECT(count == 0 || count == kNumSegments);
+  for (intptr_t i = 0; i < count; i++) {
+    EXPECT(Utils::IsAligned(segments[i]->start(), kSegmentSize));
+    EXPECT_EQ(kSegmentSize, segments[i]->size());
+    if (i > 0) {
+      EXPECT_EQ(segments[i - 1]->end(), segments[i]->start());
+    }
+    memset(segments[i]->address(), 0xAB, kSegmentSize);
+  }
+  // Segments are released independently.
+  for (intptr_t i = count - 1; i >= 0; i--) {
+    delete segments[i];
+  }
+}
+
 }  // namespace dart
@@ -67,6 +67,19 @@ VirtualMemory* VirtualMemory::AllocateAligned(intptr_t size,
   return new VirtualMemory(region, reserved);
 }
 
+intptr_t VirtualMemory::AllocateHugePageSegments(intptr_t size,
+                                                 intptr_t count,
+                                                 intptr_t numa_node,
+                                                 VirtualMemory** segments) {
+  return 0;  // Not supported.
+}
+
+intptr_t VirtualMemory::CurrentNumaNode() {
+  return -1;
+}
+
+void VirtualMemory::PreferNumaNode(intptr_t numa_node) {}
+
 VirtualMemory::~VirtualMemory() {
   // Note that the size of the reserved region might be set to 0 by
   // Truncate(0, true) but that does not actually release the mapping
@@ -122,6 +135,15 @@ void VirtualMemory::Protect(void* address, intptr_t size, Protection mode) {
   }
 }
 
+void VirtualMemory::DontNeed(void* address, intptr_t size) {
+  ASSERT(Utils::IsAligned(reinterpret_cast<uword>(address), PageSize()));
+  ASSERT(Utils::IsAligned(size, PageSize()));
+  // MEM_RESET keeps the range committed but lets the system discard its
+  // contents instead of writing them to the paging file. This is only advice,
+  // so a failure just leaves the pages resident.
+  VirtualAlloc(address, size, MEM_RESET, PAGE_READWRITE);
+}
+
 }  // namespace dart
 
 #endif  // defined(HOST_OS_WINDOWS)